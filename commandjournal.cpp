@@ -0,0 +1,381 @@
+#include "commandjournal.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <chrono>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(CommandJournalRecord) == CommandJournalRecord::SIZE, "CommandJournalRecord 必须为定长32字节");
+static_assert(sizeof(CommandJournalHeader) == CommandJournalHeader::SIZE, "日志文件头必须为16字节");
+
+CommandJournal::CommandJournal()
+    : m_jointCount(0)
+    , m_sequence(0)
+    , m_fileRecords(0)
+    , m_pendingRecords(0)
+{
+}
+
+CommandJournal::~CommandJournal()
+{
+    close();
+}
+
+bool CommandJournal::open(const QString &fileName, int jointCount, CommandJournalState *state, QString *errorMessage)
+{
+    close();
+
+    m_fileName = fileName;
+    m_jointCount = jointCount;
+    m_sequence = 0;
+    m_fileRecords = 0;
+    m_pending.clear();
+    m_pendingRecords = 0;
+    m_state = CommandJournalState();
+    m_state.targets.fill(0.0, jointCount);
+
+    qint64 validBytes = 0;
+    if (QFileInfo::exists(fileName)) {
+        QString replayError;
+        if (replay(fileName, jointCount, &m_state, &validBytes, &replayError)) {
+            m_sequence = m_state.sequence;
+        } else {
+            // 无法识别的旧日志保留下来供排查，然后重新开始
+            const QString corruptName = fileName + ".corrupt";
+            QFile::remove(corruptName);
+            QFile::rename(fileName, corruptName);
+            qWarning() << "指令日志无法重放，已另存为" << corruptName << ":" << replayError;
+            m_state = CommandJournalState();
+            m_state.targets.fill(0.0, jointCount);
+            validBytes = 0;
+        }
+    }
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法打开指令日志 %1: %2").arg(fileName, m_file.errorString());
+        }
+        return false;
+    }
+
+    if (validBytes == 0) {
+        CommandJournalHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = CommandJournalHeader::MAGIC;
+        header.version = CommandJournalHeader::VERSION;
+        header.jointCount = static_cast<quint32>(jointCount);
+        if (!m_file.resize(0)
+                || m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)
+                || !syncFile(m_file)) {
+            if (errorMessage) {
+                *errorMessage = QString("无法写入指令日志 %1: %2").arg(fileName, m_file.errorString());
+            }
+            m_file.close();
+            return false;
+        }
+    } else if (m_file.size() > validBytes) {
+        // 截掉崩溃时写了一半的尾部记录
+        m_file.resize(validBytes);
+    }
+    m_file.seek(m_file.size());
+    m_fileRecords = m_state.records;
+
+    if (state) {
+        *state = m_state;
+    }
+    return true;
+}
+
+void CommandJournal::close()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    append(CommandJournalType::CleanShutdown, 0, 0.0);
+    QString error;
+    if (!sync(&error)) {
+        qWarning() << error;
+    }
+    m_file.close();
+}
+
+void CommandJournal::recordTarget(int jointId, double value)
+{
+    append(CommandJournalType::Target, jointId, value);
+}
+
+void CommandJournal::recordEnabled(int jointId, bool enabled)
+{
+    append(CommandJournalType::Enable, jointId, enabled ? 1.0 : 0.0);
+}
+
+void CommandJournal::recordEmergencyStop(bool active)
+{
+    append(CommandJournalType::EmergencyStop, 0, active ? 1.0 : 0.0);
+}
+
+void CommandJournal::append(CommandJournalType type, int jointId, double value)
+{
+    if (!m_file.isOpen() || jointId < 0 || jointId >= m_jointCount) {
+        return;
+    }
+
+    CommandJournalRecord record;
+    record.type = static_cast<quint16>(type);
+    record.joint = static_cast<quint16>(jointId);
+    record.checksum = 0;
+    record.sequence = ++m_sequence;
+    record.timestampUs = currentTimeUs();
+    record.value = value;
+    record.checksum = recordChecksum(record);
+
+    apply(m_state, record);
+    m_pending.append(reinterpret_cast<const char *>(&record), sizeof(record));
+    ++m_pendingRecords;
+
+    if (m_pendingRecords >= SYNC_BATCH_RECORDS) {
+        QString error;
+        if (!sync(&error)) {
+            qWarning() << error;
+        }
+    }
+}
+
+bool CommandJournal::sync(QString *errorMessage)
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    if (m_pendingRecords == 0) {
+        return true;
+    }
+
+    // 快照已包含缓冲中的记录
+    if (m_fileRecords + static_cast<quint64>(m_pendingRecords) > COMPACT_THRESHOLD) {
+        return compact(errorMessage);
+    }
+
+    if (m_file.write(m_pending) != m_pending.size() || !syncFile(m_file)) {
+        if (errorMessage) {
+            *errorMessage = QString("指令日志写入失败: %1").arg(m_file.errorString());
+        }
+        // 写入失败时回到上次完整落盘的位置，缓冲保留到下次重试
+        m_file.resize(CommandJournalHeader::SIZE + qint64(m_fileRecords) * CommandJournalRecord::SIZE);
+        m_file.seek(m_file.size());
+        return false;
+    }
+
+    m_fileRecords += static_cast<quint64>(m_pendingRecords);
+    m_pending.clear();
+    m_pendingRecords = 0;
+    return true;
+}
+
+bool CommandJournal::compact(QString *errorMessage)
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    return writeSnapshot(errorMessage);
+}
+
+bool CommandJournal::writeSnapshot(QString *errorMessage)
+{
+    // 当前状态写成最少的记录：已下发的目标位置、全部使能位和急停状态
+    QVector<CommandJournalRecord> records;
+    auto add = [&](CommandJournalType type, int jointId, double value) {
+        CommandJournalRecord record;
+        record.type = static_cast<quint16>(type);
+        record.joint = static_cast<quint16>(jointId);
+        record.checksum = 0;
+        record.sequence = ++m_sequence;
+        record.timestampUs = m_state.lastCommandUs;
+        record.value = value;
+        record.checksum = recordChecksum(record);
+        records.append(record);
+    };
+
+    const int maskJoints = qMin(m_jointCount, 64);
+    for (int i = 0; i < maskJoints; ++i) {
+        if (m_state.targetMask & (quint64(1) << i)) {
+            add(CommandJournalType::Target, i, m_state.targets[i]);
+        }
+    }
+    for (int i = 0; i < maskJoints; ++i) {
+        add(CommandJournalType::Enable, i, (m_state.enableMask >> i) & 1u ? 1.0 : 0.0);
+    }
+    add(CommandJournalType::EmergencyStop, 0, m_state.emergencyStop ? 1.0 : 0.0);
+    if (m_state.cleanShutdown) {
+        add(CommandJournalType::CleanShutdown, 0, 0.0);
+    }
+
+    CommandJournalHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = CommandJournalHeader::MAGIC;
+    header.version = CommandJournalHeader::VERSION;
+    header.jointCount = static_cast<quint32>(m_jointCount);
+
+    // QSaveFile 写临时文件后改名替换，崩溃时旧日志仍然完整
+    QSaveFile snapshot(m_fileName);
+    const qint64 recordBytes = qint64(records.size()) * CommandJournalRecord::SIZE;
+    if (!snapshot.open(QIODevice::WriteOnly)
+            || snapshot.write(reinterpret_cast<const char *>(&header), sizeof(header)) != sizeof(header)
+            || snapshot.write(reinterpret_cast<const char *>(records.constData()), recordBytes) != recordBytes
+            || !syncFile(snapshot)
+            || !snapshot.commit()) {
+        if (errorMessage) {
+            *errorMessage = QString("指令日志压缩失败: %1").arg(snapshot.errorString());
+        }
+        snapshot.cancelWriting();
+        return false;
+    }
+
+    // 旧文件句柄指向被替换的文件，重新打开新日志继续追加
+    m_file.close();
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法重新打开指令日志 %1: %2").arg(m_fileName, m_file.errorString());
+        }
+        return false;
+    }
+    m_file.seek(m_file.size());
+
+    m_fileRecords = static_cast<quint64>(records.size());
+    m_pending.clear();
+    m_pendingRecords = 0;
+    return true;
+}
+
+bool CommandJournal::replay(const QString &fileName, int jointCount, CommandJournalState *state,
+                            qint64 *validBytes, QString *errorMessage)
+{
+    CommandJournalState result;
+    result.targets.fill(0.0, jointCount);
+    if (validBytes) {
+        *validBytes = 0;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法打开指令日志 %1: %2").arg(fileName, file.errorString());
+        }
+        return false;
+    }
+    const QByteArray data = file.readAll();
+
+    CommandJournalHeader header;
+    if (data.size() < CommandJournalHeader::SIZE) {
+        if (errorMessage) {
+            *errorMessage = "文件头不完整";
+        }
+        return false;
+    }
+    std::memcpy(&header, data.constData(), sizeof(header));
+    if (header.magic != CommandJournalHeader::MAGIC || header.version != CommandJournalHeader::VERSION) {
+        if (errorMessage) {
+            *errorMessage = "不是指令日志文件或版本不支持";
+        }
+        return false;
+    }
+    if (header.jointCount != static_cast<quint32>(jointCount)) {
+        if (errorMessage) {
+            *errorMessage = QString("日志关节数 %1 与当前机器人描述 %2 不一致").arg(header.jointCount).arg(jointCount);
+        }
+        return false;
+    }
+
+    // 逐条校验，遇到第一条无效记录（崩溃时未写完）即停止
+    qint64 offset = CommandJournalHeader::SIZE;
+    quint64 previousSequence = 0;
+    while (offset + CommandJournalRecord::SIZE <= data.size()) {
+        CommandJournalRecord record;
+        std::memcpy(&record, data.constData() + offset, sizeof(record));
+        if (record.checksum != recordChecksum(record) || record.sequence <= previousSequence
+                || record.joint >= static_cast<quint32>(jointCount)) {
+            break;
+        }
+        apply(result, record);
+        previousSequence = record.sequence;
+        offset += CommandJournalRecord::SIZE;
+    }
+
+    if (state) {
+        *state = result;
+    }
+    if (validBytes) {
+        *validBytes = offset;
+    }
+    return true;
+}
+
+void CommandJournal::apply(CommandJournalState &state, const CommandJournalRecord &record)
+{
+    const quint64 bit = record.joint < 64 ? quint64(1) << record.joint : 0;
+    state.sequence = record.sequence;
+    ++state.records;
+
+    switch (static_cast<CommandJournalType>(record.type)) {
+    case CommandJournalType::Target:
+        if (record.joint < state.targets.size()) {
+            state.targets[record.joint] = record.value;
+            state.targetMask |= bit;
+        }
+        break;
+    case CommandJournalType::Enable:
+        if (record.value != 0.0) {
+            state.enableMask |= bit;
+        } else {
+            state.enableMask &= ~bit;
+        }
+        break;
+    case CommandJournalType::EmergencyStop:
+        state.emergencyStop = record.value != 0.0;
+        break;
+    case CommandJournalType::CleanShutdown:
+        state.cleanShutdown = true;
+        return;
+    }
+
+    state.cleanShutdown = false;
+    state.lastCommandUs = record.timestampUs;
+}
+
+quint32 CommandJournal::recordChecksum(const CommandJournalRecord &record)
+{
+    // FNV-1a，校验范围：去掉 checksum 字段本身的整条记录
+    CommandJournalRecord copy = record;
+    copy.checksum = 0;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&copy);
+    quint32 hash = 2166136261u;
+    for (int i = 0; i < CommandJournalRecord::SIZE; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool CommandJournal::syncFile(QFileDevice &file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return ::_commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+qint64 CommandJournal::currentTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
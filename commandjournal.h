@@ -0,0 +1,115 @@
+#ifndef COMMANDJOURNAL_H
+#define COMMANDJOURNAL_H
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+
+// 指令日志记录类型
+enum class CommandJournalType : quint16 {
+    Target = 1,         // 关节目标位置
+    Enable = 2,         // 关节使能（value 非零为使能）
+    EmergencyStop = 3,  // 急停状态（value 非零为急停）
+    CleanShutdown = 4   // 正常退出标记
+};
+
+// 定长记录（32字节）
+struct CommandJournalRecord {
+    static const int SIZE = 32;
+
+    quint16 type;
+    quint16 joint;
+    quint32 checksum;       // 去掉本字段后的记录校验
+    quint64 sequence;
+    qint64 timestampUs;     // UTC 微秒
+    double value;
+};
+
+// 日志文件头（16字节）
+struct CommandJournalHeader {
+    static const quint32 MAGIC = 0x4C4E4A43;  // "CJNL"
+    static const quint32 VERSION = 1;
+    static const int SIZE = 16;
+
+    quint32 magic;
+    quint32 version;
+    quint32 jointCount;
+    quint32 reserved;
+};
+
+// 由日志重放得到的指令状态
+struct CommandJournalState {
+    QVector<double> targets;
+    quint64 targetMask;     // 下发过目标位置的关节
+    quint64 enableMask;
+    bool emergencyStop;
+    bool cleanShutdown;     // 最后一条记录是正常退出标记
+    quint64 records;        // 有效记录数
+    quint64 sequence;       // 最后一条记录的序号
+    qint64 lastCommandUs;
+
+    CommandJournalState() : targetMask(0), enableMask(0), emergencyStop(false)
+                          , cleanShutdown(false), records(0), sequence(0), lastCommandUs(0) {}
+    bool isEmpty() const { return records == 0; }
+};
+
+// 指令预写日志
+// 改变机器人指令状态的操作（目标位置、使能、急停）先以定长记录追加到缓冲区，
+// 由 sync() 成批写入并 fsync（控制器定时调用，急停立即调用）。启动时 open()
+// 重放日志恢复最后下发的指令状态，遇到校验失败的残缺尾部即截断。
+// 文件中记录数超过阈值时把当前状态压缩成快照，原子替换旧日志。
+class CommandJournal
+{
+public:
+    static const int SYNC_INTERVAL_MS = 20;
+    static const int SYNC_BATCH_RECORDS = 256;      // 缓冲超过此数时立即落盘
+    static const int COMPACT_THRESHOLD = 4096;      // 文件记录数超过此值时压缩
+
+    CommandJournal();
+    ~CommandJournal();
+
+    // 打开（不存在则创建）日志并重放已有记录；格式不符的旧日志改名为 .corrupt 后重新开始
+    bool open(const QString &fileName, int jointCount, CommandJournalState *state = nullptr,
+              QString *errorMessage = nullptr);
+    // 写入正常退出标记并落盘
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString fileName() const { return m_fileName; }
+
+    void recordTarget(int jointId, double value);
+    void recordEnabled(int jointId, bool enabled);
+    void recordEmergencyStop(bool active);
+
+    // 把缓冲的记录写入文件并 fsync，文件过大时先压缩
+    bool sync(QString *errorMessage = nullptr);
+    bool compact(QString *errorMessage = nullptr);
+    bool hasPending() const { return m_pendingRecords > 0; }
+    quint64 fileRecords() const { return m_fileRecords; }
+
+    // 包含尚未落盘记录在内的最新指令状态
+    const CommandJournalState &state() const { return m_state; }
+
+    // 只读重放：validBytes 返回有效部分（文件头 + 完整记录）的长度
+    static bool replay(const QString &fileName, int jointCount, CommandJournalState *state,
+                       qint64 *validBytes = nullptr, QString *errorMessage = nullptr);
+
+private:
+    void append(CommandJournalType type, int jointId, double value);
+    bool writeSnapshot(QString *errorMessage);
+    static void apply(CommandJournalState &state, const CommandJournalRecord &record);
+    static quint32 recordChecksum(const CommandJournalRecord &record);
+    static bool syncFile(QFileDevice &file);
+    static qint64 currentTimeUs();
+
+    QString m_fileName;
+    QFile m_file;
+    int m_jointCount;
+    quint64 m_sequence;
+    quint64 m_fileRecords;          // 文件中已有的记录数
+    QByteArray m_pending;           // 尚未写入的记录
+    int m_pendingRecords;
+    CommandJournalState m_state;
+};
+
+#endif // COMMANDJOURNAL_H
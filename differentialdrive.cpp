@@ -0,0 +1,176 @@
+#include "differentialdrive.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+double wrapAngle(double angle)
+{
+    return std::remainder(angle, 2.0 * PI);
+}
+
+} // namespace
+
+DifferentialDrive::DifferentialDrive()
+    : m_configured(false)
+    , m_linear(0.0)
+    , m_angular(0.0)
+    , m_distance(0.0)
+    , m_commandLinear(0.0)
+    , m_commandAngular(0.0)
+    , m_outputLeft(0.0)
+    , m_outputRight(0.0)
+    , m_saturated(false)
+{
+}
+
+bool DifferentialDrive::configure(const DriveGeometry &geometry, const MotionLimits &wheelLimits,
+                                  std::string *errorMessage)
+{
+    auto fail = [&](const std::string &message) {
+        m_configured = false;
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    if (!(geometry.wheelRadius > 0.0) || !(geometry.trackWidth > 0.0) || !(geometry.gearRatio > 0.0)) {
+        return fail("底盘几何参数无效");
+    }
+    if (std::fabs(std::fabs(geometry.leftDirection) - 1.0) > 1e-9
+        || std::fabs(std::fabs(geometry.rightDirection) - 1.0) > 1e-9) {
+        return fail("电机安装方向只能为 1 或 -1");
+    }
+    if (!(wheelLimits.maxVelocity > 0.0) || !(wheelLimits.maxAcceleration > 0.0)) {
+        return fail("轮速限制无效");
+    }
+    m_geometry = geometry;
+    m_wheelLimits = wheelLimits;
+    m_configured = true;
+    halt();
+    return true;
+}
+
+double DifferentialDrive::wheelScale() const
+{
+    return 2.0 * PI / 60.0 / m_geometry.gearRatio * m_geometry.wheelRadius;
+}
+
+void DifferentialDrive::wheelSpeeds(double linear, double angular, double *left, double *right) const
+{
+    const double halfTrack = 0.5 * m_geometry.trackWidth;
+    *left = (linear - angular * halfTrack) / wheelScale() * m_geometry.leftDirection;
+    *right = (linear + angular * halfTrack) / wheelScale() * m_geometry.rightDirection;
+}
+
+void DifferentialDrive::bodyVelocity(double left, double right, double *linear, double *angular) const
+{
+    const double leftSpeed = left * m_geometry.leftDirection * wheelScale();
+    const double rightSpeed = right * m_geometry.rightDirection * wheelScale();
+    *linear = 0.5 * (leftSpeed + rightSpeed);
+    *angular = (rightSpeed - leftSpeed) / m_geometry.trackWidth;
+}
+
+double DifferentialDrive::maxLinearAcceleration() const
+{
+    return m_wheelLimits.maxAcceleration * wheelScale();
+}
+
+double DifferentialDrive::maxAngularAcceleration() const
+{
+    return 2.0 * m_wheelLimits.maxAcceleration * wheelScale() / m_geometry.trackWidth;
+}
+
+void DifferentialDrive::resetOdometry(const PlanarPose &pose)
+{
+    m_pose = pose;
+    m_pose.heading = wrapAngle(pose.heading);
+    m_distance = 0.0;
+}
+
+PlanarPose DifferentialDrive::predict(const PlanarPose &pose, double linear, double angular, double dt)
+{
+    // 圆弧闭式解：转角很小时按直线，避免 v/ω 的相消误差
+    const double turn = angular * dt;
+    PlanarPose next = pose;
+    if (std::fabs(turn) < 1e-9) {
+        next.x += linear * dt * std::cos(pose.heading + 0.5 * turn);
+        next.y += linear * dt * std::sin(pose.heading + 0.5 * turn);
+    } else {
+        const double radius = linear / angular;
+        next.x += radius * (std::sin(pose.heading + turn) - std::sin(pose.heading));
+        next.y -= radius * (std::cos(pose.heading + turn) - std::cos(pose.heading));
+    }
+    next.heading = wrapAngle(pose.heading + turn);
+    return next;
+}
+
+void DifferentialDrive::integrate(double left, double right, double dt)
+{
+    if (!m_configured || !(dt > 0.0)) {
+        return;
+    }
+    bodyVelocity(left, right, &m_linear, &m_angular);
+    m_pose = predict(m_pose, m_linear, m_angular, dt);
+    m_distance += std::fabs(m_linear) * dt;
+}
+
+void DifferentialDrive::setCommand(double linear, double angular)
+{
+    m_commandLinear = std::isfinite(linear) ? linear : 0.0;
+    m_commandAngular = std::isfinite(angular) ? angular : 0.0;
+}
+
+void DifferentialDrive::halt()
+{
+    m_commandLinear = 0.0;
+    m_commandAngular = 0.0;
+    m_outputLeft = 0.0;
+    m_outputRight = 0.0;
+    m_saturated = false;
+}
+
+bool DifferentialDrive::isActive() const
+{
+    return m_commandLinear != 0.0 || m_commandAngular != 0.0 || m_outputLeft != 0.0 || m_outputRight != 0.0;
+}
+
+void DifferentialDrive::step(double dt, double *left, double *right)
+{
+    if (!m_configured) {
+        *left = 0.0;
+        *right = 0.0;
+        return;
+    }
+
+    // 指令对应的轮速，超速时两轮同比缩小
+    double goalLeft = 0.0;
+    double goalRight = 0.0;
+    wheelSpeeds(m_commandLinear, m_commandAngular, &goalLeft, &goalRight);
+    const double fastest = std::max(std::fabs(goalLeft), std::fabs(goalRight));
+    m_saturated = fastest > m_wheelLimits.maxVelocity;
+    if (m_saturated) {
+        const double scale = m_wheelLimits.maxVelocity / fastest;
+        goalLeft *= scale;
+        goalRight *= scale;
+    }
+
+    // 变化量同比缩放到轮加速度限制内，两轮同时到达
+    const double deltaLeft = goalLeft - m_outputLeft;
+    const double deltaRight = goalRight - m_outputRight;
+    const double largest = std::max(std::fabs(deltaLeft), std::fabs(deltaRight));
+    const double allowed = m_wheelLimits.maxAcceleration * std::max(0.0, dt);
+    if (largest <= allowed) {
+        m_outputLeft = goalLeft;
+        m_outputRight = goalRight;
+    } else {
+        const double scale = allowed / largest;
+        m_outputLeft += deltaLeft * scale;
+        m_outputRight += deltaRight * scale;
+    }
+    *left = m_outputLeft;
+    *right = m_outputRight;
+}
@@ -0,0 +1,94 @@
+#ifndef DIFFERENTIALDRIVE_H
+#define DIFFERENTIALDRIVE_H
+
+#include "trajectory.h"
+#include <string>
+
+// 差速底盘几何：左右两个驱动轮，轮速以电机转速（rpm）表示
+struct DriveGeometry {
+    double wheelRadius;         // 米
+    double trackWidth;          // 左右轮接地点间距（米）
+    double gearRatio;           // 电机转速 / 车轮转速
+    double leftDirection;       // 电机正转时车轮向前为 1，反向安装为 -1
+    double rightDirection;
+
+    DriveGeometry()
+        : wheelRadius(0.08), trackWidth(0.46), gearRatio(1.0), leftDirection(1.0), rightDirection(1.0) {}
+};
+
+// 平面位姿：世界坐标系中的位置（米）和航向（弧度，绕 z 轴，x 轴为 0）
+struct PlanarPose {
+    double x;
+    double y;
+    double heading;
+
+    PlanarPose(double x = 0.0, double y = 0.0, double heading = 0.0) : x(x), y(y), heading(heading) {}
+};
+
+// 差速驱动：轮速与本体速度互换、里程计积分、速度指令的加速度限制
+//
+// 里程计：两次积分之间轮速视为常数，本体沿圆弧运动，按圆弧闭式解积分（直线时退化为直线），
+// 不随积分步长累积截断误差。
+// 速度指令：每个控制周期输出的轮速按轮加速度限制逼近指令对应的轮速。两轮的变化量同比缩放，
+// 两轮同时到达，转弯半径只在加减速过程中平滑过渡；指令对应的轮速超出速度限制时两轮同比缩小，
+// 保持转弯半径不变。
+class DifferentialDrive
+{
+public:
+    DifferentialDrive();
+
+    // wheelLimits 为电机转速限制（rpm、rpm/s），不限加加速度
+    bool configure(const DriveGeometry &geometry, const MotionLimits &wheelLimits,
+                   std::string *errorMessage = nullptr);
+    bool isEmpty() const { return !m_configured; }
+    const DriveGeometry &geometry() const { return m_geometry; }
+    const MotionLimits &wheelLimits() const { return m_wheelLimits; }
+
+    // 本体速度（m/s、rad/s，逆时针为正）与电机转速（rpm，含安装方向）互换
+    void wheelSpeeds(double linear, double angular, double *left, double *right) const;
+    void bodyVelocity(double left, double right, double *linear, double *angular) const;
+    // 底盘以最大轮加速度减速时的本体线、角加速度
+    double maxLinearAcceleration() const;
+    double maxAngularAcceleration() const;
+
+    // 里程计
+    void resetOdometry(const PlanarPose &pose);
+    void integrate(double left, double right, double dt);  // 按电机转速积分 dt 秒
+    const PlanarPose &pose() const { return m_pose; }
+    double linearVelocity() const { return m_linear; }     // 最近一次积分的本体速度
+    double angularVelocity() const { return m_angular; }
+    double travelledDistance() const { return m_distance; }
+    // 按当前位姿和给定本体速度沿圆弧外推 dt 秒
+    static PlanarPose predict(const PlanarPose &pose, double linear, double angular, double dt);
+
+    // 速度指令
+    void setCommand(double linear, double angular);
+    void stop() { setCommand(0.0, 0.0); }                   // 按加速度限制减速到零
+    void halt();                                            // 指令和输出立即清零（急停）
+    double commandedLinear() const { return m_commandLinear; }
+    double commandedAngular() const { return m_commandAngular; }
+    bool isActive() const;                                  // 指令非零或输出轮速尚未归零
+    // 一个控制周期：更新并返回输出的电机转速
+    void step(double dt, double *left, double *right);
+    double outputLeft() const { return m_outputLeft; }
+    double outputRight() const { return m_outputRight; }
+    bool isSaturated() const { return m_saturated; }        // 指令超出轮速限制，已同比缩小
+
+private:
+    double wheelScale() const;  // rpm → 车轮线速度（m/s）
+
+    bool m_configured;
+    DriveGeometry m_geometry;
+    MotionLimits m_wheelLimits;
+    PlanarPose m_pose;
+    double m_linear;
+    double m_angular;
+    double m_distance;
+    double m_commandLinear;
+    double m_commandAngular;
+    double m_outputLeft;
+    double m_outputRight;
+    bool m_saturated;
+};
+
+#endif // DIFFERENTIALDRIVE_H
@@ -0,0 +1,619 @@
+#include "distancefield.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const float FAR_DISTANCE = std::numeric_limits<float>::max();
+const int BAND_VOXELS = 3;                  // 网格窄带宽度（体素）
+
+void transformPoint(const Transform &pose, const double *local, double *world)
+{
+    for (int i = 0; i < 3; ++i) {
+        world[i] = pose.r[i * 3] * local[0] + pose.r[i * 3 + 1] * local[1] + pose.r[i * 3 + 2] * local[2] + pose.p[i];
+    }
+}
+
+// world 转到 pose 的局部坐标：R^T (p - t)
+void inversePoint(const Transform &pose, const double *world, double *local)
+{
+    const double d[3] = { world[0] - pose.p[0], world[1] - pose.p[1], world[2] - pose.p[2] };
+    for (int i = 0; i < 3; ++i) {
+        local[i] = pose.r[i] * d[0] + pose.r[3 + i] * d[1] + pose.r[6 + i] * d[2];
+    }
+}
+
+double length3(double x, double y, double z)
+{
+    return std::sqrt(x * x + y * y + z * z);
+}
+
+// 基本体的精确有符号距离（局部坐标）
+double primitiveDistance(const EnvironmentShape &shape, const double *p)
+{
+    switch (shape.type) {
+    case EnvironmentShape::Box: {
+        const double q[3] = { std::fabs(p[0]) - 0.5 * shape.size[0], std::fabs(p[1]) - 0.5 * shape.size[1],
+                              std::fabs(p[2]) - 0.5 * shape.size[2] };
+        const double outside = length3(std::max(q[0], 0.0), std::max(q[1], 0.0), std::max(q[2], 0.0));
+        return outside + std::min(std::max(q[0], std::max(q[1], q[2])), 0.0);
+    }
+    case EnvironmentShape::Sphere:
+        return length3(p[0], p[1], p[2]) - shape.size[0];
+    case EnvironmentShape::Cylinder: {
+        const double radial = std::sqrt(p[0] * p[0] + p[1] * p[1]) - shape.size[0];
+        const double axial = std::fabs(p[2]) - 0.5 * shape.size[1];
+        const double outside = std::sqrt(std::max(radial, 0.0) * std::max(radial, 0.0)
+                                         + std::max(axial, 0.0) * std::max(axial, 0.0));
+        return outside + std::min(std::max(radial, axial), 0.0);
+    }
+    case EnvironmentShape::Mesh:
+        break;
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+// 物体在世界坐标下的包围盒
+void shapeBounds(const EnvironmentShape &shape, double *lower, double *upper)
+{
+    for (int k = 0; k < 3; ++k) {
+        lower[k] = std::numeric_limits<double>::infinity();
+        upper[k] = -std::numeric_limits<double>::infinity();
+    }
+    auto include = [&](const double *local) {
+        double world[3];
+        transformPoint(shape.pose, local, world);
+        for (int k = 0; k < 3; ++k) {
+            lower[k] = std::min(lower[k], world[k]);
+            upper[k] = std::max(upper[k], world[k]);
+        }
+    };
+
+    if (shape.type == EnvironmentShape::Mesh) {
+        for (size_t v = 0; v + 2 < shape.vertices.size(); v += 3) {
+            include(&shape.vertices[v]);
+        }
+        return;
+    }
+    double half[3] = { 0.5 * shape.size[0], 0.5 * shape.size[1], 0.5 * shape.size[2] };
+    if (shape.type == EnvironmentShape::Sphere) {
+        half[0] = half[1] = half[2] = shape.size[0];
+    } else if (shape.type == EnvironmentShape::Cylinder) {
+        half[0] = half[1] = shape.size[0];
+        half[2] = 0.5 * shape.size[1];
+    }
+    for (int corner = 0; corner < 8; ++corner) {
+        const double local[3] = { (corner & 1) ? half[0] : -half[0], (corner & 2) ? half[1] : -half[1],
+                                  (corner & 4) ? half[2] : -half[2] };
+        include(local);
+    }
+}
+
+double dot3(const double *a, const double *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// 点到三角形的最近点（按区域分类，见 Ericson《Real-Time Collision Detection》5.1.5）
+void closestPointOnTriangle(const double *p, const double *a, const double *b, const double *c, double *closest)
+{
+    const double ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    const double ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    const double ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+    auto set = [closest](const double *origin, const double *u, double s, const double *v, double t) {
+        for (int k = 0; k < 3; ++k) {
+            closest[k] = origin[k] + u[k] * s + v[k] * t;
+        }
+    };
+
+    const double d1 = dot3(ab, ap);
+    const double d2 = dot3(ac, ap);
+    if (d1 <= 0.0 && d2 <= 0.0) {
+        set(a, ab, 0.0, ac, 0.0);
+        return;
+    }
+    const double bp[3] = { p[0] - b[0], p[1] - b[1], p[2] - b[2] };
+    const double d3 = dot3(ab, bp);
+    const double d4 = dot3(ac, bp);
+    if (d3 >= 0.0 && d4 <= d3) {
+        set(a, ab, 1.0, ac, 0.0);
+        return;
+    }
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+        set(a, ab, d1 / (d1 - d3), ac, 0.0);
+        return;
+    }
+    const double cp[3] = { p[0] - c[0], p[1] - c[1], p[2] - c[2] };
+    const double d5 = dot3(ab, cp);
+    const double d6 = dot3(ac, cp);
+    if (d6 >= 0.0 && d5 <= d6) {
+        set(a, ab, 0.0, ac, 1.0);
+        return;
+    }
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+        set(a, ab, 0.0, ac, d2 / (d2 - d6));
+        return;
+    }
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) {
+        const double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        const double bc[3] = { c[0] - b[0], c[1] - b[1], c[2] - b[2] };
+        set(b, bc, w, ab, 0.0);
+        return;
+    }
+    const double denominator = 1.0 / (va + vb + vc);
+    set(a, ab, vb * denominator, ac, vc * denominator);
+}
+
+// 一维平方距离变换（Felzenszwalb & Huttenlocher），f 为各点的初值，结果写回 f
+void distanceTransform1d(float *f, size_t count, size_t stride, std::vector<float> &values,
+                         std::vector<int> &hull, std::vector<float> &bounds)
+{
+    values.resize(count);
+    hull.resize(count);
+    bounds.resize(count + 1);
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = f[i * stride];
+    }
+
+    int k = -1;
+    for (int q = 0; q < int(count); ++q) {
+        if (values[size_t(q)] >= FAR_DISTANCE) {
+            continue;
+        }
+        float s = -std::numeric_limits<float>::infinity();
+        while (k >= 0) {
+            const int v = hull[size_t(k)];
+            s = ((values[size_t(q)] + float(q) * q) - (values[size_t(v)] + float(v) * v)) / (2.0f * (q - v));
+            if (s > bounds[size_t(k)]) {
+                break;
+            }
+            --k;
+        }
+        ++k;
+        hull[size_t(k)] = q;
+        bounds[size_t(k)] = k == 0 ? -std::numeric_limits<float>::infinity() : s;
+        bounds[size_t(k) + 1] = std::numeric_limits<float>::infinity();
+    }
+    if (k < 0) {
+        return;
+    }
+
+    int j = 0;
+    for (int q = 0; q < int(count); ++q) {
+        while (bounds[size_t(j) + 1] < float(q)) {
+            ++j;
+        }
+        const int v = hull[size_t(j)];
+        f[size_t(q) * stride] = float(q - v) * float(q - v) + values[size_t(v)];
+    }
+}
+
+} // namespace
+
+DistanceField::DistanceField()
+    : m_dims{ 0, 0, 0 }
+    , m_origin{ 0.0, 0.0, 0.0 }
+    , m_resolution(0.0)
+    , m_inverseResolution(0.0)
+{
+}
+
+bool DistanceField::build(const std::vector<EnvironmentShape> &shapes, double resolution, double margin,
+                          std::string *errorMessage)
+{
+    auto fail = [errorMessage](const std::string &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+    if (!(resolution > 0.0)) {
+        return fail("体素尺寸必须大于 0");
+    }
+    if (shapes.empty()) {
+        return fail("环境中没有物体");
+    }
+
+    double lower[3] = { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                        std::numeric_limits<double>::infinity() };
+    double upper[3] = { -lower[0], -lower[1], -lower[2] };
+    for (const EnvironmentShape &shape : shapes) {
+        double shapeLower[3];
+        double shapeUpper[3];
+        shapeBounds(shape, shapeLower, shapeUpper);
+        for (int k = 0; k < 3; ++k) {
+            lower[k] = std::min(lower[k], shapeLower[k] - margin);
+            upper[k] = std::max(upper[k], shapeUpper[k] + margin);
+        }
+    }
+    uint64_t voxels = 1;
+    uint32_t dims[3];
+    for (int k = 0; k < 3; ++k) {
+        if (!(upper[k] >= lower[k])) {
+            return fail("环境物体的尺寸无效");
+        }
+        dims[k] = uint32_t(std::ceil((upper[k] - lower[k]) / resolution)) + 1;
+        voxels *= dims[k];
+    }
+    if (voxels > MAX_VOXELS) {
+        return fail("体素数量 " + std::to_string(voxels) + " 超过上限，请增大体素尺寸或缩小环境范围");
+    }
+
+    std::copy(dims, dims + 3, m_dims);
+    std::copy(lower, lower + 3, m_origin);
+    m_resolution = resolution;
+    m_inverseResolution = 1.0 / resolution;
+    m_values.assign(size_t(voxels), FAR_DISTANCE);
+
+    // 网格整体作为一个三角形集合处理，多个网格的并集也能正确区分内外
+    bool hasMesh = false;
+    for (const EnvironmentShape &shape : shapes) {
+        hasMesh = hasMesh || (shape.type == EnvironmentShape::Mesh && !shape.triangles.empty());
+    }
+    if (hasMesh) {
+        buildMeshes(shapes, m_values);
+    }
+
+    // 基本体逐体素取并集（最小值）
+    for (uint32_t z = 0; z < m_dims[2]; ++z) {
+        for (uint32_t y = 0; y < m_dims[1]; ++y) {
+            for (uint32_t x = 0; x < m_dims[0]; ++x) {
+                const double world[3] = { m_origin[0] + x * resolution, m_origin[1] + y * resolution,
+                                          m_origin[2] + z * resolution };
+                float &value = m_values[index(x, y, z)];
+                for (const EnvironmentShape &shape : shapes) {
+                    if (shape.type == EnvironmentShape::Mesh) {
+                        continue;
+                    }
+                    double local[3];
+                    inversePoint(shape.pose, world, local);
+                    value = std::min(value, float(primitiveDistance(shape, local)));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void DistanceField::buildMeshes(const std::vector<EnvironmentShape> &shapes, std::vector<float> &meshField) const
+{
+    const size_t voxels = meshField.size();
+    const double resolution = m_resolution;
+    std::vector<float> band(voxels, FAR_DISTANCE);     // 窄带内到最近三角形的精确距离
+    std::vector<int8_t> bandSign(voxels, 1);            // 由最近三角形法线判断的内外
+
+    // 1. 窄带：每个三角形只更新其包围盒向外扩展 BAND_VOXELS 的体素
+    std::vector<double> world;
+    for (const EnvironmentShape &shape : shapes) {
+        if (shape.type != EnvironmentShape::Mesh) {
+            continue;
+        }
+        world.resize(shape.vertices.size());
+        for (size_t v = 0; v + 2 < shape.vertices.size(); v += 3) {
+            transformPoint(shape.pose, &shape.vertices[v], &world[v]);
+        }
+        for (size_t t = 0; t + 2 < shape.triangles.size(); t += 3) {
+            const double *a = &world[size_t(shape.triangles[t]) * 3];
+            const double *b = &world[size_t(shape.triangles[t + 1]) * 3];
+            const double *c = &world[size_t(shape.triangles[t + 2]) * 3];
+            const double u[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            const double v[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            const double normal[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+
+            uint32_t from[3];
+            uint32_t to[3];
+            for (int k = 0; k < 3; ++k) {
+                const double low = (std::min(a[k], std::min(b[k], c[k])) - m_origin[k]) * m_inverseResolution;
+                const double high = (std::max(a[k], std::max(b[k], c[k])) - m_origin[k]) * m_inverseResolution;
+                from[k] = uint32_t(std::max(0.0, std::floor(low) - BAND_VOXELS));
+                to[k] = uint32_t(std::min(double(m_dims[k] - 1), std::ceil(high) + BAND_VOXELS));
+            }
+            for (uint32_t z = from[2]; z <= to[2]; ++z) {
+                for (uint32_t y = from[1]; y <= to[1]; ++y) {
+                    for (uint32_t x = from[0]; x <= to[0]; ++x) {
+                        const double p[3] = { m_origin[0] + x * resolution, m_origin[1] + y * resolution,
+                                              m_origin[2] + z * resolution };
+                        double closest[3];
+                        closestPointOnTriangle(p, a, b, c, closest);
+                        const double offset[3] = { p[0] - closest[0], p[1] - closest[1], p[2] - closest[2] };
+                        const float distance = float(length3(offset[0], offset[1], offset[2]));
+                        const size_t i = index(x, y, z);
+                        if (distance < band[i]) {
+                            band[i] = distance;
+                            bandSign[i] = dot3(offset, normal) < 0.0 ? -1 : 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // 2. 表面体素：表面穿过体素立方体（中心距离不超过半对角线），这一层把内外隔开
+    const float surfaceDistance = float(0.5 * std::sqrt(3.0) * resolution);
+    std::vector<uint8_t> state(voxels, 0);              // 0 未知，1 表面，2 外部
+    for (size_t i = 0; i < voxels; ++i) {
+        state[i] = band[i] <= surfaceDistance ? 1 : 0;
+    }
+
+    // 3. 从范围边界出发做 6 邻域洪泛填充，到不了的非表面体素在物体内部
+    std::vector<size_t> stack;
+    auto push = [&](uint32_t x, uint32_t y, uint32_t z) {
+        const size_t i = index(x, y, z);
+        if (state[i] == 0) {
+            state[i] = 2;
+            stack.push_back(i);
+        }
+    };
+    for (uint32_t z = 0; z < m_dims[2]; ++z) {
+        for (uint32_t y = 0; y < m_dims[1]; ++y) {
+            for (uint32_t x = 0; x < m_dims[0]; ++x) {
+                if (x == 0 || y == 0 || z == 0 || x + 1 == m_dims[0] || y + 1 == m_dims[1] || z + 1 == m_dims[2]) {
+                    push(x, y, z);
+                }
+            }
+        }
+    }
+    const size_t strideY = m_dims[0];
+    const size_t strideZ = size_t(m_dims[0]) * m_dims[1];
+    while (!stack.empty()) {
+        const size_t i = stack.back();
+        stack.pop_back();
+        const uint32_t x = uint32_t(i % strideY);
+        const uint32_t y = uint32_t((i / strideY) % m_dims[1]);
+        const uint32_t z = uint32_t(i / strideZ);
+        if (x > 0) push(x - 1, y, z);
+        if (x + 1 < m_dims[0]) push(x + 1, y, z);
+        if (y > 0) push(x, y - 1, z);
+        if (y + 1 < m_dims[1]) push(x, y + 1, z);
+        if (z > 0) push(x, y, z - 1);
+        if (z + 1 < m_dims[2]) push(x, y, z + 1);
+    }
+
+    // 4. 到表面体素的欧氏距离变换（体素单位的平方距离，按 x、y、z 依次做一维变换）
+    std::vector<float> squared(voxels, FAR_DISTANCE);
+    for (size_t i = 0; i < voxels; ++i) {
+        if (state[i] == 1) {
+            squared[i] = 0.0f;
+        }
+    }
+    std::vector<float> values;
+    std::vector<int> hull;
+    std::vector<float> bounds;
+    for (uint32_t z = 0; z < m_dims[2]; ++z) {
+        for (uint32_t y = 0; y < m_dims[1]; ++y) {
+            distanceTransform1d(&squared[index(0, y, z)], m_dims[0], 1, values, hull, bounds);
+        }
+    }
+    for (uint32_t z = 0; z < m_dims[2]; ++z) {
+        for (uint32_t x = 0; x < m_dims[0]; ++x) {
+            distanceTransform1d(&squared[index(x, 0, z)], m_dims[1], strideY, values, hull, bounds);
+        }
+    }
+    for (uint32_t y = 0; y < m_dims[1]; ++y) {
+        for (uint32_t x = 0; x < m_dims[0]; ++x) {
+            distanceTransform1d(&squared[index(x, y, 0)], m_dims[2], strideZ, values, hull, bounds);
+        }
+    }
+
+    // 5. 窄带内用精确距离，带外用变换结果；表面体素按最近三角形法线、其余按洪泛结果取符号。
+    // 倾斜三角形的包围盒会覆盖远离表面的体素，那里记录的只是到个别三角形的距离，
+    // 只有不超过带宽的值才保证是到所有三角形的最小值
+    const float bandDistance = float(BAND_VOXELS * resolution);
+    for (size_t i = 0; i < voxels; ++i) {
+        if (squared[i] >= FAR_DISTANCE && band[i] > bandDistance) {
+            continue;
+        }
+        const bool inside = state[i] == 1 ? bandSign[i] < 0 : state[i] == 0;
+        float value;
+        if (band[i] <= bandDistance) {
+            value = inside ? -band[i] : band[i];
+        } else {
+            // 到最近表面体素中心的距离与到表面相差不超过半个对角线，按偏小的方向取值，不会高估间隙
+            const float distance = float(std::sqrt(double(squared[i])) * resolution);
+            value = inside ? -(distance + surfaceDistance) : std::max(bandDistance, distance - surfaceDistance);
+        }
+        meshField[i] = std::min(meshField[i], value);
+    }
+}
+
+double DistanceField::distance(const double *point) const
+{
+    if (m_values.empty()) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    // 范围外的点投影到边界，再加上到边界的距离（范围比物体大 margin，远处的点不影响检测）
+    double g[3];
+    double outside = 0.0;
+    uint32_t cell[3];
+    double fraction[3];
+    for (int k = 0; k < 3; ++k) {
+        g[k] = (point[k] - m_origin[k]) * m_inverseResolution;
+        const double limit = double(m_dims[k] - 1);
+        if (g[k] < 0.0) {
+            outside += g[k] * g[k];
+            g[k] = 0.0;
+        } else if (g[k] > limit) {
+            outside += (g[k] - limit) * (g[k] - limit);
+            g[k] = limit;
+        }
+        // g 已不小于 0，截断即向下取整；最后一个体素归入前一格，插值的另一角不越界
+        cell[k] = std::min(uint32_t(g[k]), m_dims[k] > 1 ? m_dims[k] - 2 : 0u);
+        fraction[k] = g[k] - cell[k];
+    }
+
+    // 三线性插值
+    const size_t stepX = m_dims[0] > 1 ? 1 : 0;
+    const size_t stepY = m_dims[1] > 1 ? size_t(m_dims[0]) : 0;
+    const size_t stepZ = m_dims[2] > 1 ? size_t(m_dims[0]) * m_dims[1] : 0;
+    const float *v = &m_values[index(cell[0], cell[1], cell[2])];
+    const double c00 = v[0] + (v[stepX] - v[0]) * fraction[0];
+    const double c10 = v[stepY] + (v[stepY + stepX] - v[stepY]) * fraction[0];
+    const double c01 = v[stepZ] + (v[stepZ + stepX] - v[stepZ]) * fraction[0];
+    const double c11 = v[stepZ + stepY] + (v[stepZ + stepY + stepX] - v[stepZ + stepY]) * fraction[0];
+    const double c0 = c00 + (c10 - c00) * fraction[1];
+    const double c1 = c01 + (c11 - c01) * fraction[1];
+    const double value = c0 + (c1 - c0) * fraction[2];
+    return outside > 0.0 ? value + std::sqrt(outside) * m_resolution : value;
+}
+
+double DistanceField::capsuleClearance(const double *p0, const double *p1, double radius) const
+{
+    const double d[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const double length = length3(d[0], d[1], d[2]);
+    const int samples = std::max(1, int(std::ceil(length * m_inverseResolution)));
+    const double spacing = length / samples;
+
+    double nearest = std::numeric_limits<double>::infinity();
+    for (int i = 0; i <= samples; ++i) {
+        const double t = double(i) / samples;
+        const double p[3] = { p0[0] + d[0] * t, p0[1] + d[1] * t, p0[2] + d[2] * t };
+        nearest = std::min(nearest, distance(p));
+    }
+    return nearest - radius - 0.5 * spacing;
+}
+
+EnvironmentClearance DistanceField::robotClearance(const SelfCollisionModel &robot, const Transform &basePose,
+                                                   double footprintRadius, double footprintHeight, double range) const
+{
+    EnvironmentClearance result;
+    result.minimumDistance = range;
+    if (m_values.empty()) {
+        return result;
+    }
+
+    // 线段 [p0, p1] 加半径 radius 的间隙；中点距离减去半长仍不小于当前最小值时整段跳过（距离场 1-Lipschitz）
+    auto segmentClearance = [this, &result](const double *p0, const double *p1, double radius) {
+        const double middle[3] = { 0.5 * (p0[0] + p1[0]), 0.5 * (p0[1] + p1[1]), 0.5 * (p0[2] + p1[2]) };
+        const double halfLength = 0.5 * std::sqrt((p1[0] - p0[0]) * (p1[0] - p0[0]) + (p1[1] - p0[1]) * (p1[1] - p0[1])
+                                                  + (p1[2] - p0[2]) * (p1[2] - p0[2]));
+        if (distance(middle) - halfLength - radius >= result.minimumDistance) {
+            return false;
+        }
+        const double clearance = capsuleClearance(p0, p1, radius);
+        if (clearance >= result.minimumDistance) {
+            return false;
+        }
+        result.minimumDistance = clearance;
+        return true;
+    };
+
+    const std::vector<CollisionCapsule> &capsules = robot.capsules();
+    const std::vector<double> &points = robot.capsulePoints();
+    for (size_t i = 0; i < capsules.size(); ++i) {
+        double p0[3];
+        double p1[3];
+        transformPoint(basePose, &points[i * 6], p0);
+        transformPoint(basePose, &points[i * 6 + 3], p1);
+        if (segmentClearance(p0, p1, capsules[i].radius)) {
+            result.capsule = int(i);
+        }
+    }
+
+    // 底盘：侧面沿圆周取竖直线段，相邻线段之间的部分由半个弦长的半径覆盖。
+    // 地面不建模，顶面由升降立柱的胶囊和外圈线段的上端覆盖
+    if (footprintRadius > 0.0 && footprintHeight > 0.0) {
+        const double pi = std::acos(-1.0);
+        const double circumference = 2.0 * pi * footprintRadius;
+        const int segments = std::max(16, std::min(256, int(std::ceil(circumference / m_resolution))));
+        const double halfChord = footprintRadius * std::sin(pi / segments);
+        for (int s = 0; s < segments; ++s) {
+            const double angle = 2.0 * pi * s / segments;
+            const double bottom[3] = { footprintRadius * std::cos(angle), footprintRadius * std::sin(angle), 0.0 };
+            const double top[3] = { bottom[0], bottom[1], footprintHeight };
+            double p0[3];
+            double p1[3];
+            transformPoint(basePose, bottom, p0);
+            transformPoint(basePose, top, p1);
+            if (segmentClearance(p0, p1, halfChord)) {
+                result.capsule = -1;
+                result.chassis = true;
+            }
+        }
+    }
+    return result;
+}
+
+bool DistanceField::save(const std::string &fileName, uint64_t sourceHash, std::string *errorMessage) const
+{
+    DistanceFieldHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = DistanceFieldHeader::MAGIC;
+    header.version = DistanceFieldHeader::VERSION;
+    header.sourceHash = sourceHash;
+    std::copy(m_dims, m_dims + 3, header.dims);
+    std::copy(m_origin, m_origin + 3, header.origin);
+    header.resolution = m_resolution;
+
+    // 先写临时文件再改名，中途失败不会留下半个缓存
+    const std::string temporary = fileName + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        if (errorMessage) {
+            *errorMessage = "无法创建距离场缓存 " + fileName;
+        }
+        return false;
+    }
+    const bool written = std::fwrite(&header, sizeof(header), 1, file) == 1
+        && std::fwrite(m_values.data(), sizeof(float), m_values.size(), file) == m_values.size();
+    const bool closed = std::fclose(file) == 0;
+    std::remove(fileName.c_str());
+    if (!written || !closed || std::rename(temporary.c_str(), fileName.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        if (errorMessage) {
+            *errorMessage = "写入距离场缓存失败 " + fileName;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool DistanceField::load(const std::string &fileName, uint64_t sourceHash, std::string *errorMessage)
+{
+    auto fail = [errorMessage](const std::string &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    std::FILE *file = std::fopen(fileName.c_str(), "rb");
+    if (!file) {
+        return fail("距离场缓存不存在");
+    }
+    DistanceFieldHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 || header.magic != DistanceFieldHeader::MAGIC
+        || header.version != DistanceFieldHeader::VERSION) {
+        std::fclose(file);
+        return fail("距离场缓存格式无效");
+    }
+    if (header.sourceHash != sourceHash) {
+        std::fclose(file);
+        return fail("环境描述已修改，缓存失效");
+    }
+
+    const uint64_t voxels = uint64_t(header.dims[0]) * header.dims[1] * header.dims[2];
+    if (voxels == 0 || voxels > MAX_VOXELS || !(header.resolution > 0.0)) {
+        std::fclose(file);
+        return fail("距离场缓存尺寸无效");
+    }
+    std::vector<float> values(static_cast<size_t>(voxels));
+    const bool complete = std::fread(values.data(), sizeof(float), values.size(), file) == values.size();
+    std::fclose(file);
+    if (!complete) {
+        return fail("距离场缓存不完整");
+    }
+
+    std::copy(header.dims, header.dims + 3, m_dims);
+    std::copy(header.origin, header.origin + 3, m_origin);
+    m_resolution = header.resolution;
+    m_inverseResolution = 1.0 / header.resolution;
+    m_values.swap(values);
+    return true;
+}
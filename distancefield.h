@@ -0,0 +1,109 @@
+#ifndef DISTANCEFIELD_H
+#define DISTANCEFIELD_H
+
+#include "kinematics.h"
+#include "selfcollision.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 环境中的静态物体，位姿与尺寸单位为米
+struct EnvironmentShape {
+    enum Type {
+        Box,            // size = 长宽高（全尺寸）
+        Sphere,         // size[0] = 半径
+        Cylinder,       // size[0] = 半径，size[1] = 高度，轴线为局部 z 轴，原点在中心
+        Mesh            // 三角网格，顶点为局部坐标，三角形按逆时针为外法线方向
+    };
+
+    Type type;
+    std::string name;
+    Transform pose;
+    double size[3];
+    std::vector<double> vertices;       // x, y, z 依次排列
+    std::vector<int> triangles;         // 每 3 个顶点下标一个三角形
+
+    EnvironmentShape() : type(Box), size{ 0.0, 0.0, 0.0 } {}
+};
+
+// 机器人与环境的最小间隙
+struct EnvironmentClearance {
+    double minimumDistance;     // 米，负值为穿透深度；超出检测范围时为检测范围
+    int capsule;                // 最近的连杆胶囊（SelfCollisionModel::capsules() 下标），-1 为没有或是底盘
+    bool chassis;               // 最近的是底盘外形
+
+    EnvironmentClearance() : minimumDistance(0.0), capsule(-1), chassis(false) {}
+};
+
+#pragma pack(push, 1)
+struct DistanceFieldHeader {
+    static const uint32_t MAGIC = 0x46445352;  // "RSDF"
+    static const uint16_t VERSION = 1;
+    static const int SIZE = 80;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved0;
+    uint64_t sourceHash;        // 生成该缓存的环境描述（含网格文件）的哈希
+    uint32_t dims[3];
+    uint32_t reserved1;
+    double origin[3];           // 第一个体素中心
+    double resolution;
+    uint8_t reserved[16];
+};
+#pragma pack(pop)
+
+// 体素有符号距离场：物体外为正、内部为负（米）
+// 基本体按解析式逐体素求精确距离；网格先在三角形附近的窄带内求精确距离，
+// 带外用欧氏距离变换传播并按半个体素对角线向偏小方向修正，内外由从边界出发的洪泛填充确定。
+// 查询对相邻 8 个体素做三线性插值，耗时与环境复杂度无关。
+class DistanceField
+{
+public:
+    static const uint64_t MAX_VOXELS = 64ull * 1024 * 1024;
+
+    DistanceField();
+
+    // 范围为所有物体的包围盒向外扩展 margin
+    bool build(const std::vector<EnvironmentShape> &shapes, double resolution, double margin,
+               std::string *errorMessage = nullptr);
+
+    // 缓存文件：文件头 + 按 x 最快变化排列的 float 数组
+    bool save(const std::string &fileName, uint64_t sourceHash, std::string *errorMessage = nullptr) const;
+    // 哈希不一致（环境描述已修改）时返回 false，调用方重新生成
+    bool load(const std::string &fileName, uint64_t sourceHash, std::string *errorMessage = nullptr);
+
+    bool isEmpty() const { return m_values.empty(); }
+    double resolution() const { return m_resolution; }
+    const uint32_t *dims() const { return m_dims; }
+    const double *origin() const { return m_origin; }
+    size_t memoryBytes() const { return m_values.size() * sizeof(float); }
+
+    // 点到环境表面的有符号距离；网格范围外按到范围边界的距离加上边界处的值
+    double distance(const double *point) const;
+
+    // 胶囊（线段 + 半径）到环境的最小间隙，小于 0 为接触。线段按体素尺寸采样，
+    // 距离场满足 1-Lipschitz，扣除半个采样间隔后结果不会偏大
+    double capsuleClearance(const double *p0, const double *p1, double radius) const;
+
+    // 连杆胶囊取自 robot 最近一次 check 的端点，底盘为以底座原点为中心的竖直圆柱（半径为 0 时不检测）。
+    // basePose 为底座在世界坐标系中的位姿。胶囊中点处的距离已足以说明整段在范围外时不逐点采样，
+    // 远离环境时每个胶囊只查询一次。只读，可在多个线程中对各自的 robot 同时调用
+    EnvironmentClearance robotClearance(const SelfCollisionModel &robot, const Transform &basePose,
+                                        double footprintRadius, double footprintHeight, double range) const;
+
+private:
+    size_t index(uint32_t x, uint32_t y, uint32_t z) const
+    {
+        return (size_t(z) * m_dims[1] + y) * m_dims[0] + x;
+    }
+    void buildMeshes(const std::vector<EnvironmentShape> &shapes, std::vector<float> &meshField) const;
+
+    uint32_t m_dims[3];
+    double m_origin[3];
+    double m_resolution;
+    double m_inverseResolution;
+    std::vector<float> m_values;
+};
+
+#endif // DISTANCEFIELD_H
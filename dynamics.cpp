@@ -0,0 +1,302 @@
+#include "dynamics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double STANDARD_GRAVITY = 9.81;
+
+void cross(const double *a, const double *b, double *out)
+{
+    out[0] = a[1] * b[2] - a[2] * b[1];
+    out[1] = a[2] * b[0] - a[0] * b[2];
+    out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+double dot(const double *a, const double *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// out = r * v（r 行优先）
+void rotate(const double *r, const double *v, double *out)
+{
+    for (int row = 0; row < 3; ++row) {
+        out[row] = r[row * 3] * v[0] + r[row * 3 + 1] * v[1] + r[row * 3 + 2] * v[2];
+    }
+}
+
+// 刚体上与参考点相距 r 的点的加速度：a + α × r + ω × (ω × r)
+void pointAcceleration(const double *a, const double *w, const double *dw, const double *r, double *out)
+{
+    double wr[3];
+    double alpha[3];
+    double centripetal[3];
+    cross(w, r, wr);
+    cross(dw, r, alpha);
+    cross(w, wr, centripetal);
+    for (int k = 0; k < 3; ++k) {
+        out[k] = a[k] + alpha[k] + centripetal[k];
+    }
+}
+
+// 正向递推的连杆状态，全部在底座坐标系中
+struct BodyState {
+    double r[9];        // 连杆坐标系姿态
+    double o[3];        // 连杆坐标系原点
+    double w[3];        // 角速度
+    double dw[3];       // 角加速度
+    double a[3];        // 原点的加速度（含重力项）
+    double joint[3];    // 关节轴上的点
+    double axis[3];
+    double f[3];        // 连杆及其子树受的合力
+    double n[3];        // 绕 joint 的合力矩
+};
+
+} // namespace
+
+DynamicModel::DynamicModel()
+    : m_jointCount(0)
+    , m_gravity{ 0.0, 0.0, -STANDARD_GRAVITY }
+{
+}
+
+bool DynamicModel::configure(const KinematicModel &model, const std::vector<LinkInertia> &inertias)
+{
+    m_bodies.clear();
+    m_jointCount = 0;
+
+    // 躯干依次串联，两臂的第一个连杆都挂在躯干最后一个连杆上
+    int trunkEnd = -1;
+    for (KinematicModel::ChainId id : { KinematicModel::Trunk, KinematicModel::LeftArm, KinematicModel::RightArm }) {
+        const KinematicChain &chain = model.chain(id);
+        int parent = id == KinematicModel::Trunk ? -1 : trunkEnd;
+        for (size_t i = 0; i < chain.joints.size(); ++i) {
+            const KinematicJoint &joint = chain.joints[i];
+            Body body;
+            body.jointId = joint.jointId;
+            body.parent = parent;
+            body.prismatic = joint.prismatic;
+            body.scale = joint.scale;
+            if (id != KinematicModel::Trunk && i == 0) {
+                body.fixed = model.chain(KinematicModel::Trunk).tool;
+            }
+            if (joint.hasOrigin) {
+                body.fixed = body.fixed * joint.origin;
+            }
+            body.a = joint.dh.a;
+            body.d = joint.dh.d;
+            body.theta = joint.dh.theta;
+            body.cosAlpha = std::cos(joint.dh.alpha);
+            body.sinAlpha = std::sin(joint.dh.alpha);
+
+            const LinkInertia inertia = size_t(joint.jointId) < inertias.size() ? inertias[size_t(joint.jointId)]
+                                                                                 : LinkInertia();
+            body.mass = inertia.mass;
+            std::copy(inertia.com, inertia.com + 3, body.com);
+            const double *I = inertia.inertia;
+            const double matrix[9] = { I[0], I[3], I[4], I[3], I[1], I[5], I[4], I[5], I[2] };
+            std::copy(matrix, matrix + 9, body.inertia);
+
+            m_bodies.push_back(body);
+            m_jointCount = std::max(m_jointCount, joint.jointId + 1);
+            parent = int(m_bodies.size()) - 1;
+        }
+        if (id == KinematicModel::Trunk) {
+            trunkEnd = parent;
+        }
+    }
+
+    if (m_bodies.size() > size_t(MAX_BODIES)) {
+        m_bodies.clear();
+        m_jointCount = 0;
+        return false;
+    }
+    return true;
+}
+
+bool DynamicModel::hasJoint(int jointId) const
+{
+    for (const Body &body : m_bodies) {
+        if (body.jointId == jointId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DynamicModel::setGravity(const double *gravity)
+{
+    std::copy(gravity, gravity + 3, m_gravity);
+}
+
+void DynamicModel::inverseDynamics(const double *q, const double *dq, const double *ddq, double *tau) const
+{
+    compute(q, dq, ddq, true, tau);
+}
+
+void DynamicModel::gravityTorques(const double *q, double *tau) const
+{
+    compute(q, nullptr, nullptr, true, tau);
+}
+
+void DynamicModel::inverseDynamicsBatch(const double *q, const double *dq, const double *ddq, size_t stride,
+                                        size_t count, double *tau) const
+{
+    for (size_t i = 0; i < count; ++i) {
+        const size_t row = i * stride;
+        compute(q + row, dq ? dq + row : nullptr, ddq ? ddq + row : nullptr, true, tau + row);
+    }
+}
+
+void DynamicModel::pathCoefficients(const double *q, const double *dq, const double *ddq, double *a, double *b,
+                                    double *c) const
+{
+    // 逆动力学对速度是二次的、对加速度是线性的，三次求值即可分离出三项
+    compute(q, nullptr, dq, false, a);
+    compute(q, dq, ddq, false, b);
+    compute(q, nullptr, nullptr, true, c);
+}
+
+void DynamicModel::compute(const double *q, const double *dq, const double *ddq, bool withGravity,
+                           double *tau) const
+{
+    BodyState states[MAX_BODIES];
+    const size_t count = m_bodies.size();
+
+    // 底座静止，重力等效为底座以 -g 加速
+    BodyState base;
+    std::fill(base.r, base.r + 9, 0.0);
+    base.r[0] = base.r[4] = base.r[8] = 1.0;
+    for (int k = 0; k < 3; ++k) {
+        base.o[k] = 0.0;
+        base.w[k] = 0.0;
+        base.dw[k] = 0.0;
+        base.a[k] = withGravity ? -m_gravity[k] : 0.0;
+    }
+
+    // 正向：运动学递推，同时求各连杆的惯性力和绕关节点的惯性力矩
+    for (size_t i = 0; i < count; ++i) {
+        const Body &body = m_bodies[i];
+        const BodyState &parent = body.parent < 0 ? base : states[body.parent];
+        BodyState &state = states[i];
+        const size_t id = size_t(body.jointId);
+        const double value = q[id] * body.scale;
+        const double velocity = dq ? dq[id] * body.scale : 0.0;
+        const double acceleration = ddq ? ddq[id] * body.scale : 0.0;
+
+        // 关节坐标系：z 轴为关节轴
+        double jointR[9];
+        for (int row = 0; row < 3; ++row) {
+            for (int col = 0; col < 3; ++col) {
+                jointR[row * 3 + col] = parent.r[row * 3] * body.fixed.r[col]
+                    + parent.r[row * 3 + 1] * body.fixed.r[3 + col] + parent.r[row * 3 + 2] * body.fixed.r[6 + col];
+            }
+        }
+        rotate(parent.r, body.fixed.p, state.joint);
+        for (int k = 0; k < 3; ++k) {
+            state.joint[k] += parent.o[k];
+            state.axis[k] = jointR[k * 3 + 2];
+        }
+
+        // DH：Rz(theta) * Tz(d) * Tx(a) * Rx(alpha)
+        const double theta = body.theta + (body.prismatic ? 0.0 : value);
+        const double d = body.d + (body.prismatic ? value : 0.0);
+        const double c = std::cos(theta);
+        const double s = std::sin(theta);
+        const double local[3] = { body.a * c, body.a * s, d };
+        double offset[3];
+        rotate(jointR, local, offset);
+        for (int row = 0; row < 3; ++row) {
+            const double r0 = jointR[row * 3];
+            const double r1 = jointR[row * 3 + 1];
+            const double r2 = jointR[row * 3 + 2];
+            const double x = r0 * c + r1 * s;
+            const double t = r1 * c - r0 * s;
+            state.r[row * 3] = x;
+            state.r[row * 3 + 1] = t * body.cosAlpha + r2 * body.sinAlpha;
+            state.r[row * 3 + 2] = r2 * body.cosAlpha - t * body.sinAlpha;
+            state.o[row] = state.joint[row] + offset[row];
+        }
+
+        // 关节点固连在父连杆上
+        double toJoint[3];
+        double jointAcceleration[3];
+        for (int k = 0; k < 3; ++k) {
+            toJoint[k] = state.joint[k] - parent.o[k];
+        }
+        pointAcceleration(parent.a, parent.w, parent.dw, toJoint, jointAcceleration);
+
+        double wz[3];
+        cross(parent.w, state.axis, wz);
+        if (body.prismatic) {
+            std::copy(parent.w, parent.w + 3, state.w);
+            std::copy(parent.dw, parent.dw + 3, state.dw);
+            pointAcceleration(jointAcceleration, state.w, state.dw, offset, state.a);
+            for (int k = 0; k < 3; ++k) {
+                state.a[k] += 2.0 * wz[k] * velocity + state.axis[k] * acceleration;
+            }
+        } else {
+            for (int k = 0; k < 3; ++k) {
+                state.w[k] = parent.w[k] + state.axis[k] * velocity;
+                state.dw[k] = parent.dw[k] + state.axis[k] * acceleration + wz[k] * velocity;
+            }
+            pointAcceleration(jointAcceleration, state.w, state.dw, offset, state.a);
+        }
+
+        // 质心处：F = m a_c，N = I α + ω × (I ω)，力矩取绕关节点
+        double toCom[3];
+        double comAcceleration[3];
+        rotate(state.r, body.com, toCom);
+        pointAcceleration(state.a, state.w, state.dw, toCom, comAcceleration);
+        double bodyW[3];
+        double bodyDw[3];
+        double iw[3];
+        double idw[3];
+        for (int k = 0; k < 3; ++k) {
+            bodyW[k] = state.r[k] * state.w[0] + state.r[3 + k] * state.w[1] + state.r[6 + k] * state.w[2];
+            bodyDw[k] = state.r[k] * state.dw[0] + state.r[3 + k] * state.dw[1] + state.r[6 + k] * state.dw[2];
+        }
+        rotate(body.inertia, bodyW, iw);
+        rotate(body.inertia, bodyDw, idw);
+        double gyroscopic[3];
+        cross(bodyW, iw, gyroscopic);
+        for (int k = 0; k < 3; ++k) {
+            idw[k] += gyroscopic[k];
+        }
+        double moment[3];
+        rotate(state.r, idw, moment);
+
+        double comArm[3];
+        for (int k = 0; k < 3; ++k) {
+            state.f[k] = body.mass * comAcceleration[k];
+            comArm[k] = state.o[k] + toCom[k] - state.joint[k];
+        }
+        double comMoment[3];
+        cross(comArm, state.f, comMoment);
+        for (int k = 0; k < 3; ++k) {
+            state.n[k] = moment[k] + comMoment[k];
+        }
+    }
+
+    // 反向：子树的力和力矩累加到父连杆
+    for (size_t i = count; i-- > 0;) {
+        const Body &body = m_bodies[i];
+        BodyState &state = states[i];
+        tau[body.jointId] = dot(state.axis, body.prismatic ? state.f : state.n);
+        if (body.parent < 0) {
+            continue;
+        }
+        BodyState &parent = states[body.parent];
+        double arm[3];
+        double transfer[3];
+        for (int k = 0; k < 3; ++k) {
+            arm[k] = state.joint[k] - parent.joint[k];
+        }
+        cross(arm, state.f, transfer);
+        for (int k = 0; k < 3; ++k) {
+            parent.f[k] += state.f[k];
+            parent.n[k] += state.n[k] + transfer[k];
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef DYNAMICS_H
+#define DYNAMICS_H
+
+#include "kinematics.h"
+#include <cstddef>
+#include <vector>
+
+// 连杆惯性参数：质量（kg）、质心（米）和绕质心的惯量（kg·m²），都在该关节之后的 DH 坐标系中表示
+struct LinkInertia {
+    double mass;
+    double com[3];
+    double inertia[6];      // Ixx, Iyy, Izz, Ixy, Ixz, Iyz
+
+    LinkInertia() : mass(0.0), com{ 0.0, 0.0, 0.0 }, inertia{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 } {}
+};
+
+// 整机逆动力学（递归牛顿-欧拉）：底座 → 躯干（升降、腰部）→ 左右臂，两臂的反力经躯干末端传回躯干。
+// 正向递推各连杆的角速度、角加速度和坐标原点加速度（底座坐标系），重力作为底座的向上加速度代入；
+// 反向递推连杆受力，投影到关节轴即为关节力矩。单组构型约 20 个连杆、几千次浮点运算，不分配内存。
+// 关节值、速度、加速度的单位与关节一致（度、毫米及其导数），输出力矩为 N·m（转动）或 N（移动）。
+class DynamicModel
+{
+public:
+    static const int MAX_BODIES = 32;
+
+    DynamicModel();
+
+    // inertias 按全局关节ID索引，缺少的关节按无质量处理；连杆数超过 MAX_BODIES 时返回 false
+    bool configure(const KinematicModel &model, const std::vector<LinkInertia> &inertias);
+    bool isEmpty() const { return m_bodies.empty(); }
+    int jointCount() const { return m_jointCount; }
+    bool hasJoint(int jointId) const;           // 是否为参与计算的运动学关节
+
+    // 底座坐标系中的重力加速度（m/s²），默认 (0, 0, -9.81)；底座倾斜时由调用方换算到底座坐标系
+    void setGravity(const double *gravity);
+    const double *gravity() const { return m_gravity; }
+
+    // tau 只写运动学关节，其余元素不变；dq、ddq 为空时按零处理
+    void inverseDynamics(const double *q, const double *dq, const double *ddq, double *tau) const;
+    void gravityTorques(const double *q, double *tau) const;
+    // 批量：行优先 [采样点][关节]，与轨迹设定点缓冲的布局相同，stride 为每行的元素数
+    void inverseDynamicsBatch(const double *q, const double *dq, const double *ddq, size_t stride, size_t count,
+                              double *tau) const;
+    // 沿路径 q(s) 的力矩系数 τ = a·s̈ + b·ṡ² + c（dq、ddq 为对 s 的导数），供 PathTorqueConstraint 使用：
+    // a = M(q)q'，b = M(q)q'' + C(q, q')q'，c = g(q)
+    void pathCoefficients(const double *q, const double *dq, const double *ddq, double *a, double *b,
+                          double *c) const;
+
+private:
+    struct Body {
+        int jointId;
+        int parent;             // 父连杆下标，-1 为底座
+        bool prismatic;
+        double scale;
+        Transform fixed;        // 父连杆坐标系到关节坐标系的固定变换（躯干末端变换、安装位姿）
+        double a;
+        double d;
+        double theta;
+        double cosAlpha;
+        double sinAlpha;
+        double mass;
+        double com[3];
+        double inertia[9];      // 绕质心的惯量矩阵（行优先）
+    };
+
+    void compute(const double *q, const double *dq, const double *ddq, bool withGravity, double *tau) const;
+
+    std::vector<Body> m_bodies; // 父连杆总在子连杆之前
+    int m_jointCount;
+    double m_gravity[3];
+};
+
+#endif // DYNAMICS_H
@@ -0,0 +1,258 @@
+#include "environmentmodel.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtMath>
+
+namespace {
+
+// FNV-1a，用于判断缓存是否与描述文件、网格文件一致
+uint64_t hashBytes(const QByteArray &data, uint64_t hash)
+{
+    for (const char byte : data) {
+        hash ^= uint8_t(byte);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool parseNumbers(const QJsonValue &value, int count, double *numbers)
+{
+    const QJsonArray array = value.toArray();
+    if (array.size() != count) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (!array[i].isDouble()) {
+            return false;
+        }
+        numbers[i] = array[i].toDouble();
+    }
+    return true;
+}
+
+} // namespace
+
+EnvironmentModel::EnvironmentModel()
+    : m_loadedFromCache(false)
+    , m_buildSeconds(0.0)
+    , m_sourceHash(0)
+{
+}
+
+void EnvironmentModel::clear()
+{
+    *this = EnvironmentModel();
+}
+
+QString EnvironmentModel::cacheFileName(const QString &fileName)
+{
+    const QFileInfo info(fileName);
+    return info.dir().filePath(info.completeBaseName() + ".sdf");
+}
+
+EnvironmentModel EnvironmentModel::loadDefault()
+{
+    QStringList candidates;
+    const QString envFile = qEnvironmentVariable("ROBOT_ENVIRONMENT");
+    if (!envFile.isEmpty()) {
+        candidates << envFile;
+    }
+    if (QCoreApplication::instance()) {
+        candidates << QDir(QCoreApplication::applicationDirPath()).filePath("environment.json");
+    }
+    candidates << QDir::current().filePath("environment.json");
+
+    for (const QString &fileName : candidates) {
+        if (!QFileInfo::exists(fileName)) {
+            continue;
+        }
+
+        EnvironmentModel environment;
+        QString error;
+        if (environment.loadFromFile(fileName, &error)) {
+            qDebug() << "环境模型已加载:" << fileName << environment.shapes().size() << "个物体"
+                     << (environment.loadedFromCache() ? "（缓存）" : "");
+            return environment;
+        }
+        qWarning() << "环境模型加载失败:" << fileName << error;
+    }
+    return EnvironmentModel();
+}
+
+bool EnvironmentModel::loadFromFile(const QString &fileName, QString *errorMessage)
+{
+    auto fail = [errorMessage](const QString &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(file.errorString());
+    }
+    const QByteArray source = file.readAll();
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(source, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        return fail(QString("JSON解析错误: %1").arg(parseError.errorString()));
+    }
+
+    const QJsonObject root = doc.object();
+    const double resolution = root.value("resolution").toDouble(0.02);
+    const double margin = root.value("margin").toDouble(0.3);
+    if (!(resolution > 0.0) || margin < 0.0) {
+        return fail("体素尺寸或范围扩展无效");
+    }
+
+    // 哈希覆盖描述文件和引用的网格文件，任一修改都会使缓存失效
+    uint64_t hash = hashBytes(source, 14695981039346656037ull ^ DistanceFieldHeader::VERSION);
+    std::vector<EnvironmentShape> shapes;
+    const QString directory = QFileInfo(fileName).absolutePath();
+    for (const QJsonValue &value : root.value("objects").toArray()) {
+        EnvironmentShape shape;
+        QByteArray meshBytes;
+        if (!parseObject(value.toObject(), directory, &shape, &meshBytes, errorMessage)) {
+            return false;
+        }
+        hash = hashBytes(meshBytes, hash);
+        shapes.push_back(shape);
+    }
+    if (shapes.empty()) {
+        return fail("环境描述中没有物体");
+    }
+
+    const QString cacheFile = cacheFileName(fileName);
+    const std::string cachePath = QFile::encodeName(cacheFile).toStdString();
+    DistanceField field;
+    bool fromCache = field.load(cachePath, hash);
+    if (!fromCache) {
+        std::string error;
+        if (!field.build(shapes, resolution, margin, &error)) {
+            return fail(QString::fromStdString(error));
+        }
+        // 缓存写不进去（如只读目录）不影响使用，下次启动重新生成
+        if (!field.save(cachePath, hash, &error)) {
+            qWarning() << QString::fromStdString(error);
+        }
+    }
+
+    m_name = root.value("name").toString(QFileInfo(fileName).completeBaseName());
+    m_sourceFile = fileName;
+    m_loadedFromCache = fromCache;
+    m_buildSeconds = timer.nsecsElapsed() * 1e-9;
+    m_sourceHash = hash;
+    m_shapes.swap(shapes);
+    m_field = field;
+    return true;
+}
+
+bool EnvironmentModel::parseObject(const QJsonObject &object, const QString &directory, EnvironmentShape *shape,
+                                   QByteArray *meshBytes, QString *errorMessage) const
+{
+    auto fail = [errorMessage](const QString &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    const QString type = object.value("type").toString();
+    const QString name = object.value("name").toString(type);
+    shape->name = name.toStdString();
+
+    double pose[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    if (object.contains("pose") && !parseNumbers(object.value("pose"), 6, pose)) {
+        return fail(QString("物体 %1 的位姿无效").arg(name));
+    }
+    shape->pose = Transform::fromXyzRpy(pose[0], pose[1], pose[2], qDegreesToRadians(pose[3]),
+                                        qDegreesToRadians(pose[4]), qDegreesToRadians(pose[5]));
+
+    if (type == "box") {
+        shape->type = EnvironmentShape::Box;
+        if (!parseNumbers(object.value("size"), 3, shape->size)
+            || !(shape->size[0] > 0.0 && shape->size[1] > 0.0 && shape->size[2] > 0.0)) {
+            return fail(QString("物体 %1 的尺寸无效").arg(name));
+        }
+    } else if (type == "sphere" || type == "cylinder") {
+        shape->type = type == "sphere" ? EnvironmentShape::Sphere : EnvironmentShape::Cylinder;
+        shape->size[0] = object.value("radius").toDouble(0.0);
+        shape->size[1] = object.value("height").toDouble(type == "sphere" ? 1.0 : 0.0);
+        if (!(shape->size[0] > 0.0 && shape->size[1] > 0.0)) {
+            return fail(QString("物体 %1 的半径或高度无效").arg(name));
+        }
+    } else if (type == "mesh") {
+        shape->type = EnvironmentShape::Mesh;
+        const QString meshFile = QDir(directory).filePath(object.value("file").toString());
+        QFile file(meshFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return fail(QString("物体 %1 的网格文件无法打开: %2").arg(name, file.errorString()));
+        }
+        *meshBytes = file.readAll();
+        const double scale = object.value("scale").toDouble(1.0);
+        if (!loadObj(*meshBytes, scale, shape, errorMessage)) {
+            return false;
+        }
+    } else {
+        return fail(QString("物体 %1 的类型无效: %2").arg(name, type));
+    }
+    return true;
+}
+
+bool EnvironmentModel::loadObj(const QByteArray &data, double scale, EnvironmentShape *shape, QString *errorMessage)
+{
+    auto fail = [errorMessage](const QString &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    const QList<QByteArray> lines = data.split('\n');
+    for (int lineNumber = 0; lineNumber < lines.size(); ++lineNumber) {
+        const QList<QByteArray> fields = lines[lineNumber].simplified().split(' ');
+        if (fields.isEmpty()) {
+            continue;
+        }
+        if (fields[0] == "v") {
+            if (fields.size() < 4) {
+                return fail(QString("网格文件第 %1 行顶点无效").arg(lineNumber + 1));
+            }
+            for (int k = 1; k <= 3; ++k) {
+                shape->vertices.push_back(fields[k].toDouble() * scale);
+            }
+        } else if (fields[0] == "f") {
+            // 顶点下标从 1 开始，负数为相对末尾；"v/vt/vn" 只取第一项
+            std::vector<int> face;
+            const int vertexCount = int(shape->vertices.size() / 3);
+            for (int k = 1; k < fields.size(); ++k) {
+                int index = fields[k].split('/').first().toInt();
+                index = index < 0 ? vertexCount + index : index - 1;
+                if (index < 0 || index >= vertexCount) {
+                    return fail(QString("网格文件第 %1 行面引用了不存在的顶点").arg(lineNumber + 1));
+                }
+                face.push_back(index);
+            }
+            for (size_t k = 2; k < face.size(); ++k) {
+                shape->triangles.push_back(face[0]);
+                shape->triangles.push_back(face[k - 1]);
+                shape->triangles.push_back(face[k]);
+            }
+        }
+    }
+    if (shape->triangles.empty()) {
+        return fail("网格文件中没有三角形");
+    }
+    return true;
+}
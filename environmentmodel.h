@@ -0,0 +1,70 @@
+#ifndef ENVIRONMENTMODEL_H
+#define ENVIRONMENTMODEL_H
+
+#include <QString>
+#include <vector>
+#include "distancefield.h"
+
+class QJsonObject;
+
+// 静态环境模型：工作台、夹具、墙等固定物体
+//
+// 描述文件（JSON，长度为米，角度为度，位姿为 [x, y, z, roll, pitch, yaw]，世界坐标系）：
+// {
+//   "name": "装配工位",
+//   "resolution": 0.02,                 体素尺寸（默认 0.02）
+//   "margin": 0.3,                      距离场范围在物体包围盒外的扩展（默认 0.3）
+//   "objects": [
+//     { "name": "工作台", "type": "box",      "pose": [...], "size": [长, 宽, 高] },
+//     { "name": "立柱",   "type": "cylinder", "pose": [...], "radius": 0.05, "height": 1.8 },
+//     { "name": "灯罩",   "type": "sphere",   "pose": [...], "radius": 0.2 },
+//     { "name": "料箱",   "type": "mesh",     "pose": [...], "file": "bin.obj", "scale": 0.001 }
+//   ]
+// }
+// 网格为 OBJ 文件（相对路径相对于描述文件），只读取 v 和 f，多边形按扇形三角化。
+// 机器人行驶的地面不需要建模。
+//
+// 加载时编译为体素距离场并缓存到描述文件旁的 .sdf 文件；描述文件和网格文件内容不变时
+// 直接读取缓存，不再重新生成。
+class EnvironmentModel
+{
+public:
+    EnvironmentModel();
+
+    bool loadFromFile(const QString &fileName, QString *errorMessage = nullptr);
+    // 查找顺序：环境变量 ROBOT_ENVIRONMENT、程序目录、当前目录下的 environment.json；都没有时为空
+    static EnvironmentModel loadDefault();
+    void clear();
+
+    bool isEmpty() const { return m_field.isEmpty(); }
+    QString name() const { return m_name; }
+    QString sourceFile() const { return m_sourceFile; }
+    bool loadedFromCache() const { return m_loadedFromCache; }
+    double buildSeconds() const { return m_buildSeconds; }     // 生成或读取缓存的耗时
+    uint64_t sourceHash() const { return m_sourceHash; }       // 描述文件和网格文件内容的哈希（缓存键）
+    const std::vector<EnvironmentShape> &shapes() const { return m_shapes; }
+    const DistanceField &distanceField() const { return m_field; }
+
+    static QString cacheFileName(const QString &fileName);
+
+    EnvironmentClearance robotClearance(const SelfCollisionModel &robot, const Transform &basePose,
+                                        double footprintRadius, double footprintHeight, double range) const
+    {
+        return m_field.robotClearance(robot, basePose, footprintRadius, footprintHeight, range);
+    }
+
+private:
+    bool parseObject(const QJsonObject &object, const QString &directory, EnvironmentShape *shape,
+                     QByteArray *meshBytes, QString *errorMessage) const;
+    static bool loadObj(const QByteArray &data, double scale, EnvironmentShape *shape, QString *errorMessage);
+
+    QString m_name;
+    QString m_sourceFile;
+    bool m_loadedFromCache;
+    double m_buildSeconds;
+    uint64_t m_sourceHash;
+    std::vector<EnvironmentShape> m_shapes;
+    DistanceField m_field;
+};
+
+#endif // ENVIRONMENTMODEL_H
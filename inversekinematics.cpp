@@ -0,0 +1,402 @@
+#include "inversekinematics.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+const double LIMIT_MARGIN = 0.1;   // 限位回避生效的区间（占半行程的比例）
+const double LIMIT_FADE = 20.0;    // 残差小于 20 倍位置容差时开始减弱限位回避
+
+// 6x6 对称正定矩阵的 Cholesky 分解（下三角写入 l），失败返回 false
+bool cholesky6(const double *a, double *l)
+{
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = a[i * 6 + j];
+            for (int k = 0; k < j; ++k) {
+                sum -= l[i * 6 + k] * l[j * 6 + k];
+            }
+            if (i == j) {
+                if (!(sum > 0.0)) {
+                    return false;
+                }
+                l[i * 6 + i] = std::sqrt(sum);
+            } else {
+                l[i * 6 + j] = sum / l[j * 6 + j];
+            }
+        }
+    }
+    return true;
+}
+
+// 用分解结果解 L L^T x = b（原地）
+void choleskySolve6(const double *l, double *b)
+{
+    for (int i = 0; i < 6; ++i) {
+        double sum = b[i];
+        for (int k = 0; k < i; ++k) {
+            sum -= l[i * 6 + k] * b[k];
+        }
+        b[i] = sum / l[i * 6 + i];
+    }
+    for (int i = 5; i >= 0; --i) {
+        double sum = b[i];
+        for (int k = i + 1; k < 6; ++k) {
+            sum -= l[k * 6 + i] * b[k];
+        }
+        b[i] = sum / l[i * 6 + i];
+    }
+}
+
+} // namespace
+
+ArmIkSolver::ArmIkSolver()
+    : m_model(nullptr)
+    , m_arm(KinematicModel::LeftArm)
+    , m_jointCount(0)
+{
+}
+
+bool ArmIkSolver::configure(const KinematicModel *model, KinematicModel::ChainId arm,
+                            const double *minLimits, const double *maxLimits)
+{
+    m_model = nullptr;
+    m_jointCount = 0;
+    const std::vector<KinematicJoint> &joints = model->chain(arm).joints;
+    if (joints.empty() || joints.size() > size_t(MAX_CHAIN_JOINTS)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < joints.size(); ++i) {
+        const KinematicJoint &joint = joints[i];
+        m_jointIds[i] = joint.jointId;
+        m_scale[i] = joint.scale;
+        m_lower[i] = minLimits[joint.jointId] * joint.scale;
+        m_upper[i] = maxLimits[joint.jointId] * joint.scale;
+    }
+    m_jointCount = int(joints.size());
+    m_arm = arm;
+    m_model = model;
+    return true;
+}
+
+void ArmIkSolver::orientationError(const Transform &target, const Transform &current, double *error)
+{
+    // R = R_target * R_current^T，取其对数映射
+    double r[9];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            r[i * 3 + j] = target.r[i * 3] * current.r[j * 3] + target.r[i * 3 + 1] * current.r[j * 3 + 1]
+                         + target.r[i * 3 + 2] * current.r[j * 3 + 2];
+        }
+    }
+
+    const double cosine = std::max(-1.0, std::min(1.0, 0.5 * (r[0] + r[4] + r[8] - 1.0)));
+    const double angle = std::acos(cosine);
+    const double skew[3] = { r[7] - r[5], r[2] - r[6], r[3] - r[1] };
+    if (angle < 1e-6) {
+        // 小角度：旋转向量约等于反对称部分
+        for (int k = 0; k < 3; ++k) {
+            error[k] = 0.5 * skew[k];
+        }
+        return;
+    }
+    if (PI - angle > 1e-4) {
+        const double factor = angle / (2.0 * std::sin(angle));
+        for (int k = 0; k < 3; ++k) {
+            error[k] = factor * skew[k];
+        }
+        return;
+    }
+
+    // 接近 180 度：由对称部分取转轴，符号参考反对称部分
+    int k = 0;
+    if (r[4] > r[k * 4]) {
+        k = 1;
+    }
+    if (r[8] > r[k * 4]) {
+        k = 2;
+    }
+    double axis[3];
+    axis[k] = std::sqrt(std::max(0.0, 0.5 * (r[k * 4] + 1.0)));
+    for (int j = 0; j < 3; ++j) {
+        if (j != k) {
+            axis[j] = 0.25 * (r[k * 3 + j] + r[j * 3 + k]) / axis[k];
+        }
+    }
+    const double sign = (axis[0] * skew[0] + axis[1] * skew[1] + axis[2] * skew[2]) < 0.0 ? -1.0 : 1.0;
+    for (int j = 0; j < 3; ++j) {
+        error[j] = sign * angle * axis[j];
+    }
+}
+
+IkResult ArmIkSolver::solve(const Transform &target, const double *seed, double *solution,
+                            const IkOptions &options) const
+{
+    IkResult result;
+    if (!m_model) {
+        return result;
+    }
+    if (solution != seed) {
+        std::copy(seed, seed + m_model->jointCount(), solution);
+    }
+
+    const int n = m_jointCount;
+    double x[MAX_CHAIN_JOINTS];         // 关节值（弧度/米）
+    double best[MAX_CHAIN_JOINTS];
+    double jacobian[6 * MAX_CHAIN_JOINTS];
+    for (int i = 0; i < n; ++i) {
+        x[i] = std::max(m_lower[i], std::min(m_upper[i], solution[m_jointIds[i]] * m_scale[i]));
+        best[i] = x[i];
+    }
+    double bestCost = std::numeric_limits<double>::infinity();
+    const double weight = options.orientationWeight;
+
+    for (int iteration = 0; ; ++iteration) {
+        for (int i = 0; i < n; ++i) {
+            solution[m_jointIds[i]] = x[i] / m_scale[i];
+        }
+        const Transform pose = m_model->jacobian(m_arm, solution, jacobian);
+
+        double error[6];
+        for (int k = 0; k < 3; ++k) {
+            error[k] = target.p[k] - pose.p[k];
+        }
+        orientationError(target, pose, error + 3);
+        const double positionError = std::sqrt(error[0] * error[0] + error[1] * error[1] + error[2] * error[2]);
+        const double orientationError = std::sqrt(error[3] * error[3] + error[4] * error[4] + error[5] * error[5]);
+
+        result.iterations = iteration;
+        const bool converged = positionError <= options.positionTolerance
+                            && orientationError <= options.orientationTolerance;
+        const double cost = positionError + weight * orientationError;
+        if (converged || cost < bestCost) {
+            bestCost = cost;
+            std::copy(x, x + n, best);
+            result.positionError = positionError;
+            result.orientationError = orientationError;
+        }
+        if (converged) {
+            result.converged = true;
+            break;
+        }
+        if (iteration >= options.maxIterations) {
+            break;
+        }
+
+        // 雅可比换算到弧度/米，姿态行乘权重
+        for (int c = 0; c < n; ++c) {
+            const double inverseScale = 1.0 / m_scale[c];
+            for (int r = 0; r < 6; ++r) {
+                jacobian[r * n + c] *= r < 3 ? inverseScale : inverseScale * weight;
+            }
+        }
+        for (int r = 3; r < 6; ++r) {
+            error[r] *= weight;
+        }
+
+        // A = J J^T + λ²I，λ² = ½|e|² + 最小阻尼²：远离目标时步长保守，接近收敛时退化为高斯-牛顿；
+        // 最小阻尼保证奇异位形处方程仍然正定
+        double a[36];
+        double lambda2 = options.damping * options.damping;
+        for (int r = 0; r < 6; ++r) {
+            lambda2 += 0.5 * error[r] * error[r];
+        }
+        for (int i = 0; i < 6; ++i) {
+            for (int j = 0; j <= i; ++j) {
+                double sum = 0.0;
+                for (int c = 0; c < n; ++c) {
+                    sum += jacobian[i * n + c] * jacobian[j * n + c];
+                }
+                a[i * 6 + j] = sum;
+                a[j * 6 + i] = sum;
+            }
+            a[i * 6 + i] += lambda2;
+        }
+        double l[36];
+        if (!cholesky6(a, l)) {
+            break;
+        }
+
+        // 主任务：dq = J^T (J J^T + λ²I)^-1 e
+        double y[6];
+        std::copy(error, error + 6, y);
+        choleskySolve6(l, y);
+        double step[MAX_CHAIN_JOINTS];
+        for (int c = 0; c < n; ++c) {
+            double sum = 0.0;
+            for (int r = 0; r < 6; ++r) {
+                sum += jacobian[r * n + c] * y[r];
+            }
+            step[c] = sum;
+        }
+
+        // 限位回避：只推开进入限位区间两端各 LIMIT_MARGIN 的关节，减去其在任务空间的分量。
+        // 零空间运动对末端仍有二阶影响，随残差减小而减弱，否则会在容差附近来回拉扯
+        if (options.limitGain > 0.0) {
+            const double fade = std::min(1.0, cost / (LIMIT_FADE * options.positionTolerance));
+            double z[MAX_CHAIN_JOINTS];
+            for (int c = 0; c < n; ++c) {
+                const double half = 0.5 * (m_upper[c] - m_lower[c]);
+                const double u = half > 0.0 ? (x[c] - 0.5 * (m_upper[c] + m_lower[c])) / half : 0.0;
+                const double depth = std::max(0.0, std::fabs(u) - (1.0 - LIMIT_MARGIN)) / LIMIT_MARGIN;
+                z[c] = u > 0.0 ? -options.limitGain * depth * fade : options.limitGain * depth * fade;
+            }
+            double jz[6];
+            for (int r = 0; r < 6; ++r) {
+                double sum = 0.0;
+                for (int c = 0; c < n; ++c) {
+                    sum += jacobian[r * n + c] * z[c];
+                }
+                jz[r] = sum;
+            }
+            choleskySolve6(l, jz);
+            for (int c = 0; c < n; ++c) {
+                double sum = 0.0;
+                for (int r = 0; r < 6; ++r) {
+                    sum += jacobian[r * n + c] * jz[r];
+                }
+                step[c] += z[c] - sum;
+            }
+        }
+
+        // 截断步长后更新并夹紧到限位
+        double largest = 0.0;
+        for (int c = 0; c < n; ++c) {
+            largest = std::max(largest, std::fabs(step[c]));
+        }
+        const double shrink = largest > options.maxStep ? options.maxStep / largest : 1.0;
+        for (int c = 0; c < n; ++c) {
+            x[c] = std::max(m_lower[c], std::min(m_upper[c], x[c] + step[c] * shrink));
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        solution[m_jointIds[i]] = best[i] / m_scale[i];
+    }
+    return result;
+}
+
+double ArmIkSolver::dampedVelocities(const double *jacobian, const double *weights, const double *twist,
+                                     const JogOptions &options, double *dq) const
+{
+    const int n = m_jointCount;
+    double a[36];
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = 0.0;
+            for (int c = 0; c < n; ++c) {
+                sum += jacobian[i * n + c] * weights[c] * jacobian[j * n + c];
+            }
+            a[i * 6 + j] = sum;
+            a[j * 6 + i] = sum;
+        }
+    }
+
+    // 可操作度 w = sqrt(det(J W J^T)) 即 Cholesky 对角元之积；
+    // w 低于阈值时 λ² = λmax² (1 - (w/w0)²)，远离奇异时不加阻尼
+    double l[36];
+    double manipulability = 0.0;
+    double lambda2 = options.maxDamping * options.maxDamping;
+    if (cholesky6(a, l)) {
+        manipulability = 1.0;
+        for (int i = 0; i < 6; ++i) {
+            manipulability *= l[i * 6 + i];
+        }
+        const double ratio = manipulability / options.manipulabilityThreshold;
+        lambda2 = ratio < 1.0 ? lambda2 * (1.0 - ratio * ratio) : 0.0;
+    }
+    if (lambda2 > 0.0) {
+        for (int i = 0; i < 6; ++i) {
+            a[i * 6 + i] += lambda2;
+        }
+        if (!cholesky6(a, l)) {
+            std::fill(dq, dq + n, 0.0);
+            return manipulability;
+        }
+    }
+
+    double y[6];
+    std::copy(twist, twist + 6, y);
+    choleskySolve6(l, y);
+    for (int c = 0; c < n; ++c) {
+        double sum = 0.0;
+        for (int r = 0; r < 6; ++r) {
+            sum += jacobian[r * n + c] * y[r];
+        }
+        dq[c] = weights[c] * sum;
+    }
+    return manipulability;
+}
+
+JogResult ArmIkSolver::jogVelocities(const double *q, const double *twist, bool toolFrame,
+                                     const double *maxVelocities, double *velocities,
+                                     const JogOptions &options) const
+{
+    JogResult result;
+    if (!m_model) {
+        return result;
+    }
+
+    const int n = m_jointCount;
+    double jacobian[6 * MAX_CHAIN_JOINTS];
+    const Transform pose = m_model->jacobian(m_arm, q, jacobian);
+
+    // 工具坐标系下的旋量转到基坐标系
+    double v[6];
+    for (int k = 0; k < 6; k += 3) {
+        for (int i = 0; i < 3; ++i) {
+            v[k + i] = toolFrame
+                ? pose.r[i * 3] * twist[k] + pose.r[i * 3 + 1] * twist[k + 1] + pose.r[i * 3 + 2] * twist[k + 2]
+                : twist[k + i];
+        }
+    }
+
+    // 换算到弧度/米；朝正、负方向的允许速度在限位区间内线性减小
+    double upperSpeed[MAX_CHAIN_JOINTS];
+    double lowerSpeed[MAX_CHAIN_JOINTS];
+    double weights[MAX_CHAIN_JOINTS];
+    for (int c = 0; c < n; ++c) {
+        const double inverseScale = 1.0 / m_scale[c];
+        for (int r = 0; r < 6; ++r) {
+            jacobian[r * n + c] *= inverseScale;
+        }
+        const double x = q[m_jointIds[c]] * m_scale[c];
+        const double speed = std::fabs(maxVelocities[m_jointIds[c]] * m_scale[c]);
+        upperSpeed[c] = speed * std::max(0.0, std::min(1.0, (m_upper[c] - x) / options.limitZone));
+        lowerSpeed[c] = speed * std::max(0.0, std::min(1.0, (x - m_lower[c]) / options.limitZone));
+    }
+    std::fill(weights, weights + MAX_CHAIN_JOINTS, 1.0);
+
+    double dq[MAX_CHAIN_JOINTS];
+    result.manipulability = dampedVelocities(jacobian, weights, v, options, dq);
+
+    // 朝限位运动的关节按剩余允许速度降低权重后重解，让其余冗余关节接替
+    for (int c = 0; c < n; ++c) {
+        const double speed = std::fabs(maxVelocities[m_jointIds[c]] * m_scale[c]);
+        const double allowed = dq[c] > 0.0 ? upperSpeed[c] : lowerSpeed[c];
+        if (dq[c] != 0.0 && allowed < speed) {
+            weights[c] = speed > 0.0 ? allowed / speed : 0.0;
+            result.limited = true;
+        }
+    }
+    if (result.limited) {
+        dampedVelocities(jacobian, weights, v, options, dq);
+    }
+
+    // 整体缩放，保证每个关节都不超过允许速度
+    double scale = 1.0;
+    for (int c = 0; c < n; ++c) {
+        const double allowed = dq[c] > 0.0 ? upperSpeed[c] : lowerSpeed[c];
+        if (std::fabs(dq[c]) > allowed) {
+            scale = std::min(scale, allowed / std::fabs(dq[c]));
+        }
+    }
+    for (int c = 0; c < n; ++c) {
+        velocities[m_jointIds[c]] = dq[c] * scale / m_scale[c];
+    }
+    result.scale = scale;
+    return result;
+}
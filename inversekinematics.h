@@ -0,0 +1,96 @@
+#ifndef INVERSEKINEMATICS_H
+#define INVERSEKINEMATICS_H
+
+#include "kinematics.h"
+
+// 逆解参数。长度为米，角度为弧度；关节步长按弧度（移动关节按米）计
+struct IkOptions {
+    int maxIterations;              // 迭代上限：每次迭代的计算量固定，上限即决定最坏耗时
+    double positionTolerance;
+    double orientationTolerance;
+    double orientationWeight;       // 姿态误差折算为位置误差的长度（米/弧度）
+    double damping;                 // 最小阻尼（米），保证奇异位形处步长有界
+    double maxStep;                 // 单次迭代的最大关节步长
+    double limitGain;               // 零空间关节限位回避增益，0 关闭
+
+    IkOptions()
+        : maxIterations(24), positionTolerance(1e-4), orientationTolerance(1e-3), orientationWeight(0.3)
+        , damping(1e-3), maxStep(0.3), limitGain(0.05) {}
+};
+
+struct IkResult {
+    bool converged;
+    int iterations;
+    double positionError;           // 最终残差（米）
+    double orientationError;        // 最终残差（弧度）
+
+    IkResult() : converged(false), iterations(0), positionError(0.0), orientationError(0.0) {}
+};
+
+// 笛卡尔点动参数。速度为米/秒、弧度/秒
+struct JogOptions {
+    double manipulabilityThreshold; // 可操作度低于该值时开始加阻尼（奇异位形附近）
+    double maxDamping;              // 奇异位形处的最大阻尼
+    double limitZone;               // 距限位该距离（弧度/米）内，朝限位方向的速度线性减到零
+
+    JogOptions() : manipulabilityThreshold(0.005), maxDamping(0.05), limitZone(0.15) {}
+};
+
+struct JogResult {
+    double scale;                   // 实际执行的速度比例（0 ~ 1），受关节速度和限位约束
+    double manipulability;          // sqrt(det(J J^T))
+    bool limited;                   // 有关节因接近限位被减速
+
+    JogResult() : scale(0.0), manipulability(0.0), limited(false) {}
+};
+
+// 单臂阻尼最小二乘逆解
+// 每次迭代：正运动学 + 几何雅可比，dq = J^T (J J^T + λ²I)^-1 e，6x6 方程用 Cholesky 分解求解。
+// 阻尼随残差变化（λ² = ½|e|² + 最小阻尼²，Levenberg-Marquardt 形式）：残差大时步长保守，
+// 接近目标时二次收敛，奇异位形处由最小阻尼保证步长有界。
+// 关节限位回避项投影到雅可比零空间，只利用冗余自由度，不影响末端；步长另行截断并夹紧到限位内。
+// 求解过程不分配内存，躯干关节保持初值不变。
+class ArmIkSolver
+{
+public:
+    static const int MAX_CHAIN_JOINTS = 16;
+
+    ArmIkSolver();
+
+    // minLimits/maxLimits 按全局关节ID索引，单位与关节一致；模型需在求解期间保持有效
+    bool configure(const KinematicModel *model, KinematicModel::ChainId arm,
+                   const double *minLimits, const double *maxLimits);
+    bool isConfigured() const { return m_model != nullptr; }
+    KinematicModel::ChainId arm() const { return m_arm; }
+
+    // seed 为初值（完整关节数组，通常是当前关节状态），solution 可与 seed 相同；
+    // 未收敛时 solution 为迭代上限内残差最小的解
+    IkResult solve(const Transform &target, const double *seed, double *solution,
+                   const IkOptions &options = IkOptions()) const;
+
+    // 笛卡尔点动：把末端速度旋量 twist = [vx, vy, vz, wx, wy, wz] 映射为关节速度。
+    // toolFrame 为 true 时旋量在工具坐标系下表达，否则在基坐标系下。
+    // 阻尼随可操作度增大（奇异位形附近速度有界）；接近限位的关节降低权重，由其余关节补偿；
+    // 最后整体缩放旋量以满足关节速度上限，运动方向保持不变。
+    // q、maxVelocities、velocities 按全局关节ID索引，单位与关节一致，只写入该臂的关节
+    JogResult jogVelocities(const double *q, const double *twist, bool toolFrame, const double *maxVelocities,
+                            double *velocities, const JogOptions &options = JogOptions()) const;
+
+    // 旋转误差 R_target * R^T 的旋转向量（弧度）
+    static void orientationError(const Transform &target, const Transform &current, double *error);
+
+private:
+    // dq = W J^T (J W J^T + λ²I)^-1 v，λ 由可操作度决定；返回可操作度
+    double dampedVelocities(const double *jacobian, const double *weights, const double *twist,
+                            const JogOptions &options, double *dq) const;
+
+    const KinematicModel *m_model;
+    KinematicModel::ChainId m_arm;
+    int m_jointCount;                       // 链上的关节数
+    int m_jointIds[MAX_CHAIN_JOINTS];
+    double m_scale[MAX_CHAIN_JOINTS];       // 关节单位到弧度/米
+    double m_lower[MAX_CHAIN_JOINTS];       // 弧度/米
+    double m_upper[MAX_CHAIN_JOINTS];
+};
+
+#endif // INVERSEKINEMATICS_H
@@ -9,6 +9,8 @@ JointControlWidget::JointControlWidget(int jointId, const QString &jointName, QW
     , m_maxValue(180.0)
     , m_currentValue(0.0)
     , m_jointEnabled(true)
+    , m_unit("°")
+    , m_colorLevel(0)
 {
     setupUI();
     
@@ -146,23 +148,41 @@ void JointControlWidget::setValue(double value)
     updateSliderFromSpinBox();
     
     // 更新显示标签
-    m_valueLabel->setText(QString("%1°").arg(value, 0, 'f', 2));
+    m_valueLabel->setText(QString("%1%2").arg(value, 0, 'f', 2).arg(m_unit));
     
     // 更新进度条
+    updatePositionBar(value);
+}
+
+void JointControlWidget::setFeedbackValue(double value)
+{
+    // 反馈只刷新位置条，不改变用户正在编辑的目标值
+    updatePositionBar(qBound(m_minValue, value, m_maxValue));
+}
+
+void JointControlWidget::updatePositionBar(double value)
+{
     double normalizedValue = (value - m_minValue) / (m_maxValue - m_minValue);
     int progressValue = static_cast<int>(normalizedValue * SLIDER_RESOLUTION);
     m_positionBar->setValue(progressValue);
     
     // 根据值的大小改变进度条颜色
-    QString color;
+    int colorLevel;
     if (qAbs(value) < 10.0) {
-        color = "#4CAF50"; // 绿色 - 接近零位
+        colorLevel = 0; // 绿色 - 接近零位
     } else if (qAbs(value) < 90.0) {
-        color = "#FFC107"; // 黄色 - 中等角度
+        colorLevel = 1; // 黄色 - 中等角度
     } else {
-        color = "#FF5722"; // 红色 - 大角度
+        colorLevel = 2; // 红色 - 大角度
     }
     
+    // 样式表会触发样式重算，只在颜色档位变化时设置
+    if (colorLevel == m_colorLevel) {
+        return;
+    }
+    m_colorLevel = colorLevel;
+    
+    static const char *const colors[] = { "#4CAF50", "#FFC107", "#FF5722" };
     m_positionBar->setStyleSheet(
         QString("QProgressBar {"
                 "    border: 1px solid #555;"
@@ -172,7 +192,7 @@ void JointControlWidget::setValue(double value)
                 "QProgressBar::chunk {"
                 "    background-color: %1;"
                 "    border-radius: 3px;"
-                "}").arg(color)
+                "}").arg(colors[colorLevel])
     );
 }
 
@@ -191,6 +211,13 @@ void JointControlWidget::setRange(double min, double max)
     }
 }
 
+void JointControlWidget::setUnit(const QString &unit)
+{
+    m_unit = unit;
+    m_spinBox->setSuffix(unit);
+    m_valueLabel->setText(QString("%1%2").arg(m_currentValue, 0, 'f', 2).arg(unit));
+}
+
 double JointControlWidget::getMinValue() const
 {
     return m_minValue;
@@ -251,8 +278,8 @@ void JointControlWidget::onEnabledChanged(bool enabled)
 
 void JointControlWidget::onZeroButtonClicked()
 {
+    // 回零由控制器按轨迹执行，不再作为直接设定发出
     setValue(0.0);
-    emit valueChanged(m_jointId, 0.0);
     emit zeroRequested(m_jointId);
 }
 
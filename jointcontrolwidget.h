@@ -27,11 +27,17 @@ public:
     double getCurrentValue() const;
     double getTargetValue() const;
     
+    // 显示机器人反馈的实际位置
+    void setFeedbackValue(double value);
+    
     // 获取和设置范围
     void setRange(double min, double max);
     double getMinValue() const;
     double getMaxValue() const;
     
+    // 设置显示单位（如 "°"、" mm"）
+    void setUnit(const QString &unit);
+    
     // 使能控制
     void setJointEnabled(bool enabled);
     bool isJointEnabled() const;
@@ -54,6 +60,7 @@ private:
     void setupUI();
     void updateSliderFromSpinBox();
     void updateSpinBoxFromSlider();
+    void updatePositionBar(double value);
     
     int m_jointId;
     QString m_jointName;
@@ -61,6 +68,8 @@ private:
     double m_maxValue;
     double m_currentValue;
     bool m_jointEnabled;
+    QString m_unit;
+    int m_colorLevel;   // 位置条当前颜色档位
     
     // UI组件
     QGroupBox *m_groupBox;
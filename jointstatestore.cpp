@@ -0,0 +1,289 @@
+#include "jointstatestore.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define JOINTSTATE_SSE2
+#endif
+
+namespace {
+
+// 单步 SIMD 运算，每步处理 LANE_WIDTH 个关节
+#if defined(__AVX__)
+const int LANE_WIDTH = 4;
+
+inline void clampLanes(double *values, const double *lo, const double *hi, int i)
+{
+    __m256d v = _mm256_load_pd(values + i);
+    v = _mm256_max_pd(v, _mm256_load_pd(lo + i));
+    v = _mm256_min_pd(v, _mm256_load_pd(hi + i));
+    _mm256_store_pd(values + i, v);
+}
+
+inline uint64_t violationLanes(const double *values, const double *lo, const double *hi, int i)
+{
+    const __m256d v = _mm256_load_pd(values + i);
+    const __m256d below = _mm256_cmp_pd(v, _mm256_load_pd(lo + i), _CMP_LT_OQ);
+    const __m256d above = _mm256_cmp_pd(v, _mm256_load_pd(hi + i), _CMP_GT_OQ);
+    return uint64_t(_mm256_movemask_pd(_mm256_or_pd(below, above))) << i;
+}
+
+inline uint64_t changedLanes(const double *values, const double *reference, double epsilon, int i)
+{
+    const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+    const __m256d diff = _mm256_and_pd(absMask,
+        _mm256_sub_pd(_mm256_load_pd(values + i), _mm256_load_pd(reference + i)));
+    return uint64_t(_mm256_movemask_pd(_mm256_cmp_pd(diff, _mm256_set1_pd(epsilon), _CMP_GT_OQ))) << i;
+}
+#elif defined(JOINTSTATE_SSE2)
+const int LANE_WIDTH = 2;
+
+inline void clampLanes(double *values, const double *lo, const double *hi, int i)
+{
+    __m128d v = _mm_load_pd(values + i);
+    v = _mm_max_pd(v, _mm_load_pd(lo + i));
+    v = _mm_min_pd(v, _mm_load_pd(hi + i));
+    _mm_store_pd(values + i, v);
+}
+
+inline uint64_t violationLanes(const double *values, const double *lo, const double *hi, int i)
+{
+    const __m128d v = _mm_load_pd(values + i);
+    const __m128d below = _mm_cmplt_pd(v, _mm_load_pd(lo + i));
+    const __m128d above = _mm_cmpgt_pd(v, _mm_load_pd(hi + i));
+    return uint64_t(_mm_movemask_pd(_mm_or_pd(below, above))) << i;
+}
+
+inline uint64_t changedLanes(const double *values, const double *reference, double epsilon, int i)
+{
+    const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+    const __m128d diff = _mm_and_pd(absMask,
+        _mm_sub_pd(_mm_load_pd(values + i), _mm_load_pd(reference + i)));
+    return uint64_t(_mm_movemask_pd(_mm_cmpgt_pd(diff, _mm_set1_pd(epsilon)))) << i;
+}
+#else
+const int LANE_WIDTH = 1;
+
+inline void clampLanes(double *values, const double *lo, const double *hi, int i)
+{
+    values[i] = std::min(std::max(values[i], lo[i]), hi[i]);
+}
+
+inline uint64_t violationLanes(const double *values, const double *lo, const double *hi, int i)
+{
+    return (values[i] < lo[i] || values[i] > hi[i]) ? (uint64_t(1) << i) : 0;
+}
+
+inline uint64_t changedLanes(const double *values, const double *reference, double epsilon, int i)
+{
+    return std::fabs(values[i] - reference[i]) > epsilon ? (uint64_t(1) << i) : 0;
+}
+#endif
+
+// 编译期关节数：完全展开，无循环
+template<typename F, int... Steps>
+inline void unrollLanes(F &&f, std::integer_sequence<int, Steps...>)
+{
+    (f(Steps * LANE_WIDTH), ...);
+}
+
+template<int Count, typename F>
+inline void forEachLane(std::integral_constant<int, Count>, F &&f)
+{
+    static_assert(Count % LANE_WIDTH == 0, "补齐数量必须是SIMD宽度的整数倍");
+    unrollLanes(f, std::make_integer_sequence<int, Count / LANE_WIDTH>());
+}
+
+// 运行期关节数：普通循环
+template<typename F>
+inline void forEachLane(int count, F &&f)
+{
+    for (int i = 0; i < count; i += LANE_WIDTH) {
+        f(i);
+    }
+}
+
+// 按位掩码拷贝选中的关节
+inline void copyChanged(const double *source, double *target, uint64_t mask)
+{
+    for (int i = 0; mask; ++i, mask >>= 1) {
+        if (mask & 1u) {
+            target[i] = source[i];
+        }
+    }
+}
+
+// 常见布局（16、18/19/21 关节等）按补齐后的数量特化
+template<typename F>
+inline void dispatchPadded(int paddedCount, F &&f)
+{
+    switch (paddedCount) {
+    case 8:  f(std::integral_constant<int, 8>());  break;
+    case 16: f(std::integral_constant<int, 16>()); break;
+    case 24: f(std::integral_constant<int, 24>()); break;
+    case 32: f(std::integral_constant<int, 32>()); break;
+    default: f(paddedCount); break;
+    }
+}
+
+} // namespace
+
+JointStateStore::JointStateStore(int jointCount)
+    : m_publishedEnableMask(0)
+    , m_forcedChanges(0)
+    , m_enableMask(0)
+    , m_jointMask(0)
+    , m_jointCount(0)
+    , m_paddedCount(0)
+{
+    std::fill(m_positions, m_positions + MAX_JOINTS, 0.0);
+    std::fill(m_velocities, m_velocities + MAX_JOINTS, 0.0);
+    std::fill(m_torques, m_torques + MAX_JOINTS, 0.0);
+    std::fill(m_targets, m_targets + MAX_JOINTS, 0.0);
+    std::fill(m_minLimits, m_minLimits + MAX_JOINTS, 0.0);
+    std::fill(m_maxLimits, m_maxLimits + MAX_JOINTS, 0.0);
+    std::fill(m_publishedPositions, m_publishedPositions + MAX_JOINTS, 0.0);
+    std::fill(m_publishedVelocities, m_publishedVelocities + MAX_JOINTS, 0.0);
+    std::fill(m_publishedTorques, m_publishedTorques + MAX_JOINTS, 0.0);
+    std::fill(m_publishedTargets, m_publishedTargets + MAX_JOINTS, 0.0);
+    std::fill(m_publishedMinLimits, m_publishedMinLimits + MAX_JOINTS, 0.0);
+    std::fill(m_publishedMaxLimits, m_publishedMaxLimits + MAX_JOINTS, 0.0);
+
+    resize(jointCount);
+}
+
+void JointStateStore::resize(int jointCount)
+{
+    jointCount = std::max(0, std::min(jointCount, static_cast<int>(MAX_JOINTS)));
+
+    // 超出新数量的关节恢复为补齐状态
+    for (int i = jointCount; i < MAX_JOINTS; ++i) {
+        m_positions[i] = m_velocities[i] = m_torques[i] = m_targets[i] = 0.0;
+        m_minLimits[i] = m_maxLimits[i] = 0.0;
+    }
+
+    m_jointCount = jointCount;
+    m_paddedCount = (jointCount + SIMD_LANES - 1) / SIMD_LANES * SIMD_LANES;
+    m_jointMask = jointCount >= 64 ? ~uint64_t(0) : ((uint64_t(1) << jointCount) - 1);
+    m_enableMask &= m_jointMask;
+    markAllChanged();
+}
+
+void JointStateStore::setLimits(int jointId, double minValue, double maxValue)
+{
+    if (jointId < 0 || jointId >= m_jointCount) {
+        return;
+    }
+
+    m_minLimits[jointId] = minValue;
+    m_maxLimits[jointId] = maxValue;
+}
+
+double JointStateStore::clampToLimits(int jointId, double value) const
+{
+    return std::min(std::max(value, m_minLimits[jointId]), m_maxLimits[jointId]);
+}
+
+void JointStateStore::setEnabled(int jointId, bool enabled)
+{
+    if (jointId < 0 || jointId >= m_jointCount) {
+        return;
+    }
+
+    const uint64_t bit = uint64_t(1) << jointId;
+    m_enableMask = enabled ? (m_enableMask | bit) : (m_enableMask & ~bit);
+}
+
+void JointStateStore::setAllEnabled(bool enabled)
+{
+    m_enableMask = enabled ? m_jointMask : 0;
+}
+
+void JointStateStore::clampTargets()
+{
+    double *targets = m_targets;
+    const double *lo = m_minLimits;
+    const double *hi = m_maxLimits;
+
+    dispatchPadded(m_paddedCount, [&](auto count) {
+        forEachLane(count, [&](int i) { clampLanes(targets, lo, hi, i); });
+    });
+}
+
+uint64_t JointStateStore::limitViolationMask() const
+{
+    const double *positions = m_positions;
+    const double *lo = m_minLimits;
+    const double *hi = m_maxLimits;
+    uint64_t mask = 0;
+
+    dispatchPadded(m_paddedCount, [&](auto count) {
+        forEachLane(count, [&](int i) { mask |= violationLanes(positions, lo, hi, i); });
+    });
+    return mask & m_jointMask;
+}
+
+uint64_t JointStateStore::changedMask(const double *values, const double *reference, double epsilon) const
+{
+    // values 与 reference 都必须是按缓存行对齐、长度不小于 paddedCount() 的数组
+    uint64_t mask = 0;
+
+    dispatchPadded(m_paddedCount, [&](auto count) {
+        forEachLane(count, [&](int i) { mask |= changedLanes(values, reference, epsilon, i); });
+    });
+    return mask & m_jointMask;
+}
+
+void JointStateStore::fill(double *values, double value) const
+{
+    std::fill(values, values + m_jointCount, value);
+}
+
+uint64_t JointStateStore::ChangeSet::joints() const
+{
+    uint64_t all = 0;
+    for (uint64_t mask : masks) {
+        all |= mask;
+    }
+    return all;
+}
+
+JointStateStore::ChangeSet JointStateStore::takeChanges(double epsilon)
+{
+    ChangeSet changes;
+    changes.masks[PositionField] = changedMask(m_positions, m_publishedPositions, epsilon);
+    changes.masks[VelocityField] = changedMask(m_velocities, m_publishedVelocities, epsilon);
+    changes.masks[TorqueField] = changedMask(m_torques, m_publishedTorques, epsilon);
+    changes.masks[TargetField] = changedMask(m_targets, m_publishedTargets, epsilon);
+    changes.masks[LimitField] = changedMask(m_minLimits, m_publishedMinLimits, 0.0)
+                              | changedMask(m_maxLimits, m_publishedMaxLimits, 0.0);
+    changes.masks[EnableField] = (m_enableMask ^ m_publishedEnableMask) & m_jointMask;
+
+    if (m_forcedChanges) {
+        for (uint64_t &mask : changes.masks) {
+            mask |= m_forcedChanges;
+        }
+        m_forcedChanges = 0;
+    }
+
+    // 只为发生变化的关节更新快照，未超过阈值的微小漂移继续累积
+    copyChanged(m_positions, m_publishedPositions, changes.masks[PositionField]);
+    copyChanged(m_velocities, m_publishedVelocities, changes.masks[VelocityField]);
+    copyChanged(m_torques, m_publishedTorques, changes.masks[TorqueField]);
+    copyChanged(m_targets, m_publishedTargets, changes.masks[TargetField]);
+    copyChanged(m_minLimits, m_publishedMinLimits, changes.masks[LimitField]);
+    copyChanged(m_maxLimits, m_publishedMaxLimits, changes.masks[LimitField]);
+    m_publishedEnableMask = m_enableMask;
+
+    return changes;
+}
+
+void JointStateStore::markAllChanged()
+{
+    m_forcedChanges = m_jointMask;
+}
@@ -0,0 +1,102 @@
+#ifndef JOINTSTATESTORE_H
+#define JOINTSTATESTORE_H
+
+#include <cstdint>
+
+// 关节热数据存储（数组结构体布局）
+// 每个控制周期都会读写的数据（位置、速度、扭矩、目标、限位、使能位）
+// 按字段连续存放并对齐到缓存行，名称等描述性冷数据保留在 JointConfig 中。
+// 数组长度按 SIMD 宽度补齐，补齐部分的限位为 [0, 0]，批量运算可以无分支地处理全部关节。
+class alignas(64) JointStateStore
+{
+public:
+    static const int MAX_JOINTS = 64;   // 使能掩码为64位
+    static const int SIMD_LANES = 8;    // 补齐粒度：一个缓存行的 double 数
+
+    // 可追踪变更的字段
+    enum Field {
+        PositionField,
+        VelocityField,
+        TorqueField,
+        TargetField,
+        LimitField,
+        EnableField,
+        FIELD_COUNT
+    };
+
+    // 每个字段一个关节位掩码，记录自上次读取以来发生变化的关节
+    struct ChangeSet {
+        uint64_t masks[FIELD_COUNT];
+
+        ChangeSet() { for (uint64_t &mask : masks) mask = 0; }
+        uint64_t field(Field f) const { return masks[f]; }
+        uint64_t joints() const;
+        bool isEmpty() const { return joints() == 0; }
+    };
+
+    explicit JointStateStore(int jointCount = 0);
+
+    // 关节数量
+    void resize(int jointCount);
+    int jointCount() const { return m_jointCount; }
+    int paddedCount() const { return m_paddedCount; }
+    uint64_t jointMask() const { return m_jointMask; }
+
+    // 字段数组（长度为 paddedCount()）
+    double *positions() { return m_positions; }
+    double *velocities() { return m_velocities; }
+    double *torques() { return m_torques; }
+    double *targets() { return m_targets; }
+    const double *positions() const { return m_positions; }
+    const double *velocities() const { return m_velocities; }
+    const double *torques() const { return m_torques; }
+    const double *targets() const { return m_targets; }
+    const double *minLimits() const { return m_minLimits; }
+    const double *maxLimits() const { return m_maxLimits; }
+
+    // 限位
+    void setLimits(int jointId, double minValue, double maxValue);
+    double clampToLimits(int jointId, double value) const;
+
+    // 使能掩码
+    uint64_t enableMask() const { return m_enableMask; }
+    bool isEnabled(int jointId) const { return (m_enableMask >> jointId) & 1u; }
+    void setEnabled(int jointId, bool enabled);
+    void setAllEnabled(bool enabled);
+
+    // 批量运算（SIMD）
+    void clampTargets();
+    uint64_t limitViolationMask() const;
+    uint64_t changedMask(const double *values, const double *reference, double epsilon) const;
+    void fill(double *values, double value) const;
+
+    // 变更追踪（单一消费者）
+    // takeChanges() 与上次读取时的快照逐字段比较，返回变化掩码并更新快照。
+    ChangeSet takeChanges(double epsilon);
+    void markAllChanged();
+
+private:
+    alignas(64) double m_positions[MAX_JOINTS];
+    alignas(64) double m_velocities[MAX_JOINTS];
+    alignas(64) double m_torques[MAX_JOINTS];
+    alignas(64) double m_targets[MAX_JOINTS];
+    alignas(64) double m_minLimits[MAX_JOINTS];
+    alignas(64) double m_maxLimits[MAX_JOINTS];
+
+    // 上次 takeChanges() 时的快照
+    alignas(64) double m_publishedPositions[MAX_JOINTS];
+    alignas(64) double m_publishedVelocities[MAX_JOINTS];
+    alignas(64) double m_publishedTorques[MAX_JOINTS];
+    alignas(64) double m_publishedTargets[MAX_JOINTS];
+    alignas(64) double m_publishedMinLimits[MAX_JOINTS];
+    alignas(64) double m_publishedMaxLimits[MAX_JOINTS];
+    uint64_t m_publishedEnableMask;
+    uint64_t m_forcedChanges;
+
+    uint64_t m_enableMask;
+    uint64_t m_jointMask;
+    int m_jointCount;
+    int m_paddedCount;
+};
+
+#endif // JOINTSTATESTORE_H
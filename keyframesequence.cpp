@@ -0,0 +1,316 @@
+#include "keyframesequence.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double MIN_SEGMENT_SECONDS = 0.1;     // 相同位姿之间的停留时间
+
+} // namespace
+
+KeyframeSequence::KeyframeSequence()
+    : m_interpolation(Cubic)
+    , m_jointCount(0)
+    , m_segments(0)
+    , m_order(4)
+    , m_timeScale(1.0)
+{
+}
+
+bool KeyframeSequence::build(const std::vector<Keyframe> &keyframes, const MotionLimits *limits, int jointCount,
+                             Interpolation interpolation, std::string *errorMessage)
+{
+    auto fail = [&](const std::string &message) {
+        clear();
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    clear();
+    if (keyframes.size() < 2) {
+        return fail("序列至少需要起点和一个关键帧");
+    }
+    for (const Keyframe &keyframe : keyframes) {
+        if (keyframe.pose.size() != size_t(jointCount)) {
+            return fail("关键帧的关节数与机器人不一致");
+        }
+    }
+    for (int i = 0; i < jointCount; ++i) {
+        if (!(limits[i].maxVelocity > 0.0) || !(limits[i].maxAcceleration > 0.0)) {
+            return fail("关节运动限制无效");
+        }
+    }
+
+    m_interpolation = interpolation;
+    m_jointCount = jointCount;
+    m_segments = static_cast<int>(keyframes.size()) - 1;
+    m_order = interpolation == Cubic ? 4 : 6;
+
+    // 节点时刻：按最慢关节的速度和加速度估算最短时长（静止到静止的三次曲线
+    // 峰值速度为平均速度的1.5倍，峰值加速度为 6Δ/T²），显式时长不能短于全速时的估算值
+    m_knots.assign(size_t(m_segments) + 1, 0.0);
+    for (int k = 1; k <= m_segments; ++k) {
+        const Keyframe &keyframe = keyframes[size_t(k)];
+        const double scale = keyframe.duration > 0.0 ? 1.0 : std::min(1.0, std::max(0.01, keyframe.speedScale));
+        double segment = std::max(MIN_SEGMENT_SECONDS, keyframe.duration);
+        for (int i = 0; i < jointCount; ++i) {
+            const double delta = std::fabs(keyframe.pose[size_t(i)] - keyframes[size_t(k) - 1].pose[size_t(i)]);
+            segment = std::max(segment, 1.5 * delta / (scale * limits[i].maxVelocity));
+            segment = std::max(segment, std::sqrt(6.0 * delta / (scale * limits[i].maxAcceleration)));
+        }
+        m_knots[size_t(k)] = m_knots[size_t(k) - 1] + segment;
+    }
+
+    const double plannedDuration = m_knots.back();
+    fit(keyframes);
+
+    // 相邻分段互相影响，逐段估算不能保证整条样条不超限；速度和加速度随时间
+    // 拉长分别按 1/k、1/k² 缩小，按最大超限比例整体拉长后必然满足限制
+    const double ratio = limitRatio(limits);
+    if (ratio > 1.0) {
+        for (double &knot : m_knots) {
+            knot *= ratio;
+        }
+        fit(keyframes);
+    }
+    m_timeScale = m_knots.back() / plannedDuration;
+    return true;
+}
+
+void KeyframeSequence::clear()
+{
+    m_jointCount = 0;
+    m_segments = 0;
+    m_timeScale = 1.0;
+    m_knots.clear();
+    m_coefficients.clear();
+}
+
+void KeyframeSequence::fit(const std::vector<Keyframe> &keyframes)
+{
+    m_coefficients.assign(size_t(m_segments) * m_order * m_jointCount, 0.0);
+    if (m_interpolation == Cubic) {
+        fitCubic(keyframes);
+    } else {
+        fitQuintic(keyframes);
+    }
+}
+
+void KeyframeSequence::fitCubic(const std::vector<Keyframe> &keyframes)
+{
+    // 节点二阶导 M 的三对角方程组，两端速度为零（夹持边界）：
+    //   h[k-1]*M[k-1] + 2*(h[k-1]+h[k])*M[k] + h[k]*M[k+1] = 6*(s[k] - s[k-1])
+    const int n = m_segments;
+    const int joints = m_jointCount;
+    std::vector<double> h(static_cast<size_t>(n));
+    for (int k = 0; k < n; ++k) {
+        h[size_t(k)] = m_knots[size_t(k) + 1] - m_knots[size_t(k)];
+    }
+
+    // 前向消元：矩阵只与节点间隔有关，所有关节共用
+    std::vector<double> upper(size_t(n) + 1, 0.0);
+    std::vector<double> inversePivot(size_t(n) + 1, 0.0);
+    std::vector<double> moments(size_t(n + 1) * joints, 0.0);
+    for (int k = 0; k <= n; ++k) {
+        const double sub = k > 0 ? h[size_t(k) - 1] : 0.0;
+        const double super = k < n ? h[size_t(k)] : 0.0;
+        const double diag = 2.0 * (sub + super);
+        const double pivot = diag - (k > 0 ? sub * upper[size_t(k) - 1] : 0.0);
+        inversePivot[size_t(k)] = 1.0 / pivot;
+        upper[size_t(k)] = super * inversePivot[size_t(k)];
+
+        // 右端项按关节连续存放，消元对所有关节同时进行
+        double *row = moments.data() + size_t(k) * joints;
+        const double *previous = k > 0 ? row - joints : nullptr;
+        const double *pose = keyframes[size_t(k)].pose.data();
+        for (int j = 0; j < joints; ++j) {
+            const double slopeNext = k < n ? (keyframes[size_t(k) + 1].pose[size_t(j)] - pose[j]) / h[size_t(k)] : 0.0;
+            const double slopePrev = k > 0 ? (pose[j] - keyframes[size_t(k) - 1].pose[size_t(j)]) / h[size_t(k) - 1] : 0.0;
+            const double rhs = 6.0 * (slopeNext - slopePrev);
+            row[j] = (rhs - (k > 0 ? sub * previous[j] : 0.0)) * inversePivot[size_t(k)];
+        }
+    }
+
+    // 回代
+    for (int k = n - 1; k >= 0; --k) {
+        double *row = moments.data() + size_t(k) * joints;
+        const double *next = row + joints;
+        for (int j = 0; j < joints; ++j) {
+            row[j] -= upper[size_t(k)] * next[j];
+        }
+    }
+
+    // 分段系数：q(τ) = y + b*τ + (M0/2)*τ² + (M1-M0)/(6h)*τ³
+    for (int k = 0; k < n; ++k) {
+        const double hk = h[size_t(k)];
+        const double *m0 = moments.data() + size_t(k) * joints;
+        const double *m1 = m0 + joints;
+        const double *y0 = keyframes[size_t(k)].pose.data();
+        const double *y1 = keyframes[size_t(k) + 1].pose.data();
+        double *c0 = coefficients(k, 0);
+        double *c1 = coefficients(k, 1);
+        double *c2 = coefficients(k, 2);
+        double *c3 = coefficients(k, 3);
+        for (int j = 0; j < joints; ++j) {
+            c0[j] = y0[j];
+            c1[j] = (y1[j] - y0[j]) / hk - hk * (2.0 * m0[j] + m1[j]) / 6.0;
+            c2[j] = m0[j] / 2.0;
+            c3[j] = (m1[j] - m0[j]) / (6.0 * hk);
+        }
+    }
+}
+
+void KeyframeSequence::fitQuintic(const std::vector<Keyframe> &keyframes)
+{
+    const int n = m_segments;
+    const int joints = m_jointCount;
+
+    // 节点速度和加速度，两端为零
+    std::vector<double> velocity(size_t(n + 1) * joints, 0.0);
+    std::vector<double> acceleration(size_t(n + 1) * joints, 0.0);
+    for (int k = 1; k < n; ++k) {
+        const double hPrev = m_knots[size_t(k)] - m_knots[size_t(k) - 1];
+        const double hNext = m_knots[size_t(k) + 1] - m_knots[size_t(k)];
+        const double *yPrev = keyframes[size_t(k) - 1].pose.data();
+        const double *y = keyframes[size_t(k)].pose.data();
+        const double *yNext = keyframes[size_t(k) + 1].pose.data();
+        double *v = velocity.data() + size_t(k) * joints;
+        double *a = acceleration.data() + size_t(k) * joints;
+        for (int j = 0; j < joints; ++j) {
+            const double slopePrev = (y[j] - yPrev[j]) / hPrev;
+            const double slopeNext = (yNext[j] - y[j]) / hNext;
+            v[j] = slopePrev * slopeNext > 0.0 ? (hNext * slopePrev + hPrev * slopeNext) / (hPrev + hNext) : 0.0;
+            a[j] = 2.0 * (slopeNext - slopePrev) / (hPrev + hNext);
+        }
+    }
+
+    // 五次 Hermite 系数
+    for (int k = 0; k < n; ++k) {
+        const double hk = m_knots[size_t(k) + 1] - m_knots[size_t(k)];
+        const double h2 = hk * hk;
+        const double h3 = h2 * hk;
+        const double *p0 = keyframes[size_t(k)].pose.data();
+        const double *p1 = keyframes[size_t(k) + 1].pose.data();
+        const double *v0 = velocity.data() + size_t(k) * joints;
+        const double *v1 = v0 + joints;
+        const double *a0 = acceleration.data() + size_t(k) * joints;
+        const double *a1 = a0 + joints;
+        double *c0 = coefficients(k, 0);
+        double *c1 = coefficients(k, 1);
+        double *c2 = coefficients(k, 2);
+        double *c3 = coefficients(k, 3);
+        double *c4 = coefficients(k, 4);
+        double *c5 = coefficients(k, 5);
+        for (int j = 0; j < joints; ++j) {
+            const double dp = p1[j] - p0[j];
+            c0[j] = p0[j];
+            c1[j] = v0[j];
+            c2[j] = a0[j] / 2.0;
+            c3[j] = (20.0 * dp - (8.0 * v1[j] + 12.0 * v0[j]) * hk - (3.0 * a0[j] - a1[j]) * h2) / (2.0 * h3);
+            c4[j] = (-30.0 * dp + (14.0 * v1[j] + 16.0 * v0[j]) * hk + (3.0 * a0[j] - 2.0 * a1[j]) * h2) / (2.0 * h3 * hk);
+            c5[j] = (12.0 * dp - 6.0 * (v1[j] + v0[j]) * hk - (a0[j] - a1[j]) * h2) / (2.0 * h3 * h2);
+        }
+    }
+}
+
+double KeyframeSequence::limitRatio(const MotionLimits *limits) const
+{
+    // 每段均匀采样检查速度和加速度，返回需要拉长时间的倍数
+    double ratio = 0.0;
+    for (int k = 0; k < m_segments; ++k) {
+        const double hk = m_knots[size_t(k) + 1] - m_knots[size_t(k)];
+        for (int s = 0; s <= LIMIT_CHECK_SAMPLES; ++s) {
+            const double tau = hk * s / LIMIT_CHECK_SAMPLES;
+            for (int j = 0; j < m_jointCount; ++j) {
+                double v = 0.0;
+                double a = 0.0;
+                for (int p = m_order - 1; p >= 1; --p) {
+                    const double c = coefficients(k, p)[j];
+                    v = v * tau + p * c;
+                    if (p >= 2) {
+                        a = a * tau + p * (p - 1) * c;
+                    }
+                }
+                ratio = std::max(ratio, std::fabs(v) / limits[j].maxVelocity);
+                ratio = std::max(ratio, std::sqrt(std::fabs(a) / limits[j].maxAcceleration));
+            }
+        }
+    }
+    return ratio;
+}
+
+int KeyframeSequence::segmentAt(double t, int *segmentHint) const
+{
+    int segment = segmentHint && *segmentHint >= 0 && *segmentHint < m_segments ? *segmentHint : 0;
+    if (t < m_knots[size_t(segment)]) {
+        segment = static_cast<int>(std::upper_bound(m_knots.begin(), m_knots.end(), t) - m_knots.begin()) - 1;
+        segment = std::max(0, segment);
+    }
+    while (segment < m_segments - 1 && t >= m_knots[size_t(segment) + 1]) {
+        ++segment;
+    }
+    if (segmentHint) {
+        *segmentHint = segment;
+    }
+    return segment;
+}
+
+void KeyframeSequence::evaluate(double t, double *positions, int *segmentHint) const
+{
+    evaluate(t, positions, nullptr, segmentHint);
+}
+
+void KeyframeSequence::evaluate(double t, double *positions, double *velocities, int *segmentHint) const
+{
+    evaluate(t, positions, velocities, nullptr, segmentHint);
+}
+
+void KeyframeSequence::evaluate(double t, double *positions, double *velocities, double *accelerations,
+                                int *segmentHint) const
+{
+    if (m_segments == 0) {
+        return;
+    }
+
+    t = std::min(std::max(t, 0.0), duration());
+    const int segment = segmentAt(t, segmentHint);
+    const double tau = t - m_knots[size_t(segment)];
+
+    // Horner：按幂次从高到低，内层循环遍历关节
+    const double *top = coefficients(segment, m_order - 1);
+    for (int j = 0; j < m_jointCount; ++j) {
+        positions[j] = top[j];
+    }
+    for (int p = m_order - 2; p >= 0; --p) {
+        const double *c = coefficients(segment, p);
+        for (int j = 0; j < m_jointCount; ++j) {
+            positions[j] = positions[j] * tau + c[j];
+        }
+    }
+
+    if (velocities) {
+        for (int j = 0; j < m_jointCount; ++j) {
+            velocities[j] = (m_order - 1) * top[j];
+        }
+        for (int p = m_order - 2; p >= 1; --p) {
+            const double *c = coefficients(segment, p);
+            for (int j = 0; j < m_jointCount; ++j) {
+                velocities[j] = velocities[j] * tau + p * c[j];
+            }
+        }
+    }
+
+    if (accelerations) {
+        for (int j = 0; j < m_jointCount; ++j) {
+            accelerations[j] = (m_order - 1) * (m_order - 2) * top[j];
+        }
+        for (int p = m_order - 2; p >= 2; --p) {
+            const double *c = coefficients(segment, p);
+            for (int j = 0; j < m_jointCount; ++j) {
+                accelerations[j] = accelerations[j] * tau + p * (p - 1) * c[j];
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef KEYFRAMESEQUENCE_H
+#define KEYFRAMESEQUENCE_H
+
+#include "trajectory.h"
+#include <string>
+#include <vector>
+
+// 关键帧：一个整机位姿及到达它的时间约束
+struct Keyframe {
+    std::vector<double> pose;
+    double duration;        // 从上一关键帧到此处的时长（秒），<= 0 时按速度自动计算；
+                            // 短于关节全速所需的时长时取后者
+    double speedScale;      // 自动计时使用的关节最大速度比例（0, 1]
+
+    Keyframe() : duration(0.0), speedScale(0.5) {}
+};
+
+// 关键帧序列插值
+// 所有关节共用同一组节点时刻，在节点之间用多项式分段插值，起止速度为零（五次插值起止加速度也为零）：
+//   Cubic   - 三次样条，C2 连续、曲率最小，节点二阶导由三对角方程组求出
+//             （系数矩阵各关节相同，只消元一次，回代按关节向量化）；
+//   Quintic - 五次 Hermite 分段，节点速度取相邻斜率的加权平均（关键帧为极值点时为零，
+//             不会在关键帧处冲过头），节点加速度由相邻斜率差估计，C2 连续。
+// 构建后如有关节超过速度或加速度限制，整体按比例拉长时间后重新拟合。
+// 系数按 [分段][幂次][关节] 存放，每个控制周期对每个关节只需几次乘加。
+class KeyframeSequence
+{
+public:
+    enum Interpolation {
+        Cubic,
+        Quintic
+    };
+
+    static const int LIMIT_CHECK_SAMPLES = 32;  // 每段检查限制时的采样数
+
+    KeyframeSequence();
+
+    // keyframes[0] 为起点；limits 为各关节限制
+    bool build(const std::vector<Keyframe> &keyframes, const MotionLimits *limits, int jointCount,
+               Interpolation interpolation, std::string *errorMessage = nullptr);
+    void clear();
+
+    bool isEmpty() const { return m_segments == 0; }
+    Interpolation interpolation() const { return m_interpolation; }
+    int jointCount() const { return m_jointCount; }
+    int segmentCount() const { return m_segments; }
+    double duration() const { return m_knots.empty() ? 0.0 : m_knots.back(); }
+    const std::vector<double> &knotTimes() const { return m_knots; }
+    double timeScale() const { return m_timeScale; }   // 为满足限制总时长被拉长的倍数
+
+    // positions 长度为 jointCount()；segmentHint 保存上次的分段，时间单调增加时不需要查找
+    void evaluate(double t, double *positions, int *segmentHint = nullptr) const;
+    void evaluate(double t, double *positions, double *velocities, int *segmentHint = nullptr) const;
+    void evaluate(double t, double *positions, double *velocities, double *accelerations, int *segmentHint) const;
+
+private:
+    void fit(const std::vector<Keyframe> &keyframes);
+    void fitCubic(const std::vector<Keyframe> &keyframes);
+    void fitQuintic(const std::vector<Keyframe> &keyframes);
+    int segmentAt(double t, int *segmentHint) const;
+    double limitRatio(const MotionLimits *limits) const;
+    double *coefficients(int segment, int power) { return m_coefficients.data() + (size_t(segment) * m_order + power) * m_jointCount; }
+    const double *coefficients(int segment, int power) const { return m_coefficients.data() + (size_t(segment) * m_order + power) * m_jointCount; }
+
+    Interpolation m_interpolation;
+    int m_jointCount;
+    int m_segments;
+    int m_order;                        // 每段系数个数：三次为4，五次为6
+    double m_timeScale;
+    std::vector<double> m_knots;        // 节点时刻，m_knots[0] == 0
+    std::vector<double> m_coefficients;
+};
+
+#endif // KEYFRAMESEQUENCE_H
@@ -0,0 +1,477 @@
+#include "kinematics.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define KINEMATICS_AVX
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define KINEMATICS_SSE2
+#endif
+
+namespace {
+
+// 通道类型：把一组构型当作一个值运算，同一份运动学代码按标量、SSE2、AVX 实例化
+struct ScalarLanes {
+    typedef double Value;
+    typedef bool Mask;
+    static const int WIDTH = 1;
+
+    static Value set1(double x) { return x; }
+    static Value load(const double *p) { return *p; }
+    static void store(double *p, Value v) { *p = v; }
+    static Value abs(Value v) { return std::fabs(v); }
+    static Mask less(Value a, Value b) { return a < b; }
+    static Mask greater(Value a, Value b) { return a > b; }
+    static Mask equal(Value a, Value b) { return a == b; }
+    static Mask either(Mask a, Mask b) { return a || b; }
+    static Value select(Mask m, Value a, Value b) { return m ? a : b; }
+};
+
+#if defined(KINEMATICS_AVX)
+struct SimdLanes {
+    struct Value {
+        __m256d v;
+        Value() {}
+        Value(__m256d x) : v(x) {}
+        friend Value operator+(Value a, Value b) { return _mm256_add_pd(a.v, b.v); }
+        friend Value operator-(Value a, Value b) { return _mm256_sub_pd(a.v, b.v); }
+        friend Value operator*(Value a, Value b) { return _mm256_mul_pd(a.v, b.v); }
+    };
+    typedef __m256d Mask;
+    static const int WIDTH = 4;
+
+    static Value set1(double x) { return _mm256_set1_pd(x); }
+    static Value load(const double *p) { return _mm256_loadu_pd(p); }
+    static void store(double *p, Value v) { _mm256_storeu_pd(p, v.v); }
+    static Value abs(Value v) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v.v); }
+    static Mask less(Value a, Value b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+    static Mask greater(Value a, Value b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+    static Mask equal(Value a, Value b) { return _mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ); }
+    static Mask either(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+    static Value select(Mask m, Value a, Value b) { return _mm256_blendv_pd(b.v, a.v, m); }
+};
+#elif defined(KINEMATICS_SSE2)
+struct SimdLanes {
+    struct Value {
+        __m128d v;
+        Value() {}
+        Value(__m128d x) : v(x) {}
+        friend Value operator+(Value a, Value b) { return _mm_add_pd(a.v, b.v); }
+        friend Value operator-(Value a, Value b) { return _mm_sub_pd(a.v, b.v); }
+        friend Value operator*(Value a, Value b) { return _mm_mul_pd(a.v, b.v); }
+    };
+    typedef __m128d Mask;
+    static const int WIDTH = 2;
+
+    static Value set1(double x) { return _mm_set1_pd(x); }
+    static Value load(const double *p) { return _mm_loadu_pd(p); }
+    static void store(double *p, Value v) { _mm_storeu_pd(p, v.v); }
+    static Value abs(Value v) { return _mm_andnot_pd(_mm_set1_pd(-0.0), v.v); }
+    static Mask less(Value a, Value b) { return _mm_cmplt_pd(a.v, b.v); }
+    static Mask greater(Value a, Value b) { return _mm_cmpgt_pd(a.v, b.v); }
+    static Mask equal(Value a, Value b) { return _mm_cmpeq_pd(a.v, b.v); }
+    static Mask either(Mask a, Mask b) { return _mm_or_pd(a, b); }
+    static Value select(Mask m, Value a, Value b) { return _mm_or_pd(_mm_and_pd(m, a.v), _mm_andnot_pd(m, b.v)); }
+};
+#else
+typedef ScalarLanes SimdLanes;
+#endif
+
+// 正余弦：按 pi/2 分三段精确约简（Cody-Waite），在 [-pi/4, pi/4] 上用 fdlibm 的多项式，
+// 再按象限交换和取反。取整用 1.5*2^52 的加减实现，全程无分支，误差约 1 ulp。
+const double ROUND_MAGIC = 6755399441055744.0;
+const double TWO_OVER_PI = 6.36619772367581382433e-01;
+const double PIO2_1 = 1.57079632673412561417e+00;
+const double PIO2_2 = 6.07710050630396597660e-11;
+const double PIO2_3 = 2.02226624871116645580e-21;
+
+template<typename L>
+inline void sinCos(typename L::Value x, typename L::Value &sine, typename L::Value &cosine)
+{
+    typedef typename L::Value V;
+    const V magic = L::set1(ROUND_MAGIC);
+    const V q = (x * L::set1(TWO_OVER_PI) + magic) - magic;
+    const V r = ((x - q * L::set1(PIO2_1)) - q * L::set1(PIO2_2)) - q * L::set1(PIO2_3);
+    const V z = r * r;
+
+    const V sinPoly = L::set1(-1.66666666666666324348e-01) + z * (L::set1(8.33333333332248946124e-03)
+        + z * (L::set1(-1.98412698298579493134e-04) + z * (L::set1(2.75573137070700676789e-06)
+        + z * (L::set1(-2.50507602534068634195e-08) + z * L::set1(1.58969099521155010221e-10)))));
+    const V cosPoly = L::set1(4.16666666666666019037e-02) + z * (L::set1(-1.38888888888741095749e-03)
+        + z * (L::set1(2.48015872894767294178e-05) + z * (L::set1(-2.75573143513906633035e-07)
+        + z * (L::set1(2.08757232129817482790e-09) + z * L::set1(-1.13596475577881948265e-11)))));
+    const V sr = r + r * z * sinPoly;
+    const V cr = (L::set1(1.0) - L::set1(0.5) * z) + z * z * cosPoly;
+
+    // 象限 m = q - 4 * round(q / 4)，取值 -2..2
+    const V m = q - ((q * L::set1(0.25) + magic) - magic) * L::set1(4.0);
+    const typename L::Mask odd = L::equal(L::abs(m), L::set1(1.0));
+    const V s = L::select(odd, cr, sr);
+    const V c = L::select(odd, sr, cr);
+    const V zero = L::set1(0.0);
+    sine = L::select(L::either(L::less(m, L::set1(-0.5)), L::greater(m, L::set1(1.5))), zero - s, s);
+    cosine = L::select(L::either(L::greater(m, L::set1(0.5)), L::less(m, L::set1(-1.5))), zero - c, c);
+}
+
+template<typename L>
+struct LanePose {
+    typename L::Value r[9];
+    typename L::Value p[3];
+
+    explicit LanePose(const Transform &t)
+    {
+        for (int k = 0; k < 9; ++k) {
+            r[k] = L::set1(t.r[k]);
+        }
+        for (int k = 0; k < 3; ++k) {
+            p[k] = L::set1(t.p[k]);
+        }
+    }
+
+    void store(double *out, size_t stride) const
+    {
+        for (int k = 0; k < 9; ++k) {
+            L::store(out + size_t(k) * stride, r[k]);
+        }
+        for (int k = 0; k < 3; ++k) {
+            L::store(out + size_t(9 + k) * stride, p[k]);
+        }
+    }
+};
+
+template<typename L>
+inline void applyFixed(LanePose<L> &pose, const Transform &f)
+{
+    typedef typename L::Value V;
+    for (int row = 0; row < 3; ++row) {
+        const V r0 = pose.r[row * 3];
+        const V r1 = pose.r[row * 3 + 1];
+        const V r2 = pose.r[row * 3 + 2];
+        pose.p[row] = pose.p[row] + r0 * L::set1(f.p[0]) + r1 * L::set1(f.p[1]) + r2 * L::set1(f.p[2]);
+        for (int col = 0; col < 3; ++col) {
+            pose.r[row * 3 + col] = r0 * L::set1(f.r[col]) + r1 * L::set1(f.r[3 + col]) + r2 * L::set1(f.r[6 + col]);
+        }
+    }
+}
+
+// 右乘 DH 变换。新的 x 轴 = R0*c + R1*s，y/z 轴由 t = R1*c - R0*s 与 R2 按 alpha 旋转得到，
+// 平移 = p + a * 新x轴 + d * 原z轴，每行约十次乘加
+template<typename L>
+inline void applyDh(LanePose<L> &pose, typename L::Value c, typename L::Value s,
+                    double cosAlpha, double sinAlpha, double a, typename L::Value d)
+{
+    typedef typename L::Value V;
+    const V ca = L::set1(cosAlpha);
+    const V sa = L::set1(sinAlpha);
+    const V av = L::set1(a);
+    for (int row = 0; row < 3; ++row) {
+        const V r0 = pose.r[row * 3];
+        const V r1 = pose.r[row * 3 + 1];
+        const V r2 = pose.r[row * 3 + 2];
+        const V x = r0 * c + r1 * s;
+        const V t = r1 * c - r0 * s;
+        pose.r[row * 3] = x;
+        pose.r[row * 3 + 1] = t * ca + r2 * sa;
+        pose.r[row * 3 + 2] = r2 * ca - t * sa;
+        pose.p[row] = pose.p[row] + x * av + r2 * d;
+    }
+}
+
+// 去掉 cos(pi/2) 之类的舍入残差，让零位姿态的矩阵保持精确
+double snap(double value)
+{
+    return std::fabs(value) < 1e-15 ? 0.0 : value;
+}
+
+// 关节运动部分（不含安装位姿）
+template<typename L>
+inline void applyJoint(LanePose<L> &pose, const KinematicModel::Link &link, const double *q)
+{
+    typedef typename L::Value V;
+    const V value = L::load(q) * L::set1(link.scale);
+    if (link.prismatic) {
+        applyDh(pose, L::set1(link.cosTheta), L::set1(link.sinTheta), link.cosAlpha, link.sinAlpha, link.a,
+                value + L::set1(link.d));
+    } else {
+        V s, c;
+        sinCos<L>(value + L::set1(link.theta), s, c);
+        applyDh(pose, c, s, link.cosAlpha, link.sinAlpha, link.a, L::set1(link.d));
+    }
+}
+
+template<typename L>
+inline void applyLink(LanePose<L> &pose, const KinematicModel::Link &link, const double *q)
+{
+    if (link.hasOrigin) {
+        applyFixed(pose, link.origin);
+    }
+    applyJoint(pose, link, q);
+}
+
+template<typename L>
+inline void applyChain(LanePose<L> &pose, const std::vector<KinematicModel::Link> &links, const Transform &tool,
+                       const double *q, size_t stride)
+{
+    for (const KinematicModel::Link &link : links) {
+        applyLink(pose, link, q + link.jointId * stride);
+    }
+    applyFixed(pose, tool);
+}
+
+// 一组通道：躯干只算一次，两条手臂从躯干末端分别继续
+template<typename L>
+inline void forwardLanes(const std::vector<KinematicModel::Link> *links, const KinematicChain *chains,
+                         const double *q, size_t stride, double *left, double *right)
+{
+    LanePose<L> trunk{Transform()};
+    applyChain(trunk, links[KinematicModel::Trunk], chains[KinematicModel::Trunk].tool, q, stride);
+
+    LanePose<L> arm = trunk;
+    applyChain(arm, links[KinematicModel::LeftArm], chains[KinematicModel::LeftArm].tool, q, stride);
+    arm.store(left, stride);
+
+    arm = trunk;
+    applyChain(arm, links[KinematicModel::RightArm], chains[KinematicModel::RightArm].tool, q, stride);
+    arm.store(right, stride);
+}
+
+Transform toTransform(const LanePose<ScalarLanes> &pose)
+{
+    Transform t;
+    std::copy(pose.r, pose.r + 9, t.r);
+    std::copy(pose.p, pose.p + 3, t.p);
+    return t;
+}
+
+} // namespace
+
+Transform::Transform()
+{
+    for (int k = 0; k < 9; ++k) {
+        r[k] = (k % 4 == 0) ? 1.0 : 0.0;
+    }
+    p[0] = p[1] = p[2] = 0.0;
+}
+
+Transform Transform::fromXyzRpy(double x, double y, double z, double roll, double pitch, double yaw)
+{
+    const double cr = snap(std::cos(roll)), sr = snap(std::sin(roll));
+    const double cp = snap(std::cos(pitch)), sp = snap(std::sin(pitch));
+    const double cy = snap(std::cos(yaw)), sy = snap(std::sin(yaw));
+
+    Transform t;
+    t.r[0] = cy * cp;   t.r[1] = cy * sp * sr - sy * cr;    t.r[2] = cy * sp * cr + sy * sr;
+    t.r[3] = sy * cp;   t.r[4] = sy * sp * sr + cy * cr;    t.r[5] = sy * sp * cr - cy * sr;
+    t.r[6] = -sp;       t.r[7] = cp * sr;                   t.r[8] = cp * cr;
+    t.p[0] = x;
+    t.p[1] = y;
+    t.p[2] = z;
+    return t;
+}
+
+void Transform::toXyzRpy(double *values) const
+{
+    values[0] = p[0];
+    values[1] = p[1];
+    values[2] = p[2];
+    values[3] = std::atan2(r[7], r[8]);
+    values[4] = std::asin(std::max(-1.0, std::min(1.0, -r[6])));
+    values[5] = std::atan2(r[3], r[0]);
+}
+
+Transform Transform::operator*(const Transform &other) const
+{
+    Transform t;
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            t.r[row * 3 + col] = r[row * 3] * other.r[col] + r[row * 3 + 1] * other.r[3 + col]
+                               + r[row * 3 + 2] * other.r[6 + col];
+        }
+        t.p[row] = r[row * 3] * other.p[0] + r[row * 3 + 1] * other.p[1] + r[row * 3 + 2] * other.p[2] + p[row];
+    }
+    return t;
+}
+
+KinematicModel::KinematicModel()
+    : m_jointCount(0)
+{
+}
+
+void KinematicModel::setChain(ChainId id, const KinematicChain &chain)
+{
+    m_chains[id] = chain;
+
+    std::vector<Link> &links = m_links[id];
+    links.clear();
+    for (const KinematicJoint &joint : chain.joints) {
+        Link link;
+        link.jointId = size_t(joint.jointId);
+        link.prismatic = joint.prismatic;
+        link.hasOrigin = joint.hasOrigin;
+        link.scale = joint.scale;
+        link.a = joint.dh.a;
+        link.d = joint.dh.d;
+        link.theta = joint.dh.theta;
+        link.cosAlpha = snap(std::cos(joint.dh.alpha));
+        link.sinAlpha = snap(std::sin(joint.dh.alpha));
+        link.cosTheta = snap(std::cos(joint.dh.theta));
+        link.sinTheta = snap(std::sin(joint.dh.theta));
+        link.origin = joint.origin;
+        links.push_back(link);
+    }
+
+    m_jointCount = 0;
+    for (int c = 0; c < CHAIN_COUNT; ++c) {
+        for (const KinematicJoint &joint : m_chains[c].joints) {
+            m_jointCount = std::max(m_jointCount, joint.jointId + 1);
+        }
+    }
+}
+
+bool KinematicModel::isEmpty() const
+{
+    return m_chains[LeftArm].joints.empty() && m_chains[RightArm].joints.empty();
+}
+
+int KinematicModel::frameCount() const
+{
+    int count = 0;
+    for (int c = 0; c < CHAIN_COUNT; ++c) {
+        count += int(m_chains[c].joints.size()) + 1;
+    }
+    return count;
+}
+
+int KinematicModel::laneWidth()
+{
+    return SimdLanes::WIDTH;
+}
+
+void KinematicModel::forward(const double *q, Transform *leftTool, Transform *rightTool) const
+{
+    LanePose<ScalarLanes> trunk{Transform()};
+    applyChain(trunk, m_links[Trunk], m_chains[Trunk].tool, q, 1);
+
+    if (leftTool) {
+        LanePose<ScalarLanes> arm = trunk;
+        applyChain(arm, m_links[LeftArm], m_chains[LeftArm].tool, q, 1);
+        *leftTool = toTransform(arm);
+    }
+    if (rightTool) {
+        LanePose<ScalarLanes> arm = trunk;
+        applyChain(arm, m_links[RightArm], m_chains[RightArm].tool, q, 1);
+        *rightTool = toTransform(arm);
+    }
+}
+
+Transform KinematicModel::forward(ChainId id, const double *q) const
+{
+    LanePose<ScalarLanes> pose{Transform()};
+    applyChain(pose, m_links[Trunk], m_chains[Trunk].tool, q, 1);
+    if (id != Trunk) {
+        applyChain(pose, m_links[id], m_chains[id].tool, q, 1);
+    }
+    return toTransform(pose);
+}
+
+Transform KinematicModel::jacobian(ChainId id, const double *q, double *jacobian) const
+{
+    return chainJacobian(id, false, q, jacobian);
+}
+
+Transform KinematicModel::wholeBodyJacobian(ChainId arm, const double *q, double *jacobian) const
+{
+    return chainJacobian(arm, arm != Trunk, q, jacobian);
+}
+
+Transform KinematicModel::chainJacobian(ChainId id, bool withTrunk, const double *q, double *jacobian) const
+{
+    LanePose<ScalarLanes> pose{Transform()};
+    if (id != Trunk && !withTrunk) {
+        applyChain(pose, m_links[Trunk], m_chains[Trunk].tool, q, 1);
+    }
+
+    // 列依次为（躯干关节）、该链关节；躯干末端变换在躯干最后一个关节之后
+    const size_t trunkColumns = withTrunk ? m_links[Trunk].size() : 0;
+    const size_t n = trunkColumns + m_links[id].size();
+    auto linkAt = [&](size_t c) -> const Link & {
+        return c < trunkColumns ? m_links[Trunk][c] : m_links[id][c - trunkColumns];
+    };
+
+    // 先把各关节轴方向放在角速度行、轴上一点放在线速度行，末端位置求出后再换算
+    for (size_t c = 0; c < n; ++c) {
+        const Link &link = linkAt(c);
+        if (withTrunk && c == trunkColumns) {
+            applyFixed(pose, m_chains[Trunk].tool);
+        }
+        if (link.hasOrigin) {
+            applyFixed(pose, link.origin);
+        }
+        for (int k = 0; k < 3; ++k) {
+            jacobian[size_t(k) * n + c] = pose.p[k];
+            jacobian[size_t(3 + k) * n + c] = pose.r[k * 3 + 2];
+        }
+        applyJoint(pose, link, q + link.jointId);
+    }
+    if (withTrunk && n == trunkColumns) {
+        applyFixed(pose, m_chains[Trunk].tool);
+    }
+    applyFixed(pose, m_chains[id].tool);
+
+    // 转动关节：v = z × (p末端 - o)，w = z；移动关节：v = z，w = 0。再乘单位换算
+    for (size_t c = 0; c < n; ++c) {
+        const double z[3] = { jacobian[3 * n + c], jacobian[4 * n + c], jacobian[5 * n + c] };
+        const double scale = linkAt(c).scale;
+        if (linkAt(c).prismatic) {
+            for (int k = 0; k < 3; ++k) {
+                jacobian[size_t(k) * n + c] = z[k] * scale;
+                jacobian[size_t(3 + k) * n + c] = 0.0;
+            }
+            continue;
+        }
+        const double d[3] = { pose.p[0] - jacobian[c], pose.p[1] - jacobian[n + c], pose.p[2] - jacobian[2 * n + c] };
+        jacobian[c] = (z[1] * d[2] - z[2] * d[1]) * scale;
+        jacobian[n + c] = (z[2] * d[0] - z[0] * d[2]) * scale;
+        jacobian[2 * n + c] = (z[0] * d[1] - z[1] * d[0]) * scale;
+        for (int k = 0; k < 3; ++k) {
+            jacobian[size_t(3 + k) * n + c] = z[k] * scale;
+        }
+    }
+    return toTransform(pose);
+}
+
+void KinematicModel::linkFrames(const double *q, Transform *frames) const
+{
+    LanePose<ScalarLanes> trunk{Transform()};
+    for (const Link &link : m_links[Trunk]) {
+        applyLink(trunk, link, q + link.jointId);
+        *frames++ = toTransform(trunk);
+    }
+    applyFixed(trunk, m_chains[Trunk].tool);
+    *frames++ = toTransform(trunk);
+
+    for (int c = LeftArm; c <= RightArm; ++c) {
+        LanePose<ScalarLanes> arm = trunk;
+        for (const Link &link : m_links[c]) {
+            applyLink(arm, link, q + link.jointId);
+            *frames++ = toTransform(arm);
+        }
+        applyFixed(arm, m_chains[c].tool);
+        *frames++ = toTransform(arm);
+    }
+}
+
+void KinematicModel::forwardBatch(const double *q, size_t stride, size_t count, double *left, double *right) const
+{
+    const size_t width = size_t(SimdLanes::WIDTH);
+    size_t i = 0;
+    for (; i + width <= count; i += width) {
+        forwardLanes<SimdLanes>(m_links, m_chains, q + i, stride, left + i, right + i);
+    }
+    // 不足一组 SIMD 宽度的尾部逐个计算
+    for (; i < count; ++i) {
+        forwardLanes<ScalarLanes>(m_links, m_chains, q + i, stride, left + i, right + i);
+    }
+}
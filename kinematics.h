@@ -0,0 +1,115 @@
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include <cstddef>
+#include <vector>
+
+// 刚体变换：旋转矩阵（行优先）+ 平移（米）
+struct Transform {
+    double r[9];
+    double p[3];
+
+    Transform();    // 单位变换
+
+    // 平移 xyz（米）+ 固定轴 roll/pitch/yaw（弧度），R = Rz(yaw) * Ry(pitch) * Rx(roll)
+    static Transform fromXyzRpy(double x, double y, double z, double roll, double pitch, double yaw);
+
+    // fromXyzRpy 的逆：values = [x, y, z, roll, pitch, yaw]
+    void toXyzRpy(double *values) const;
+
+    Transform operator*(const Transform &other) const;
+};
+
+// 标准 DH 参数：T = Rz(theta) * Tz(d) * Tx(a) * Rx(alpha)
+struct DhParameters {
+    double a;       // 米
+    double alpha;   // 弧度
+    double d;       // 米（移动关节的零位偏置）
+    double theta;   // 弧度（转动关节的零位偏置）
+
+    DhParameters(double a = 0.0, double alpha = 0.0, double d = 0.0, double theta = 0.0)
+        : a(a), alpha(alpha), d(d), theta(theta) {}
+};
+
+struct KinematicJoint {
+    int jointId;            // 全局关节ID，即关节数组中的下标
+    bool prismatic;         // 移动关节变量加在 d 上，转动关节加在 theta 上
+    double scale;           // 关节单位换算到弧度或米（度为 pi/180，毫米为 0.001）
+    bool hasOrigin;
+    Transform origin;       // 该关节之前的固定变换（组的安装位姿）
+    DhParameters dh;
+
+    KinematicJoint() : jointId(0), prismatic(false), scale(1.0), hasOrigin(false) {}
+};
+
+// 一条串联链，末端再接固定的工具变换
+struct KinematicChain {
+    std::vector<KinematicJoint> joints;
+    Transform tool;
+};
+
+// 整机正运动学：底座 → 躯干（升降、腰部）→ 左右臂
+// 两条手臂都挂在躯干末端坐标系上，批量计算时躯干只算一次。
+// 单组构型走标量路径（控制周期内使用）；批量路径按数组结构体布局输入，
+// 每次用 SIMD 同时计算 LANE_WIDTH 组构型，正余弦用无分支多项式代替 libm。
+class KinematicModel
+{
+public:
+    enum ChainId {
+        Trunk,
+        LeftArm,
+        RightArm,
+        CHAIN_COUNT
+    };
+
+    static const int POSE_COMPONENTS = 12;  // 批量输出：9 个旋转分量（行优先）+ 3 个平移分量
+
+    // 预先算好的关节参数，求值时不再计算 alpha 的正余弦
+    struct Link {
+        size_t jointId;
+        bool prismatic;
+        bool hasOrigin;
+        double scale;
+        double a;
+        double d;
+        double theta;
+        double cosAlpha;
+        double sinAlpha;
+        double cosTheta;
+        double sinTheta;
+        Transform origin;
+    };
+
+    KinematicModel();
+
+    void setChain(ChainId id, const KinematicChain &chain);
+    const KinematicChain &chain(ChainId id) const { return m_chains[id]; }
+    bool isEmpty() const;
+    int jointCount() const { return m_jointCount; }     // q 至少需要的长度
+    int frameCount() const;                             // linkFrames 输出的坐标系个数
+
+    // 单组构型，q 按全局关节ID索引，单位与关节一致
+    void forward(const double *q, Transform *leftTool, Transform *rightTool) const;
+    Transform forward(ChainId id, const double *q) const;
+    // 链末端的几何雅可比（6 x n，行优先：前三行线速度、后三行角速度，基坐标系），
+    // 列对应 chain(id) 中的关节，按关节单位求导；返回末端位姿。手臂链不含躯干关节
+    Transform jacobian(ChainId id, const double *q, double *jacobian) const;
+    // 手臂末端对躯干和该臂关节的雅可比（6 x (躯干关节数 + 手臂关节数)），躯干关节的列在前，其余同上
+    Transform wholeBodyJacobian(ChainId arm, const double *q, double *jacobian) const;
+    // 躯干各关节、躯干末端、左臂各关节、左臂末端、右臂各关节、右臂末端依次输出，用于显示
+    void linkFrames(const double *q, Transform *frames) const;
+
+    // 批量：q[joint * stride + i]，输出 left/right[k * stride + i]，k 见 POSE_COMPONENTS
+    void forwardBatch(const double *q, size_t stride, size_t count, double *left, double *right) const;
+
+    static int laneWidth();     // 批量路径的 SIMD 宽度
+
+private:
+    Transform chainJacobian(ChainId id, bool withTrunk, const double *q, double *jacobian) const;
+
+    KinematicChain m_chains[CHAIN_COUNT];
+    std::vector<Link> m_links[CHAIN_COUNT];
+    int m_jointCount;
+};
+
+#endif // KINEMATICS_H
@@ -2,16 +2,32 @@
 #include <QApplication>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QSettings>
 #include <QDateTime>
 #include <QTime>
 #include <QFrame>
 #include <QSplitter>
+#include <QtAlgorithms>
+#include <QActionGroup>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QtMath>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_centralWidget(nullptr)
+    , m_jogStatusLabel(nullptr)
+    , m_chassisStatusLabel(nullptr)
+    , m_motionState(MotionUnknown)
+    , m_activeJoints(0)
+    , m_totalSpeed(0.0)
+    , m_motionElapsedSecs(-1)
+    , m_robotSkeletonItem(nullptr)
+    , m_robotJointItem(nullptr)
+    , m_endEffectorText(nullptr)
     , m_robotController(nullptr)
+    , m_resyncOnConnect(false)
     , m_statusUpdateTimer(nullptr)
 {
     setWindowTitle("机器人运动控制上位机 v1.0");
@@ -22,6 +38,12 @@ MainWindow::MainWindow(QWidget *parent)
     m_robotController = new RobotController(this);
     connect(m_robotController, &RobotController::connectionStatusChanged,
             this, &MainWindow::onRobotStatusChanged);
+    connect(m_robotController, &RobotController::errorOccurred, this, [this](const QString &error) {
+        appendLog(QString("错误: %1").arg(error));
+    });
+    
+    // 初始化回放引擎
+    m_replayEngine = new ReplayEngine(m_robotController, this);
     
     // 设置UI
     setupUI();
@@ -33,9 +55,18 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_statusUpdateTimer, &QTimer::timeout, this, &MainWindow::updateRobotStatus);
     m_statusUpdateTimer->start(100); // 100ms更新一次
     
+    // 回放状态显示
+    connect(m_replayEngine, &ReplayEngine::positionChanged, this, &MainWindow::onReplayPositionChanged);
+    connect(m_replayEngine, &ReplayEngine::playbackStateChanged, m_replayPlayAction, &QAction::setChecked);
+    
     // 初始状态
     m_isSimulationMode = false;  // 初始化仿真模式标志
     onRobotStatusChanged(false);
+    
+    // 上次异常退出留下的指令状态，窗口显示后再询问
+    if (m_robotController->hasRecoveredCommandState()) {
+        QTimer::singleShot(0, this, &MainWindow::offerCommandResync);
+    }
 }
 
 MainWindow::~MainWindow()
@@ -87,22 +118,210 @@ void MainWindow::setupJointControls()
     QWidget *jointControlWidget = new QWidget;
     QVBoxLayout *jointLayout = new QVBoxLayout(jointControlWidget);
     
-    // 创建各个关节组
-    createJointControlGroup("左臂关节 (8个)", 0, 8, jointControlWidget);
-    createJointControlGroup("右臂关节 (8个)", 8, 8, jointControlWidget);
-    createJointControlGroup("腰部关节 (2个)", 16, 2, jointControlWidget);
-    createJointControlGroup("底盘电机 (2个)", 18, 2, jointControlWidget);
-    createJointControlGroup("升降机构 (1个)", 20, 1, jointControlWidget);
+    // 按机器人描述创建各个关节组
+    for (const JointGroupDescription &group : m_robotController->robotDescription().groups()) {
+        createJointControlGroup(QString("%1 (%2个)").arg(group.name).arg(group.joints.size()),
+                                group.firstJoint, group.joints.size(), jointControlWidget);
+    }
     
     jointLayout->addStretch();
     m_scrollArea->setWidget(jointControlWidget);
     
     m_jointTabWidget->addTab(m_scrollArea, "关节控制");
+    setupCartesianJogPanel();
+    setupChassisPanel();
     
     // 添加到主分割器
     m_mainSplitter->addWidget(m_jointTabWidget);
 }
 
+void MainWindow::setupCartesianJogPanel()
+{
+    QWidget *jogWidget = new QWidget;
+    QVBoxLayout *jogLayout = new QVBoxLayout(jogWidget);
+    
+    QGroupBox *settingsGroup = new QGroupBox("点动设置");
+    QGridLayout *settingsLayout = new QGridLayout(settingsGroup);
+    m_jogArmCombo = new QComboBox;
+    m_jogArmCombo->addItems({ "左臂", "右臂" });
+    m_jogFrameCombo = new QComboBox;
+    m_jogFrameCombo->addItems({ "基坐标系", "工具坐标系" });
+    m_jogLinearSpeed = new QDoubleSpinBox;
+    m_jogLinearSpeed->setRange(1.0, 250.0);
+    m_jogLinearSpeed->setValue(50.0);
+    m_jogLinearSpeed->setSuffix(" mm/s");
+    m_jogAngularSpeed = new QDoubleSpinBox;
+    m_jogAngularSpeed->setRange(1.0, 90.0);
+    m_jogAngularSpeed->setValue(15.0);
+    m_jogAngularSpeed->setSuffix(" °/s");
+    settingsLayout->addWidget(new QLabel("手臂:"), 0, 0);
+    settingsLayout->addWidget(m_jogArmCombo, 0, 1);
+    settingsLayout->addWidget(new QLabel("坐标系:"), 1, 0);
+    settingsLayout->addWidget(m_jogFrameCombo, 1, 1);
+    settingsLayout->addWidget(new QLabel("平移速度:"), 2, 0);
+    settingsLayout->addWidget(m_jogLinearSpeed, 2, 1);
+    settingsLayout->addWidget(new QLabel("旋转速度:"), 3, 0);
+    settingsLayout->addWidget(m_jogAngularSpeed, 3, 1);
+    
+    // 全身点动：升降、腰部一起参与，另一臂末端保持不动
+    QCheckBox *wholeBodyCheck = new QCheckBox("全身点动（升降、腰部参与）");
+    wholeBodyCheck->setChecked(m_robotController->wholeBodyJog());
+    connect(wholeBodyCheck, &QCheckBox::toggled, m_robotController, &RobotController::setWholeBodyJog);
+    settingsLayout->addWidget(wholeBodyCheck, 4, 0, 1, 2);
+    
+    // 按住按钮时点动，松开即停
+    QGroupBox *axisGroup = new QGroupBox("末端点动（按住移动）");
+    QGridLayout *axisLayout = new QGridLayout(axisGroup);
+    const QStringList axes = { "X", "Y", "Z", "Roll", "Pitch", "Yaw" };
+    for (int axis = 0; axis < axes.size(); ++axis) {
+        axisLayout->addWidget(new QLabel(axes[axis]), axis, 0);
+        for (int direction = -1; direction <= 1; direction += 2) {
+            QPushButton *button = new QPushButton(direction < 0 ? "−" : "+");
+            axisLayout->addWidget(button, axis, direction < 0 ? 1 : 2);
+            connect(button, &QPushButton::pressed, this, [this, axis, direction]() {
+                QVector<double> twist(6, 0.0);
+                twist[axis] = axis < 3 ? direction * m_jogLinearSpeed->value() / 1000.0
+                                       : direction * qDegreesToRadians(m_jogAngularSpeed->value());
+                const KinematicModel::ChainId arm = m_jogArmCombo->currentIndex() == 0
+                    ? KinematicModel::LeftArm : KinematicModel::RightArm;
+                if (!m_robotController->startCartesianJog(arm, twist, m_jogFrameCombo->currentIndex() == 1)) {
+                    m_jogStatusLabel->setText("无法点动：急停中或该手臂没有运动学参数");
+                }
+            });
+            connect(button, &QPushButton::released, this, [this]() {
+                m_robotController->stopCartesianJog();
+                updateCartesianJogStatus();
+                
+                // 关节滑块同步到点动停下的位置（全身点动时躯干和另一臂也可能动过）
+                const double *targets = m_robotController->jointState().targets();
+                for (int i = 0; i < m_jointControls.size(); ++i) {
+                    m_jointControls[i]->setValue(targets[i]);
+                }
+            });
+        }
+    }
+    
+    m_jogStatusLabel = new QLabel("未点动");
+    
+    jogLayout->addWidget(settingsGroup);
+    jogLayout->addWidget(axisGroup);
+    jogLayout->addWidget(m_jogStatusLabel);
+    jogLayout->addStretch();
+    
+    m_jointTabWidget->addTab(jogWidget, "笛卡尔点动");
+}
+
+void MainWindow::updateCartesianJogStatus()
+{
+    if (!m_jogStatusLabel) {
+        return;
+    }
+    if (!m_robotController->isJogging()) {
+        m_jogStatusLabel->setText("未点动");
+        m_jogStatusLabel->setStyleSheet("");
+        return;
+    }
+    
+    // 速度比例低于 100% 说明受关节速度或限位约束，可操作度接近 0 说明接近奇异位形
+    const KinematicModel::ChainId arm = m_jogArmCombo->currentIndex() == 0
+        ? KinematicModel::LeftArm : KinematicModel::RightArm;
+    const JogResult status = m_robotController->jogStatus(arm);
+    m_jogStatusLabel->setText(QString("点动中  速度比例 %1%  可操作度 %2%3")
+        .arg(qRound(status.scale * 100.0))
+        .arg(status.manipulability, 0, 'f', 4)
+        .arg(status.limited ? "  接近关节限位" : ""));
+    m_jogStatusLabel->setStyleSheet(status.scale < 0.999 || status.limited ? "color: orange;" : "color: green;");
+}
+
+void MainWindow::setupChassisPanel()
+{
+    if (m_robotController->drive().isEmpty()) {
+        return;
+    }
+    
+    QWidget *chassisWidget = new QWidget;
+    QVBoxLayout *chassisLayout = new QVBoxLayout(chassisWidget);
+    
+    QGroupBox *settingsGroup = new QGroupBox("速度设置");
+    QGridLayout *settingsLayout = new QGridLayout(settingsGroup);
+    m_baseLinearSpeed = new QDoubleSpinBox;
+    m_baseLinearSpeed->setRange(0.01, 1.0);
+    m_baseLinearSpeed->setSingleStep(0.05);
+    m_baseLinearSpeed->setValue(0.2);
+    m_baseLinearSpeed->setSuffix(" m/s");
+    m_baseAngularSpeed = new QDoubleSpinBox;
+    m_baseAngularSpeed->setRange(1.0, 90.0);
+    m_baseAngularSpeed->setValue(20.0);
+    m_baseAngularSpeed->setSuffix(" °/s");
+    settingsLayout->addWidget(new QLabel("线速度:"), 0, 0);
+    settingsLayout->addWidget(m_baseLinearSpeed, 0, 1);
+    settingsLayout->addWidget(new QLabel("角速度:"), 1, 0);
+    settingsLayout->addWidget(m_baseAngularSpeed, 1, 1);
+    
+    // 按住按钮时行驶，松开后按加速度限制减速停下
+    QGroupBox *driveGroup = new QGroupBox("底盘行驶（按住移动）");
+    QGridLayout *driveLayout = new QGridLayout(driveGroup);
+    struct DriveButton {
+        const char *text;
+        int row;
+        int column;
+        double linear;      // 线速度、角速度的方向
+        double angular;
+    };
+    const DriveButton buttons[] = {
+        { "前进", 0, 1, 1.0, 0.0 },
+        { "左转", 1, 0, 0.0, 1.0 },
+        { "右转", 1, 2, 0.0, -1.0 },
+        { "后退", 2, 1, -1.0, 0.0 },
+    };
+    for (const DriveButton &spec : buttons) {
+        QPushButton *button = new QPushButton(QString::fromUtf8(spec.text));
+        driveLayout->addWidget(button, spec.row, spec.column);
+        const double linear = spec.linear;
+        const double angular = spec.angular;
+        connect(button, &QPushButton::pressed, this, [this, linear, angular]() {
+            if (!m_robotController->setBaseVelocity(linear * m_baseLinearSpeed->value(),
+                                                    angular * qDegreesToRadians(m_baseAngularSpeed->value()))) {
+                appendLog("底盘无法行驶：急停中");
+            }
+        });
+        connect(button, &QPushButton::released, this, [this]() {
+            m_robotController->stopBase();
+        });
+    }
+    
+    m_chassisStatusLabel = new QLabel;
+    
+    chassisLayout->addWidget(settingsGroup);
+    chassisLayout->addWidget(driveGroup);
+    chassisLayout->addWidget(m_chassisStatusLabel);
+    chassisLayout->addStretch();
+    
+    m_jointTabWidget->addTab(chassisWidget, "底盘");
+}
+
+void MainWindow::updateChassisStatus()
+{
+    if (!m_chassisStatusLabel) {
+        return;
+    }
+    
+    // 里程计位姿和最近一次积分的本体速度；指令超出轮速限制时两轮同比降速
+    const DifferentialDrive &drive = m_robotController->drive();
+    const PlanarPose &pose = drive.pose();
+    const QString text = QString("里程计  x %1 m  y %2 m  航向 %3°\n速度 %4 m/s  %5 °/s%6")
+        .arg(pose.x, 0, 'f', 3)
+        .arg(pose.y, 0, 'f', 3)
+        .arg(qRadiansToDegrees(pose.heading), 0, 'f', 1)
+        .arg(drive.linearVelocity(), 0, 'f', 2)
+        .arg(qRadiansToDegrees(drive.angularVelocity()), 0, 'f', 1)
+        .arg(drive.isSaturated() ? "  已按轮速限制降速" : "");
+    if (m_chassisStatusLabel->text() != text) {
+        m_chassisStatusLabel->setText(text);
+        m_chassisStatusLabel->setStyleSheet(drive.isSaturated() ? "color: orange;" : "");
+    }
+}
+
 void MainWindow::createJointControlGroup(const QString &groupName, int startJoint, int jointCount, QWidget *parent)
 {
     QGroupBox *group = new QGroupBox(groupName);
@@ -110,11 +329,16 @@ void MainWindow::createJointControlGroup(const QString &groupName, int startJoin
     
     for (int i = 0; i < jointCount; ++i) {
         int jointId = startJoint + i;
-        QString jointName = QString("关节 %1").arg(jointId + 1);
+        const JointConfig config = m_robotController->getJointConfig(jointId);
         
-        JointControlWidget *jointControl = new JointControlWidget(jointId, jointName);
+        JointControlWidget *jointControl = new JointControlWidget(jointId, config.name);
+        jointControl->setRange(config.minAngle, config.maxAngle);
+        jointControl->setUnit(config.unit == "deg" ? "°" : " " + config.unit);
         connect(jointControl, &JointControlWidget::valueChanged,
                 this, &MainWindow::onJointValueChanged);
+        connect(jointControl, &JointControlWidget::zeroRequested, this, [this](int jointId) {
+            m_robotController->moveJointTo(jointId, 0.0);
+        });
         
         m_jointControls.append(jointControl);
         
@@ -190,10 +414,17 @@ void MainWindow::setupControlPanel()
     m_batteryLevel->setRange(0, 100);
     m_batteryLevel->setValue(0);
     
+    m_selfCollisionLabel = new QLabel;
+    m_selfCollisionLabel->setWordWrap(true);
+    m_environmentLabel = new QLabel;
+    m_environmentLabel->setWordWrap(true);
+    
     statusLayout->addWidget(m_connectionStatusLabel);
     statusLayout->addWidget(m_robotStatusLabel);
     statusLayout->addWidget(batteryLabel);
     statusLayout->addWidget(m_batteryLevel);
+    statusLayout->addWidget(m_selfCollisionLabel);
+    statusLayout->addWidget(m_environmentLabel);
     
     // 添加到控制布局
     controlLayout->addWidget(connectionGroup);
@@ -237,13 +468,22 @@ void MainWindow::setupLogPanel()
     }
     
     // 添加初始日志
-    m_logTextEdit->append(QString("[%1] 系统启动").arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+    appendLog("系统启动");
 }
 
 void MainWindow::setupMenuBar()
 {
     // 文件菜单
     m_fileMenu = menuBar()->addMenu("文件(&F)");
+    m_startRecordingAction = new QAction("开始会话记录(&R)...", this);
+    m_stopRecordingAction = new QAction("停止会话记录(&S)", this);
+    m_stopRecordingAction->setEnabled(false);
+    connect(m_startRecordingAction, &QAction::triggered, this, &MainWindow::startSessionRecording);
+    connect(m_stopRecordingAction, &QAction::triggered, this, &MainWindow::stopSessionRecording);
+    m_fileMenu->addAction(m_startRecordingAction);
+    m_fileMenu->addAction(m_stopRecordingAction);
+    m_fileMenu->addSeparator();
+    
     m_exitAction = new QAction("退出(&X)", this);
     m_exitAction->setShortcut(QKeySequence::Quit);
     connect(m_exitAction, &QAction::triggered, this, &QWidget::close);
@@ -263,21 +503,82 @@ void MainWindow::setupMenuBar()
     m_robotMenu->addAction(m_connectAction);
     m_robotMenu->addAction(m_disconnectAction);
     m_robotMenu->addSeparator();
+    QAction *playSequenceAction = m_robotMenu->addAction("播放位置序列(&Q)...");
+    QAction *moveArmAction = m_robotMenu->addAction("末端位姿移动(&K)...");
+    QAction *planMoveAction = m_robotMenu->addAction("规划移动到位置(&L)...");
+    QAction *loadEnvironmentAction = m_robotMenu->addAction("加载环境模型(&V)...");
+    QAction *loadRoadmapAction = m_robotMenu->addAction("加载路图(&M)...");
+    QAction *loadReachabilityAction = m_robotMenu->addAction("加载可达性图(&A)...");
+    QAction *feedforwardAction = m_robotMenu->addAction("力矩前馈(&F)");
+    feedforwardAction->setCheckable(true);
+    QAction *stopMotionAction = m_robotMenu->addAction("停止运动(&T)");
+    connect(playSequenceAction, &QAction::triggered, this, &MainWindow::playPositionSequence);
+    connect(moveArmAction, &QAction::triggered, this, &MainWindow::moveArmToPose);
+    connect(planMoveAction, &QAction::triggered, this, &MainWindow::planMoveToPosition);
+    connect(loadEnvironmentAction, &QAction::triggered, this, &MainWindow::loadEnvironment);
+    connect(loadRoadmapAction, &QAction::triggered, this, &MainWindow::loadRoadmap);
+    connect(loadReachabilityAction, &QAction::triggered, this, &MainWindow::loadReachabilityMap);
+    connect(feedforwardAction, &QAction::toggled, [this](bool enabled) {
+        m_robotController->setTorqueFeedforward(enabled);
+        appendLog(enabled ? "力矩前馈已开启：轨迹设定点同时下发重力补偿和惯性力矩" : "力矩前馈已关闭");
+    });
+    connect(stopMotionAction, &QAction::triggered, [this]() {
+        m_robotController->stopMotion();
+        appendLog("运动已停止");
+    });
+    m_robotMenu->addSeparator();
     m_robotMenu->addAction(m_emergencyStopAction);
     
+    // 回放菜单
+    m_replayMenu = menuBar()->addMenu("回放(&P)");
+    QAction *openReplayAction = m_replayMenu->addAction("打开回放文件(&O)...");
+    m_replayPlayAction = m_replayMenu->addAction("播放(&P)");
+    m_replayPlayAction->setCheckable(true);
+    QAction *stepAction = m_replayMenu->addAction("单步(&S)");
+    QAction *seekAction = m_replayMenu->addAction("跳转到(&G)...");
+    
+    QMenu *speedMenu = m_replayMenu->addMenu("播放速度");
+    QActionGroup *speedGroup = new QActionGroup(this);
+    const QList<QPair<QString, double>> speeds = {
+        { "0.1x", 0.1 }, { "0.5x", 0.5 }, { "1x", 1.0 }, { "2x", 2.0 },
+        { "10x", 10.0 }, { "100x", 100.0 }, { "最快", ReplayEngine::AS_FAST_AS_POSSIBLE }
+    };
+    for (const auto &speed : speeds) {
+        QAction *action = speedMenu->addAction(speed.first);
+        action->setCheckable(true);
+        action->setChecked(speed.second == 1.0);
+        speedGroup->addAction(action);
+        const double value = speed.second;
+        connect(action, &QAction::triggered, this, [this, value]() {
+            m_replayEngine->setSpeed(value);
+        });
+    }
+    
+    connect(openReplayAction, &QAction::triggered, this, &MainWindow::openReplayFile);
+    connect(m_replayPlayAction, &QAction::triggered, this, [this](bool play) {
+        if (play) {
+            m_replayEngine->play();
+        } else {
+            m_replayEngine->pause();
+        }
+    });
+    connect(stepAction, &QAction::triggered, this, [this]() {
+        m_replayEngine->pause();
+        m_replayEngine->step();
+    });
+    connect(seekAction, &QAction::triggered, this, &MainWindow::seekReplay);
+    
     // 帮助菜单
     m_helpMenu = menuBar()->addMenu("帮助(&H)");
     m_aboutAction = new QAction("关于(&A)", this);
     connect(m_aboutAction, &QAction::triggered, [this]() {
-        QMessageBox::about(this, "关于", 
-            "机器人运动控制上位机 v1.0\n\n"
-            "支持轮臂机器人控制:\n"
-            "- 左臂: 8个关节\n"
-            "- 右臂: 8个关节\n"
-            "- 腰部: 2个关节\n"
-            "- 底盘: 2个电机\n"
-            "- 升降: 1个电机\n\n"
-            "总计21个自由度");
+        const RobotDescription &description = m_robotController->robotDescription();
+        QString text = QString("机器人运动控制上位机 v1.0\n\n%1:\n").arg(description.name());
+        for (const JointGroupDescription &group : description.groups()) {
+            text += QString("- %1: %2个\n").arg(group.name).arg(group.joints.size());
+        }
+        text += QString("\n总计%1个自由度").arg(description.jointCount());
+        QMessageBox::about(this, "关于", text);
     });
     m_helpMenu->addAction(m_aboutAction);
 }
@@ -287,15 +588,129 @@ void MainWindow::setupStatusBar()
     statusBar()->showMessage("就绪");
 }
 
+void MainWindow::appendLog(const QString &message)
+{
+    m_logTextEdit->append(QString("[%1] %2").arg(QDateTime::currentDateTime().toString("hh:mm:ss"), message));
+    
+    // 操作日志同时写入会话记录
+    m_robotController->recordOperatorAction(message);
+}
+
+void MainWindow::startSessionRecording()
+{
+    QString directory = QFileDialog::getExistingDirectory(this, "选择会话记录目录");
+    if (directory.isEmpty()) {
+        return;
+    }
+    
+    QString error;
+    if (!m_robotController->startSessionRecording(directory, &error)) {
+        QMessageBox::warning(this, "会话记录", QString("无法开始会话记录: %1").arg(error));
+        return;
+    }
+    
+    m_startRecordingAction->setEnabled(false);
+    m_stopRecordingAction->setEnabled(true);
+    appendLog(QString("会话记录已开始: %1").arg(directory));
+}
+
+void MainWindow::stopSessionRecording()
+{
+    appendLog("会话记录已停止");
+    m_robotController->stopSessionRecording();
+    
+    m_startRecordingAction->setEnabled(true);
+    m_stopRecordingAction->setEnabled(false);
+}
+
+void MainWindow::openReplayFile()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "打开回放文件", "", "状态数据 (*.jsonl *.log *.txt);;所有文件 (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    QString error;
+    if (!m_replayEngine->open(fileName, &error)) {
+        QMessageBox::warning(this, "回放", QString("无法打开回放文件: %1").arg(error));
+        return;
+    }
+    
+    // 回放数据经由控制器送入，界面按已连接状态工作
+    m_robotController->disconnectFromRobot();
+    m_robotController->setConnectionType("replay");
+    m_robotController->connectToRobot();
+    
+    appendLog(QString("回放文件已打开: %1 (%2帧)").arg(fileName).arg(m_replayEngine->frameCount()));
+    m_replayEngine->play();
+}
+
+void MainWindow::seekReplay()
+{
+    if (!m_replayEngine->isOpen()) {
+        return;
+    }
+    
+    const qint64 durationSecs = (m_replayEngine->endTime() - m_replayEngine->startTime()) / 1000;
+    const qint64 currentSecs = (m_replayEngine->currentTime() - m_replayEngine->startTime()) / 1000;
+    bool ok = false;
+    int secs = QInputDialog::getInt(this, "跳转", QString("跳转到 (秒, 0-%1):").arg(durationSecs),
+                                    static_cast<int>(currentSecs), 0, static_cast<int>(durationSecs), 1, &ok);
+    if (ok) {
+        m_replayEngine->seek(m_replayEngine->startTime() + qint64(secs) * 1000);
+    }
+}
+
+void MainWindow::onReplayPositionChanged(qint64 timestampMs)
+{
+    const qint64 elapsed = (timestampMs - m_replayEngine->startTime()) / 1000;
+    const qint64 duration = (m_replayEngine->endTime() - m_replayEngine->startTime()) / 1000;
+    statusBar()->showMessage(QString("回放: %1:%2:%3 / %4:%5:%6")
+        .arg(elapsed / 3600, 2, 10, QChar('0')).arg(elapsed / 60 % 60, 2, 10, QChar('0')).arg(elapsed % 60, 2, 10, QChar('0'))
+        .arg(duration / 3600, 2, 10, QChar('0')).arg(duration / 60 % 60, 2, 10, QChar('0')).arg(duration % 60, 2, 10, QChar('0')));
+}
+
+void MainWindow::offerCommandResync()
+{
+    const CommandJournalState &state = m_robotController->recoveredCommandState();
+    
+    // 界面显示恢复的目标位置和使能状态
+    for (int i = 0; i < m_jointControls.size(); ++i) {
+        if (state.targetMask & (quint64(1) << i)) {
+            m_jointControls[i]->setValue(state.targets[i]);
+        }
+        m_jointControls[i]->setJointEnabled((state.enableMask >> i) & 1u);
+    }
+    
+    const QString lastCommand = QDateTime::fromMSecsSinceEpoch(state.lastCommandUs / 1000).toString("yyyy-MM-dd hh:mm:ss");
+    appendLog(QString("已从指令日志恢复上次异常退出前的指令状态（最后指令 %1）").arg(lastCommand));
+    
+    QString text = QString("程序上次未正常退出，已恢复最后下发的指令状态：\n"
+                           "- %1 个关节的目标位置\n- %2 个关节处于使能\n- 急停: %3\n\n"
+                           "连接机器人后是否重新下发这些指令？")
+        .arg(qPopulationCount(state.targetMask))
+        .arg(qPopulationCount(state.enableMask))
+        .arg(state.emergencyStop ? "已激活" : "未激活");
+    if (QMessageBox::question(this, "恢复指令状态", text) == QMessageBox::Yes) {
+        m_resyncOnConnect = true;
+        if (m_robotController->isConnected()) {
+            onRobotStatusChanged(true);
+        }
+    } else {
+        m_robotController->discardRecoveredState();
+        appendLog("已放弃恢复的指令状态");
+    }
+}
+
 void MainWindow::connectToRobot()
 {
-    m_logTextEdit->append(QString("[%1] 正在连接机器人...").arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+    appendLog("正在连接机器人...");
     
     if (m_robotController->connectToRobot()) {
-        m_logTextEdit->append(QString("[%1] 机器人连接成功").arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+        appendLog("机器人连接成功");
         statusBar()->showMessage("已连接到机器人");
     } else {
-        m_logTextEdit->append(QString("[%1] 机器人连接失败").arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+        appendLog("机器人连接失败");
         QMessageBox::warning(this, "连接失败", "无法连接到机器人，请检查连接设置。");
     }
 }
@@ -303,14 +718,14 @@ void MainWindow::connectToRobot()
 void MainWindow::disconnectFromRobot()
 {
     m_robotController->disconnectFromRobot();
-    m_logTextEdit->append(QString("[%1] 已断开机器人连接").arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+    appendLog("已断开机器人连接");
     statusBar()->showMessage("已断开连接");
 }
 
 void MainWindow::emergencyStop()
 {
     m_robotController->emergencyStop();
-    m_logTextEdit->append(QString("[%1] 紧急停止已激活").arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+    appendLog("紧急停止已激活");
     QMessageBox::warning(this, "紧急停止", "紧急停止已激活！所有运动已停止。");
 }
 
@@ -323,7 +738,7 @@ void MainWindow::resetToZeroPosition()
         jointControl->setValue(0.0);
     }
     
-    m_logTextEdit->append(QString("[%1] 机器人已复位到零位").arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+    appendLog("机器人已复位到零位");
 }
 
 void MainWindow::saveCurrentPosition()
@@ -336,7 +751,7 @@ void MainWindow::saveCurrentPosition()
             settings.setValue(QString("joint_%1").arg(i), m_jointControls[i]->getValue());
         }
         
-        m_logTextEdit->append(QString("[%1] 位置已保存到: %2").arg(QDateTime::currentDateTime().toString("hh:mm:ss"), fileName));
+        appendLog(QString("位置已保存到: %1").arg(fileName));
     }
 }
 
@@ -346,14 +761,213 @@ void MainWindow::loadPosition()
     if (!fileName.isEmpty()) {
         QSettings settings(fileName, QSettings::IniFormat);
         
+        QVector<double> pose(m_robotController->jointCount(), 0.0);
         for (int i = 0; i < m_jointControls.size(); ++i) {
-            double value = settings.value(QString("joint_%1").arg(i), 0.0).toDouble();
-            m_jointControls[i]->setValue(value);
-            m_robotController->setJointPosition(i, value);
+            pose[i] = settings.value(QString("joint_%1").arg(i), 0.0).toDouble();
+            m_jointControls[i]->setValue(pose[i]);
         }
         
-        m_logTextEdit->append(QString("[%1] 位置已从文件加载: %2").arg(QDateTime::currentDateTime().toString("hh:mm:ss"), fileName));
+        // 所有关节同步运动到保存的位姿
+        m_robotController->moveToPose(pose);
+        const MotionProgress motion = m_robotController->motionProgress();
+        appendLog(QString("位置已从文件加载: %1，同步运动 %2 秒").arg(fileName).arg(motion.duration, 0, 'f', 2));
+    }
+}
+
+void MainWindow::playPositionSequence()
+{
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, "选择位置序列", "", "位置文件 (*.pos)");
+    if (fileNames.isEmpty()) {
+        return;
     }
+    // 按文件名决定播放顺序（如 01_抓取.pos、02_放置.pos）
+    fileNames.sort();
+    
+    bool ok = false;
+    const QStringList modes = { "三次样条（C2连续，最平滑）", "五次样条（不冲过关键帧）", "时间最优（沿五次样条路径）" };
+    const QString mode = QInputDialog::getItem(this, "位置序列", "插值方式:", modes, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    // 时间最优按关节限制取满速度，不需要速度比例
+    const bool timeOptimal = mode == modes.last();
+    int speed = 100;
+    if (!timeOptimal) {
+        speed = QInputDialog::getInt(this, "位置序列", "速度（关节最大速度的百分比）:", 50, 1, 100, 5, &ok);
+        if (!ok) {
+            return;
+        }
+    }
+    
+    std::vector<Keyframe> keyframes;
+    for (const QString &fileName : fileNames) {
+        QSettings settings(fileName, QSettings::IniFormat);
+        Keyframe keyframe;
+        keyframe.pose.resize(size_t(m_robotController->jointCount()), 0.0);
+        for (int i = 0; i < m_robotController->jointCount(); ++i) {
+            keyframe.pose[size_t(i)] = settings.value(QString("joint_%1").arg(i), 0.0).toDouble();
+        }
+        // 位置文件中可选的 duration（秒）和 speed（0~1）覆盖默认计时
+        keyframe.duration = settings.value("duration", 0.0).toDouble();
+        keyframe.speedScale = settings.value("speed", speed / 100.0).toDouble();
+        keyframes.push_back(keyframe);
+    }
+    
+    const KeyframeSequence::Interpolation interpolation =
+        mode == modes.first() ? KeyframeSequence::Cubic : KeyframeSequence::Quintic;
+    QString error;
+    const bool started = timeOptimal ? m_robotController->playTimeOptimal(keyframes, &error)
+                                     : m_robotController->playSequence(keyframes, interpolation, &error);
+    if (!started) {
+        QMessageBox::warning(this, "位置序列", QString("无法播放位置序列: %1").arg(error));
+        return;
+    }
+    
+    const std::vector<double> &last = keyframes.back().pose;
+    for (int i = 0; i < m_jointControls.size(); ++i) {
+        m_jointControls[i]->setValue(last[size_t(i)]);
+    }
+    appendLog(QString("开始播放位置序列: %1个关键帧，%2，时长 %3 秒")
+        .arg(keyframes.size()).arg(mode).arg(m_robotController->motionProgress().duration, 0, 'f', 2));
+}
+
+void MainWindow::planMoveToPosition()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "规划移动到位置", "", "位置文件 (*.pos)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QSettings settings(fileName, QSettings::IniFormat);
+    const int count = m_robotController->jointCount();
+    QVector<double> pose(count, 0.0);
+    for (int i = 0; i < count; ++i) {
+        pose[i] = settings.value(QString("joint_%1").arg(i), 0.0).toDouble();
+    }
+    
+    // 只规划位置文件与当前设定点不同的手臂
+    const KinematicModel &model = m_robotController->kinematicModel();
+    const double *targets = m_robotController->jointState().targets();
+    quint64 mask = 0;
+    for (KinematicModel::ChainId arm : { KinematicModel::LeftArm, KinematicModel::RightArm }) {
+        quint64 armMask = 0;
+        bool changed = false;
+        for (const KinematicJoint &joint : model.chain(arm).joints) {
+            armMask |= quint64(1) << joint.jointId;
+            changed = changed || qAbs(pose[joint.jointId] - targets[joint.jointId]) > 1e-6;
+        }
+        if (changed) {
+            mask |= armMask;
+        }
+    }
+    if (mask == 0) {
+        appendLog("手臂已在目标位置，无需规划");
+        return;
+    }
+    
+    PlanResult result;
+    QString error;
+    if (!m_robotController->moveToPoseCollisionFree(pose, mask, &result, &error)) {
+        QMessageBox::warning(this, "规划移动", QString("无法规划到目标位置: %1").arg(error));
+        return;
+    }
+    for (int i = 0; i < m_jointControls.size(); ++i) {
+        if (mask & (quint64(1) << i)) {
+            m_jointControls[i]->setValue(pose[i]);
+        }
+    }
+    appendLog(QString("规划移动（%1）: %2，%3个路径点，规划 %4 ms（%5个节点，%6次碰撞检测），缩短 %7 ms，"
+                      "路径长度 %8 -> %9，时长 %10 秒")
+        .arg(result.fromRoadmap ? "路图" : "RRT-Connect")
+        .arg(QFileInfo(fileName).fileName()).arg(result.waypoints.size())
+        .arg(result.planningSeconds * 1000.0, 0, 'f', 1).arg(result.nodes).arg(result.stateChecks)
+        .arg(result.shortcutSeconds * 1000.0, 0, 'f', 1)
+        .arg(result.rawLength, 0, 'f', 0).arg(result.length, 0, 'f', 0)
+        .arg(m_robotController->motionProgress().duration, 0, 'f', 2));
+}
+
+void MainWindow::moveArmToPose()
+{
+    bool ok = false;
+    const QStringList arms = { "左臂", "右臂", "左臂（全身）", "右臂（全身）" };
+    const QString armName = QInputDialog::getItem(this, "末端位姿移动", "手臂:", arms, 0, false, &ok);
+    if (!ok) {
+        return;
+    }
+    // 全身：升降、腰部一起求解，另一臂末端保持当前位姿
+    const int armIndex = arms.indexOf(armName);
+    const bool wholeBody = armIndex >= 2;
+    const KinematicModel::ChainId arm = armIndex % 2 == 0 ? KinematicModel::LeftArm : KinematicModel::RightArm;
+    if (m_robotController->kinematicModel().chain(arm).joints.empty()) {
+        QMessageBox::warning(this, "末端位姿移动", "机器人描述中没有该手臂的运动学参数");
+        return;
+    }
+    
+    // 以当前末端位姿为默认值：位置为米，姿态为 roll/pitch/yaw（度）
+    double current[6];
+    m_robotController->armPose(arm).toXyzRpy(current);
+    QStringList fields;
+    for (int i = 0; i < 6; ++i) {
+        fields << QString::number(i < 3 ? current[i] : qRadiansToDegrees(current[i]), 'f', i < 3 ? 4 : 2);
+    }
+    const QString text = QInputDialog::getText(this, "末端位姿移动", "目标位姿 x y z (m) roll pitch yaw (°):",
+                                               QLineEdit::Normal, fields.join(' '), &ok);
+    if (!ok) {
+        return;
+    }
+    
+    const QStringList parts = QString(text).replace(',', ' ').simplified().split(' ', Qt::SkipEmptyParts);
+    double values[6];
+    bool valid = parts.size() == 6;
+    for (int i = 0; valid && i < 6; ++i) {
+        values[i] = parts[i].toDouble(&valid);
+    }
+    if (!valid) {
+        QMessageBox::warning(this, "末端位姿移动", "请输入 6 个数值：x y z roll pitch yaw");
+        return;
+    }
+    
+    const Transform target = Transform::fromXyzRpy(values[0], values[1], values[2], qDegreesToRadians(values[3]),
+                                                   qDegreesToRadians(values[4]), qDegreesToRadians(values[5]));
+    IkResult result;
+    QVector<double> solution;
+    const bool moved = wholeBody ? m_robotController->moveWholeBodyTo(arm, target, &result, &solution)
+                                 : m_robotController->moveArmTo(arm, target, &result, &solution);
+    if (!moved) {
+        // 加载了可达性图时附上目标位置所在体素的统计
+        QString reach;
+        const ReachabilityMap &map = m_robotController->reachabilityMap();
+        if (!map.isEmpty()) {
+            const ReachabilityCell *cell = map.cell(arm == KinematicModel::LeftArm ? 0 : 1, target.p);
+            reach = !cell || cell->samples == 0
+                ? QString("\n可达性图：目标位置不在该臂的可达范围内")
+                : QString("\n可达性图：目标位置可达，接近方向覆盖 %1%，最大可操作度 %2")
+                      .arg(ReachabilityMap::coverage(*cell) * 100.0, 0, 'f', 0)
+                      .arg(cell->manipulability, 0, 'f', 4);
+        }
+        QMessageBox::warning(this, "末端位姿移动",
+            QString("逆解未收敛（%1 次迭代），残差 %2 mm / %3°，目标可能超出工作空间或关节限位%4")
+                .arg(result.iterations)
+                .arg(result.positionError * 1000.0, 0, 'f', 2)
+                .arg(qRadiansToDegrees(result.orientationError), 0, 'f', 2)
+                .arg(reach));
+        return;
+    }
+    
+    const KinematicModel &model = m_robotController->kinematicModel();
+    for (KinematicModel::ChainId chain : { KinematicModel::Trunk, KinematicModel::LeftArm, KinematicModel::RightArm }) {
+        if (chain != arm && !wholeBody) {
+            continue;
+        }
+        for (const KinematicJoint &joint : model.chain(chain).joints) {
+            if (joint.jointId < m_jointControls.size()) {
+                m_jointControls[joint.jointId]->setValue(solution[joint.jointId]);
+            }
+        }
+    }
+    appendLog(QString("%1移动到末端位姿 %2：%3 次迭代，残差 %4 mm / %5°")
+        .arg(armName).arg(text.simplified()).arg(result.iterations)
+        .arg(result.positionError * 1000.0, 0, 'f', 3)
+        .arg(qRadiansToDegrees(result.orientationError), 0, 'f', 3));
 }
 
 void MainWindow::enableAllJoints()
@@ -362,7 +976,7 @@ void MainWindow::enableAllJoints()
         jointControl->setEnabled(true);
     }
     m_robotController->enableAllJoints();
-    m_logTextEdit->append(QString("[%1] 所有关节已使能").arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+    appendLog("所有关节已使能");
 }
 
 void MainWindow::disableAllJoints()
@@ -371,7 +985,7 @@ void MainWindow::disableAllJoints()
         jointControl->setEnabled(false);
     }
     m_robotController->disableAllJoints();
-    m_logTextEdit->append(QString("[%1] 所有关节已失能").arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+    appendLog("所有关节已失能");
 }
 
 void MainWindow::onRobotStatusChanged(bool connected)
@@ -387,6 +1001,12 @@ void MainWindow::onRobotStatusChanged(bool connected)
     m_connectAction->setEnabled(!connected);
     m_disconnectAction->setEnabled(connected);
     
+    if (connected && m_resyncOnConnect) {
+        m_resyncOnConnect = false;
+        m_robotController->resyncRecoveredState();
+        appendLog("已向机器人重新下发恢复的指令状态");
+    }
+    
     if (connected) {
         m_connectionStatusLabel->setText("连接状态: 已连接");
         m_robotStatusLabel->setText("机器人状态: 在线");
@@ -402,22 +1022,170 @@ void MainWindow::onRobotStatusChanged(bool connected)
 void MainWindow::onJointValueChanged(int jointId, double value)
 {
     m_robotController->setJointPosition(jointId, value);
+    
+    // 设定点被自碰撞保护拒绝时滑块退回
+    const JointStateStore &state = m_robotController->jointState();
+    if (state.targets()[jointId] != state.clampToLimits(jointId, value)) {
+        m_jointControls[jointId]->setValue(state.targets()[jointId]);
+    }
+}
+
+void MainWindow::updateSelfCollisionStatus()
+{
+    // 绿色：检测范围外；橙色：50 mm 内；红色：10 mm 内（靠近的设定点会被拒绝）
+    const SelfCollisionResult &status = m_robotController->selfCollisionStatus();
+    QString text;
+    QString style;
+    if (status.capsuleA < 0) {
+        text = "自碰撞距离: 安全";
+        style = "color: green;";
+    } else {
+        text = QString("自碰撞距离: %1 mm（%2）")
+            .arg(status.minimumDistance * 1000.0, 0, 'f', 0)
+            .arg(m_robotController->selfCollisionPairName(status));
+        style = status.minimumDistance < 0.01 ? "color: red; font-weight: bold;"
+              : status.minimumDistance < 0.05 ? "color: orange;" : "color: green;";
+    }
+    if (m_selfCollisionLabel->text() != text) {
+        m_selfCollisionLabel->setText(text);
+        m_selfCollisionLabel->setStyleSheet(style);
+    }
+}
+
+void MainWindow::loadEnvironment()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "加载环境模型", "", "环境描述 (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    QString error;
+    if (!m_robotController->loadEnvironment(fileName, &error)) {
+        QMessageBox::warning(this, "环境模型", QString("无法加载环境模型: %1").arg(error));
+        return;
+    }
+    const EnvironmentModel &environment = m_robotController->environment();
+    const DistanceField &field = environment.distanceField();
+    appendLog(QString("环境模型已加载: %1（%2个物体，体素 %3 mm，%4 MB，%5 %6 ms）")
+        .arg(environment.name()).arg(environment.shapes().size())
+        .arg(field.resolution() * 1000.0, 0, 'f', 0).arg(field.memoryBytes() / 1048576.0, 0, 'f', 1)
+        .arg(environment.loadedFromCache() ? "读取缓存" : "生成距离场")
+        .arg(environment.buildSeconds() * 1000.0, 0, 'f', 0));
+    updateEnvironmentStatus();
+}
+
+void MainWindow::loadRoadmap()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "加载路图", "", "路图文件 (*.prm)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    QString error;
+    if (!m_robotController->loadRoadmap(fileName, &error)) {
+        QMessageBox::warning(this, "路图", QString("无法加载路图: %1").arg(error));
+        return;
+    }
+    const Roadmap &roadmap = m_robotController->roadmap();
+    appendLog(QString("路图已加载: %1（%2个关节，%3个节点，其中%4个常用位姿，%5条边，%6 KB）")
+        .arg(QFileInfo(fileName).fileName()).arg(roadmap.jointCount()).arg(roadmap.nodeCount())
+        .arg(roadmap.anchorCount()).arg(roadmap.edgeCount()).arg(roadmap.imageBytes() / 1024.0, 0, 'f', 0));
+}
+
+void MainWindow::loadReachabilityMap()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "加载可达性图", "", "可达性图文件 (*.rmap)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    QString error;
+    if (!m_robotController->loadReachabilityMap(fileName, &error)) {
+        QMessageBox::warning(this, "可达性图", QString("无法加载可达性图: %1").arg(error));
+        return;
+    }
+    const ReachabilityMap &map = m_robotController->reachabilityMap();
+    const ReachabilityHeader &header = map.header();
+    const double cellVolume = map.resolution() * map.resolution() * map.resolution();
+    const ReachabilitySummary left = map.summary(0);
+    const ReachabilitySummary right = map.summary(1);
+    appendLog(QString("可达性图已加载: %1（体素 %2 mm，躯干%3，左臂可达 %4 m³ / 灵活 %5 m³，"
+                      "右臂可达 %6 m³ / 灵活 %7 m³，%8 MB）")
+        .arg(QFileInfo(fileName).fileName()).arg(map.resolution() * 1000.0, 0, 'f', 0)
+        .arg(header.trunkSampled ? "随机采样" : "固定")
+        .arg(left.reachableCells * cellVolume, 0, 'f', 3).arg(left.dexterousCells * cellVolume, 0, 'f', 3)
+        .arg(right.reachableCells * cellVolume, 0, 'f', 3).arg(right.dexterousCells * cellVolume, 0, 'f', 3)
+        .arg(map.imageBytes() / 1048576.0, 0, 'f', 1));
+}
+
+void MainWindow::updateEnvironmentStatus()
+{
+    // 颜色规则与自碰撞一致，红色阈值为环境停止距离 20 mm
+    QString text;
+    QString style;
+    if (m_robotController->environment().isEmpty()) {
+        text = "环境距离: 未加载环境模型";
+    } else {
+        const EnvironmentClearance &status = m_robotController->environmentStatus();
+        if (status.capsule < 0 && !status.chassis) {
+            text = "环境距离: 安全";
+            style = "color: green;";
+        } else {
+            text = QString("环境距离: %1 mm（%2）")
+                .arg(status.minimumDistance * 1000.0, 0, 'f', 0)
+                .arg(m_robotController->environmentPartName(status));
+            style = status.minimumDistance < 0.02 ? "color: red; font-weight: bold;"
+                  : status.minimumDistance < 0.05 ? "color: orange;" : "color: green;";
+        }
+    }
+    if (m_environmentLabel->text() != text) {
+        m_environmentLabel->setText(text);
+        m_environmentLabel->setStyleSheet(style);
+    }
 }
 
 void MainWindow::updateRobotStatus()
 {
-    if (m_robotController->isConnected()) {
-        // 更新电池电量（模拟数据）
-        static int batteryValue = 85;
-        m_batteryLevel->setValue(batteryValue);
-        
-        // 更新关节位置反馈（如果有的话）
-        // 这里可以从机器人控制器获取实际的关节位置反馈
-        
-        // 更新运动状态显示
-        updateMotionStatusDisplay();
+    // 只刷新自上次读取以来数据发生变化的控件
+    const RobotChangeSet changes = m_robotController->takeChanges();
+    const bool connected = m_robotController->isConnected();
+    
+    if (connected) {
+        // 更新电池电量
+        if (changes.status & RobotChangeSet::BatteryChanged) {
+            m_batteryLevel->setValue(qRound(m_robotController->batteryLevel()));
+        }
         
-        // 更新渲染窗口
+        // 更新关节位置反馈
+        const quint64 positionChanges = changes.joints.field(JointStateStore::PositionField);
+        if (positionChanges) {
+            const double *positions = m_robotController->jointState().positions();
+            for (int i = 0; i < m_jointControls.size(); ++i) {
+                if (positionChanges & (quint64(1) << i)) {
+                    m_jointControls[i]->setFeedbackValue(positions[i]);
+                }
+            }
+            updateRobotModelView();
+        }
+    }
+    
+    // 离线点动时关节位置由控制器积分，没有反馈通道，直接重画骨架
+    if (m_robotController->isJogging()) {
+        if (!connected) {
+            updateRobotModelView();
+        }
+        updateCartesianJogStatus();
+    }
+    
+    updateChassisStatus();
+    updateSelfCollisionStatus();
+    updateEnvironmentStatus();
+    
+    // 更新运动状态显示
+    updateMotionStatusDisplay(changes);
+    
+    // 更新渲染窗口
+    if (changes.status & RobotChangeSet::ConnectionChanged) {
         updateRenderWindow();
     }
 }
@@ -478,13 +1246,17 @@ void MainWindow::setupMotionStatusPanel()
     statusLayout->addWidget(m_motionProgressBar);
     
     // 活跃关节数
-    m_activeJointsLabel = new QLabel("活跃关节: 0/21", this);
+    m_activeJointsLabel = new QLabel(QString("活跃关节: 0/%1").arg(m_robotController->jointCount()), this);
     statusLayout->addWidget(m_activeJointsLabel);
     
     // 运动时间
     m_motionTimeLabel = new QLabel("运动时间: 00:00", this);
     statusLayout->addWidget(m_motionTimeLabel);
     
+    // 轨迹预计剩余时间
+    m_motionEtaLabel = new QLabel("预计剩余: --", this);
+    statusLayout->addWidget(m_motionEtaLabel);
+    
     // 添加分隔线
     QFrame *line = new QFrame(this);
     line->setFrameShape(QFrame::HLine);
@@ -495,61 +1267,85 @@ void MainWindow::setupMotionStatusPanel()
     // 这里需要修改setupControlPanel中的布局
 }
 
-void MainWindow::updateMotionStatusDisplay()
+void MainWindow::updateMotionStatusDisplay(const RobotChangeSet &changes)
 {
     if (!m_robotController->isConnected()) {
-        m_motionStateLabel->setText("运动状态: 离线");
-        m_motionStateLabel->setStyleSheet("font-weight: bold; color: #DC143C;");
-        m_currentSpeedLabel->setText("当前速度: -- °/s");
-        m_targetPositionLabel->setText("目标位置: --");
-        m_motionProgressBar->setValue(0);
-        m_activeJointsLabel->setText("活跃关节: --/21");
-        m_motionTimeLabel->setText("运动时间: --:--");
+        if (m_motionState != MotionOffline) {
+            m_motionState = MotionOffline;
+            m_motionStateLabel->setText("运动状态: 离线");
+            m_motionStateLabel->setStyleSheet("font-weight: bold; color: #DC143C;");
+            m_currentSpeedLabel->setText("当前速度: -- °/s");
+            m_targetPositionLabel->setText("目标位置: --");
+            m_motionProgressBar->setValue(0);
+            m_activeJointsLabel->setText(QString("活跃关节: --/%1").arg(m_robotController->jointCount()));
+            m_motionTimeLabel->setText("运动时间: --:--");
+            m_motionEtaLabel->setText("预计剩余: --");
+            m_motionElapsedSecs = -1;
+        }
         return;
     }
     
-    // 计算活跃关节数（正在运动的关节）
-    int activeJoints = 0;
-    double totalSpeed = 0.0;
+    const JointStateStore &state = m_robotController->jointState();
+    const quint64 motionFields = changes.joints.field(JointStateStore::VelocityField)
+                               | changes.joints.field(JointStateStore::EnableField);
+    
+    // 使能或速度变化时才重新统计
+    if (motionFields || m_motionState == MotionUnknown || m_motionState == MotionOffline) {
+        // 计算活跃关节数（已使能的关节）与总速度
+        const quint64 enableMask = state.enableMask();
+        const double *velocities = state.velocities();
+        m_activeJoints = qPopulationCount(enableMask);
+        m_totalSpeed = 0.0;
+        for (int i = 0; i < state.jointCount(); ++i) {
+            if (enableMask & (quint64(1) << i)) {
+                m_totalSpeed += qAbs(velocities[i]);
+            }
+        }
+        
+        m_currentSpeedLabel->setText(QString("当前速度: %1 °/s").arg(m_totalSpeed, 0, 'f', 1));
+        m_activeJointsLabel->setText(QString("活跃关节: %1/%2").arg(m_activeJoints).arg(state.jointCount()));
+    }
     
-    for (auto *jointControl : m_jointControls) {
-        if (jointControl->isEnabled()) {
-            activeJoints++;
-            // 这里可以获取关节的实际速度，现在使用模拟数据
-            totalSpeed += qAbs(jointControl->getCurrentValue() - jointControl->getTargetValue()) * 0.1;
+    // 更新运动状态，样式表只在状态切换时设置
+    const MotionProgress motion = m_robotController->motionProgress();
+    const bool moving = motion.active || (m_activeJoints > 0 && m_totalSpeed > 0.1);
+    const MotionState motionState = moving ? MotionMoving : MotionIdle;
+    if (motionState != m_motionState) {
+        m_motionState = motionState;
+        if (motionState == MotionMoving) {
+            m_motionStateLabel->setText("运动状态: 运动中");
+            m_motionStateLabel->setStyleSheet("font-weight: bold; color: #FF8C00;");
+            m_motionProgressBar->setValue(0);
+        } else {
+            m_motionStateLabel->setText("运动状态: 静止");
+            m_motionStateLabel->setStyleSheet("font-weight: bold; color: #2E8B57;");
+            m_motionProgressBar->setValue(100);
+            m_motionEtaLabel->setText("预计剩余: --");
         }
     }
     
-    // 更新运动状态
-    if (activeJoints > 0 && totalSpeed > 0.1) {
-        m_motionStateLabel->setText("运动状态: 运动中");
-        m_motionStateLabel->setStyleSheet("font-weight: bold; color: #FF8C00;");
-        
-        // 模拟运动进度
-        static int progress = 0;
-        progress = (progress + 2) % 101;
-        m_motionProgressBar->setValue(progress);
-    } else {
-        m_motionStateLabel->setText("运动状态: 静止");
-        m_motionStateLabel->setStyleSheet("font-weight: bold; color: #2E8B57;");
-        m_motionProgressBar->setValue(100);
+    // 轨迹运动的真实进度和剩余时间（反馈速度引起的运动没有可知的终点）
+    if (motion.active) {
+        m_motionProgressBar->setValue(qRound(motion.progress * 100.0));
+        m_motionEtaLabel->setText(QString("预计剩余: %1 s").arg(motion.remaining, 0, 'f', 1));
     }
     
-    // 更新显示信息
-    m_currentSpeedLabel->setText(QString("当前速度: %1 °/s").arg(totalSpeed, 0, 'f', 1));
-    m_activeJointsLabel->setText(QString("活跃关节: %1/21").arg(activeJoints));
+    // 更新运动时间，只在秒数变化时刷新
+    int elapsed = 0;
+    if (m_activeJoints > 0) {
+        if (!m_motionStartTime.isValid()) {
+            m_motionStartTime.start();
+        }
+        elapsed = static_cast<int>(m_motionStartTime.elapsed() / 1000);
+    } else {
+        m_motionStartTime.invalidate();
+    }
     
-    // 更新运动时间（模拟）
-    static QTime motionStartTime = QTime::currentTime();
-    if (activeJoints > 0) {
-        QTime currentTime = QTime::currentTime();
-        int elapsed = motionStartTime.secsTo(currentTime);
+    if (elapsed != m_motionElapsedSecs) {
+        m_motionElapsedSecs = elapsed;
         m_motionTimeLabel->setText(QString("运动时间: %1:%2")
             .arg(elapsed / 60, 2, 10, QChar('0'))
             .arg(elapsed % 60, 2, 10, QChar('0')));
-    } else {
-        motionStartTime = QTime::currentTime();
-        m_motionTimeLabel->setText("运动时间: 00:00");
     }
 }
 
@@ -607,10 +1403,13 @@ void MainWindow::setupRenderWindow()
         m_renderScene->addLine(-200, i, 200, i, gridPen);
     }
     
-    // 添加中心提示文本
-    QGraphicsTextItem *centerText = m_renderScene->addText("机器人3D模型渲染区域\n(开发中...)", QFont("Arial", 12));
-    centerText->setDefaultTextColor(Qt::white);
-    centerText->setPos(-80, -10);
+    // 机器人骨架：连杆坐标系由正运动学求出，斜二测投影到场景中
+    m_robotSkeletonItem = m_renderScene->addPath(QPainterPath(), QPen(QColor(0, 170, 255), 3));
+    m_robotJointItem = m_renderScene->addPath(QPainterPath(), QPen(Qt::white, 1), QBrush(QColor(255, 200, 0)));
+    m_endEffectorText = m_renderScene->addText(QString(), QFont("Arial", 9));
+    m_endEffectorText->setDefaultTextColor(Qt::white);
+    m_endEffectorText->setPos(10, -148);
+    updateRobotModelView();
     
     // 创建状态标签
     m_renderStatusLabel = new QLabel("渲染状态: 就绪");
@@ -662,9 +1461,54 @@ void MainWindow::updateRenderWindow()
         m_renderStatusLabel->setStyleSheet("color: #DC143C; font-weight: bold;");
     }
     
-    // TODO: 在这里添加实际的机器人模型渲染逻辑
-    // 根据关节角度更新机器人姿态
-    // 这里可以集成OpenGL或其他3D渲染库
+    updateRobotModelView();
+}
+
+void MainWindow::updateRobotModelView()
+{
+    const KinematicModel &model = m_robotController->kinematicModel();
+    if (!m_robotSkeletonItem || model.isEmpty()) {
+        return;
+    }
+    
+    m_linkFrames.resize(size_t(model.frameCount()));
+    model.linkFrames(m_robotController->jointState().positions(), m_linkFrames.data());
+    
+    // 从机器人正前方观察：y 向右、z 向上，x 向左下方斜投影，底座原点在场景底部
+    const double scale = 110.0;
+    auto project = [scale](const double *p) {
+        return QPointF((p[1] - 0.35 * p[0]) * scale, 140.0 - (p[2] - 0.35 * p[0]) * scale);
+    };
+    
+    QPainterPath skeleton;
+    QPainterPath joints;
+    const double origin[3] = { 0.0, 0.0, 0.0 };
+    skeleton.moveTo(project(origin));
+    size_t frame = 0;
+    const size_t trunkFrames = model.chain(KinematicModel::Trunk).joints.size() + 1;
+    for (; frame < trunkFrames; ++frame) {
+        skeleton.lineTo(project(m_linkFrames[frame].p));
+        joints.addEllipse(project(m_linkFrames[frame].p), 3, 3);
+    }
+    const QPointF torso = project(m_linkFrames[trunkFrames - 1].p);
+    
+    const Transform *tools[2] = { nullptr, nullptr };
+    for (int arm = 0; arm < 2; ++arm) {
+        const KinematicModel::ChainId id = arm == 0 ? KinematicModel::LeftArm : KinematicModel::RightArm;
+        const size_t armFrames = model.chain(id).joints.size() + 1;
+        skeleton.moveTo(torso);
+        for (size_t k = 0; k < armFrames; ++k, ++frame) {
+            skeleton.lineTo(project(m_linkFrames[frame].p));
+            joints.addEllipse(project(m_linkFrames[frame].p), 3, 3);
+        }
+        tools[arm] = &m_linkFrames[frame - 1];
+    }
+    m_robotSkeletonItem->setPath(skeleton);
+    m_robotJointItem->setPath(joints);
+    
+    m_endEffectorText->setPlainText(QString("左臂末端: (%1, %2, %3) m\n右臂末端: (%4, %5, %6) m")
+        .arg(tools[0]->p[0], 0, 'f', 3).arg(tools[0]->p[1], 0, 'f', 3).arg(tools[0]->p[2], 0, 'f', 3)
+        .arg(tools[1]->p[0], 0, 'f', 3).arg(tools[1]->p[1], 0, 'f', 3).arg(tools[1]->p[2], 0, 'f', 3));
 }
 
 void MainWindow::toggleSimulationMode(bool enabled)
@@ -673,8 +1517,7 @@ void MainWindow::toggleSimulationMode(bool enabled)
     
     if (enabled) {
         // 启用仿真模式
-        m_logTextEdit->append(QString("[%1] 仿真模式已启用")
-            .arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+        appendLog("仿真模式已启用");
         
         // 在仿真模式下，允许关节控制即使没有连接机器人
         for (auto *jointControl : m_jointControls) {
@@ -687,8 +1530,7 @@ void MainWindow::toggleSimulationMode(bool enabled)
         
     } else {
         // 禁用仿真模式
-        m_logTextEdit->append(QString("[%1] 仿真模式已禁用")
-            .arg(QDateTime::currentDateTime().toString("hh:mm:ss")));
+        appendLog("仿真模式已禁用");
         
         // 恢复正常的连接状态控制
         bool isConnected = m_robotController && m_robotController->isConnected();
@@ -25,11 +25,14 @@
 #include <QGraphicsView>
 #include <QGraphicsScene>
 #include <QGraphicsTextItem>
+#include <QGraphicsPathItem>
 #include <QCheckBox>
 #include <QFrame>
+#include <QElapsedTimer>
 
 #include "robotcontroller.h"
 #include "jointcontrolwidget.h"
+#include "replayengine.h"
 
 QT_BEGIN_NAMESPACE
 class QAction;
@@ -51,12 +54,24 @@ private slots:
     void resetToZeroPosition();
     void saveCurrentPosition();
     void loadPosition();
+    void playPositionSequence();
+    void moveArmToPose();
+    void planMoveToPosition();
+    void loadRoadmap();
+    void loadReachabilityMap();
+    void loadEnvironment();
     void enableAllJoints();
     void disableAllJoints();
     void onRobotStatusChanged(bool connected);
     void onJointValueChanged(int jointId, double value);
     void updateRobotStatus();
     void toggleSimulationMode(bool enabled);  // 新增：切换仿真模式
+    void startSessionRecording();
+    void stopSessionRecording();
+    void openReplayFile();
+    void seekReplay();
+    void onReplayPositionChanged(qint64 timestampMs);
+    void offerCommandResync();
 
 private:
     void setupUI();
@@ -65,10 +80,18 @@ private:
     void setupJointControls();
     void setupControlPanel();
     void setupLogPanel();
+    void appendLog(const QString &message);
     void setupMotionStatusPanel();  // 新增：运动状态面板
     void setupRenderWindow();       // 新增：设置渲染窗口
-    void updateMotionStatusDisplay();  // 新增：更新运动状态显示
+    void updateMotionStatusDisplay(const RobotChangeSet &changes);  // 新增：更新运动状态显示
     void updateRenderWindow();      // 新增：更新渲染窗口
+    void updateRobotModelView();    // 按当前关节位置重画机器人骨架
+    void setupCartesianJogPanel();  // 笛卡尔点动标签页
+    void updateCartesianJogStatus();
+    void setupChassisPanel();       // 底盘速度控制标签页
+    void updateChassisStatus();
+    void updateSelfCollisionStatus();
+    void updateEnvironmentStatus();
     void createJointControlGroup(const QString &groupName, int startJoint, int jointCount, QWidget *parent);
     
     // UI组件
@@ -84,6 +107,18 @@ private:
     QGroupBox *m_chassisGroup;
     QGroupBox *m_liftGroup;
     
+    // 笛卡尔点动
+    QComboBox *m_jogArmCombo;
+    QComboBox *m_jogFrameCombo;
+    QDoubleSpinBox *m_jogLinearSpeed;   // mm/s
+    QDoubleSpinBox *m_jogAngularSpeed;  // °/s
+    QLabel *m_jogStatusLabel;
+    
+    // 底盘速度控制
+    QDoubleSpinBox *m_baseLinearSpeed;  // m/s
+    QDoubleSpinBox *m_baseAngularSpeed; // °/s
+    QLabel *m_chassisStatusLabel;
+    
     // 控制面板
     QGroupBox *m_controlGroup;
     QPushButton *m_connectBtn;
@@ -99,6 +134,8 @@ private:
     QLabel *m_connectionStatusLabel;
     QLabel *m_robotStatusLabel;
     QProgressBar *m_batteryLevel;
+    QLabel *m_selfCollisionLabel;       // 自碰撞最小距离
+    QLabel *m_environmentLabel;         // 与环境的最小距离
     
     // 运动状态显示
     QGroupBox *m_motionStatusGroup;
@@ -108,12 +145,25 @@ private:
     QProgressBar *m_motionProgressBar; // 运动进度
     QLabel *m_activeJointsLabel;       // 活跃关节数
     QLabel *m_motionTimeLabel;         // 运动时间
+    QLabel *m_motionEtaLabel;          // 轨迹预计剩余时间
+    
+    // 运动状态缓存（只在变化时刷新控件）
+    enum MotionState { MotionUnknown, MotionOffline, MotionIdle, MotionMoving };
+    MotionState m_motionState;
+    int m_activeJoints;
+    double m_totalSpeed;
+    QElapsedTimer m_motionStartTime;
+    int m_motionElapsedSecs;
     
     // 渲染窗口
     QWidget *m_renderWidget;           // 渲染窗口容器
     QGraphicsView *m_renderView;       // 图形视图
     QGraphicsScene *m_renderScene;     // 图形场景
     QLabel *m_renderStatusLabel;       // 渲染状态标签
+    QGraphicsPathItem *m_robotSkeletonItem; // 机器人连杆
+    QGraphicsPathItem *m_robotJointItem;    // 关节位置
+    QGraphicsTextItem *m_endEffectorText;   // 两臂末端坐标
+    std::vector<Transform> m_linkFrames;    // 正运动学求出的各连杆坐标系
     
     // 仿真模式
     QCheckBox *m_simulationModeCheckBox; // 仿真模式复选框
@@ -127,6 +177,8 @@ private:
     
     // 机器人控制器
     RobotController *m_robotController;
+    ReplayEngine *m_replayEngine;
+    bool m_resyncOnConnect;            // 连接后重新下发从指令日志恢复的状态
     
     // 定时器
     QTimer *m_statusUpdateTimer;
@@ -134,12 +186,16 @@ private:
     // 菜单和动作
     QMenu *m_fileMenu;
     QMenu *m_robotMenu;
+    QMenu *m_replayMenu;
     QMenu *m_helpMenu;
     QAction *m_exitAction;
+    QAction *m_startRecordingAction;
+    QAction *m_stopRecordingAction;
     QAction *m_aboutAction;
     QAction *m_connectAction;
     QAction *m_disconnectAction;
     QAction *m_emergencyStopAction;
+    QAction *m_replayPlayAction;
 };
 
 #endif // MAINWINDOW_H
\ No newline at end of file
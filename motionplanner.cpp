@@ -0,0 +1,463 @@
+#include "motionplanner.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace {
+
+double secondsNow()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+PlanResult::PlanResult()
+    : success(false)
+    , planningSeconds(0.0)
+    , shortcutSeconds(0.0)
+    , nodes(0)
+    , stateChecks(0)
+    , winningThread(-1)
+    , rawLength(0.0)
+    , length(0.0)
+    , fromRoadmap(false)
+{
+}
+
+MotionPlanner::MotionPlanner(int threadCount)
+    : m_threadCount(threadCount > 0 ? threadCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))
+{
+}
+
+bool MotionPlanner::configure(const PlanningScene &scene, const std::vector<int> &jointIds, std::string *errorMessage)
+{
+    auto fail = [errorMessage](const std::string &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    if (!scene.model || scene.minLimits.size() != scene.maxLimits.size()) {
+        return fail("规划场景无效");
+    }
+    if (jointIds.empty()) {
+        return fail("没有参与规划的关节");
+    }
+    for (int jointId : jointIds) {
+        if (jointId < 0 || size_t(jointId) >= scene.minLimits.size()) {
+            return fail("规划关节ID超出范围: " + std::to_string(jointId));
+        }
+    }
+
+    SelfCollisionModel collision;
+    collision.configure(scene.model, scene.linkRadii);
+
+    m_scene = scene;
+    m_jointIds = jointIds;
+    m_lower.clear();
+    m_upper.clear();
+    for (int jointId : jointIds) {
+        m_lower.push_back(scene.minLimits[size_t(jointId)]);
+        m_upper.push_back(scene.maxLimits[size_t(jointId)]);
+    }
+
+    // 每个线程一份碰撞检测暂存，复制已配置好的模型即可
+    m_checkers.assign(size_t(m_threadCount), Checker());
+    for (Checker &checker : m_checkers) {
+        checker.collision = collision;
+        checker.full.assign(scene.minLimits.size(), 0.0);
+        checker.checks = 0;
+    }
+    return true;
+}
+
+double MotionPlanner::distance(const double *a, const double *b) const
+{
+    double sum = 0.0;
+    for (size_t k = 0; k < m_jointIds.size(); ++k) {
+        const double d = a[k] - b[k];
+        sum += d * d;
+    }
+    return std::sqrt(sum);
+}
+
+bool MotionPlanner::stateValid(Checker &checker, const double *x, double clearance) const
+{
+    ++checker.checks;
+    for (size_t k = 0; k < m_jointIds.size(); ++k) {
+        checker.full[size_t(m_jointIds[k])] = x[k];
+    }
+    if (checker.collision.check(checker.full.data(), clearance).minimumDistance < clearance) {
+        return false;
+    }
+    // 底盘在规划期间不动，只检查连杆胶囊
+    if (m_scene.environment && !m_scene.environment->isEmpty()) {
+        const EnvironmentClearance environment =
+            m_scene.environment->robotClearance(checker.collision, m_scene.basePose, 0.0, 0.0, clearance);
+        if (environment.minimumDistance < clearance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MotionPlanner::isStateValid(const double *q, double clearance)
+{
+    if (!isConfigured()) {
+        return false;
+    }
+    Checker &checker = m_checkers.front();
+    std::copy(q, q + checker.full.size(), checker.full.begin());
+    std::vector<double> x(m_jointIds.size());
+    for (size_t k = 0; k < m_jointIds.size(); ++k) {
+        x[k] = q[m_jointIds[k]];
+    }
+    return stateValid(checker, x.data(), clearance);
+}
+
+void MotionPlanner::setFixedJoints(const double *q)
+{
+    for (Checker &checker : m_checkers) {
+        std::copy(q, q + checker.full.size(), checker.full.begin());
+    }
+}
+
+bool MotionPlanner::checkState(int worker, const double *x, double clearance)
+{
+    return stateValid(m_checkers[size_t(worker)], x, clearance);
+}
+
+bool MotionPlanner::checkMotion(int worker, const double *from, const double *to, const PlannerOptions &options)
+{
+    return motionValid(m_checkers[size_t(worker)], from, to, options);
+}
+
+size_t MotionPlanner::stateChecks() const
+{
+    size_t checks = 0;
+    for (const Checker &checker : m_checkers) {
+        checks += checker.checks;
+    }
+    return checks;
+}
+
+bool MotionPlanner::motionValid(Checker &checker, const double *from, const double *to,
+                                const PlannerOptions &options) const
+{
+    const size_t n = m_jointIds.size();
+    double maxDelta = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        maxDelta = std::max(maxDelta, std::fabs(to[k] - from[k]));
+    }
+    const int steps = std::max(1, int(std::ceil(maxDelta / options.checkResolution)));
+
+    // 先查终点，再按二分顺序检查中间点（起点已在树上或已检查过），有碰撞时能更早发现
+    if (!stateValid(checker, to, options.clearance)) {
+        return false;
+    }
+    double point[64];
+    std::vector<double> heapPoint;
+    double *x = point;
+    if (n > 64) {
+        heapPoint.resize(n);
+        x = heapPoint.data();
+    }
+    int stride = 1;
+    while (stride < steps) {
+        stride *= 2;
+    }
+    for (; stride > 1; stride /= 2) {
+        for (int s = stride / 2; s < steps; s += stride) {
+            const double t = double(s) / steps;
+            for (size_t k = 0; k < n; ++k) {
+                x[k] = from[k] + (to[k] - from[k]) * t;
+            }
+            if (!stateValid(checker, x, options.clearance)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+size_t MotionPlanner::nearest(const Tree &tree, const double *x) const
+{
+    const size_t n = m_jointIds.size();
+    size_t best = 0;
+    double bestDistance = std::numeric_limits<double>::infinity();
+    const double *node = tree.nodes.data();
+    for (size_t i = 0; i < tree.size(); ++i, node += n) {
+        double sum = 0.0;
+        for (size_t k = 0; k < n && sum < bestDistance; ++k) {
+            const double d = node[k] - x[k];
+            sum += d * d;
+        }
+        if (sum < bestDistance) {
+            bestDistance = sum;
+            best = i;
+        }
+    }
+    return best;
+}
+
+MotionPlanner::ExtendStatus MotionPlanner::extend(Checker &checker, Tree &tree, const double *target,
+                                                  const PlannerOptions &options) const
+{
+    const size_t n = m_jointIds.size();
+    const size_t index = nearest(tree, target);
+    const size_t offset = index * n;
+    const double d = distance(&tree.nodes[offset], target);
+
+    // 新节点先放到末尾，检查不通过再撤掉（避免 nodes 扩容使指针失效）
+    tree.nodes.resize(tree.nodes.size() + n);
+    const double *near = &tree.nodes[offset];
+    double *next = &tree.nodes[tree.nodes.size() - n];
+    ExtendStatus status = Reached;
+    if (d > options.stepSize) {
+        const double scale = options.stepSize / d;
+        for (size_t k = 0; k < n; ++k) {
+            next[k] = near[k] + (target[k] - near[k]) * scale;
+        }
+        status = Advanced;
+    } else {
+        std::copy(target, target + n, next);
+    }
+    if (!motionValid(checker, near, next, options)) {
+        tree.nodes.resize(tree.nodes.size() - n);
+        return Trapped;
+    }
+    tree.parents.push_back(int(index));
+    return status;
+}
+
+void MotionPlanner::shortcut(Checker &checker, std::vector<double> &path, const PlannerOptions &options,
+                             double deadline) const
+{
+    // 在两段路径上各取一个随机点，能直连就替换中间部分
+    const size_t n = m_jointIds.size();
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<double> a(n);
+    std::vector<double> b(n);
+    for (int iteration = 0; iteration < options.shortcutIterations && secondsNow() < deadline; ++iteration) {
+        const size_t segments = path.size() / n - 1;
+        if (segments < 2) {
+            break;
+        }
+        size_t i = size_t(unit(random) * segments);
+        size_t j = size_t(unit(random) * segments);
+        i = std::min(i, segments - 1);
+        j = std::min(j, segments - 1);
+        if (i == j) {
+            continue;
+        }
+        if (i > j) {
+            std::swap(i, j);
+        }
+        const double ta = unit(random);
+        const double tb = unit(random);
+        for (size_t k = 0; k < n; ++k) {
+            a[k] = path[i * n + k] + (path[(i + 1) * n + k] - path[i * n + k]) * ta;
+            b[k] = path[j * n + k] + (path[(j + 1) * n + k] - path[j * n + k]) * tb;
+        }
+        if (!motionValid(checker, a.data(), b.data(), options)) {
+            continue;
+        }
+        // 路径变为 P0..Pi, a, b, Pj+1..；a、b 所在的线段本身已验证，直连边刚验证
+        std::vector<double> shortened(path.begin(), path.begin() + std::ptrdiff_t((i + 1) * n));
+        shortened.insert(shortened.end(), a.begin(), a.end());
+        shortened.insert(shortened.end(), b.begin(), b.end());
+        shortened.insert(shortened.end(), path.begin() + std::ptrdiff_t((j + 1) * n), path.end());
+        path.swap(shortened);
+    }
+
+    // 去掉与前后两点共线或可以直接跳过的点
+    for (size_t i = 0; i + 2 < path.size() / n;) {
+        if (motionValid(checker, &path[i * n], &path[(i + 2) * n], options)) {
+            path.erase(path.begin() + std::ptrdiff_t((i + 1) * n), path.begin() + std::ptrdiff_t((i + 2) * n));
+        } else {
+            ++i;
+        }
+    }
+}
+
+PlanResult MotionPlanner::plan(const double *start, const double *goal, const PlannerOptions &options)
+{
+    PlanResult result;
+    const double begin = secondsNow();
+    const double deadline = begin + options.timeBudget;
+    if (!isConfigured()) {
+        result.error = "规划器未配置";
+        return result;
+    }
+
+    const size_t n = m_jointIds.size();
+    const size_t jointCount = m_scene.minLimits.size();
+    m_fixed.assign(start, start + jointCount);
+    for (Checker &checker : m_checkers) {
+        std::copy(start, start + jointCount, checker.full.begin());
+        checker.checks = 0;
+    }
+
+    std::vector<double> xs(n);
+    std::vector<double> xg(n);
+    for (size_t k = 0; k < n; ++k) {
+        xs[k] = start[m_jointIds[k]];
+        xg[k] = goal[m_jointIds[k]];
+        if (xg[k] < m_lower[k] || xg[k] > m_upper[k]) {
+            result.error = "终点超出关节限位";
+            return result;
+        }
+    }
+
+    Checker &main = m_checkers.front();
+    if (!stateValid(main, xs.data(), options.clearance)) {
+        result.error = "起点不满足间隙要求";
+        return result;
+    }
+    if (!stateValid(main, xg.data(), options.clearance)) {
+        result.error = "终点不满足间隙要求";
+        return result;
+    }
+
+    std::vector<double> path;
+    if (motionValid(main, xs.data(), xg.data(), options)) {
+        // 直线可达
+        path = xs;
+        path.insert(path.end(), xg.begin(), xg.end());
+        result.winningThread = 0;
+    } else {
+        struct WorkerResult {
+            bool found;
+            uint64_t key;
+            std::vector<double> path;
+            size_t nodes;
+        };
+        std::vector<WorkerResult> workerResults(m_checkers.size(), WorkerResult{ false, 0, {}, 0 });
+        std::atomic<uint64_t> bestKey(std::numeric_limits<uint64_t>::max());
+        const uint64_t threads = m_checkers.size();
+
+        auto grow = [&](size_t index) {
+            Checker &checker = m_checkers[index];
+            WorkerResult &output = workerResults[index];
+            std::mt19937 random(options.seed + uint32_t(index));
+            std::vector<std::uniform_real_distribution<double>> ranges;
+            for (size_t k = 0; k < n; ++k) {
+                ranges.emplace_back(m_lower[k], m_upper[k]);
+            }
+
+            Tree trees[2];
+            trees[0].nodes = xs;
+            trees[0].parents.push_back(-1);
+            trees[1].nodes = xg;
+            trees[1].parents.push_back(-1);
+            int grown = 0;          // 本轮扩展的树，0 为起点树
+            std::vector<double> sample(n);
+            for (uint64_t iteration = 0;; ++iteration) {
+                const uint64_t key = iteration * threads + index;
+                if (key > bestKey.load(std::memory_order_relaxed) || secondsNow() > deadline) {
+                    break;
+                }
+                for (size_t k = 0; k < n; ++k) {
+                    sample[k] = ranges[k](random);
+                }
+
+                Tree &a = trees[grown];
+                Tree &b = trees[1 - grown];
+                if (extend(checker, a, sample.data(), options) != Trapped) {
+                    // 另一棵树向新节点连续扩展直到连上或受阻
+                    const std::vector<double> target(a.nodes.end() - std::ptrdiff_t(n), a.nodes.end());
+                    ExtendStatus status;
+                    do {
+                        status = extend(checker, b, target.data(), options);
+                    } while (status == Advanced);
+                    if (status == Reached) {
+                        uint64_t current = bestKey.load();
+                        while (key < current && !bestKey.compare_exchange_weak(current, key)) {
+                        }
+                        // 两棵树的最后一个节点即连接点
+                        const Tree &startTree = trees[0];
+                        const Tree &goalTree = trees[1];
+                        for (int i = int(startTree.size()) - 1; i >= 0; i = startTree.parents[size_t(i)]) {
+                            output.path.insert(output.path.begin(), startTree.nodes.begin() + std::ptrdiff_t(size_t(i) * n),
+                                               startTree.nodes.begin() + std::ptrdiff_t(size_t(i + 1) * n));
+                        }
+                        for (int i = goalTree.parents.back(); i >= 0; i = goalTree.parents[size_t(i)]) {
+                            output.path.insert(output.path.end(), goalTree.nodes.begin() + std::ptrdiff_t(size_t(i) * n),
+                                               goalTree.nodes.begin() + std::ptrdiff_t(size_t(i + 1) * n));
+                        }
+                        output.found = true;
+                        output.key = key;
+                        break;
+                    }
+                }
+                grown = 1 - grown;
+            }
+            output.nodes = trees[0].size() + trees[1].size();
+        };
+
+        if (threads == 1) {
+            grow(0);
+        } else {
+            std::vector<std::thread> workers;
+            workers.reserve(size_t(threads));
+            for (size_t index = 0; index < threads; ++index) {
+                workers.emplace_back(grow, index);
+            }
+            for (std::thread &worker : workers) {
+                worker.join();
+            }
+        }
+
+        int winner = -1;
+        for (size_t index = 0; index < workerResults.size(); ++index) {
+            result.nodes += workerResults[index].nodes;
+            if (workerResults[index].found && (winner < 0 || workerResults[index].key < workerResults[size_t(winner)].key)) {
+                winner = int(index);
+            }
+        }
+        if (winner < 0) {
+            for (const Checker &checker : m_checkers) {
+                result.stateChecks += checker.checks;
+            }
+            result.planningSeconds = secondsNow() - begin;
+            result.error = "规划时间内未找到路径";
+            return result;
+        }
+        result.winningThread = winner;
+        path.swap(workerResults[size_t(winner)].path);
+    }
+    result.planningSeconds = secondsNow() - begin;
+
+    auto pathLength = [this, n](const std::vector<double> &points) {
+        double length = 0.0;
+        for (size_t i = n; i < points.size(); i += n) {
+            length += distance(&points[i - n], &points[i]);
+        }
+        return length;
+    };
+    result.rawLength = pathLength(path);
+    const double shortcutBegin = secondsNow();
+    shortcut(main, path, options, deadline);
+    result.shortcutSeconds = secondsNow() - shortcutBegin;
+    result.length = pathLength(path);
+
+    for (size_t i = 0; i < path.size(); i += n) {
+        std::vector<double> waypoint = m_fixed;
+        for (size_t k = 0; k < n; ++k) {
+            waypoint[size_t(m_jointIds[k])] = path[i + k];
+        }
+        result.waypoints.push_back(waypoint);
+    }
+    for (const Checker &checker : m_checkers) {
+        result.stateChecks += checker.checks;
+    }
+    result.success = true;
+    return result;
+}
@@ -0,0 +1,120 @@
+#ifndef MOTIONPLANNER_H
+#define MOTIONPLANNER_H
+
+#include "distancefield.h"
+#include "kinematics.h"
+#include "selfcollision.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 规划场景：机器人模型与静态环境，规划期间需保持有效
+struct PlanningScene {
+    const KinematicModel *model;
+    std::vector<double> linkRadii;      // 按全局关节ID，与自碰撞模型一致
+    std::vector<double> minLimits;      // 按全局关节ID，单位与关节一致
+    std::vector<double> maxLimits;
+    const DistanceField *environment;   // 为空或空距离场时只检查自碰撞
+    uint64_t environmentHash;           // 环境描述的内容哈希，路图据此判断已验证的边是否仍然有效
+    Transform basePose;                 // 底座在环境坐标系中的位姿（规划期间底盘不动）
+
+    PlanningScene() : model(nullptr), environment(nullptr), environmentHash(0) {}
+};
+
+struct PlannerOptions {
+    double timeBudget;          // 秒，树生长和路径缩短共用
+    uint32_t seed;              // 第 i 个线程使用 seed + i，线程数和种子相同时结果可复现
+    double stepSize;            // 每次扩展在关节空间的最大步长（关节单位的欧氏距离）
+    double checkResolution;     // 边检查时相邻检查点任一关节的最大差值
+    double clearance;           // 米，自碰撞和环境间隙都不得小于该值
+    int shortcutIterations;     // 随机缩短路径的尝试次数
+
+    PlannerOptions()
+        : timeBudget(1.0), seed(1), stepSize(20.0), checkResolution(1.0), clearance(0.03), shortcutIterations(200) {}
+};
+
+struct PlanResult {
+    bool success;
+    std::vector<std::vector<double>> waypoints;  // 按全局关节ID的整机位姿，首尾为起点和终点
+    double planningSeconds;     // 树生长（含等待其他线程确认结果）
+    double shortcutSeconds;
+    size_t nodes;               // 所有线程两棵树的节点总数
+    size_t stateChecks;         // 所有线程的碰撞检测次数
+    int winningThread;
+    double rawLength;           // 缩短前后的关节空间路径长度
+    double length;
+    bool fromRoadmap;           // 由路图查询得到（nodes 为 A* 展开的节点数）
+    std::string error;
+
+    PlanResult();
+};
+
+// 关节空间 RRT-Connect 运动规划
+// 只在 jointIds 指定的关节上规划（一条手臂或两臂同时），其余关节保持起点值。
+// 每个线程用各自的种子独立生长一对树（起点树、终点树交替扩展并尝试连接），
+// 各自持有一份碰撞检测暂存；距离场只读共享。
+// 结果取“找到路径时的迭代次数最少、次数相同取线程号最小”的线程：某线程找到路径后，
+// 其他线程只需跑到同样的迭代次数即可确定胜者，因此结果不依赖线程调度。
+// 找到路径后随机选两点尝试直连以缩短路径（种子固定，结果同样可复现）。
+// 状态有效：自碰撞最小距离和环境间隙均不小于 clearance；边按 checkResolution 离散检查。
+class MotionPlanner
+{
+public:
+    explicit MotionPlanner(int threadCount = 0);   // 0 为硬件线程数
+
+    bool configure(const PlanningScene &scene, const std::vector<int> &jointIds, std::string *errorMessage = nullptr);
+    bool isConfigured() const { return m_scene.model != nullptr && !m_jointIds.empty(); }
+    int threadCount() const { return m_threadCount; }
+    const PlanningScene &scene() const { return m_scene; }
+    const std::vector<int> &jointIds() const { return m_jointIds; }
+
+    // start、goal 按全局关节ID；未参与规划的关节取 start 的值
+    PlanResult plan(const double *start, const double *goal, const PlannerOptions &options);
+
+    // 整机位姿是否满足间隙要求（使用第一个线程的暂存，不可与 plan 同时调用）
+    bool isStateValid(const double *q, double clearance);
+
+    // 供路图等外部搜索使用：坐标只含规划关节（jointIds 顺序），未规划关节取 setFixedJoints 的值。
+    // worker 为线程暂存下标（0 ~ threadCount()-1），各线程使用不同下标时可以并行调用
+    void setFixedJoints(const double *q);
+    bool checkState(int worker, const double *x, double clearance);
+    bool checkMotion(int worker, const double *from, const double *to, const PlannerOptions &options);
+    size_t stateChecks() const;         // 所有线程暂存累计的碰撞检测次数（plan 开始时清零）
+
+private:
+    struct Checker {
+        SelfCollisionModel collision;
+        std::vector<double> full;       // 整机位姿暂存
+        size_t checks;
+    };
+
+    struct Tree {
+        std::vector<double> nodes;      // 每 n 个值一个节点
+        std::vector<int> parents;
+        size_t size() const { return parents.size(); }
+    };
+
+    enum ExtendStatus {
+        Trapped,
+        Advanced,
+        Reached
+    };
+
+    bool stateValid(Checker &checker, const double *x, double clearance) const;
+    bool motionValid(Checker &checker, const double *from, const double *to, const PlannerOptions &options) const;
+    ExtendStatus extend(Checker &checker, Tree &tree, const double *target, const PlannerOptions &options) const;
+    size_t nearest(const Tree &tree, const double *x) const;
+    double distance(const double *a, const double *b) const;
+    void shortcut(Checker &checker, std::vector<double> &path, const PlannerOptions &options,
+                  double deadline) const;
+
+    int m_threadCount;
+    PlanningScene m_scene;
+    std::vector<int> m_jointIds;
+    std::vector<double> m_lower;        // 规划关节的限位
+    std::vector<double> m_upper;
+    std::vector<double> m_fixed;        // 本次规划的整机起点（未规划关节的取值）
+    std::vector<Checker> m_checkers;    // 每个线程一份
+};
+
+#endif // MOTIONPLANNER_H
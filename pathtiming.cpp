@@ -0,0 +1,276 @@
+#include "pathtiming.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double INFINITE = std::numeric_limits<double>::infinity();
+const double EPSILON = 1e-12;
+
+// 一条约束 lo <= alpha * u + beta * x <= hi
+struct Row {
+    double alpha;
+    double beta;
+    double lo;
+    double hi;
+};
+
+double tolerance(double x)
+{
+    return 1e-9 * (1.0 + std::fabs(x));
+}
+
+// 在 x 的范围 [*low, *high] 内求存在可行 u 的 x 区间：u 的每个下界 p + q x 都不能超过每个上界 r + t x，
+// 两两相减是 x 的一次不等式
+bool feasibleRange(const std::vector<Row> &rows, double *low, double *high)
+{
+    double xLow = *low;
+    double xHigh = *high;
+    std::vector<std::pair<double, double>> lowers;
+    std::vector<std::pair<double, double>> uppers;
+    lowers.reserve(rows.size());
+    uppers.reserve(rows.size());
+    for (const Row &row : rows) {
+        if (std::fabs(row.alpha) < EPSILON) {
+            if (row.beta > EPSILON) {
+                xLow = std::max(xLow, row.lo / row.beta);
+                xHigh = std::min(xHigh, row.hi / row.beta);
+            } else if (row.beta < -EPSILON) {
+                xLow = std::max(xLow, row.hi / row.beta);
+                xHigh = std::min(xHigh, row.lo / row.beta);
+            } else if (row.lo > tolerance(row.lo) || row.hi < -tolerance(row.hi)) {
+                return false;
+            }
+            continue;
+        }
+        const double slope = -row.beta / row.alpha;
+        if (row.alpha > 0.0) {
+            lowers.emplace_back(row.lo / row.alpha, slope);
+            uppers.emplace_back(row.hi / row.alpha, slope);
+        } else {
+            lowers.emplace_back(row.hi / row.alpha, slope);
+            uppers.emplace_back(row.lo / row.alpha, slope);
+        }
+    }
+    for (const auto &lower : lowers) {
+        for (const auto &upper : uppers) {
+            const double d = lower.second - upper.second;
+            const double e = upper.first - lower.first;
+            if (d > EPSILON) {
+                xHigh = std::min(xHigh, e / d);
+            } else if (d < -EPSILON) {
+                xLow = std::max(xLow, e / d);
+            } else if (e < -tolerance(e)) {
+                return false;
+            }
+        }
+    }
+    if (xLow > xHigh + tolerance(xHigh)) {
+        return false;
+    }
+    *low = xLow;
+    *high = std::max(xLow, xHigh);
+    return true;
+}
+
+// x 固定时 u 的最大值（没有上界时为无穷）
+double maximumControl(const std::vector<Row> &rows, double x)
+{
+    double u = INFINITE;
+    for (const Row &row : rows) {
+        if (row.alpha > EPSILON) {
+            u = std::min(u, (row.hi - row.beta * x) / row.alpha);
+        } else if (row.alpha < -EPSILON) {
+            u = std::min(u, (row.lo - row.beta * x) / row.alpha);
+        }
+    }
+    return u;
+}
+
+} // namespace
+
+PathTiming::PathTiming()
+    : m_jointCount(0)
+    , m_rate(0.0)
+    , m_sampleCount(0)
+{
+}
+
+void PathTiming::clear()
+{
+    *this = PathTiming();
+}
+
+double PathTiming::pathVelocity(int gridPoint) const
+{
+    return std::sqrt(std::max(0.0, m_x[size_t(gridPoint)]));
+}
+
+bool PathTiming::compute(const KeyframeSequence &sequence, const MotionLimits *limits,
+                         const PathTorqueConstraint *torque, const PathTimingOptions &options,
+                         std::string *errorMessage)
+{
+    // 拷贝一份序列，渲染时仍可求值
+    int segment = 0;
+    const PathFunction path = [sequence, segment](double s, double *q, double *dq, double *ddq) mutable {
+        sequence.evaluate(s, q, dq, ddq, &segment);
+    };
+    return compute(path, sequence.duration(), sequence.jointCount(), limits, torque, options, errorMessage);
+}
+
+bool PathTiming::compute(const PathFunction &path, double length, int jointCount, const MotionLimits *limits,
+                         const PathTorqueConstraint *torque, const PathTimingOptions &options,
+                         std::string *errorMessage)
+{
+    auto fail = [&](const std::string &message) {
+        clear();
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    clear();
+    if (!path || jointCount <= 0 || !(length > 0.0) || options.gridPoints < 2) {
+        return fail("路径无效");
+    }
+    if (!(options.velocityScale > 0.0 && options.velocityScale <= 1.0)
+        || !(options.accelerationScale > 0.0 && options.accelerationScale <= 1.0)) {
+        return fail("速度或加速度比例无效");
+    }
+    for (int j = 0; j < jointCount; ++j) {
+        if (!(limits[j].maxVelocity > 0.0) || !(limits[j].maxAcceleration > 0.0)) {
+            return fail("关节运动限制无效");
+        }
+    }
+    const bool useTorque = torque && !torque->isEmpty();
+    if (useTorque && torque->limits.size() < size_t(jointCount)) {
+        return fail("力矩限制的关节数不足");
+    }
+
+    // 网格点上的路径导数和力矩系数
+    const size_t n = size_t(options.gridPoints);
+    const size_t joints = size_t(jointCount);
+    const double delta = length / double(n - 1);
+    std::vector<double> q(n * joints);
+    std::vector<double> dq(n * joints);
+    std::vector<double> ddq(n * joints);
+    std::vector<double> a;
+    std::vector<double> b;
+    std::vector<double> c;
+    if (useTorque) {
+        a.resize(n * joints);
+        b.resize(n * joints);
+        c.resize(n * joints);
+    }
+    m_grid.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        m_grid[i] = i + 1 < n ? double(i) * delta : length;
+        path(m_grid[i], &q[i * joints], &dq[i * joints], &ddq[i * joints]);
+        if (useTorque) {
+            torque->coefficients(&q[i * joints], &dq[i * joints], &ddq[i * joints], &a[i * joints], &b[i * joints],
+                                 &c[i * joints]);
+        }
+    }
+
+    // 第 i 点的约束：本点的加速度、力矩，以及按 x + 2Δu 插值到下一点的同样约束
+    std::vector<double> xMaximum(n, INFINITE);
+    auto stageRows = [&](size_t i, std::vector<Row> &rows) {
+        rows.clear();
+        for (size_t next = i; next <= std::min(i + 1, n - 1); ++next) {
+            const double shift = next == i ? 0.0 : 2.0 * delta;
+            for (size_t j = 0; j < joints; ++j) {
+                const size_t k = next * joints + j;
+                const double acceleration = limits[j].maxAcceleration * options.accelerationScale;
+                rows.push_back(Row{ dq[k] + shift * ddq[k], ddq[k], -acceleration, acceleration });
+                if (useTorque && torque->limits[j] > 0.0) {
+                    rows.push_back(Row{ a[k] + shift * b[k], b[k], -torque->limits[j] - c[k], torque->limits[j] - c[k] });
+                }
+            }
+        }
+    };
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < joints; ++j) {
+            const double slope = std::fabs(dq[i * joints + j]);
+            if (slope > EPSILON) {
+                const double ratio = limits[j].maxVelocity * options.velocityScale / slope;
+                xMaximum[i] = std::min(xMaximum[i], ratio * ratio);
+            }
+        }
+    }
+
+    // 反向：可控集，终点静止
+    std::vector<double> controllableLow(n, 0.0);
+    std::vector<double> controllableHigh(n, 0.0);
+    std::vector<Row> rows;
+    for (size_t i = n - 1; i-- > 0;) {
+        stageRows(i, rows);
+        rows.push_back(Row{ 2.0 * delta, 1.0, controllableLow[i + 1], controllableHigh[i + 1] });
+        double low = 0.0;
+        double high = xMaximum[i];
+        if (!feasibleRange(rows, &low, &high)) {
+            return fail("路径在参数 " + std::to_string(m_grid[i]) + " 处无法满足关节限制");
+        }
+        controllableLow[i] = low;
+        controllableHigh[i] = high;
+    }
+    if (controllableLow[0] > tolerance(0.0)) {
+        return fail("路径无法从静止开始");
+    }
+
+    // 正向：每段取可控集允许的最大 s̈
+    m_x.assign(n, 0.0);
+    m_u.assign(n - 1, 0.0);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        stageRows(i, rows);
+        const double u = maximumControl(rows, m_x[i]);
+        double next = std::isfinite(u) ? m_x[i] + 2.0 * delta * u : controllableHigh[i + 1];
+        next = std::min(std::max(next, controllableLow[i + 1]), controllableHigh[i + 1]);
+        m_x[i + 1] = std::max(0.0, next);
+        m_u[i] = (m_x[i + 1] - m_x[i]) / (2.0 * delta);
+    }
+
+    m_times.assign(n, 0.0);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        const double speed = std::sqrt(m_x[i]) + std::sqrt(m_x[i + 1]);
+        if (!(speed > 0.0)) {
+            return fail("路径在参数 " + std::to_string(m_grid[i]) + " 处速度为零，无法继续");
+        }
+        m_times[i + 1] = m_times[i] + 2.0 * delta / speed;
+    }
+    m_path = path;
+    m_jointCount = jointCount;
+    return true;
+}
+
+double PathTiming::pathParameter(double t) const
+{
+    if (m_times.empty()) {
+        return 0.0;
+    }
+    if (t >= m_times.back()) {
+        return m_grid.back();
+    }
+    if (t <= 0.0) {
+        return 0.0;
+    }
+    const size_t i = size_t(std::upper_bound(m_times.begin(), m_times.end(), t) - m_times.begin()) - 1;
+    const double tau = t - m_times[i];
+    const double s = m_grid[i] + std::sqrt(m_x[i]) * tau + 0.5 * m_u[i] * tau * tau;
+    return std::min(std::max(s, m_grid[i]), m_grid[i + 1]);
+}
+
+void PathTiming::render(double rateHz)
+{
+    m_rate = rateHz;
+    m_sampleCount = static_cast<int>(std::ceil(duration() * rateHz)) + 1;
+    m_setpoints.resize(size_t(m_sampleCount) * size_t(m_jointCount));
+
+    std::vector<double> dq(static_cast<size_t>(m_jointCount));
+    std::vector<double> ddq(static_cast<size_t>(m_jointCount));
+    for (int sample = 0; sample < m_sampleCount; ++sample) {
+        const double s = sample + 1 < m_sampleCount ? pathParameter(sample / rateHz) : m_grid.back();
+        m_path(s, m_setpoints.data() + size_t(sample) * m_jointCount, dq.data(), ddq.data());
+    }
+}
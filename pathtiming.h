@@ -0,0 +1,78 @@
+#ifndef PATHTIMING_H
+#define PATHTIMING_H
+
+#include "keyframesequence.h"
+#include "trajectory.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+// 力矩约束：沿路径把关节力矩写成 τ = a·s̈ + b·ṡ² + c（由逆动力学对 q(s)、q'(s)、q''(s) 求出），
+// 即 a = M(q)q'，b = M(q)q'' + C(q, q')q'，c = g(q)
+struct PathTorqueConstraint {
+    std::function<void(const double *q, const double *dq, const double *ddq, double *a, double *b, double *c)> coefficients;
+    std::vector<double> limits;         // 按关节，<= 0 表示该关节不限力矩
+
+    bool isEmpty() const { return !coefficients; }
+};
+
+struct PathTimingOptions {
+    int gridPoints;                 // 路径参数等分点数
+    double velocityScale;           // 关节速度、加速度限制的使用比例 (0, 1]
+    double accelerationScale;
+
+    PathTimingOptions() : gridPoints(400), velocityScale(1.0), accelerationScale(1.0) {}
+};
+
+// 时间最优路径参数化（TOPP-RA，可达性分析）
+// 几何路径 q(s) 给定后求最快的 s(t)：以 x = ṡ²、u = s̈ 为变量，各关节速度、加速度（及可选的力矩）
+// 约束在每个网格点上都是 (u, x) 的线性不等式。先从终点（静止）向前逐点求可控集 [xmin, xmax]，
+// 再从起点（静止）逐点取可控集允许的最大 u，结果即为时间最优。每个网格点只需解一个两变量线性规划，
+// 按约束两两求交线在 x 轴上的范围，不需要通用 LP 求解器。
+// 约束同时在段起点和按 x + 2Δu 插值的段终点检查（一阶插值离散），网格较粗时也不会明显越限。
+// 加加速度不受约束：网格段内 s̈ 为常数，关节加速度在网格点处可能跳变。
+class PathTiming
+{
+public:
+    // 路径函数：给出 s 处的位置、一阶和二阶导数（长度均为 jointCount）
+    typedef std::function<void(double s, double *q, double *dq, double *ddq)> PathFunction;
+
+    PathTiming();
+
+    // 路径参数范围为 [0, length]，起止均为静止；limits 为各关节限制，torque 可为空
+    bool compute(const PathFunction &path, double length, int jointCount, const MotionLimits *limits,
+                 const PathTorqueConstraint *torque, const PathTimingOptions &options,
+                 std::string *errorMessage = nullptr);
+    // 以关键帧序列的样条为几何路径（序列原有的时间只作为路径参数）
+    bool compute(const KeyframeSequence &sequence, const MotionLimits *limits, const PathTorqueConstraint *torque,
+                 const PathTimingOptions &options, std::string *errorMessage = nullptr);
+    void clear();
+
+    bool isEmpty() const { return m_times.empty(); }
+    int jointCount() const { return m_jointCount; }
+    double duration() const { return m_times.empty() ? 0.0 : m_times.back(); }
+    int gridPoints() const { return int(m_grid.size()); }
+    double pathVelocity(int gridPoint) const;       // ṡ
+
+    // 设定点缓冲（行优先：第 i 个采样点的全部关节），最后一行为终点；与 JointTrajectory 相同的布局
+    void render(double rateHz);
+    double rate() const { return m_rate; }
+    int sampleCount() const { return m_sampleCount; }
+    const double *setpoints(int sample) const { return m_setpoints.data() + size_t(sample) * m_jointCount; }
+
+    // t 时刻的路径参数
+    double pathParameter(double t) const;
+
+private:
+    PathFunction m_path;
+    int m_jointCount;
+    std::vector<double> m_grid;     // s_i
+    std::vector<double> m_x;        // ṡ² at s_i
+    std::vector<double> m_u;        // 段 i 内的 s̈
+    std::vector<double> m_times;    // 到达 s_i 的时刻
+    double m_rate;
+    int m_sampleCount;
+    std::vector<double> m_setpoints;
+};
+
+#endif // PATHTIMING_H
@@ -0,0 +1,495 @@
+#include "reachabilitymap.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+const size_t SAMPLE_BLOCK = 1024;       // 每块的构型数，块内用批量正运动学
+const int MAX_CHAIN_JOINTS = 16;
+
+uint64_t hashBytes(const void *data, size_t size, uint64_t hash)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 按块号分配给 threads 个线程，function(worker, block)
+void parallelBlocks(int threads, size_t blocks, const std::function<void(int, size_t)> &function)
+{
+    std::atomic<size_t> next(0);
+    auto work = [&](int worker) {
+        for (size_t block = next++; block < blocks; block = next++) {
+            function(worker, block);
+        }
+    };
+    if (threads <= 1) {
+        work(0);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < threads; ++worker) {
+        workers.emplace_back(work, worker);
+    }
+    for (std::thread &thread : workers) {
+        thread.join();
+    }
+}
+
+// 每个线程的暂存
+struct SampleScratch {
+    std::vector<double> q;          // q[joint * SAMPLE_BLOCK + i]
+    std::vector<double> single;     // 一组构型，按全局关节ID
+    std::vector<double> left;       // 批量正运动学输出
+    std::vector<double> right;
+    double lower[3];                // 第一遍：本线程样本的包围盒
+    double upper[3];
+};
+
+// 单位球面上近似均匀分布的接近方向（斐波那契点集）
+struct DirectionBins {
+    double axis[ReachabilityMap::DIRECTION_COUNT][3];
+
+    DirectionBins()
+    {
+        const int count = ReachabilityMap::DIRECTION_COUNT;
+        const double golden = PI * (3.0 - std::sqrt(5.0));
+        for (int k = 0; k < count; ++k) {
+            const double z = 1.0 - (2.0 * k + 1.0) / count;
+            const double radius = std::sqrt(1.0 - z * z);
+            axis[k][0] = radius * std::cos(golden * k);
+            axis[k][1] = radius * std::sin(golden * k);
+            axis[k][2] = z;
+        }
+    }
+
+    int nearest(double x, double y, double z) const
+    {
+        int best = 0;
+        double bestDot = -2.0;
+        for (int k = 0; k < ReachabilityMap::DIRECTION_COUNT; ++k) {
+            const double dot = axis[k][0] * x + axis[k][1] * y + axis[k][2] * z;
+            if (dot > bestDot) {
+                bestDot = dot;
+                best = k;
+            }
+        }
+        return best;
+    }
+};
+
+const DirectionBins &directionBins()
+{
+    static const DirectionBins bins;
+    return bins;
+}
+
+// sqrt(det(J J^T))，J 为 6 x n（行优先，已换算到弧度/米）；奇异时为 0
+double manipulability(const double *jacobian, int n)
+{
+    double a[36];
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = 0.0;
+            for (int c = 0; c < n; ++c) {
+                sum += jacobian[i * n + c] * jacobian[j * n + c];
+            }
+            a[i * 6 + j] = sum;
+        }
+    }
+    // Cholesky 对角元之积
+    double product = 1.0;
+    for (int j = 0; j < 6; ++j) {
+        double diagonal = a[j * 6 + j];
+        for (int k = 0; k < j; ++k) {
+            diagonal -= a[j * 6 + k] * a[j * 6 + k];
+        }
+        if (!(diagonal > 1e-18)) {
+            return 0.0;
+        }
+        const double l = std::sqrt(diagonal);
+        a[j * 6 + j] = l;
+        for (int i = j + 1; i < 6; ++i) {
+            double sum = a[i * 6 + j];
+            for (int k = 0; k < j; ++k) {
+                sum -= a[i * 6 + k] * a[j * 6 + k];
+            }
+            a[i * 6 + j] = sum / l;
+        }
+        product *= l;
+    }
+    return product;
+}
+
+// 非负浮点数的位模式与数值同序，按无符号整数取最大值
+void atomicMax(std::atomic<uint32_t> &target, float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t current = target.load(std::memory_order_relaxed);
+    while (bits > current && !target.compare_exchange_weak(current, bits, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+ReachabilityMap::ReachabilityMap()
+    : m_external(nullptr)
+    , m_size(0)
+    , m_cellCount(0)
+{
+}
+
+void ReachabilityMap::clear()
+{
+    *this = ReachabilityMap();
+}
+
+uint64_t ReachabilityMap::modelStamp(const KinematicModel &model, const double *minLimits, const double *maxLimits)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (int id = 0; id < KinematicModel::CHAIN_COUNT; ++id) {
+        const KinematicChain &chain = model.chain(KinematicModel::ChainId(id));
+        for (const KinematicJoint &joint : chain.joints) {
+            const uint8_t flags = uint8_t((joint.prismatic ? 1 : 0) | (joint.hasOrigin ? 2 : 0));
+            hash = hashBytes(&joint.jointId, sizeof(joint.jointId), hash);
+            hash = hashBytes(&flags, sizeof(flags), hash);
+            hash = hashBytes(&joint.scale, sizeof(joint.scale), hash);
+            if (joint.hasOrigin) {
+                hash = hashBytes(joint.origin.r, sizeof(joint.origin.r), hash);
+                hash = hashBytes(joint.origin.p, sizeof(joint.origin.p), hash);
+            }
+            const double dh[4] = { joint.dh.a, joint.dh.alpha, joint.dh.d, joint.dh.theta };
+            hash = hashBytes(dh, sizeof(dh), hash);
+            hash = hashBytes(&minLimits[joint.jointId], sizeof(double), hash);
+            hash = hashBytes(&maxLimits[joint.jointId], sizeof(double), hash);
+        }
+        hash = hashBytes(chain.tool.r, sizeof(chain.tool.r), hash);
+        hash = hashBytes(chain.tool.p, sizeof(chain.tool.p), hash);
+    }
+    return hash;
+}
+
+bool ReachabilityMap::build(const KinematicModel &model, const double *minLimits, const double *maxLimits,
+                            const double *fixedPose, const ReachabilityOptions &options, std::string *errorMessage)
+{
+    auto fail = [errorMessage](const std::string &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    const KinematicModel::ChainId arms[2] = { KinematicModel::LeftArm, KinematicModel::RightArm };
+    const std::vector<KinematicJoint> &trunk = model.chain(KinematicModel::Trunk).joints;
+    if (model.chain(arms[0]).joints.empty() || model.chain(arms[1]).joints.empty()) {
+        return fail("机器人描述中没有两臂的运动学参数");
+    }
+    if (model.chain(arms[0]).joints.size() > size_t(MAX_CHAIN_JOINTS)
+        || model.chain(arms[1]).joints.size() > size_t(MAX_CHAIN_JOINTS)
+        || trunk.size() > size_t(ReachabilityHeader::MAX_TRUNK_JOINTS)) {
+        return fail("运动链关节过多");
+    }
+    if (options.sampleCount == 0 || !(options.resolution > 0.0)) {
+        return fail("采样数或分辨率无效");
+    }
+    const int threads = options.threads > 0 ? options.threads
+                                            : std::max(1, int(std::thread::hardware_concurrency()));
+
+    // 采样的关节：两臂，以及可选的躯干；其余关节取 fixedPose（限制在限位内）
+    const int jointCount = model.jointCount();
+    std::vector<double> fixed(static_cast<size_t>(jointCount));
+    for (int j = 0; j < jointCount; ++j) {
+        fixed[size_t(j)] = std::min(std::max(fixedPose[j], minLimits[j]), maxLimits[j]);
+    }
+    std::vector<int> sampled;
+    for (KinematicModel::ChainId id : { KinematicModel::Trunk, arms[0], arms[1] }) {
+        if (id == KinematicModel::Trunk && !options.sampleTrunk) {
+            continue;
+        }
+        for (const KinematicJoint &joint : model.chain(id).joints) {
+            sampled.push_back(joint.jointId);
+        }
+    }
+
+    // 第 block 块的构型：q[joint * SAMPLE_BLOCK + i]，随机数序列只取决于种子和块号
+    const size_t blocks = (options.sampleCount + SAMPLE_BLOCK - 1) / SAMPLE_BLOCK;
+    auto generate = [&](size_t block, double *q) {
+        const size_t count = std::min(SAMPLE_BLOCK, options.sampleCount - block * SAMPLE_BLOCK);
+        std::seed_seq sequence{ options.seed, uint32_t(block), uint32_t(uint64_t(block) >> 32) };
+        std::mt19937 random(sequence);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        for (int j = 0; j < jointCount; ++j) {
+            std::fill(q + size_t(j) * SAMPLE_BLOCK, q + size_t(j + 1) * SAMPLE_BLOCK, fixed[size_t(j)]);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            for (int id : sampled) {
+                q[size_t(id) * SAMPLE_BLOCK + i] = minLimits[id] + (maxLimits[id] - minLimits[id]) * unit(random);
+            }
+        }
+        return count;
+    };
+
+    std::vector<SampleScratch> scratch(static_cast<size_t>(threads));
+    for (SampleScratch &buffers : scratch) {
+        buffers.q.resize(size_t(jointCount) * SAMPLE_BLOCK);
+        buffers.single.resize(size_t(jointCount));
+        buffers.left.resize(size_t(KinematicModel::POSE_COMPONENTS) * SAMPLE_BLOCK);
+        buffers.right.resize(size_t(KinematicModel::POSE_COMPONENTS) * SAMPLE_BLOCK);
+        std::fill(buffers.lower, buffers.lower + 3, std::numeric_limits<double>::infinity());
+        std::fill(buffers.upper, buffers.upper + 3, -std::numeric_limits<double>::infinity());
+    }
+
+    // 第一遍：批量正运动学求两臂末端的包围盒
+    parallelBlocks(threads, blocks, [&](int worker, size_t block) {
+        SampleScratch &buffers = scratch[size_t(worker)];
+        const size_t count = generate(block, buffers.q.data());
+        model.forwardBatch(buffers.q.data(), SAMPLE_BLOCK, count, buffers.left.data(), buffers.right.data());
+        for (const std::vector<double> *poses : { &buffers.left, &buffers.right }) {
+            for (int axis = 0; axis < 3; ++axis) {
+                const double *p = poses->data() + size_t(9 + axis) * SAMPLE_BLOCK;
+                const auto range = std::minmax_element(p, p + count);
+                buffers.lower[axis] = std::min(buffers.lower[axis], *range.first);
+                buffers.upper[axis] = std::max(buffers.upper[axis], *range.second);
+            }
+        }
+    });
+
+    // 网格：包围盒按分辨率对齐
+    ReachabilityHeader h;
+    std::memset(&h, 0, sizeof(h));
+    h.magic = ReachabilityHeader::MAGIC;
+    h.version = ReachabilityHeader::VERSION;
+    h.trunkSampled = options.sampleTrunk ? 1 : 0;
+    h.resolution = float(options.resolution);
+    size_t cellCount = 1;
+    for (int axis = 0; axis < 3; ++axis) {
+        double low = std::numeric_limits<double>::infinity();
+        double high = -std::numeric_limits<double>::infinity();
+        for (const SampleScratch &buffers : scratch) {
+            low = std::min(low, buffers.lower[axis]);
+            high = std::max(high, buffers.upper[axis]);
+        }
+        const double origin = std::floor(low / options.resolution) * options.resolution;
+        const double cells = std::floor((high - origin) / options.resolution) + 1.0;
+        if (!std::isfinite(cells) || cells > double(MAX_CELLS)) {
+            return fail("可达性网格过大，请增大分辨率");
+        }
+        h.origin[axis] = float(origin);
+        h.dimensions[axis] = uint32_t(cells);
+        cellCount *= size_t(cells);
+    }
+    if (cellCount > MAX_CELLS) {
+        return fail("可达性网格过大，请增大分辨率");
+    }
+    h.sampleCount = options.sampleCount;
+    h.modelStamp = modelStamp(model, minLimits, maxLimits);
+    h.seed = options.seed;
+    h.trunkCount = uint16_t(trunk.size());
+    for (size_t k = 0; k < trunk.size(); ++k) {
+        h.trunkPose[k] = float(fixed[size_t(trunk[k].jointId)]);
+    }
+
+    // 第二遍：逐个构型求两臂雅可比（末端位姿 + 可操作度），原子累计到体素
+    std::vector<std::atomic<uint32_t>> samples(2 * cellCount);
+    std::vector<std::atomic<uint32_t>> directions(2 * cellCount);
+    std::vector<std::atomic<uint32_t>> best(2 * cellCount);
+    const double origin[3] = { h.origin[0], h.origin[1], h.origin[2] };
+    const double inverseResolution = 1.0 / options.resolution;
+    const DirectionBins &bins = directionBins();
+    parallelBlocks(threads, blocks, [&](int worker, size_t block) {
+        std::vector<double> &q = scratch[size_t(worker)].q;
+        std::vector<double> &single = scratch[size_t(worker)].single;
+        const size_t count = generate(block, q.data());
+        double jacobian[6 * MAX_CHAIN_JOINTS];
+        for (size_t i = 0; i < count; ++i) {
+            for (int j = 0; j < jointCount; ++j) {
+                single[size_t(j)] = q[size_t(j) * SAMPLE_BLOCK + i];
+            }
+            for (int arm = 0; arm < 2; ++arm) {
+                const std::vector<KinematicJoint> &joints = model.chain(arms[arm]).joints;
+                const int n = int(joints.size());
+                const Transform tool = model.jacobian(arms[arm], single.data(), jacobian);
+                size_t index = 0;
+                bool inside = true;
+                for (int axis = 2; axis >= 0; --axis) {
+                    const double cell = std::floor((tool.p[axis] - origin[axis]) * inverseResolution);
+                    inside = inside && cell >= 0.0 && cell < double(h.dimensions[axis]);
+                    index = index * h.dimensions[axis] + (inside ? size_t(cell) : 0);
+                }
+                if (!inside) {
+                    continue;   // 批量与标量路径的舍入差落在网格边界外
+                }
+                for (int c = 0; c < n; ++c) {
+                    const double inverseScale = 1.0 / joints[size_t(c)].scale;
+                    for (int r = 0; r < 6; ++r) {
+                        jacobian[r * n + c] *= inverseScale;
+                    }
+                }
+                const size_t slot = size_t(arm) * cellCount + index;
+                const int direction = bins.nearest(tool.r[2], tool.r[5], tool.r[8]);
+                samples[slot].fetch_add(1, std::memory_order_relaxed);
+                directions[slot].fetch_or(uint32_t(1) << direction, std::memory_order_relaxed);
+                atomicMax(best[slot], float(manipulability(jacobian, n)));
+            }
+        }
+    });
+
+    std::vector<uint8_t> storage(size_t(ReachabilityHeader::SIZE) + 2 * cellCount * sizeof(ReachabilityCell));
+    std::memcpy(storage.data(), &h, sizeof(h));
+    ReachabilityCell *out = reinterpret_cast<ReachabilityCell *>(storage.data() + ReachabilityHeader::SIZE);
+    for (size_t k = 0; k < 2 * cellCount; ++k) {
+        out[k].samples = samples[k].load(std::memory_order_relaxed);
+        out[k].directions = directions[k].load(std::memory_order_relaxed);
+        const uint32_t bits = best[k].load(std::memory_order_relaxed);
+        std::memcpy(&out[k].manipulability, &bits, sizeof(bits));
+    }
+
+    clear();
+    m_storage.swap(storage);
+    m_size = m_storage.size();
+    return layout(errorMessage);
+}
+
+bool ReachabilityMap::save(const std::string &fileName, std::string *errorMessage) const
+{
+    // 先写临时文件再改名，中途失败不会留下半张图
+    const std::string temporary = fileName + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        if (errorMessage) {
+            *errorMessage = "无法创建可达性图文件 " + fileName;
+        }
+        return false;
+    }
+    const bool written = m_size == 0 || std::fwrite(image(), 1, m_size, file) == m_size;
+    const bool closed = std::fclose(file) == 0;
+    std::remove(fileName.c_str());
+    if (!written || !closed || std::rename(temporary.c_str(), fileName.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        if (errorMessage) {
+            *errorMessage = "写入可达性图文件失败 " + fileName;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool ReachabilityMap::attach(const void *data, size_t size, std::string *errorMessage)
+{
+    clear();
+    m_external = static_cast<const uint8_t *>(data);
+    m_size = size;
+    if (!layout(errorMessage)) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool ReachabilityMap::layout(std::string *errorMessage)
+{
+    auto fail = [errorMessage](const std::string &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    if (!image() || m_size < size_t(ReachabilityHeader::SIZE)) {
+        return fail("可达性图文件过短");
+    }
+    const ReachabilityHeader &h = header();
+    if (h.magic != ReachabilityHeader::MAGIC || h.version != ReachabilityHeader::VERSION) {
+        return fail("不是可达性图文件或版本不支持");
+    }
+    if (!(h.resolution > 0.0f) || h.trunkCount > ReachabilityHeader::MAX_TRUNK_JOINTS) {
+        return fail("可达性图文件头无效");
+    }
+    // 体素直接按下标访问，载入时只需核对长度
+    size_t cellCount = 1;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (h.dimensions[axis] == 0 || h.dimensions[axis] > MAX_CELLS || !std::isfinite(h.origin[axis])) {
+            return fail("可达性图文件头无效");
+        }
+        cellCount *= h.dimensions[axis];
+        if (cellCount > MAX_CELLS) {
+            return fail("可达性图文件头无效");
+        }
+    }
+    if (m_size != size_t(ReachabilityHeader::SIZE) + 2 * cellCount * sizeof(ReachabilityCell)) {
+        return fail("可达性图文件长度与文件头不符");
+    }
+    m_cellCount = cellCount;
+    return true;
+}
+
+const ReachabilityCell *ReachabilityMap::cell(int arm, const double *point) const
+{
+    if (m_size == 0 || arm < 0 || arm > 1) {
+        return nullptr;
+    }
+    const ReachabilityHeader &h = header();
+    size_t index = 0;
+    for (int axis = 2; axis >= 0; --axis) {
+        const double cell = std::floor((point[axis] - h.origin[axis]) / h.resolution);
+        if (!(cell >= 0.0 && cell < double(h.dimensions[axis]))) {
+            return nullptr;
+        }
+        index = index * h.dimensions[axis] + size_t(cell);
+    }
+    return &cells()[size_t(arm) * m_cellCount + index];
+}
+
+void ReachabilityMap::cellCenter(size_t index, double *point) const
+{
+    const ReachabilityHeader &h = header();
+    const size_t x = index % h.dimensions[0];
+    const size_t y = index / h.dimensions[0] % h.dimensions[1];
+    const size_t z = index / h.dimensions[0] / h.dimensions[1];
+    point[0] = h.origin[0] + (double(x) + 0.5) * h.resolution;
+    point[1] = h.origin[1] + (double(y) + 0.5) * h.resolution;
+    point[2] = h.origin[2] + (double(z) + 0.5) * h.resolution;
+}
+
+double ReachabilityMap::coverage(const ReachabilityCell &cell)
+{
+    uint32_t bits = cell.directions;
+    int count = 0;
+    for (; bits; bits &= bits - 1) {
+        ++count;
+    }
+    return double(count) / DIRECTION_COUNT;
+}
+
+double ReachabilityMap::reachability(int arm, const double *point) const
+{
+    const ReachabilityCell *found = cell(arm, point);
+    return found ? coverage(*found) : 0.0;
+}
+
+ReachabilitySummary ReachabilityMap::summary(int arm) const
+{
+    ReachabilitySummary result;
+    for (size_t k = 0; k < m_cellCount; ++k) {
+        const ReachabilityCell &c = cell(arm, k);
+        if (c.samples == 0) {
+            continue;
+        }
+        ++result.reachableCells;
+        result.dexterousCells += coverage(c) >= 0.5 ? 1 : 0;
+        result.maxManipulability = std::max(result.maxManipulability, double(c.manipulability));
+    }
+    return result;
+}
@@ -0,0 +1,114 @@
+#ifndef REACHABILITYMAP_H
+#define REACHABILITYMAP_H
+
+#include "kinematics.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#pragma pack(push, 1)
+struct ReachabilityHeader {
+    static const uint32_t MAGIC = 0x50414D52;  // "RMAP"
+    static const uint16_t VERSION = 1;
+    static const int SIZE = 128;
+    static const int MAX_TRUNK_JOINTS = 8;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t trunkSampled;      // 1：躯干关节在行程内随机采样；0：躯干固定为 trunkPose
+    uint32_t dimensions[3];     // 网格 x、y、z 方向的体素数
+    float resolution;           // 体素边长（米）
+    float origin[3];            // 网格最小角（米，机器人基坐标系）
+    uint64_t sampleCount;       // 构建时的采样构型数
+    uint64_t modelStamp;        // 构建时的运动学参数和关节限位（见 ReachabilityMap::modelStamp）
+    uint32_t seed;
+    uint16_t trunkCount;        // 躯干关节数
+    uint16_t reserved0;
+    float trunkPose[MAX_TRUNK_JOINTS];  // 躯干固定时各关节的取值（关节单位）
+    uint8_t reserved[36];
+};
+
+// 一个体素内落入的末端样本统计
+struct ReachabilityCell {
+    uint32_t samples;           // 末端落在该体素内的采样构型数
+    uint32_t directions;        // 出现过的接近方向（工具 z 轴，按 DIRECTION_COUNT 个方向分桶）的位掩码
+    float manipulability;       // 样本中最大的 sqrt(det(J J^T))（手臂关节，弧度/米）
+};
+#pragma pack(pop)
+
+struct ReachabilityOptions {
+    size_t sampleCount;         // 采样构型数，两臂共用
+    double resolution;          // 体素边长（米）
+    uint32_t seed;
+    bool sampleTrunk;           // 躯干关节也在行程内采样；否则取 fixedPose 的值
+    int threads;                // 0 为硬件线程数
+
+    ReachabilityOptions() : sampleCount(8000000), resolution(0.04), seed(1), sampleTrunk(true), threads(0) {}
+};
+
+// 单臂在整张图上的统计
+struct ReachabilitySummary {
+    size_t reachableCells;      // 有样本的体素数
+    size_t dexterousCells;      // 接近方向覆盖一半以上的体素数
+    double maxManipulability;
+
+    ReachabilitySummary() : reachableCells(0), dexterousCells(0), maxManipulability(0.0) {}
+};
+
+// 两臂末端的体素化可达性/可操作度图，用于工位布置、底座摆放和判断目标位置能否到达
+//
+// 构建：在关节限位内均匀采样构型，按块并行（每块的随机数种子只取决于块号，结果与线程数无关）。
+// 第一遍用批量正运动学求两臂末端的包围盒确定网格；第二遍逐个构型求两臂雅可比，
+// 末端位置所在体素累计样本数、接近方向和最大可操作度（原子操作合并）。
+// 每个体素的可达性指标为接近方向的覆盖比例。
+// 映像文件 = 文件头 + ReachabilityCell[2][z][y][x]（左臂在前），可直接映射到内存使用，不需解析。
+class ReachabilityMap
+{
+public:
+    static const int DIRECTION_COUNT = 32;
+    static const size_t MAX_CELLS = size_t(1) << 26;   // 单臂体素数上限
+
+    ReachabilityMap();
+
+    // minLimits/maxLimits/fixedPose 按全局关节ID索引，单位与关节一致
+    bool build(const KinematicModel &model, const double *minLimits, const double *maxLimits,
+               const double *fixedPose, const ReachabilityOptions &options, std::string *errorMessage = nullptr);
+    bool save(const std::string &fileName, std::string *errorMessage = nullptr) const;
+    // 使用外部内存中的映像（如映射的文件），调用方保证在 clear 或重新 attach 之前有效
+    bool attach(const void *data, size_t size, std::string *errorMessage = nullptr);
+    void clear();
+
+    bool isEmpty() const { return m_size == 0; }
+    const ReachabilityHeader &header() const { return *reinterpret_cast<const ReachabilityHeader *>(image()); }
+    size_t cellCount() const { return m_cellCount; }   // 单臂体素数
+    size_t imageBytes() const { return m_size; }
+    double resolution() const { return m_size ? header().resolution : 0.0; }
+
+    // arm：0 左臂、1 右臂；point 为基坐标系中的位置（米），网格外返回 nullptr
+    const ReachabilityCell *cell(int arm, const double *point) const;
+    const ReachabilityCell &cell(int arm, size_t index) const { return cells()[size_t(arm) * m_cellCount + index]; }
+    void cellCenter(size_t index, double *point) const;
+    // 接近方向的覆盖比例（0 ~ 1），网格外或没有样本为 0
+    double reachability(int arm, const double *point) const;
+    static double coverage(const ReachabilityCell &cell);
+    ReachabilitySummary summary(int arm) const;
+
+    // 运动学参数（各链的关节、安装位姿、DH 参数和工具变换）与链上关节限位的哈希
+    static uint64_t modelStamp(const KinematicModel &model, const double *minLimits, const double *maxLimits);
+
+private:
+    const uint8_t *image() const { return m_external ? m_external : m_storage.data(); }
+    const ReachabilityCell *cells() const
+    {
+        return reinterpret_cast<const ReachabilityCell *>(image() + ReachabilityHeader::SIZE);
+    }
+    bool layout(std::string *errorMessage);
+
+    std::vector<uint8_t> m_storage;     // build 生成的映像
+    const uint8_t *m_external;          // attach 的外部映像
+    size_t m_size;                      // 映像字节数，0 为空图
+    size_t m_cellCount;
+};
+
+#endif // REACHABILITYMAP_H
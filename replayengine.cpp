@@ -0,0 +1,260 @@
+#include "replayengine.h"
+#include "robotcontroller.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cstring>
+
+ReplayEngine::ReplayEngine(RobotController *controller, QObject *parent)
+    : QObject(parent)
+    , m_controller(controller)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_clockOriginMs(0)
+    , m_speed(1.0)
+    , m_nextFrame(0)
+{
+    m_timer = new QTimer(this);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(TIMER_INTERVAL_MS);
+    connect(m_timer, &QTimer::timeout, this, &ReplayEngine::onTimer);
+}
+
+ReplayEngine::~ReplayEngine()
+{
+    close();
+}
+
+bool ReplayEngine::open(const QString &fileName, QString *errorMessage)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = m_file.errorString();
+        }
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+    if (!m_data) {
+        if (errorMessage) {
+            *errorMessage = m_size > 0 ? m_file.errorString() : QString("文件为空");
+        }
+        m_file.close();
+        return false;
+    }
+
+    if (!buildIndex(errorMessage)) {
+        close();
+        return false;
+    }
+
+    qDebug() << "回放文件已加载:" << fileName << m_frames.size() << "帧" << m_keyframes.size() << "个关键帧";
+    return true;
+}
+
+void ReplayEngine::close()
+{
+    pause();
+
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_frames.clear();
+    m_keyframes.clear();
+    m_nextFrame = 0;
+}
+
+bool ReplayEngine::buildIndex(QString *errorMessage)
+{
+    // 逐行建立帧索引，同时累计状态生成关键帧
+    QJsonObject state;
+    qint64 lastTimestamp = 0;
+    qint64 lineStart = 0;
+
+    while (lineStart < m_size) {
+        const uchar *lineEnd = static_cast<const uchar *>(
+            std::memchr(m_data + lineStart, '\n', static_cast<size_t>(m_size - lineStart)));
+        const qint64 end = lineEnd ? lineEnd - m_data : m_size;
+
+        const QByteArray line = QByteArray::fromRawData(
+            reinterpret_cast<const char *>(m_data + lineStart), static_cast<int>(end - lineStart)).trimmed();
+
+        if (!line.isEmpty()) {
+            QJsonParseError parseError;
+            const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+            if (parseError.error == QJsonParseError::NoError && doc.isObject()) {
+                const QJsonObject obj = doc.object();
+
+                // 时间戳必须单调，缺失或回退时按默认帧间隔补齐
+                qint64 timestamp = lastTimestamp + DEFAULT_FRAME_SPACING_MS;
+                if (obj.contains("timestamp")) {
+                    timestamp = qMax(static_cast<qint64>(obj.value("timestamp").toDouble()), lastTimestamp);
+                }
+                lastTimestamp = timestamp;
+
+                Frame frame;
+                frame.timestampMs = timestamp;
+                frame.offset = lineStart;
+                frame.length = static_cast<int>(end - lineStart);
+                m_frames.append(frame);
+
+                for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+                    state.insert(it.key(), it.value());
+                }
+
+                if ((m_frames.size() - 1) % KEYFRAME_INTERVAL == 0) {
+                    m_keyframes.append(QJsonDocument(state).toJson(QJsonDocument::Compact));
+                }
+            }
+        }
+
+        lineStart = end + 1;
+    }
+
+    if (m_frames.isEmpty()) {
+        if (errorMessage) {
+            *errorMessage = "文件中没有可识别的状态数据";
+        }
+        return false;
+    }
+    return true;
+}
+
+void ReplayEngine::play()
+{
+    if (!isOpen() || isPlaying()) {
+        return;
+    }
+
+    if (m_nextFrame >= m_frames.size()) {
+        seek(startTime());
+    }
+
+    restartClock();
+    m_timer->start();
+    emit playbackStateChanged(true);
+}
+
+void ReplayEngine::pause()
+{
+    if (!m_timer->isActive()) {
+        return;
+    }
+
+    m_timer->stop();
+    emit playbackStateChanged(false);
+}
+
+bool ReplayEngine::step()
+{
+    if (!isOpen() || m_nextFrame >= m_frames.size()) {
+        return false;
+    }
+
+    applyFrame(m_nextFrame++);
+    restartClock();
+    emit positionChanged(currentTime());
+    return true;
+}
+
+bool ReplayEngine::seek(qint64 timestampMs)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    // 二分查找最后一个不晚于目标时间的帧
+    auto it = std::upper_bound(m_frames.constBegin(), m_frames.constEnd(), timestampMs,
+        [](qint64 value, const Frame &frame) { return value < frame.timestampMs; });
+    const int target = static_cast<int>(it - m_frames.constBegin()) - 1;
+
+    if (target < 0) {
+        m_nextFrame = 0;
+    } else {
+        // 从最近的关键帧开始重放
+        const int keyframe = target / KEYFRAME_INTERVAL;
+        m_controller->feedReplayData(m_keyframes[keyframe]);
+        for (int i = keyframe * KEYFRAME_INTERVAL + 1; i <= target; ++i) {
+            applyFrame(i);
+        }
+        m_nextFrame = target + 1;
+    }
+
+    restartClock();
+    emit positionChanged(currentTime());
+    return true;
+}
+
+void ReplayEngine::setSpeed(double speed)
+{
+    m_speed = speed <= AS_FAST_AS_POSSIBLE ? AS_FAST_AS_POSSIBLE : qBound(MIN_SPEED, speed, MAX_SPEED);
+    restartClock();
+}
+
+qint64 ReplayEngine::startTime() const
+{
+    return m_frames.isEmpty() ? 0 : m_frames.first().timestampMs;
+}
+
+qint64 ReplayEngine::endTime() const
+{
+    return m_frames.isEmpty() ? 0 : m_frames.last().timestampMs;
+}
+
+qint64 ReplayEngine::currentTime() const
+{
+    return m_nextFrame > 0 ? m_frames[m_nextFrame - 1].timestampMs : startTime();
+}
+
+void ReplayEngine::onTimer()
+{
+    const int firstFrame = m_nextFrame;
+
+    if (m_speed == AS_FAST_AS_POSSIBLE) {
+        // 不限速：每个定时周期占用最多一半时间片，其余留给界面刷新
+        QElapsedTimer budget;
+        budget.start();
+        while (m_nextFrame < m_frames.size() && budget.elapsed() < TIMER_INTERVAL_MS / 2) {
+            applyFrame(m_nextFrame++);
+        }
+    } else {
+        const qint64 target = m_clockOriginMs + static_cast<qint64>(m_clock.elapsed() * m_speed);
+        while (m_nextFrame < m_frames.size() && m_frames[m_nextFrame].timestampMs <= target) {
+            applyFrame(m_nextFrame++);
+        }
+    }
+
+    if (m_nextFrame != firstFrame) {
+        emit positionChanged(currentTime());
+    }
+
+    if (m_nextFrame >= m_frames.size()) {
+        pause();
+        emit finished();
+    }
+}
+
+QByteArray ReplayEngine::frameData(int index) const
+{
+    const Frame &frame = m_frames[index];
+    return QByteArray(reinterpret_cast<const char *>(m_data + frame.offset), frame.length);
+}
+
+void ReplayEngine::applyFrame(int index)
+{
+    m_controller->feedReplayData(frameData(index));
+}
+
+void ReplayEngine::restartClock()
+{
+    m_clockOriginMs = currentTime();
+    m_clock.restart();
+}
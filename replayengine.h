@@ -0,0 +1,90 @@
+#ifndef REPLAYENGINE_H
+#define REPLAYENGINE_H
+
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QVector>
+
+class RobotController;
+
+// 会话回放引擎
+// 读取按行分隔的机器人状态数据（如 robot_simulator.py 发出的 JSON 状态流），
+// 按原始时间间隔或变速送入 RobotController，界面和分析模块的行为与实时连接一致。
+// 打开文件时建立帧索引，并每隔 KEYFRAME_INTERVAL 帧保存一次累计状态关键帧，
+// 跳转时二分查找目标帧，从最近的关键帧开始最多重放 KEYFRAME_INTERVAL 帧。
+class ReplayEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int KEYFRAME_INTERVAL = 256;
+    static const int TIMER_INTERVAL_MS = 10;
+    static const int DEFAULT_FRAME_SPACING_MS = 100;    // 数据中没有时间戳时的帧间隔
+    static constexpr double MIN_SPEED = 0.1;
+    static constexpr double MAX_SPEED = 1000.0;
+    static constexpr double AS_FAST_AS_POSSIBLE = 0.0;
+
+    explicit ReplayEngine(RobotController *controller, QObject *parent = nullptr);
+    ~ReplayEngine();
+
+    // 文件
+    bool open(const QString &fileName, QString *errorMessage = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    QString fileName() const { return m_file.fileName(); }
+
+    // 播放控制
+    void play();
+    void pause();
+    bool step();
+    bool seek(qint64 timestampMs);
+    void setSpeed(double speed);    // 0.1 ~ 1000 倍速，AS_FAST_AS_POSSIBLE 为不限速
+    double speed() const { return m_speed; }
+    bool isPlaying() const { return m_timer->isActive(); }
+
+    // 时间轴（毫秒，数据中的时间戳）
+    qint64 startTime() const;
+    qint64 endTime() const;
+    qint64 currentTime() const;
+    int frameCount() const { return m_frames.size(); }
+    int currentFrame() const { return m_nextFrame; }
+
+signals:
+    void positionChanged(qint64 timestampMs);
+    void playbackStateChanged(bool playing);
+    void finished();
+
+private slots:
+    void onTimer();
+
+private:
+    struct Frame {
+        qint64 timestampMs;
+        qint64 offset;
+        int length;
+    };
+
+    bool buildIndex(QString *errorMessage);
+    QByteArray frameData(int index) const;
+    void applyFrame(int index);
+    void restartClock();
+
+    RobotController *m_controller;
+    QFile m_file;
+    const uchar *m_data;
+    qint64 m_size;
+
+    QVector<Frame> m_frames;
+    QVector<QByteArray> m_keyframes;    // 第 k 个关键帧 = 应用完第 k*KEYFRAME_INTERVAL 帧后的累计状态
+
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_clockOriginMs;             // 时钟起点对应的数据时间戳
+    double m_speed;
+    int m_nextFrame;
+};
+
+#endif // REPLAYENGINE_H
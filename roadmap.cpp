@@ -0,0 +1,658 @@
+#include "roadmap.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace {
+
+const double SNAP_TOLERANCE = 1e-3;     // 关节单位，起止位姿与节点距离小于该值时视为同一位姿
+const size_t SAMPLE_BATCH = 512;
+
+double secondsNow()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t hashBytes(const void *data, size_t size, uint64_t hash)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 按块分配下标给 threads 个线程，function(worker, index)
+void parallelFor(int threads, size_t count, const std::function<void(int, size_t)> &function)
+{
+    const size_t chunk = 16;
+    std::atomic<size_t> next(0);
+    auto work = [&](int worker) {
+        for (size_t begin = next.fetch_add(chunk); begin < count; begin = next.fetch_add(chunk)) {
+            for (size_t i = begin; i < std::min(begin + chunk, count); ++i) {
+                function(worker, i);
+            }
+        }
+    };
+    if (threads <= 1) {
+        work(0);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < threads; ++worker) {
+        workers.emplace_back(work, worker);
+    }
+    for (std::thread &thread : workers) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+Roadmap::Roadmap()
+    : m_external(nullptr)
+    , m_size(0)
+    , m_offsetsStart(0)
+    , m_neighboursStart(0)
+    , m_stamp(0)
+    , m_nextConnection(0)
+    , m_searchNumber(0)
+{
+}
+
+void Roadmap::clear()
+{
+    *this = Roadmap();
+}
+
+std::vector<int> Roadmap::jointIds() const
+{
+    std::vector<int> ids;
+    for (int k = 0; k < jointCount(); ++k) {
+        ids.push_back(header()->jointIds[k]);
+    }
+    return ids;
+}
+
+uint64_t Roadmap::validationStamp(const MotionPlanner &planner, const double *fixedPose, const PlannerOptions &options)
+{
+    const PlanningScene &scene = planner.scene();
+    const std::vector<int> &jointIds = planner.jointIds();
+    const bool hasEnvironment = scene.environment && !scene.environment->isEmpty();
+    uint64_t hash = 14695981039346656037ull;
+    const uint64_t environmentHash = hasEnvironment ? scene.environmentHash : 0;
+    hash = hashBytes(&environmentHash, sizeof(environmentHash), hash);
+    if (hasEnvironment) {
+        hash = hashBytes(scene.basePose.r, sizeof(scene.basePose.r), hash);
+        hash = hashBytes(scene.basePose.p, sizeof(scene.basePose.p), hash);
+    }
+    for (size_t j = 0; j < scene.minLimits.size(); ++j) {
+        if (std::find(jointIds.begin(), jointIds.end(), int(j)) == jointIds.end()) {
+            hash = hashBytes(&fixedPose[j], sizeof(double), hash);
+        }
+    }
+    hash = hashBytes(jointIds.data(), jointIds.size() * sizeof(int), hash);
+    hash = hashBytes(&options.clearance, sizeof(options.clearance), hash);
+    hash = hashBytes(&options.checkResolution, sizeof(options.checkResolution), hash);
+    return hash;
+}
+
+bool Roadmap::build(MotionPlanner &planner, const double *fixedPose, const RoadmapOptions &options,
+                    const PlannerOptions &checkOptions, std::string *errorMessage)
+{
+    auto fail = [errorMessage](const std::string &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    if (!planner.isConfigured()) {
+        return fail("规划器未配置");
+    }
+    const std::vector<int> &jointIds = planner.jointIds();
+    const size_t n = jointIds.size();
+    if (n > size_t(RoadmapHeader::MAX_JOINTS)) {
+        return fail("路图的规划关节过多");
+    }
+    if (options.nodeCount < 2 || options.neighbours < 1 || options.anchors.size() > size_t(options.nodeCount)) {
+        return fail("路图节点数或近邻数无效");
+    }
+
+    const PlanningScene &scene = planner.scene();
+    const int threads = planner.threadCount();
+    const double clearance = checkOptions.clearance;
+    planner.setFixedJoints(fixedPose);
+
+    // 节点坐标先舍入为 float 再检查，保证文件中的坐标就是验证过的坐标
+    const size_t nodeCount = size_t(options.nodeCount);
+    std::vector<float> points;
+    points.reserve(nodeCount * n);
+    std::vector<double> x(n);
+    for (size_t a = 0; a < options.anchors.size(); ++a) {
+        const std::vector<double> &anchor = options.anchors[a];
+        for (size_t k = 0; k < n; ++k) {
+            const size_t id = size_t(jointIds[k]);
+            x[k] = float(id < anchor.size() ? anchor[id] : 0.0);
+        }
+        if (!planner.checkState(0, x.data(), clearance)) {
+            return fail("常用位姿 " + std::to_string(a + 1) + " 不满足间隙要求");
+        }
+        points.insert(points.end(), x.begin(), x.end());
+    }
+
+    // 候选构型由一个随机数序列依次生成，批内并行检查，保留顺序与线程数无关
+    std::mt19937 random(options.seed);
+    std::vector<std::uniform_real_distribution<double>> ranges;
+    for (int id : jointIds) {
+        ranges.emplace_back(scene.minLimits[size_t(id)], scene.maxLimits[size_t(id)]);
+    }
+    std::vector<double> candidates(SAMPLE_BATCH * n);
+    std::vector<uint8_t> accepted(SAMPLE_BATCH);
+    size_t sampled = 0;
+    while (points.size() < nodeCount * n) {
+        if (sampled > nodeCount * 1000) {
+            return fail("可用空间太小，采样不到足够的无碰撞构型");
+        }
+        for (size_t i = 0; i < SAMPLE_BATCH; ++i) {
+            for (size_t k = 0; k < n; ++k) {
+                candidates[i * n + k] = float(ranges[k](random));
+            }
+        }
+        sampled += SAMPLE_BATCH;
+        parallelFor(threads, SAMPLE_BATCH, [&](int worker, size_t i) {
+            accepted[i] = planner.checkState(worker, &candidates[i * n], clearance) ? 1 : 0;
+        });
+        for (size_t i = 0; i < SAMPLE_BATCH && points.size() < nodeCount * n; ++i) {
+            if (accepted[i]) {
+                points.insert(points.end(), candidates.begin() + std::ptrdiff_t(i * n),
+                              candidates.begin() + std::ptrdiff_t((i + 1) * n));
+            }
+        }
+    }
+
+    // 每个节点的 k 个最近邻（暴力搜索，按节点并行）
+    const size_t k = std::min(size_t(options.neighbours), nodeCount - 1);
+    std::vector<uint32_t> nearest(nodeCount * k);
+    parallelFor(threads, nodeCount, [&](int, size_t i) {
+        std::vector<std::pair<float, uint32_t>> best;
+        best.reserve(k + 1);
+        for (size_t j = 0; j < nodeCount; ++j) {
+            if (j == i) {
+                continue;
+            }
+            float sum = 0.0f;
+            for (size_t d = 0; d < n; ++d) {
+                const float delta = points[i * n + d] - points[j * n + d];
+                sum += delta * delta;
+            }
+            if (best.size() == k && sum >= best.back().first) {
+                continue;
+            }
+            const std::pair<float, uint32_t> entry(sum, uint32_t(j));
+            best.insert(std::upper_bound(best.begin(), best.end(), entry), entry);
+            if (best.size() > k) {
+                best.pop_back();
+            }
+        }
+        for (size_t m = 0; m < k; ++m) {
+            nearest[i * k + m] = best[m].second;
+        }
+    });
+
+    // 近邻关系去重为无向边后并行检查
+    std::vector<uint64_t> edges;
+    edges.reserve(nodeCount * k);
+    for (size_t i = 0; i < nodeCount; ++i) {
+        for (size_t m = 0; m < k; ++m) {
+            const uint64_t a = std::min<uint64_t>(i, nearest[i * k + m]);
+            const uint64_t b = std::max<uint64_t>(i, nearest[i * k + m]);
+            edges.push_back(a << 32 | b);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    std::vector<uint8_t> edgeValid(edges.size());
+    parallelFor(threads, edges.size(), [&](int worker, size_t e) {
+        const size_t a = size_t(edges[e] >> 32);
+        const size_t b = size_t(edges[e] & 0xffffffffu);
+        const std::vector<double> from(points.begin() + std::ptrdiff_t(a * n), points.begin() + std::ptrdiff_t((a + 1) * n));
+        const std::vector<double> to(points.begin() + std::ptrdiff_t(b * n), points.begin() + std::ptrdiff_t((b + 1) * n));
+        edgeValid[e] = planner.checkMotion(worker, from.data(), to.data(), checkOptions) ? 1 : 0;
+    });
+
+    // CSR 邻接表
+    std::vector<uint32_t> degree(nodeCount + 1, 0);
+    for (size_t e = 0; e < edges.size(); ++e) {
+        if (edgeValid[e]) {
+            ++degree[size_t(edges[e] >> 32) + 1];
+            ++degree[size_t(edges[e] & 0xffffffffu) + 1];
+        }
+    }
+    for (size_t i = 1; i <= nodeCount; ++i) {
+        degree[i] += degree[i - 1];
+    }
+    const size_t entryCount = degree[nodeCount];
+    std::vector<uint32_t> adjacency(entryCount);
+    std::vector<uint32_t> fill(degree.begin(), degree.end() - 1);
+    for (size_t e = 0; e < edges.size(); ++e) {
+        if (edgeValid[e]) {
+            const uint32_t a = uint32_t(edges[e] >> 32);
+            const uint32_t b = uint32_t(edges[e] & 0xffffffffu);
+            adjacency[fill[a]++] = b;
+            adjacency[fill[b]++] = a;
+        }
+    }
+
+    RoadmapHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = RoadmapHeader::MAGIC;
+    header.version = RoadmapHeader::VERSION;
+    header.jointCount = uint16_t(n);
+    header.nodeCount = uint32_t(nodeCount);
+    header.anchorCount = uint32_t(options.anchors.size());
+    header.edgeCount = uint32_t(entryCount);
+    header.validationStamp = validationStamp(planner, fixedPose, checkOptions);
+    for (size_t d = 0; d < n; ++d) {
+        header.jointIds[d] = uint8_t(jointIds[d]);
+    }
+
+    std::vector<uint8_t> storage(sizeof(header) + points.size() * sizeof(float)
+                                 + degree.size() * sizeof(uint32_t) + adjacency.size() * sizeof(uint32_t));
+    uint8_t *cursor = storage.data();
+    std::memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    std::memcpy(cursor, points.data(), points.size() * sizeof(float));
+    cursor += points.size() * sizeof(float);
+    std::memcpy(cursor, degree.data(), degree.size() * sizeof(uint32_t));
+    cursor += degree.size() * sizeof(uint32_t);
+    std::memcpy(cursor, adjacency.data(), adjacency.size() * sizeof(uint32_t));
+
+    clear();
+    m_storage.swap(storage);
+    m_size = m_storage.size();
+    return layout(errorMessage);
+}
+
+bool Roadmap::save(const std::string &fileName, std::string *errorMessage) const
+{
+    // 先写临时文件再改名，中途失败不会留下半个路图
+    const std::string temporary = fileName + ".tmp";
+    std::FILE *file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        if (errorMessage) {
+            *errorMessage = "无法创建路图文件 " + fileName;
+        }
+        return false;
+    }
+    const bool written = m_size == 0 || std::fwrite(image(), 1, m_size, file) == m_size;
+    const bool closed = std::fclose(file) == 0;
+    std::remove(fileName.c_str());
+    if (!written || !closed || std::rename(temporary.c_str(), fileName.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        if (errorMessage) {
+            *errorMessage = "写入路图文件失败 " + fileName;
+        }
+        return false;
+    }
+    return true;
+}
+
+bool Roadmap::attach(const void *data, size_t size, std::string *errorMessage)
+{
+    clear();
+    m_external = static_cast<const uint8_t *>(data);
+    m_size = size;
+    if (!layout(errorMessage)) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+bool Roadmap::layout(std::string *errorMessage)
+{
+    auto fail = [errorMessage](const std::string &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    if (!image() || m_size < size_t(RoadmapHeader::SIZE)) {
+        return fail("路图文件过短");
+    }
+    const RoadmapHeader *h = header();
+    if (h->magic != RoadmapHeader::MAGIC || h->version != RoadmapHeader::VERSION) {
+        return fail("不是路图文件或版本不支持");
+    }
+    if (h->jointCount == 0 || h->jointCount > RoadmapHeader::MAX_JOINTS || h->nodeCount == 0
+        || h->anchorCount > h->nodeCount) {
+        return fail("路图文件头无效");
+    }
+    const size_t nodeBytes = size_t(h->nodeCount) * h->jointCount * sizeof(float);
+    m_offsetsStart = size_t(RoadmapHeader::SIZE) + nodeBytes;
+    m_neighboursStart = m_offsetsStart + (size_t(h->nodeCount) + 1) * sizeof(uint32_t);
+    if (m_size != m_neighboursStart + size_t(h->edgeCount) * sizeof(uint32_t)) {
+        return fail("路图文件长度与文件头不符");
+    }
+
+    // 邻接表越界会在查询时读到映像之外，载入时完整检查一遍
+    const uint32_t *offset = offsets();
+    const uint32_t *neighbour = neighbours();
+    if (offset[0] != 0 || offset[h->nodeCount] != h->edgeCount) {
+        return fail("路图邻接表无效");
+    }
+    for (uint32_t i = 0; i < h->nodeCount; ++i) {
+        if (offset[i] > offset[i + 1]) {
+            return fail("路图邻接表无效");
+        }
+    }
+    for (uint32_t e = 0; e < h->edgeCount; ++e) {
+        if (neighbour[e] >= h->nodeCount) {
+            return fail("路图邻接表无效");
+        }
+    }
+
+    // 文件中只有构建时验证通过的节点和边
+    m_stamp = h->validationStamp;
+    m_nodeStates.assign(h->nodeCount, Valid);
+    m_edgeStates.assign(h->edgeCount, Valid);
+    m_connections.clear();
+    m_nextConnection = 0;
+    m_cost.assign(h->nodeCount, 0.0);
+    m_parent.assign(h->nodeCount, 0);
+    m_visited.assign(h->nodeCount, 0);
+    m_closed.assign(h->nodeCount, 0);
+    m_searchNumber = 0;
+    return true;
+}
+
+void Roadmap::invalidate()
+{
+    std::fill(m_nodeStates.begin(), m_nodeStates.end(), Unknown);
+    std::fill(m_edgeStates.begin(), m_edgeStates.end(), Unknown);
+    m_connections.clear();
+    m_nextConnection = 0;
+}
+
+size_t Roadmap::invalidEdgeCount() const
+{
+    return size_t(std::count(m_edgeStates.begin(), m_edgeStates.end(), Invalid)) / 2;
+}
+
+double Roadmap::nodeDistance(uint32_t a, uint32_t b) const
+{
+    const size_t n = size_t(jointCount());
+    const float *pa = node(a);
+    const float *pb = node(b);
+    double sum = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        const double d = double(pa[k]) - pb[k];
+        sum += d * d;
+    }
+    return std::sqrt(sum);
+}
+
+double Roadmap::distanceToNode(const double *x, uint32_t index) const
+{
+    const size_t n = size_t(jointCount());
+    const float *p = node(index);
+    double sum = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        const double d = x[k] - p[k];
+        sum += d * d;
+    }
+    return std::sqrt(sum);
+}
+
+void Roadmap::nodeCoordinates(uint32_t index, double *x) const
+{
+    const float *p = node(index);
+    std::copy(p, p + jointCount(), x);
+}
+
+bool Roadmap::nodeValid(MotionPlanner &planner, uint32_t index, const PlannerOptions &options)
+{
+    if (m_nodeStates[index] == Unknown) {
+        double x[RoadmapHeader::MAX_JOINTS];
+        nodeCoordinates(index, x);
+        m_nodeStates[index] = planner.checkState(0, x, options.clearance) ? Valid : Invalid;
+    }
+    return m_nodeStates[index] == Valid;
+}
+
+bool Roadmap::edgeValid(MotionPlanner &planner, uint32_t from, size_t entry, const PlannerOptions &options)
+{
+    if (m_edgeStates[entry] != Unknown) {
+        return m_edgeStates[entry] == Valid;
+    }
+    const uint32_t to = neighbours()[entry];
+    bool valid = nodeValid(planner, from, options) && nodeValid(planner, to, options);
+    if (valid) {
+        double a[RoadmapHeader::MAX_JOINTS];
+        double b[RoadmapHeader::MAX_JOINTS];
+        nodeCoordinates(from, a);
+        nodeCoordinates(to, b);
+        valid = planner.checkMotion(0, a, b, options);
+    }
+
+    // 反向表项同时更新
+    const State state = valid ? Valid : Invalid;
+    m_edgeStates[entry] = state;
+    for (uint32_t e = offsets()[to]; e < offsets()[to + 1]; ++e) {
+        if (neighbours()[e] == from) {
+            m_edgeStates[e] = state;
+        }
+    }
+    return valid;
+}
+
+bool Roadmap::connect(MotionPlanner &planner, const double *x, const PlannerOptions &options, uint32_t *result)
+{
+    const size_t n = size_t(jointCount());
+    const uint32_t count = uint32_t(nodeCount());
+
+    // 与某个节点重合（常用位姿）时直接使用
+    std::vector<std::pair<double, uint32_t>> candidates;
+    candidates.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        candidates.emplace_back(distanceToNode(x, i), i);
+    }
+    const size_t attempts = std::min(candidates.size(), size_t(CONNECTION_ATTEMPTS));
+    std::partial_sort(candidates.begin(), candidates.begin() + std::ptrdiff_t(attempts), candidates.end());
+    if (candidates.front().first < SNAP_TOLERANCE && nodeValid(planner, candidates.front().second, options)) {
+        *result = candidates.front().second;
+        return true;
+    }
+
+    for (const Connection &connection : m_connections) {
+        if (std::equal(connection.pose.begin(), connection.pose.end(), x)) {
+            *result = connection.node;
+            return true;
+        }
+    }
+
+    if (!planner.checkState(0, x, options.clearance)) {
+        return false;
+    }
+    for (size_t c = 0; c < attempts; ++c) {
+        const uint32_t index = candidates[c].second;
+        double p[RoadmapHeader::MAX_JOINTS];
+        nodeCoordinates(index, p);
+        if (!nodeValid(planner, index, options) || !planner.checkMotion(0, x, p, options)) {
+            continue;
+        }
+        Connection connection;
+        connection.pose.assign(x, x + n);
+        connection.node = index;
+        if (m_connections.size() < CONNECTION_CACHE_SIZE) {
+            m_connections.push_back(connection);
+        } else {
+            m_connections[m_nextConnection] = connection;
+            m_nextConnection = (m_nextConnection + 1) % CONNECTION_CACHE_SIZE;
+        }
+        *result = index;
+        return true;
+    }
+    return false;
+}
+
+bool Roadmap::search(uint32_t start, uint32_t goal, std::vector<uint32_t> *path, size_t *expanded)
+{
+    if (++m_searchNumber == 0) {
+        std::fill(m_visited.begin(), m_visited.end(), 0);
+        std::fill(m_closed.begin(), m_closed.end(), 0);
+        m_searchNumber = 1;
+    }
+    const uint32_t number = m_searchNumber;
+    const uint32_t *offset = offsets();
+    const uint32_t *neighbour = neighbours();
+    const auto greater = [](const std::pair<double, uint32_t> &a, const std::pair<double, uint32_t> &b) {
+        return a.first > b.first;
+    };
+
+    m_open.clear();
+    m_cost[start] = 0.0;
+    m_parent[start] = start;
+    m_visited[start] = number;
+    m_open.emplace_back(nodeDistance(start, goal), start);
+    while (!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end(), greater);
+        const uint32_t u = m_open.back().second;
+        m_open.pop_back();
+        if (m_closed[u] == number) {
+            continue;
+        }
+        m_closed[u] = number;
+        ++*expanded;
+        if (u == goal) {
+            path->clear();
+            for (uint32_t v = goal; v != start; v = m_parent[v]) {
+                path->push_back(v);
+            }
+            path->push_back(start);
+            std::reverse(path->begin(), path->end());
+            return true;
+        }
+        for (uint32_t e = offset[u]; e < offset[u + 1]; ++e) {
+            const uint32_t v = neighbour[e];
+            if (m_edgeStates[e] == Invalid || m_nodeStates[v] == Invalid || m_closed[v] == number) {
+                continue;
+            }
+            const double cost = m_cost[u] + nodeDistance(u, v);
+            if (m_visited[v] != number || cost < m_cost[v]) {
+                m_visited[v] = number;
+                m_cost[v] = cost;
+                m_parent[v] = u;
+                m_open.emplace_back(cost + nodeDistance(v, goal), v);
+                std::push_heap(m_open.begin(), m_open.end(), greater);
+            }
+        }
+    }
+    return false;
+}
+
+PlanResult Roadmap::query(MotionPlanner &planner, const double *start, const double *goal, const PlannerOptions &options)
+{
+    PlanResult result;
+    result.fromRoadmap = true;
+    const double begin = secondsNow();
+    if (isEmpty()) {
+        result.error = "路图为空";
+        return result;
+    }
+    if (!planner.isConfigured() || planner.jointIds() != jointIds()) {
+        result.error = "路图的规划关节与规划器不一致";
+        return result;
+    }
+
+    // 验证条件变了（环境、底座、未规划关节等），之前的验证结果全部作废
+    planner.setFixedJoints(start);
+    const uint64_t stamp = validationStamp(planner, start, options);
+    if (stamp != m_stamp) {
+        invalidate();
+        m_stamp = stamp;
+    }
+    const size_t checksBefore = planner.stateChecks();
+
+    const size_t n = size_t(jointCount());
+    const std::vector<int> ids = jointIds();
+    std::vector<double> xs(n);
+    std::vector<double> xg(n);
+    for (size_t k = 0; k < n; ++k) {
+        xs[k] = start[ids[k]];
+        xg[k] = goal[ids[k]];
+    }
+    uint32_t startNode = 0;
+    uint32_t goalNode = 0;
+    if (!connect(planner, xs.data(), options, &startNode)) {
+        result.error = "起点不满足间隙要求或无法连接到路图";
+    } else if (!connect(planner, xg.data(), options, &goalNode)) {
+        result.error = "终点不满足间隙要求或无法连接到路图";
+    }
+
+    // 惰性检查：只验证搜索到的路径上未知的边，有无效边就标记后重新搜索
+    std::vector<uint32_t> path;
+    bool found = false;
+    while (result.error.empty() && !found) {
+        if (!search(startNode, goalNode, &path, &result.nodes)) {
+            result.error = "路图中起点与终点不连通";
+            break;
+        }
+        found = true;
+        for (size_t i = 0; i + 1 < path.size() && found; ++i) {
+            for (uint32_t e = offsets()[path[i]]; e < offsets()[path[i] + 1]; ++e) {
+                if (neighbours()[e] == path[i + 1]) {
+                    found = edgeValid(planner, path[i], e, options);
+                    break;
+                }
+            }
+        }
+    }
+    result.stateChecks = planner.stateChecks() - checksBefore;
+    result.planningSeconds = secondsNow() - begin;
+    if (!found) {
+        return result;
+    }
+
+    // 起止点与节点重合时不重复加入节点坐标
+    std::vector<std::vector<double>> points;
+    points.push_back(xs);
+    for (size_t i = 0; i < path.size(); ++i) {
+        std::vector<double> x(n);
+        nodeCoordinates(path[i], x.data());
+        if ((i == 0 && distanceToNode(xs.data(), path[i]) < SNAP_TOLERANCE)
+            || (i + 1 == path.size() && distanceToNode(xg.data(), path[i]) < SNAP_TOLERANCE)) {
+            continue;
+        }
+        points.push_back(x);
+    }
+    points.push_back(xg);
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        std::vector<double> waypoint(start, start + planner.scene().minLimits.size());
+        for (size_t k = 0; k < n; ++k) {
+            waypoint[size_t(ids[k])] = points[i][k];
+        }
+        if (i > 0) {
+            double sum = 0.0;
+            for (size_t k = 0; k < n; ++k) {
+                sum += (points[i][k] - points[i - 1][k]) * (points[i][k] - points[i - 1][k]);
+            }
+            result.length += std::sqrt(sum);
+        }
+        result.waypoints.push_back(waypoint);
+    }
+    result.rawLength = result.length;
+    result.success = true;
+    return result;
+}
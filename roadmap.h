@@ -0,0 +1,129 @@
+#ifndef ROADMAP_H
+#define ROADMAP_H
+
+#include "motionplanner.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#pragma pack(push, 1)
+struct RoadmapHeader {
+    static const uint32_t MAGIC = 0x4D525052;  // "RPRM"
+    static const uint16_t VERSION = 1;
+    static const int SIZE = 128;
+    static const int MAX_JOINTS = 32;           // 参与规划的关节数上限
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t jointCount;        // 参与规划的关节数 n
+    uint32_t nodeCount;
+    uint32_t anchorCount;       // 前 anchorCount 个节点为构建时指定的常用位姿
+    uint32_t edgeCount;         // 邻接表项数（每条无向边两项）
+    uint32_t reserved0;
+    uint64_t validationStamp;   // 构建时的验证条件（见 Roadmap::validationStamp）
+    uint8_t jointIds[MAX_JOINTS];
+    uint8_t reserved[64];
+};
+#pragma pack(pop)
+
+struct RoadmapOptions {
+    int nodeCount;              // 采样节点数（含常用位姿）
+    int neighbours;             // 每个节点尝试连接的最近邻个数
+    uint32_t seed;
+    std::vector<std::vector<double>> anchors;   // 常用位姿（按全局关节ID的整机位姿），作为节点加入
+
+    RoadmapOptions() : nodeCount(2000), neighbours(10), seed(1) {}
+};
+
+// 关节空间概率路图（PRM），用于同一工位内反复在固定几组位姿之间规划
+//
+// 构建：批量采样无碰撞构型（批内并行检查，结果与线程数无关），每个节点与 k 个最近邻连边，
+// 边并行检查后按 CSR 邻接表存放。映像文件 = 文件头 + float 节点坐标[节点][关节]
+// + uint32 邻接偏移[节点数 + 1] + uint32 邻接节点[边项数]，可直接映射到内存使用，不需解析。
+//
+// 查询：起点、终点与常用位姿重合时直接用该节点，否则按距离依次尝试连到最近的节点（连接结果缓存）；
+// 然后在图上做 A*。边和节点的有效性是惰性的：环境、底座位姿、未规划关节或间隙要求与构建时不同
+// （验证条件改变）时所有状态重置为未知，A* 跳过已知无效的边，找到路径后只检查路径上未知的边，
+// 有无效边时标记后重新搜索。验证过的状态保留在内存中，重复查询不再做碰撞检测。
+class Roadmap
+{
+public:
+    Roadmap();
+
+    // 用 planner 的场景和关节构建；未规划关节取 fixedPose 的值
+    bool build(MotionPlanner &planner, const double *fixedPose, const RoadmapOptions &options,
+               const PlannerOptions &checkOptions, std::string *errorMessage = nullptr);
+    bool save(const std::string &fileName, std::string *errorMessage = nullptr) const;
+    // 使用外部内存中的映像（如映射的文件），调用方保证在 clear 或重新 attach 之前有效
+    bool attach(const void *data, size_t size, std::string *errorMessage = nullptr);
+    void clear();
+
+    bool isEmpty() const { return nodeCount() == 0; }
+    int jointCount() const { return m_size ? header()->jointCount : 0; }
+    size_t nodeCount() const { return m_size ? header()->nodeCount : 0; }
+    size_t anchorCount() const { return m_size ? header()->anchorCount : 0; }
+    size_t edgeCount() const { return m_size ? header()->edgeCount / 2 : 0; }
+    size_t imageBytes() const { return m_size; }
+    std::vector<int> jointIds() const;
+    const float *node(size_t index) const { return nodes() + index * size_t(jointCount()); }
+
+    // planner 的规划关节须与路图一致；未规划关节取 start 的值
+    PlanResult query(MotionPlanner &planner, const double *start, const double *goal, const PlannerOptions &options);
+
+    // 验证条件：环境内容、底座位姿、未规划关节取值、间隙和边检查分辨率的哈希
+    static uint64_t validationStamp(const MotionPlanner &planner, const double *fixedPose, const PlannerOptions &options);
+    void invalidate();          // 所有节点和边重置为未知
+    size_t invalidEdgeCount() const;
+
+    static const size_t CONNECTION_CACHE_SIZE = 64;
+    static const int CONNECTION_ATTEMPTS = 16;  // 起点或终点最多尝试连接的最近节点数
+
+private:
+    enum State : uint8_t {
+        Unknown,
+        Valid,
+        Invalid
+    };
+
+    struct Connection {
+        std::vector<double> pose;   // 规划关节坐标
+        uint32_t node;
+    };
+
+    const uint8_t *image() const { return m_external ? m_external : m_storage.data(); }
+    const RoadmapHeader *header() const { return reinterpret_cast<const RoadmapHeader *>(image()); }
+    const float *nodes() const { return reinterpret_cast<const float *>(image() + RoadmapHeader::SIZE); }
+    const uint32_t *offsets() const { return reinterpret_cast<const uint32_t *>(image() + m_offsetsStart); }
+    const uint32_t *neighbours() const { return reinterpret_cast<const uint32_t *>(image() + m_neighboursStart); }
+    bool layout(std::string *errorMessage);
+    double nodeDistance(uint32_t a, uint32_t b) const;
+    double distanceToNode(const double *x, uint32_t node) const;
+    void nodeCoordinates(uint32_t node, double *x) const;
+    bool nodeValid(MotionPlanner &planner, uint32_t node, const PlannerOptions &options);
+    bool edgeValid(MotionPlanner &planner, uint32_t from, size_t entry, const PlannerOptions &options);
+    bool connect(MotionPlanner &planner, const double *x, const PlannerOptions &options, uint32_t *node);
+    bool search(uint32_t start, uint32_t goal, std::vector<uint32_t> *path, size_t *expanded);
+
+    std::vector<uint8_t> m_storage;     // build 生成的映像
+    const uint8_t *m_external;          // attach 的外部映像
+    size_t m_size;                      // 映像字节数，0 为空路图
+    size_t m_offsetsStart;
+    size_t m_neighboursStart;
+
+    uint64_t m_stamp;                   // 当前状态对应的验证条件
+    std::vector<uint8_t> m_nodeStates;
+    std::vector<uint8_t> m_edgeStates;  // 按邻接表项，两个方向同时更新
+    std::vector<Connection> m_connections;
+    size_t m_nextConnection;
+
+    // A* 暂存：按搜索序号判断节点本次是否访问过，不必每次清零
+    std::vector<double> m_cost;
+    std::vector<uint32_t> m_parent;
+    std::vector<uint32_t> m_visited;
+    std::vector<uint32_t> m_closed;
+    std::vector<std::pair<double, uint32_t>> m_open;
+    uint32_t m_searchNumber;
+};
+
+#endif // ROADMAP_H
@@ -9,12 +9,63 @@ SOURCES += \
     main.cpp \
     mainwindow.cpp \
     robotcontroller.cpp \
-    jointcontrolwidget.cpp
+    jointcontrolwidget.cpp \
+    jointstatestore.cpp \
+    robotdescription.cpp \
+    telemetryhistory.cpp \
+    sessionrecorder.cpp \
+    replayengine.cpp \
+    telemetrycodec.cpp \
+    telemetryfile.cpp \
+    commandjournal.cpp \
+    trajectory.cpp \
+    keyframesequence.cpp \
+    kinematics.cpp \
+    inversekinematics.cpp \
+    selfcollision.cpp \
+    distancefield.cpp \
+    environmentmodel.cpp \
+    motionplanner.cpp \
+    roadmap.cpp \
+    pathtiming.cpp \
+    dynamics.cpp \
+    differentialdrive.cpp \
+    wholebodyik.cpp \
+    reachabilitymap.cpp
 
 HEADERS += \
     mainwindow.h \
     robotcontroller.h \
-    jointcontrolwidget.h
+    jointcontrolwidget.h \
+    jointstatestore.h \
+    robotdescription.h \
+    telemetryhistory.h \
+    sessionrecorder.h \
+    replayengine.h \
+    telemetrycodec.h \
+    telemetryfile.h \
+    commandjournal.h \
+    trajectory.h \
+    keyframesequence.h \
+    kinematics.h \
+    inversekinematics.h \
+    selfcollision.h \
+    distancefield.h \
+    environmentmodel.h \
+    motionplanner.h \
+    roadmap.h \
+    pathtiming.h \
+    dynamics.h \
+    differentialdrive.h \
+    wholebodyik.h \
+    reachabilitymap.h
 
 FORMS += \
-    mainwindow.ui
\ No newline at end of file
+    mainwindow.ui
+
+RESOURCES += \
+    robot_control.qrc
+
+DISTFILES += \
+    robot_description.json \
+    environment_example.json
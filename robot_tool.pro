@@ -0,0 +1,48 @@
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = robot_tool
+TEMPLATE = app
+
+unix: LIBS += -lpthread
+
+SOURCES += \
+    robottool.cpp \
+    robotdescription.cpp \
+    kinematics.cpp \
+    inversekinematics.cpp \
+    selfcollision.cpp \
+    distancefield.cpp \
+    environmentmodel.cpp \
+    motionplanner.cpp \
+    roadmap.cpp \
+    pathtiming.cpp \
+    dynamics.cpp \
+    differentialdrive.cpp \
+    wholebodyik.cpp \
+    reachabilitymap.cpp
+
+HEADERS += \
+    robotdescription.h \
+    jointstatestore.h \
+    kinematics.h \
+    inversekinematics.h \
+    selfcollision.h \
+    distancefield.h \
+    environmentmodel.h \
+    motionplanner.h \
+    roadmap.h \
+    pathtiming.h \
+    dynamics.h \
+    differentialdrive.h \
+    wholebodyik.h \
+    reachabilitymap.h
+
+RESOURCES += \
+    robot_control.qrc
+
+DISTFILES += \
+    robot_description.json \
+    environment_example.json
@@ -1,8 +1,20 @@
 #include "robotcontroller.h"
 #include <QDebug>
+#include <QLoggingCategory>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QStringList>
+#include <QMetaMethod>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+
+// 逐条收发日志在控制频率下会刷屏，默认关闭；需要时用 QT_LOGGING_RULES="robot.protocol.debug=true" 打开
+Q_LOGGING_CATEGORY(robotProtocol, "robot.protocol", QtWarningMsg)
 
 RobotController::RobotController(QObject *parent)
     : QObject(parent)
@@ -12,166 +24,1451 @@ RobotController::RobotController(QObject *parent)
     , m_udpSocket(nullptr)
     , m_hostAddress("127.0.0.1")
     , m_port(8080)
+    , m_description(RobotDescription::loadDefault())
+    , m_kinematics(m_description.kinematicModel())
+    , m_limitViolations(0)
+    , m_forcedStatusChanges(RobotChangeSet::AllStatusChanged)
+    , m_recorder(nullptr)
+    , m_journalHealthy(true)
+    , m_streamMask(0)
+    , m_streamSample(-1)
+    , m_sequenceMode(false)
+    , m_sequenceSegment(0)
+    , m_timedMode(false)
+    , m_jogMask(0)
+    , m_jogWholeBody(false)
+    , m_footprintRadius(0.0)
+    , m_footprintHeight(0.0)
+    , m_dynamicsMask(0)
+    , m_torqueFeedforward(false)
+    , m_feedforwardSegment(0)
+    , m_leftWheel(-1)
+    , m_rightWheel(-1)
+    , m_odometryStamp(-1.0)
 {
+    for (int arm = 0; arm < 2; ++arm) {
+        m_jogActive[arm] = false;
+        m_jogToolFrame[arm] = false;
+        std::fill(m_jogTwist[arm], m_jogTwist[arm] + 6, 0.0);
+    }
     initializeJoints();
+    openCommandJournal();
+    
+    m_environment = EnvironmentModel::loadDefault();
+    if (!m_environment.isEmpty()) {
+        m_environmentStatus = m_environment.robotClearance(m_selfCollision, m_basePose, m_footprintRadius,
+                                                           m_footprintHeight, ENVIRONMENT_RANGE);
+    }
+    
+    // 指令日志按固定周期成批落盘
+    m_journalTimer = new QTimer(this);
+    connect(m_journalTimer, &QTimer::timeout, this, &RobotController::syncCommandJournal);
+    m_journalTimer->start(CommandJournal::SYNC_INTERVAL_MS);
+    
+    // 轨迹设定点下发定时器，仅在运动时运行
+    m_trajectoryTimer = new QTimer(this);
+    m_trajectoryTimer->setTimerType(Qt::PreciseTimer);
+    m_trajectoryTimer->setInterval(1000 / CONTROL_RATE_HZ);
+    connect(m_trajectoryTimer, &QTimer::timeout, this, &RobotController::streamTrajectory);
+    
+    // 笛卡尔点动定时器，与轨迹下发同频
+    m_jogTimer = new QTimer(this);
+    m_jogTimer->setTimerType(Qt::PreciseTimer);
+    m_jogTimer->setInterval(1000 / CONTROL_RATE_HZ);
+    connect(m_jogTimer, &QTimer::timeout, this, &RobotController::streamCartesianJog);
+    
+    // 底盘速度下发定时器，仅在底盘有速度指令或尚未停稳时运行
+    m_chassisTimer = new QTimer(this);
+    m_chassisTimer->setTimerType(Qt::PreciseTimer);
+    m_chassisTimer->setInterval(1000 / CONTROL_RATE_HZ);
+    connect(m_chassisTimer, &QTimer::timeout, this, &RobotController::streamChassis);
+    m_odometryClock.start();
+    
+    m_recorder = new SessionRecorder(this);
+    connect(m_recorder, &SessionRecorder::recordingError, this, &RobotController::errorOccurred);
     
     // 创建状态更新定时器
     m_statusTimer = new QTimer(this);
     connect(m_statusTimer, &QTimer::timeout, this, &RobotController::updateRobotStatus);
     m_statusTimer->start(50); // 50ms更新一次，20Hz
+}
+
+RobotController::~RobotController()
+{
+    disconnectFromRobot();
+    m_recorder->stopRecording();
+    m_telemetryFile.close();
+    m_journal.close();
+}
+
+void RobotController::initializeJoints()
+{
+    m_jointConfigs.clear();
+    m_motionLimits.clear();
+    m_jogSpeedLimits.clear();
+    m_jointState.resize(m_description.jointCount());
+    
+    // 按描述文件中的关节组依次展开
+    const QVector<JointDescription> &joints = m_description.joints();
+    for (int i = 0; i < joints.size(); ++i) {
+        const JointDescription &joint = joints[i];
+        JointConfig config(i, joint.name, joint.minValue, joint.maxValue);
+        config.type = joint.type;
+        config.unit = joint.unit;
+        config.limits = MotionLimits(joint.maxVelocity, joint.maxAcceleration, joint.maxJerk);
+        m_jointConfigs.append(config);
+        m_motionLimits.append(config.limits);
+        m_jogSpeedLimits.push_back(joint.maxVelocity);
+        
+        // 限位同步到热数据存储
+        m_jointState.setLimits(i, joint.minValue, joint.maxValue);
+    }
+    
+    m_telemetry.configure(m_description.jointCount(), m_telemetry.memoryBudget());
+    m_jogVelocities.assign(size_t(m_description.jointCount()), 0.0);
+    m_collisionCandidate.assign(size_t(m_description.jointCount()), 0.0);
+    
+    m_armIk[0].configure(&m_kinematics, KinematicModel::LeftArm, m_jointState.minLimits(), m_jointState.maxLimits());
+    m_armIk[1].configure(&m_kinematics, KinematicModel::RightArm, m_jointState.minLimits(), m_jointState.maxLimits());
+    m_wholeBody.configure(&m_kinematics, m_jointState.minLimits(), m_jointState.maxLimits());
+    
+    m_selfCollision.configure(&m_kinematics, m_description.linkRadii());
+    m_selfCollisionStatus = m_selfCollision.check(m_jointState.targets(), SELF_COLLISION_RANGE);
+    
+    const JointGroupDescription *chassis = m_description.findGroup("chassis");
+    m_footprintRadius = chassis ? chassis->footprintRadius : 0.0;
+    m_footprintHeight = chassis ? chassis->footprintHeight : 0.0;
+    
+    // 差速驱动：轮速限制取两个电机中较小的，电机的"速度"限制即轮速的变化率
+    m_leftWheel = -1;
+    m_rightWheel = -1;
+    m_drive = DifferentialDrive();
+    if (chassis && chassis->joints.size() >= 2) {
+        const int left = chassis->firstJoint;
+        const int right = chassis->firstJoint + 1;
+        const double maxSpeed = qMin(qMin(-joints[left].minValue, joints[left].maxValue),
+                                     qMin(-joints[right].minValue, joints[right].maxValue));
+        const MotionLimits wheelLimits(maxSpeed, qMin(joints[left].maxVelocity, joints[right].maxVelocity), 0.0);
+        std::string error;
+        if (m_drive.configure(chassis->drive, wheelLimits, &error)) {
+            m_leftWheel = left;
+            m_rightWheel = right;
+        } else {
+            qWarning() << "底盘差速驱动未启用:" << QString::fromStdString(error);
+        }
+    }
+    
+    m_dynamics.configure(m_kinematics, m_description.linkInertias());
+    m_dynamicsMask = 0;
+    std::vector<double> torqueLimits;
+    bool torqueLimited = false;
+    for (int i = 0; i < joints.size(); ++i) {
+        if (m_dynamics.hasJoint(i)) {
+            m_dynamicsMask |= quint64(1) << i;
+        }
+        torqueLimits.push_back(joints[i].maxTorque);
+        torqueLimited = torqueLimited || joints[i].maxTorque > 0.0;
+    }
+    m_feedforwardScratch.assign(size_t(joints.size()) * 4, 0.0);
+    
+    // 描述文件给出力矩限制时由逆动力学提供时间最优轨迹的力矩系数
+    m_torqueConstraint = PathTorqueConstraint();
+    if (torqueLimited && !m_dynamics.isEmpty()) {
+        const DynamicModel *dynamics = &m_dynamics;
+        m_torqueConstraint.coefficients = [dynamics](const double *q, const double *dq, const double *ddq, double *a,
+                                                     double *b, double *c) {
+            dynamics->pathCoefficients(q, dq, ddq, a, b, c);
+        };
+        m_torqueConstraint.limits = torqueLimits;
+    }
+}
+
+void RobotController::openCommandJournal()
+{
+    // 日志位置：环境变量 ROBOT_COMMAND_JOURNAL，否则为应用数据目录
+    QString fileName = qEnvironmentVariable("ROBOT_COMMAND_JOURNAL");
+    if (fileName.isEmpty()) {
+        QString directory = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+        if (directory.isEmpty()) {
+            directory = QDir::currentPath();
+        }
+        QDir().mkpath(directory);
+        fileName = QDir(directory).filePath("command_journal.cjnl");
+    }
+    
+    CommandJournalState state;
+    QString error;
+    if (!m_journal.open(fileName, jointCount(), &state, &error)) {
+        qWarning() << error;
+        return;
+    }
+    
+    // 正常退出时机器人已处于操作员最后确认的状态，只有异常退出才需要恢复
+    if (state.isEmpty() || state.cleanShutdown) {
+        return;
+    }
+    
+    m_recoveredState = state;
+    double *targets = m_jointState.targets();
+    double *positions = m_jointState.positions();
+    for (int i = 0; i < jointCount(); ++i) {
+        if (state.targetMask & (quint64(1) << i)) {
+            targets[i] = state.targets[i];
+            positions[i] = state.targets[i];
+        }
+        m_jointState.setEnabled(i, (state.enableMask >> i) & 1u);
+    }
+    m_robotStatus.emergencyStop = state.emergencyStop;
+    
+    qDebug() << "已从指令日志恢复" << state.records << "条记录:" << fileName;
+}
+
+void RobotController::syncCommandJournal()
+{
+    if (!m_journal.hasPending()) {
+        return;
+    }
+    
+    QString error;
+    const bool ok = m_journal.sync(&error);
+    if (!ok && m_journalHealthy) {
+        emit errorOccurred(error);
+    }
+    m_journalHealthy = ok;
+}
+
+bool RobotController::hasRecoveredCommandState() const
+{
+    return !m_recoveredState.isEmpty();
+}
+
+const CommandJournalState &RobotController::recoveredCommandState() const
+{
+    return m_recoveredState;
+}
+
+void RobotController::resyncRecoveredState()
+{
+    if (!m_robotStatus.connected || m_recoveredState.isEmpty()) {
+        return;
+    }
+    
+    // 急停优先下发，之后再恢复使能和目标位置
+    if (m_recoveredState.emergencyStop) {
+        sendCommand("EMERGENCY_STOP");
+    }
+    for (int i = 0; i < jointCount(); ++i) {
+        const bool enabled = (m_recoveredState.enableMask >> i) & 1u;
+        sendCommand(QString("%1 %2").arg(enabled ? "ENABLE_JOINT" : "DISABLE_JOINT").arg(i));
+    }
+    for (int i = 0; i < jointCount(); ++i) {
+        if (m_recoveredState.targetMask & (quint64(1) << i)) {
+            sendCommand(formatJointCommand(i, m_recoveredState.targets[i], "position"));
+        }
+    }
+    
+    m_recorder->record(SessionRecordType::OperatorAction, "resync recovered command state");
+    m_recoveredState = CommandJournalState();
+}
+
+void RobotController::discardRecoveredState()
+{
+    m_recoveredState = CommandJournalState();
+}
+
+bool RobotController::connectToRobot()
+{
+    if (m_robotStatus.connected) {
+        return true;
+    }
+    
+    bool success = false;
+    
+    if (m_connectionType == "serial") {
+        if (!m_serialPort) {
+            m_serialPort = new QSerialPort(this);
+            connect(m_serialPort, &QSerialPort::readyRead, this, &RobotController::onSerialDataReceived);
+            connect(m_serialPort, QOverload<QSerialPort::SerialPortError>::of(&QSerialPort::errorOccurred),
+                    this, &RobotController::onConnectionError);
+        }
+        
+        if (!m_serialPort->isOpen()) {
+            success = m_serialPort->open(QIODevice::ReadWrite);
+        }
+    }
+    else if (m_connectionType == "tcp") {
+        if (!m_tcpSocket) {
+            m_tcpSocket = new QTcpSocket(this);
+            connect(m_tcpSocket, &QTcpSocket::readyRead, this, &RobotController::onTcpDataReceived);
+            connect(m_tcpSocket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::errorOccurred),
+                    this, &RobotController::onConnectionError);
+            connect(m_tcpSocket, &QTcpSocket::connected, [this]() {
+                m_robotStatus.connected = true;
+                m_recorder->record(SessionRecordType::ConnectionEvent,
+                                   QString("connected tcp %1:%2").arg(m_hostAddress).arg(m_port).toUtf8());
+                emit connectionStatusChanged(true);
+                qDebug() << "TCP连接成功";
+            });
+        }
+        
+        if (m_tcpSocket->state() != QAbstractSocket::ConnectedState) {
+            m_tcpSocket->connectToHost(m_hostAddress, m_port);
+            success = m_tcpSocket->waitForConnected(3000);
+        } else {
+            success = true;
+        }
+    }
+    else if (m_connectionType == "replay") {
+        // 回放模式：数据由 ReplayEngine 送入
+        success = true;
+    }
+    else if (m_connectionType == "udp") {
+        if (!m_udpSocket) {
+            m_udpSocket = new QUdpSocket(this);
+            connect(m_udpSocket, &QUdpSocket::readyRead, this, &RobotController::onUdpDataReceived);
+        }
+        
+        success = m_udpSocket->bind(QHostAddress::Any, m_port);
+        if (success) {
+            m_robotStatus.connected = true;
+        }
+    }
+    
+    if (success && m_connectionType != "tcp") {
+        m_robotStatus.connected = true;
+        m_recorder->record(SessionRecordType::ConnectionEvent, QString("connected %1").arg(m_connectionType).toUtf8());
+        emit connectionStatusChanged(true);
+    }
+    
+    return success;
+}
+
+void RobotController::disconnectFromRobot()
+{
+    if (m_serialPort && m_serialPort->isOpen()) {
+        m_serialPort->close();
+    }
     
-    // 初始化机器人状态
-    m_robotStatus.jointPositions.resize(TOTAL_JOINTS);
-    m_robotStatus.jointVelocities.resize(TOTAL_JOINTS);
-    m_robotStatus.jointTorques.resize(TOTAL_JOINTS);
+    if (m_tcpSocket && m_tcpSocket->state() == QAbstractSocket::ConnectedState) {
+        m_tcpSocket->disconnectFromHost();
+    }
+    
+    if (m_udpSocket) {
+        m_udpSocket->close();
+    }
+    
+    m_robotStatus.connected = false;
+    m_recorder->record(SessionRecordType::ConnectionEvent, "disconnected");
+    emit connectionStatusChanged(false);
+}
+
+bool RobotController::isConnected() const
+{
+    return m_robotStatus.connected;
+}
+
+void RobotController::setJointPosition(int jointId, double angle)
+{
+    if (jointId < 0 || jointId >= jointCount()) {
+        return;
+    }
+    
+    // 限制角度范围
+    angle = m_jointState.clampToLimits(jointId, angle);
+    
+    // 与其余关节的当前设定点一起做自碰撞检查
+    std::copy(m_jointState.targets(), m_jointState.targets() + jointCount(), m_collisionCandidate.begin());
+    m_collisionCandidate[size_t(jointId)] = angle;
+    if (!admitSetpoints(m_collisionCandidate.data())) {
+        return;
+    }
+    
+    // 直接设定的关节不再由轨迹驱动
+    m_streamMask &= ~(quint64(1) << jointId);
+    
+    // 更新内部状态
+    m_jointState.targets()[jointId] = angle;
+    m_jointState.positions()[jointId] = angle;
+    m_journal.recordTarget(jointId, angle);
+    
+    // 发送命令到机器人
+    if (m_robotStatus.connected) {
+        QString command = formatJointCommand(jointId, angle, "position");
+        sendCommand(command);
+    }
+    
+    emit jointPositionChanged(jointId, angle);
+}
+
+bool RobotController::moveJointTo(int jointId, double target)
+{
+    if (jointId < 0 || jointId >= jointCount()) {
+        return false;
+    }
+    
+    QVector<double> targets(jointCount(), 0.0);
+    targets[jointId] = target;
+    return moveJointsTo(targets, quint64(1) << jointId);
+}
+
+bool RobotController::moveJointsTo(const QVector<double> &targets, quint64 jointMask)
+{
+    return startTrajectory(targets, jointMask, false);
+}
+
+bool RobotController::moveToPose(const QVector<double> &pose, quint64 jointMask)
+{
+    return startTrajectory(pose, jointMask, true);
+}
+
+bool RobotController::startTrajectory(const QVector<double> &targets, quint64 jointMask, bool synchronized)
+{
+    const int count = jointCount();
+    if (targets.size() < count || m_robotStatus.emergencyStop) {
+        return false;
+    }
+    
+    stopCartesianJog();
+    
+    // 序列播放中收到新的运动指令时序列停在当前设定点
+    if (m_sequenceMode || m_timedMode) {
+        stopMotion();
+    }
+    jointMask &= m_jointState.jointMask();
+    
+    // 起点为当前设定点，只规划本次指令的关节
+    QVector<double> start(count);
+    QVector<double> goals(count);
+    const double *current = m_jointState.targets();
+    for (int i = 0; i < count; ++i) {
+        start[i] = current[i];
+        goals[i] = (jointMask & (quint64(1) << i)) ? m_jointState.clampToLimits(i, targets[i]) : current[i];
+    }
+    
+    // 仍在运动、本次未指令的关节沿原轨迹的剩余设定点继续，不从当前点重新规划（否则速度一步跳到零）
+    const quint64 carryMask = m_streamMask & ~jointMask;
+    JointTrajectory previous;
+    if (carryMask) {
+        previous = m_trajectory;
+    }
+    const bool planned = synchronized
+        ? m_trajectory.planSynchronized(start.constData(), goals.constData(), m_motionLimits.constData(), count, jointMask)
+        : m_trajectory.plan(start.constData(), goals.constData(), m_motionLimits.constData(), count, jointMask);
+    if (!planned) {
+        emit errorOccurred("轨迹规划失败：关节运动限制无效");
+        return false;
+    }
+    m_trajectory.render(CONTROL_RATE_HZ);
+    m_trajectory.carryOver(previous, qMax(0, m_streamSample), carryMask);
+    const quint64 moveMask = jointMask | carryMask;
+    
+    for (int i = 0; i < count; ++i) {
+        if (jointMask & (quint64(1) << i)) {
+            m_journal.recordTarget(i, goals[i]);
+        }
+    }
+    
+    m_streamMask = moveMask;
+    m_streamSample = -1;
+    m_sequenceMode = false;
+    m_timedMode = false;
+    renderFeedforward();
+    m_trajectoryClock.start();
+    m_trajectoryTimer->start();
+    streamTrajectory();
+    return true;
+}
+
+std::vector<Keyframe> RobotController::sequenceFrames(const std::vector<Keyframe> &keyframes) const
+{
+    // 起点为当前设定点，关键帧限制在关节限位内
+    const int count = jointCount();
+    std::vector<Keyframe> frames;
+    frames.reserve(keyframes.size() + 1);
+    Keyframe start;
+    start.pose.assign(m_jointState.targets(), m_jointState.targets() + count);
+    frames.push_back(start);
+    for (const Keyframe &keyframe : keyframes) {
+        Keyframe frame = keyframe;
+        frame.pose.resize(size_t(count), 0.0);
+        for (int i = 0; i < count; ++i) {
+            frame.pose[size_t(i)] = m_jointState.clampToLimits(i, frame.pose[size_t(i)]);
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+bool RobotController::playSequence(const std::vector<Keyframe> &keyframes, KeyframeSequence::Interpolation interpolation,
+                                   QString *errorMessage)
+{
+    if (m_robotStatus.emergencyStop) {
+        if (errorMessage) {
+            *errorMessage = "急停中，无法启动运动";
+        }
+        return false;
+    }
+    
+    stopCartesianJog();
+    stopMotion();
+    
+    const int count = jointCount();
+    const std::vector<Keyframe> frames = sequenceFrames(keyframes);
+    std::string error;
+    if (!m_sequence.build(frames, m_motionLimits.constData(), count, interpolation, &error)) {
+        if (errorMessage) {
+            *errorMessage = QString::fromStdString(error);
+        }
+        return false;
+    }
+    
+    const Keyframe &last = frames.back();
+    for (int i = 0; i < count; ++i) {
+        m_journal.recordTarget(i, last.pose[size_t(i)]);
+    }
+    
+    m_sequenceSetpoints.assign(size_t(count), 0.0);
+    m_sequenceSegment = 0;
+    m_feedforwardSegment = 0;
+    m_sequenceMode = true;
+    m_timedMode = false;
+    m_streamMask = m_jointState.jointMask();
+    m_streamSample = -1;
+    m_trajectoryClock.start();
+    m_trajectoryTimer->start();
+    streamTrajectory();
+    return true;
+}
+
+bool RobotController::playTimeOptimal(const std::vector<Keyframe> &keyframes, QString *errorMessage)
+{
+    stopCartesianJog();
+    stopMotion();
+    
+    KeyframeSequence path;
+    std::string error;
+    if (!path.build(sequenceFrames(keyframes), m_motionLimits.constData(), jointCount(), KeyframeSequence::Quintic,
+                    &error)) {
+        if (errorMessage) {
+            *errorMessage = QString::fromStdString(error);
+        }
+        return false;
+    }
+    return startTimedPath(path, errorMessage);
+}
+
+void RobotController::setTorqueConstraint(const PathTorqueConstraint &constraint)
+{
+    m_torqueConstraint = constraint;
+}
+
+bool RobotController::startTimedPath(const KeyframeSequence &path, QString *errorMessage)
+{
+    if (m_robotStatus.emergencyStop) {
+        if (errorMessage) {
+            *errorMessage = "急停中，无法启动运动";
+        }
+        return false;
+    }
+    
+    // 路径从当前设定点出发；参数化在启动前一次算完，下发时只查缓冲
+    std::string error;
+    if (!m_timedPath.compute(path, m_motionLimits.constData(), &m_torqueConstraint, PathTimingOptions(), &error)) {
+        if (errorMessage) {
+            *errorMessage = QString("时间最优参数化失败：%1").arg(QString::fromStdString(error));
+        }
+        return false;
+    }
+    m_timedPath.render(CONTROL_RATE_HZ);
+    
+    const double *last = m_timedPath.setpoints(m_timedPath.sampleCount() - 1);
+    for (int i = 0; i < jointCount(); ++i) {
+        m_journal.recordTarget(i, last[i]);
+    }
+    
+    m_sequenceMode = false;
+    m_timedMode = true;
+    renderFeedforward();
+    m_streamMask = m_jointState.jointMask();
+    m_streamSample = -1;
+    m_trajectoryClock.start();
+    m_trajectoryTimer->start();
+    streamTrajectory();
+    return true;
+}
+
+Transform RobotController::armPose(KinematicModel::ChainId arm) const
+{
+    if (m_kinematics.chain(arm).joints.empty()) {
+        return Transform();
+    }
+    return m_kinematics.forward(arm, m_jointState.targets());
+}
+
+IkResult RobotController::solveArmIk(KinematicModel::ChainId arm, const Transform &target,
+                                     QVector<double> *solution) const
+{
+    // 以当前设定点热启动：连续的目标位姿通常只需几次迭代
+    QVector<double> q(jointCount());
+    std::copy(m_jointState.targets(), m_jointState.targets() + jointCount(), q.begin());
+    
+    IkResult result;
+    const ArmIkSolver &solver = m_armIk[arm == KinematicModel::RightArm ? 1 : 0];
+    if (solver.isConfigured() && q.size() >= m_kinematics.jointCount()) {
+        result = solver.solve(target, q.constData(), q.data());
+    }
+    if (solution) {
+        *solution = q;
+    }
+    return result;
+}
+
+bool RobotController::moveArmTo(KinematicModel::ChainId arm, const Transform &target, IkResult *result,
+                                QVector<double> *solution)
+{
+    QVector<double> pose;
+    const IkResult ik = solveArmIk(arm, target, &pose);
+    if (result) {
+        *result = ik;
+    }
+    if (solution) {
+        *solution = pose;
+    }
+    if (!ik.converged) {
+        return false;
+    }
+    
+    quint64 mask = 0;
+    for (const KinematicJoint &joint : m_kinematics.chain(arm).joints) {
+        mask |= quint64(1) << joint.jointId;
+    }
+    return moveToPose(pose, mask);
+}
+
+IkResult RobotController::solveWholeBodyIk(KinematicModel::ChainId arm, const Transform &target,
+                                          QVector<double> *solution) const
+{
+    QVector<double> q(jointCount());
+    std::copy(m_jointState.targets(), m_jointState.targets() + jointCount(), q.begin());
+    
+    // 另一臂以当前末端位姿为目标，躯干运动时保持不动
+    IkResult result;
+    if (m_wholeBody.isConfigured() && q.size() >= m_kinematics.jointCount()) {
+        const int index = arm == KinematicModel::RightArm ? 1 : 0;
+        WholeBodyTask tasks[2];
+        for (int other = 0; other < 2; ++other) {
+            const KinematicModel::ChainId chain = other == 0 ? KinematicModel::LeftArm : KinematicModel::RightArm;
+            tasks[other].active = m_armIk[other].isConfigured();
+            tasks[other].target = other == index ? target : m_kinematics.forward(chain, q.constData());
+        }
+        IkOptions options;
+        options.maxIterations = 60;
+        result = m_wholeBody.solve(tasks, q.constData(), q.data(), WholeBodyOptions(), options);
+    }
+    if (solution) {
+        *solution = q;
+    }
+    return result;
+}
+
+bool RobotController::moveWholeBodyTo(KinematicModel::ChainId arm, const Transform &target, IkResult *result,
+                                      QVector<double> *solution)
+{
+    QVector<double> pose;
+    const IkResult ik = solveWholeBodyIk(arm, target, &pose);
+    if (result) {
+        *result = ik;
+    }
+    if (solution) {
+        *solution = pose;
+    }
+    if (!ik.converged) {
+        return false;
+    }
+    
+    quint64 mask = 0;
+    for (int c = 0; c < m_wholeBody.jointCount(); ++c) {
+        mask |= quint64(1) << m_wholeBody.jointId(c);
+    }
+    return moveToPose(pose, mask);
+}
+
+bool RobotController::moveToPoseCollisionFree(const QVector<double> &pose, quint64 jointMask, PlanResult *result,
+                                              QString *errorMessage)
+{
+    auto fail = [errorMessage](const QString &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+    
+    if (m_robotStatus.emergencyStop) {
+        return fail("急停中，无法启动运动");
+    }
+    
+    const int count = jointCount();
+    if (pose.size() < count) {
+        return fail("目标位姿的关节数不足");
+    }
+    
+    // 只在手臂关节上规划，其余关节保持当前设定点
+    jointMask &= m_jointState.jointMask();
+    std::vector<int> jointIds;
+    for (KinematicModel::ChainId arm : { KinematicModel::LeftArm, KinematicModel::RightArm }) {
+        for (const KinematicJoint &joint : m_kinematics.chain(arm).joints) {
+            if (jointMask & (quint64(1) << joint.jointId)) {
+                jointIds.push_back(joint.jointId);
+            }
+        }
+    }
+    if (jointIds.empty()) {
+        return fail("没有要规划的手臂关节");
+    }
+    
+    stopCartesianJog();
+    stopMotion();
+    
+    PlanningScene scene;
+    scene.model = &m_kinematics;
+    scene.linkRadii = m_description.linkRadii();
+    scene.minLimits.assign(m_jointState.minLimits(), m_jointState.minLimits() + count);
+    scene.maxLimits.assign(m_jointState.maxLimits(), m_jointState.maxLimits() + count);
+    scene.environment = m_environment.isEmpty() ? nullptr : &m_environment.distanceField();
+    scene.environmentHash = m_environment.sourceHash();
+    scene.basePose = m_basePose;
+    std::string error;
+    if (!m_planner.configure(scene, jointIds, &error)) {
+        return fail(QString::fromStdString(error));
+    }
+    
+    std::vector<double> start(m_jointState.targets(), m_jointState.targets() + count);
+    std::vector<double> goal = start;
+    for (int id : jointIds) {
+        goal[size_t(id)] = m_jointState.clampToLimits(id, pose[id]);
+    }
+    PlannerOptions options;
+    options.timeBudget = PLANNER_TIME_BUDGET;
+    options.clearance = PLANNER_CLEARANCE;
+    PlanResult plan;
+    if (!m_roadmap.isEmpty() && m_roadmap.jointIds() == jointIds) {
+        plan = m_roadmap.query(m_planner, start.data(), goal.data(), options);
+    }
+    if (!plan.success) {
+        plan = m_planner.plan(start.data(), goal.data(), options);
+    }
+    if (result) {
+        *result = plan;
+    }
+    if (!plan.success) {
+        return fail(QString("避障规划失败：%1").arg(QString::fromStdString(plan.error)));
+    }
+    
+    // 路径点之间的直线已验证，样条会偏离直线：按控制周期采样检查，不通过的段插入中点后重新拟合
+    std::vector<std::vector<double>> points = plan.waypoints;
+    std::vector<Keyframe> frames;
+    KeyframeSequence sequence;
+    std::vector<double> q(size_t(count), 0.0);
+    for (int round = 0;; ++round) {
+        frames.assign(points.size(), Keyframe());
+        for (size_t i = 0; i < points.size(); ++i) {
+            frames[i].pose = points[i];
+        }
+        if (!sequence.build(frames, m_motionLimits.constData(), count, KeyframeSequence::Quintic, &error)) {
+            return fail(QString::fromStdString(error));
+        }
+        
+        std::vector<bool> invalid(size_t(sequence.segmentCount()), false);
+        bool valid = true;
+        int segment = 0;
+        const double dt = 1.0 / CONTROL_RATE_HZ;
+        for (double t = 0.0; t < sequence.duration() + dt; t += dt) {
+            sequence.evaluate(std::min(t, sequence.duration()), q.data(), &segment);
+            if (!invalid[size_t(segment)] && !m_planner.isStateValid(q.data(), ENVIRONMENT_STOP_DISTANCE)) {
+                invalid[size_t(segment)] = true;
+                valid = false;
+            }
+        }
+        if (valid) {
+            break;
+        }
+        if (round == PLANNER_REFINE_ROUNDS) {
+            return fail("避障规划失败：平滑后的轨迹不满足间隙要求");
+        }
+        for (size_t i = invalid.size(); i-- > 0;) {
+            if (!invalid[i]) {
+                continue;
+            }
+            std::vector<double> middle(size_t(count));
+            for (size_t k = 0; k < middle.size(); ++k) {
+                middle[k] = 0.5 * (points[i][k] + points[i + 1][k]);
+            }
+            points.insert(points.begin() + std::ptrdiff_t(i + 1), middle);
+        }
+    }
+    
+    // 几何路径已验证，时间参数化不改变路径，直接按时间最优下发
+    return startTimedPath(sequence, errorMessage);
+}
+
+bool RobotController::loadRoadmap(const QString &fileName, QString *errorMessage)
+{
+    clearRoadmap();
+    
+    m_roadmapFile.setFileName(fileName);
+    if (!m_roadmapFile.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = m_roadmapFile.errorString();
+        }
+        return false;
+    }
+    const qint64 size = m_roadmapFile.size();
+    const uchar *data = size > 0 ? m_roadmapFile.map(0, size) : nullptr;
+    std::string error;
+    if (!data || !m_roadmap.attach(data, size_t(size), &error)) {
+        if (errorMessage) {
+            *errorMessage = data ? QString::fromStdString(error) : m_roadmapFile.errorString();
+        }
+        clearRoadmap();
+        return false;
+    }
+    
+    // 路图只用于手臂关节
+    quint64 armMask = 0;
+    for (KinematicModel::ChainId arm : { KinematicModel::LeftArm, KinematicModel::RightArm }) {
+        for (const KinematicJoint &joint : m_kinematics.chain(arm).joints) {
+            armMask |= quint64(1) << joint.jointId;
+        }
+    }
+    for (int id : m_roadmap.jointIds()) {
+        if (!(armMask & (quint64(1) << id))) {
+            if (errorMessage) {
+                *errorMessage = QString("路图包含非手臂关节 %1").arg(id);
+            }
+            clearRoadmap();
+            return false;
+        }
+    }
+    qDebug() << "路图已加载:" << fileName << m_roadmap.nodeCount() << "个节点" << m_roadmap.edgeCount() << "条边";
+    return true;
+}
+
+void RobotController::clearRoadmap()
+{
+    m_roadmap.clear();
+    m_roadmapFile.close();  // 同时解除映射
+}
+
+const Roadmap &RobotController::roadmap() const
+{
+    return m_roadmap;
+}
+
+bool RobotController::loadReachabilityMap(const QString &fileName, QString *errorMessage)
+{
+    clearReachabilityMap();
+    
+    m_reachabilityFile.setFileName(fileName);
+    if (!m_reachabilityFile.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = m_reachabilityFile.errorString();
+        }
+        return false;
+    }
+    const qint64 size = m_reachabilityFile.size();
+    const uchar *data = size > 0 ? m_reachabilityFile.map(0, size) : nullptr;
+    std::string error;
+    if (!data || !m_reachabilityMap.attach(data, size_t(size), &error)) {
+        if (errorMessage) {
+            *errorMessage = data ? QString::fromStdString(error) : m_reachabilityFile.errorString();
+        }
+        clearReachabilityMap();
+        return false;
+    }
+    
+    const uint64_t stamp = ReachabilityMap::modelStamp(m_kinematics, m_jointState.minLimits(), m_jointState.maxLimits());
+    if (m_reachabilityMap.header().modelStamp != stamp) {
+        if (errorMessage) {
+            *errorMessage = "可达性图与当前机器人的运动学参数或关节限位不一致，请重新生成";
+        }
+        clearReachabilityMap();
+        return false;
+    }
+    qDebug() << "可达性图已加载:" << fileName << m_reachabilityMap.cellCount() << "个体素";
+    return true;
+}
+
+void RobotController::clearReachabilityMap()
+{
+    m_reachabilityMap.clear();
+    m_reachabilityFile.close();  // 同时解除映射
+}
+
+const ReachabilityMap &RobotController::reachabilityMap() const
+{
+    return m_reachabilityMap;
+}
+
+void RobotController::setTorqueFeedforward(bool enabled)
+{
+    if (enabled == m_torqueFeedforward) {
+        return;
+    }
+    m_torqueFeedforward = enabled;
+    
+    // 开启时立即按当前设定点下发重力补偿，运动中开启则补算当前轨迹的缓冲；关闭时力矩清零
+    const QVector<double> torques = enabled ? gravityTorques() : QVector<double>(jointCount(), 0.0);
+    if (enabled && isMoving()) {
+        renderFeedforward();
+    }
+    for (int i = 0; i < jointCount(); ++i) {
+        if (m_dynamicsMask & (quint64(1) << i)) {
+            setJointTorque(i, torques[i]);
+        }
+    }
+}
+
+bool RobotController::torqueFeedforward() const
+{
+    return m_torqueFeedforward;
+}
+
+QVector<double> RobotController::gravityTorques() const
+{
+    QVector<double> torques(jointCount(), 0.0);
+    if (!m_dynamics.isEmpty()) {
+        m_dynamics.gravityTorques(m_jointState.targets(), torques.data());
+    }
+    return torques;
+}
+
+const DynamicModel &RobotController::dynamicModel() const
+{
+    return m_dynamics;
+}
+
+void RobotController::renderFeedforward()
+{
+    m_feedforward.clear();
+    if (!m_torqueFeedforward || m_dynamics.isEmpty() || m_sequenceMode) {
+        return;
+    }
+    
+    // 速度、加速度取设定点的中心差分，起止点静止
+    const double *setpoints = m_timedMode ? m_timedPath.setpoints(0) : m_trajectory.setpoints(0);
+    const size_t samples = size_t(m_timedMode ? m_timedPath.sampleCount() : m_trajectory.sampleCount());
+    const size_t count = size_t(jointCount());
+    std::vector<double> velocities(samples * count, 0.0);
+    std::vector<double> accelerations(samples * count, 0.0);
+    for (size_t i = 1; i + 1 < samples; ++i) {
+        const double *previous = setpoints + (i - 1) * count;
+        const double *current = setpoints + i * count;
+        const double *next = setpoints + (i + 1) * count;
+        for (size_t j = 0; j < count; ++j) {
+            velocities[i * count + j] = 0.5 * (next[j] - previous[j]) * CONTROL_RATE_HZ;
+            accelerations[i * count + j] = (next[j] - 2.0 * current[j] + previous[j]) * CONTROL_RATE_HZ * CONTROL_RATE_HZ;
+        }
+    }
+    m_feedforward.assign(samples * count, 0.0);
+    m_dynamics.inverseDynamicsBatch(setpoints, velocities.data(), accelerations.data(), count, samples,
+                                    m_feedforward.data());
+}
+
+void RobotController::sendFeedforward(int sample)
+{
+    const size_t count = size_t(jointCount());
+    const double *torques = nullptr;
+    if (m_sequenceMode) {
+        // 序列直接用样条的一、二阶导数
+        double *q = m_feedforwardScratch.data();
+        double *dq = q + count;
+        double *ddq = dq + count;
+        double *tau = ddq + count;
+        m_sequence.evaluate(double(sample) / CONTROL_RATE_HZ, q, dq, ddq, &m_feedforwardSegment);
+        m_dynamics.inverseDynamics(q, dq, ddq, tau);
+        torques = tau;
+    } else if (!m_feedforward.empty()) {
+        const size_t row = std::min(size_t(sample), m_feedforward.size() / count - 1);
+        torques = m_feedforward.data() + row * count;
+    }
+    if (!torques) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (m_dynamicsMask & (quint64(1) << i)) {
+            setJointTorque(int(i), torques[i]);
+        }
+    }
+}
+
+bool RobotController::startCartesianJog(KinematicModel::ChainId arm, const QVector<double> &twist, bool toolFrame)
+{
+    const int index = arm == KinematicModel::RightArm ? 1 : 0;
+    if (twist.size() < 6 || !m_armIk[index].isConfigured() || m_robotStatus.emergencyStop) {
+        return false;
+    }
+    
+    // 点动与轨迹运动互斥：轨迹停在当前设定点
+    stopMotion();
+    std::copy(twist.constBegin(), twist.constBegin() + 6, m_jogTwist[index]);
+    m_jogToolFrame[index] = toolFrame;
+    m_jogActive[index] = true;
+    if (!m_jogTimer->isActive()) {
+        m_jogClock.start();
+        m_jogTimer->start();
+    }
+    return true;
+}
+
+void RobotController::stopCartesianJog()
+{
+    if (!m_jogTimer->isActive()) {
+        return;
+    }
+    m_jogTimer->stop();
+    for (int arm = 0; arm < 2; ++arm) {
+        m_jogActive[arm] = false;
+        m_jogResult[arm] = JogResult();
+    }
+    
+    // 速度清零，设定点同步到停下的位置，后续轨迹从这里出发
+    double *targets = m_jointState.targets();
+    const double *positions = m_jointState.positions();
+    for (int id = 0; id < jointCount(); ++id) {
+        if (m_jogMask & (quint64(1) << id)) {
+            setJointVelocity(id, 0.0);
+            targets[id] = positions[id];
+            m_journal.recordTarget(id, positions[id]);
+        }
+    }
+    m_jogMask = 0;
+}
+
+bool RobotController::isJogging() const
+{
+    return m_jogTimer->isActive();
+}
+
+JogResult RobotController::jogStatus(KinematicModel::ChainId arm) const
+{
+    return m_jogResult[arm == KinematicModel::RightArm ? 1 : 0];
 }
 
-RobotController::~RobotController()
+void RobotController::setWholeBodyJog(bool enabled)
 {
-    disconnectFromRobot();
+    if (enabled != m_jogWholeBody) {
+        stopCartesianJog();
+        m_jogWholeBody = enabled;
+    }
 }
 
-void RobotController::initializeJoints()
+bool RobotController::wholeBodyJog() const
 {
-    m_jointConfigs.clear();
+    return m_jogWholeBody;
+}
+
+void RobotController::streamCartesianJog()
+{
+    // 离线（仿真）时没有反馈，按实际经过时间积分关节位置；定时器停顿过久时不一次补完
+    const double dt = qMin(m_jogClock.nsecsElapsed() * 1e-9, 2.0 / CONTROL_RATE_HZ);
+    m_jogClock.restart();
     
-    // 左臂关节 (0-7)
-    for (int i = 0; i < 8; ++i) {
-        m_jointConfigs.append(JointConfig(i, QString("左臂关节%1").arg(i+1), -180.0, 180.0));
+    // 雅可比取自关节反馈，而不是设定点
+    double *targets = m_jointState.targets();
+    double *positions = m_jointState.positions();
+    if (m_jogWholeBody && m_wholeBody.isConfigured()) {
+        // 全身：躯干和两臂一起分解，没有点动的手臂保持末端不动
+        WholeBodyTask tasks[2];
+        for (int arm = 0; arm < 2; ++arm) {
+            tasks[arm].active = m_armIk[arm].isConfigured();
+            tasks[arm].toolFrame = m_jogToolFrame[arm];
+            if (m_jogActive[arm]) {
+                std::copy(m_jogTwist[arm], m_jogTwist[arm] + 6, tasks[arm].twist);
+            }
+        }
+        const WholeBodyResult result = m_wholeBody.velocities(positions, tasks, m_jogSpeedLimits.data(),
+                                                              m_jogVelocities.data());
+        for (int arm = 0; arm < 2; ++arm) {
+            m_jogResult[arm].scale = result.scale;
+            m_jogResult[arm].manipulability = result.manipulability[arm];
+            m_jogResult[arm].limited = result.limited;
+        }
+        for (int c = 0; c < m_wholeBody.jointCount(); ++c) {
+            m_jogMask |= quint64(1) << m_wholeBody.jointId(c);
+        }
+    } else {
+        for (int arm = 0; arm < 2; ++arm) {
+            if (!m_jogActive[arm]) {
+                continue;
+            }
+            m_jogResult[arm] = m_armIk[arm].jogVelocities(positions, m_jogTwist[arm], m_jogToolFrame[arm],
+                                                          m_jogSpeedLimits.data(), m_jogVelocities.data());
+            const KinematicModel::ChainId chain = arm == 0 ? KinematicModel::LeftArm : KinematicModel::RightArm;
+            for (const KinematicJoint &joint : m_kinematics.chain(chain).joints) {
+                m_jogMask |= quint64(1) << joint.jointId;
+            }
+        }
     }
+    const quint64 jogMask = m_jogMask & m_jointState.jointMask();
     
-    // 右臂关节 (8-15)
-    for (int i = 8; i < 16; ++i) {
-        m_jointConfigs.append(JointConfig(i, QString("右臂关节%1").arg(i-7), -180.0, 180.0));
+    // 按两个周期后的预测位置做自碰撞检查，下一次检查之前不会越过停止距离
+    std::copy(positions, positions + jointCount(), m_collisionCandidate.begin());
+    for (int id = 0; id < jointCount(); ++id) {
+        if (jogMask & (quint64(1) << id)) {
+            m_collisionCandidate[size_t(id)] += m_jogVelocities[size_t(id)] * 2.0 / CONTROL_RATE_HZ;
+        }
     }
-    
-    // 腰部关节 (16-17)
-    for (int i = 16; i < 18; ++i) {
-        m_jointConfigs.append(JointConfig(i, QString("腰部关节%1").arg(i-15), -90.0, 90.0));
+    if (!admitSetpoints(m_collisionCandidate.data())) {
+        stopCartesianJog();
+        return;
     }
     
-    // 底盘电机 (18-19)
-    for (int i = 18; i < 20; ++i) {
-        m_jointConfigs.append(JointConfig(i, QString("底盘电机%1").arg(i-17), -1000.0, 1000.0));
+    for (int id = 0; id < jointCount(); ++id) {
+        if (!(jogMask & (quint64(1) << id))) {
+            continue;
+        }
+        setJointVelocity(id, m_jogVelocities[size_t(id)]);
+        if (!m_robotStatus.connected) {
+            positions[id] = m_jointState.clampToLimits(id, positions[id] + m_jogVelocities[size_t(id)] * dt);
+            targets[id] = positions[id];
+            emit jointPositionChanged(id, positions[id]);
+        }
     }
-    
-    // 升降机构 (20)
-    m_jointConfigs.append(JointConfig(20, "升降机构", 0.0, 500.0));
 }
 
-bool RobotController::connectToRobot()
+bool RobotController::admitSetpoints(const double *candidate)
 {
-    if (m_robotStatus.connected) {
+    if (m_selfCollision.isEmpty() && m_environment.isEmpty()) {
         return true;
     }
     
-    bool success = false;
+    // 进入停止距离且仍在靠近时拒绝；已经过近时仍允许向远离的方向运动，操作员才能退出
+    const SelfCollisionResult result = m_selfCollision.check(candidate, SELF_COLLISION_RANGE);
+    if (result.minimumDistance < SELF_COLLISION_STOP_DISTANCE
+        && result.minimumDistance < m_selfCollisionStatus.minimumDistance) {
+        emit errorOccurred(QString("自碰撞保护：%1 距离 %2 mm，已拒绝设定点")
+            .arg(selfCollisionPairName(result)).arg(result.minimumDistance * 1000.0, 0, 'f', 1));
+        return false;
+    }
     
-    if (m_connectionType == "serial") {
-        if (!m_serialPort) {
-            m_serialPort = new QSerialPort(this);
-            connect(m_serialPort, &QSerialPort::readyRead, this, &RobotController::onSerialDataReceived);
-            connect(m_serialPort, QOverload<QSerialPort::SerialPortError>::of(&QSerialPort::errorOccurred),
-                    this, &RobotController::onConnectionError);
-        }
-        
-        if (!m_serialPort->isOpen()) {
-            success = m_serialPort->open(QIODevice::ReadWrite);
+    // 环境检查复用上面刚算出的胶囊端点
+    EnvironmentClearance clearance;
+    if (!m_environment.isEmpty()) {
+        clearance = m_environment.robotClearance(m_selfCollision, m_basePose, m_footprintRadius,
+                                                 m_footprintHeight, ENVIRONMENT_RANGE);
+        if (clearance.minimumDistance < ENVIRONMENT_STOP_DISTANCE
+            && clearance.minimumDistance < m_environmentStatus.minimumDistance) {
+            emit errorOccurred(QString("环境碰撞保护：%1 与环境距离 %2 mm，已拒绝设定点")
+                .arg(environmentPartName(clearance)).arg(clearance.minimumDistance * 1000.0, 0, 'f', 1));
+            return false;
         }
     }
-    else if (m_connectionType == "tcp") {
-        if (!m_tcpSocket) {
-            m_tcpSocket = new QTcpSocket(this);
-            connect(m_tcpSocket, &QTcpSocket::readyRead, this, &RobotController::onTcpDataReceived);
-            connect(m_tcpSocket, QOverload<QAbstractSocket::SocketError>::of(&QAbstractSocket::errorOccurred),
-                    this, &RobotController::onConnectionError);
-            connect(m_tcpSocket, &QTcpSocket::connected, [this]() {
-                m_robotStatus.connected = true;
-                emit connectionStatusChanged(true);
-                qDebug() << "TCP连接成功";
-            });
-        }
-        
-        if (m_tcpSocket->state() != QAbstractSocket::ConnectedState) {
-            m_tcpSocket->connectToHost(m_hostAddress, m_port);
-            success = m_tcpSocket->waitForConnected(3000);
-        } else {
-            success = true;
-        }
+    m_selfCollisionStatus = result;
+    m_environmentStatus = clearance;
+    return true;
+}
+
+QString RobotController::selfCollisionPairName(const SelfCollisionResult &result) const
+{
+    const std::vector<CollisionCapsule> &capsules = m_selfCollision.capsules();
+    if (result.capsuleA < 0 || result.capsuleB < 0) {
+        return QString();
     }
-    else if (m_connectionType == "udp") {
-        if (!m_udpSocket) {
-            m_udpSocket = new QUdpSocket(this);
-            connect(m_udpSocket, &QUdpSocket::readyRead, this, &RobotController::onUdpDataReceived);
-        }
-        
-        success = m_udpSocket->bind(QHostAddress::Any, m_port);
-        if (success) {
-            m_robotStatus.connected = true;
+    auto capsuleName = [this](const CollisionCapsule &capsule) {
+        const QString name = m_jointConfigs[capsule.jointId].name;
+        return capsule.tool ? name + "末端" : name;
+    };
+    return QString("%1 - %2").arg(capsuleName(capsules[size_t(result.capsuleA)]))
+                             .arg(capsuleName(capsules[size_t(result.capsuleB)]));
+}
+
+const SelfCollisionResult &RobotController::selfCollisionStatus() const
+{
+    return m_selfCollisionStatus;
+}
+
+bool RobotController::loadEnvironment(const QString &fileName, QString *errorMessage)
+{
+    EnvironmentModel environment;
+    if (!environment.loadFromFile(fileName, errorMessage)) {
+        return false;
+    }
+    m_environment = environment;
+    m_selfCollision.check(m_jointState.targets(), SELF_COLLISION_RANGE);
+    m_environmentStatus = m_environment.robotClearance(m_selfCollision, m_basePose, m_footprintRadius,
+                                                       m_footprintHeight, ENVIRONMENT_RANGE);
+    return true;
+}
+
+void RobotController::clearEnvironment()
+{
+    m_environment.clear();
+    m_environmentStatus = EnvironmentClearance();
+}
+
+const EnvironmentModel &RobotController::environment() const
+{
+    return m_environment;
+}
+
+const EnvironmentClearance &RobotController::environmentStatus() const
+{
+    return m_environmentStatus;
+}
+
+QString RobotController::environmentPartName(const EnvironmentClearance &clearance) const
+{
+    if (clearance.chassis) {
+        return "底盘";
+    }
+    if (clearance.capsule < 0) {
+        return QString();
+    }
+    const CollisionCapsule &capsule = m_selfCollision.capsules()[size_t(clearance.capsule)];
+    const QString name = m_jointConfigs[capsule.jointId].name;
+    return capsule.tool ? name + "末端" : name;
+}
+
+void RobotController::setBasePose(const Transform &pose)
+{
+    // 里程计从给定位姿重新开始积分
+    double values[6];
+    pose.toXyzRpy(values);
+    m_drive.resetOdometry(PlanarPose(values[0], values[1], values[5]));
+    updateBasePose(pose);
+}
+
+void RobotController::updateBasePose(const Transform &pose)
+{
+    m_basePose = pose;
+    // 世界坐标系竖直向下的重力换算到底座坐标系：g_base = R^T * (0, 0, -g)
+    const double gravity[3] = { -9.81 * pose.r[6], -9.81 * pose.r[7], -9.81 * pose.r[8] };
+    m_dynamics.setGravity(gravity);
+    if (!m_environment.isEmpty()) {
+        m_selfCollision.check(m_jointState.targets(), SELF_COLLISION_RANGE);
+        m_environmentStatus = m_environment.robotClearance(m_selfCollision, m_basePose, m_footprintRadius,
+                                                           m_footprintHeight, ENVIRONMENT_RANGE);
+    }
+}
+
+const Transform &RobotController::basePose() const
+{
+    return m_basePose;
+}
+
+bool RobotController::setBaseVelocity(double linear, double angular)
+{
+    if (m_leftWheel < 0 || m_robotStatus.emergencyStop) {
+        return false;
+    }
+    
+    // 轮速此后由底盘定时器下发，不再由轨迹驱动；日志中的目标记为停止，异常退出后不会恢复转速
+    if (!m_chassisTimer->isActive()) {
+        m_streamMask &= ~((quint64(1) << m_leftWheel) | (quint64(1) << m_rightWheel));
+        m_journal.recordTarget(m_leftWheel, 0.0);
+        m_journal.recordTarget(m_rightWheel, 0.0);
+        m_chassisClock.start();
+        m_chassisTimer->start();
+    }
+    m_drive.setCommand(linear, angular);
+    return true;
+}
+
+void RobotController::stopBase()
+{
+    m_drive.stop();
+}
+
+bool RobotController::isBaseMoving() const
+{
+    return m_chassisTimer->isActive();
+}
+
+const DifferentialDrive &RobotController::drive() const
+{
+    return m_drive;
+}
+
+void RobotController::streamChassis()
+{
+    const double dt = qMin(m_chassisClock.nsecsElapsed() * 1e-9, 2.0 / CONTROL_RATE_HZ);
+    m_chassisClock.restart();
+    
+    // 按当前速度减速到零所需的时间（再加两个周期）外推底盘位姿，会进入停止距离且仍在靠近时减速停下
+    if (!m_environment.isEmpty() && (m_drive.commandedLinear() != 0.0 || m_drive.commandedAngular() != 0.0)) {
+        double linear = 0.0;
+        double angular = 0.0;
+        m_drive.bodyVelocity(m_drive.outputLeft(), m_drive.outputRight(), &linear, &angular);
+        const double horizon = qMax(std::fabs(linear) / m_drive.maxLinearAcceleration(),
+                                    std::fabs(angular) / m_drive.maxAngularAcceleration())
+            + 2.0 / CONTROL_RATE_HZ;
+        const PlanarPose current = m_drive.pose();
+        const PlanarPose predicted = DifferentialDrive::predict(current, m_drive.commandedLinear(),
+                                                                m_drive.commandedAngular(), horizon);
+        double values[6];
+        m_basePose.toXyzRpy(values);
+        const Transform pose = Transform::fromXyzRpy(predicted.x, predicted.y, values[2], values[3], values[4],
+                                                     predicted.heading);
+        m_selfCollision.check(m_jointState.targets(), SELF_COLLISION_RANGE);
+        const EnvironmentClearance clearance = m_environment.robotClearance(m_selfCollision, pose, m_footprintRadius,
+                                                                            m_footprintHeight, ENVIRONMENT_RANGE);
+        if (clearance.minimumDistance < ENVIRONMENT_STOP_DISTANCE
+            && clearance.minimumDistance < m_environmentStatus.minimumDistance) {
+            m_drive.stop();
+            emit errorOccurred(QString("环境碰撞保护：%1 将与环境距离 %2 mm，底盘已减速停止")
+                .arg(environmentPartName(clearance)).arg(clearance.minimumDistance * 1000.0, 0, 'f', 1));
         }
     }
     
-    if (success && m_connectionType != "tcp") {
-        m_robotStatus.connected = true;
-        emit connectionStatusChanged(true);
+    double speeds[2];
+    m_drive.step(dt, &speeds[0], &speeds[1]);
+    double *targets = m_jointState.targets();
+    double *positions = m_jointState.positions();
+    const int wheels[2] = { m_leftWheel, m_rightWheel };
+    for (int k = 0; k < 2; ++k) {
+        const int id = wheels[k];
+        targets[id] = speeds[k];
+        if (m_robotStatus.connected) {
+            sendCommand(formatJointCommand(id, speeds[k], "position"));
+        } else {
+            positions[id] = speeds[k];
+        }
+        emit jointPositionChanged(id, speeds[k]);
     }
     
-    return success;
+    // 离线（仿真）时没有轮速反馈，按下发的轮速积分里程计
+    if (!m_robotStatus.connected) {
+        integrateOdometry(speeds[0], speeds[1], dt);
+    }
+    if (!m_drive.isActive()) {
+        m_chassisTimer->stop();
+    }
 }
 
-void RobotController::disconnectFromRobot()
+void RobotController::integrateOdometry(double left, double right, double dt)
 {
-    if (m_serialPort && m_serialPort->isOpen()) {
-        m_serialPort->close();
+    m_drive.integrate(left, right, dt);
+    if (m_drive.linearVelocity() == 0.0 && m_drive.angularVelocity() == 0.0) {
+        return;
     }
     
-    if (m_tcpSocket && m_tcpSocket->state() == QAbstractSocket::ConnectedState) {
-        m_tcpSocket->disconnectFromHost();
+    // 高度、横滚、俯仰保持原值，平面位姿取自里程计
+    const PlanarPose &planar = m_drive.pose();
+    double values[6];
+    m_basePose.toXyzRpy(values);
+    updateBasePose(Transform::fromXyzRpy(planar.x, planar.y, values[2], values[3], values[4], planar.heading));
+}
+
+void RobotController::stopMotion()
+{
+    if (!m_trajectoryTimer->isActive()) {
+        return;
     }
     
-    if (m_udpSocket) {
-        m_udpSocket->close();
+    // 停在当前设定点，日志中的目标随之更新
+    m_trajectoryTimer->stop();
+    const double *current = m_jointState.targets();
+    for (int i = 0; i < jointCount(); ++i) {
+        if (m_streamMask & (quint64(1) << i)) {
+            m_journal.recordTarget(i, current[i]);
+        }
+    }
+    m_streamMask = 0;
+    m_sequenceMode = false;
+    m_timedMode = false;
+}
+
+bool RobotController::isMoving() const
+{
+    return m_trajectoryTimer->isActive();
+}
+
+MotionProgress RobotController::motionProgress() const
+{
+    MotionProgress progress;
+    if (!isMoving()) {
+        return progress;
     }
     
-    m_robotStatus.connected = false;
-    emit connectionStatusChanged(false);
+    progress.active = true;
+    progress.duration = streamDuration();
+    progress.elapsed = qMin(m_trajectoryClock.nsecsElapsed() / 1e9, progress.duration);
+    progress.remaining = progress.duration - progress.elapsed;
+    progress.progress = progress.duration > 0.0 ? progress.elapsed / progress.duration : 1.0;
+    return progress;
 }
 
-bool RobotController::isConnected() const
+double RobotController::streamDuration() const
 {
-    return m_robotStatus.connected;
+    if (m_timedMode) {
+        return m_timedPath.duration();
+    }
+    return m_sequenceMode ? m_sequence.duration() : m_trajectory.duration();
 }
 
-void RobotController::setJointPosition(int jointId, double angle)
+void RobotController::streamTrajectory()
 {
-    if (jointId < 0 || jointId >= TOTAL_JOINTS) {
+    // 按真实经过时间取采样点，定时器迟到时直接跳到当前时刻
+    const int last = static_cast<int>(std::ceil(streamDuration() * CONTROL_RATE_HZ));
+    const int sample = qMin(last, static_cast<int>(m_trajectoryClock.nsecsElapsed() * CONTROL_RATE_HZ / 1000000000LL));
+    if (sample == m_streamSample) {
         return;
     }
+    m_streamSample = sample;
     
-    // 限制角度范围
-    const JointConfig &config = m_jointConfigs[jointId];
-    angle = qBound(config.minAngle, angle, config.maxAngle);
+    // 序列按采样时刻求样条，点到点运动和时间最优路径直接取预先算好的缓冲
+    const double *setpoints = nullptr;
+    if (m_timedMode) {
+        setpoints = m_timedPath.setpoints(qMin(sample, m_timedPath.sampleCount() - 1));
+    } else if (m_sequenceMode) {
+        m_sequence.evaluate(double(sample) / CONTROL_RATE_HZ, m_sequenceSetpoints.data(), &m_sequenceSegment);
+        setpoints = m_sequenceSetpoints.data();
+    } else {
+        setpoints = m_trajectory.setpoints(sample);
+    }
+    double *targets = m_jointState.targets();
+    double *positions = m_jointState.positions();
     
-    // 更新内部状态
-    m_jointConfigs[jointId].currentAngle = angle;
-    m_robotStatus.jointPositions[jointId] = angle;
+    // 下发前做自碰撞检查，拒绝时运动停在上一个设定点
+    for (int i = 0; i < jointCount(); ++i) {
+        m_collisionCandidate[size_t(i)] = (m_streamMask & (quint64(1) << i)) ? setpoints[i] : targets[i];
+    }
+    if (!admitSetpoints(m_collisionCandidate.data())) {
+        stopMotion();
+        return;
+    }
     
-    // 发送命令到机器人
-    if (m_robotStatus.connected) {
-        QString command = formatJointCommand(jointId, angle, "position");
-        sendCommand(command);
+    for (int i = 0; i < jointCount(); ++i) {
+        if (!(m_streamMask & (quint64(1) << i)) || targets[i] == setpoints[i]) {
+            continue;
+        }
+        
+        targets[i] = setpoints[i];
+        positions[i] = setpoints[i];
+        if (m_robotStatus.connected) {
+            sendCommand(formatJointCommand(i, setpoints[i], "position"));
+        }
+        emit jointPositionChanged(i, setpoints[i]);
+    }
+    if (m_torqueFeedforward) {
+        sendFeedforward(sample);
     }
     
-    emit jointPositionChanged(jointId, angle);
+    if (sample == last) {
+        m_trajectoryTimer->stop();
+        m_streamMask = 0;
+        m_sequenceMode = false;
+        m_timedMode = false;
+    }
 }
 
 void RobotController::setJointVelocity(int jointId, double velocity)
 {
-    if (jointId < 0 || jointId >= TOTAL_JOINTS) {
+    if (jointId < 0 || jointId >= jointCount()) {
         return;
     }
     
-    m_robotStatus.jointVelocities[jointId] = velocity;
+    m_jointState.velocities()[jointId] = velocity;
     
     if (m_robotStatus.connected) {
         QString command = formatJointCommand(jointId, velocity, "velocity");
@@ -181,11 +1478,11 @@ void RobotController::setJointVelocity(int jointId, double velocity)
 
 void RobotController::setJointTorque(int jointId, double torque)
 {
-    if (jointId < 0 || jointId >= TOTAL_JOINTS) {
+    if (jointId < 0 || jointId >= jointCount()) {
         return;
     }
     
-    m_robotStatus.jointTorques[jointId] = torque;
+    m_jointState.torques()[jointId] = torque;
     
     if (m_robotStatus.connected) {
         QString command = formatJointCommand(jointId, torque, "torque");
@@ -195,45 +1492,57 @@ void RobotController::setJointTorque(int jointId, double torque)
 
 double RobotController::getJointPosition(int jointId) const
 {
-    if (jointId < 0 || jointId >= TOTAL_JOINTS) {
+    if (jointId < 0 || jointId >= jointCount()) {
         return 0.0;
     }
     
-    return m_jointConfigs[jointId].currentAngle;
+    return m_jointState.positions()[jointId];
 }
 
 void RobotController::emergencyStop()
 {
     m_robotStatus.emergencyStop = true;
     
+    stopMotion();
+    stopCartesianJog();
+    
+    // 底盘不按加速度限制减速，轮速随下面的速度清零立即归零
+    m_drive.halt();
+    m_chassisTimer->stop();
+    
+    // 急停不等定时落盘
+    m_journal.recordEmergencyStop(true);
+    syncCommandJournal();
+    
     if (m_robotStatus.connected) {
         sendCommand("EMERGENCY_STOP");
     }
     
     // 停止所有关节运动
-    for (int i = 0; i < TOTAL_JOINTS; ++i) {
+    for (int i = 0; i < jointCount(); ++i) {
         setJointVelocity(i, 0.0);
     }
 }
 
 void RobotController::resetToZeroPosition()
 {
+    // RESET_ZERO 是协议中唯一解除机器人端急停锁存的命令；先发出再清除主机端标志，
+    // 否则机器人仍处于急停、忽略之后下发的设定点
+    if (m_robotStatus.connected) {
+        sendCommand("RESET_ZERO");
+    }
     if (m_robotStatus.emergencyStop) {
         m_robotStatus.emergencyStop = false;
+        m_journal.recordEmergencyStop(false);
     }
     
-    for (int i = 0; i < TOTAL_JOINTS; ++i) {
-        setJointPosition(i, 0.0);
-    }
-    
-    if (m_robotStatus.connected) {
-        sendCommand("RESET_ZERO");
-    }
+    // 由主机端轨迹平滑地回到零位
+    moveToPose(QVector<double>(jointCount(), 0.0));
 }
 
 void RobotController::enableAllJoints()
 {
-    for (int i = 0; i < TOTAL_JOINTS; ++i) {
+    for (int i = 0; i < jointCount(); ++i) {
         enableJoint(i);
     }
     
@@ -244,7 +1553,7 @@ void RobotController::enableAllJoints()
 
 void RobotController::disableAllJoints()
 {
-    for (int i = 0; i < TOTAL_JOINTS; ++i) {
+    for (int i = 0; i < jointCount(); ++i) {
         disableJoint(i);
     }
     
@@ -255,8 +1564,9 @@ void RobotController::disableAllJoints()
 
 void RobotController::enableJoint(int jointId)
 {
-    if (jointId >= 0 && jointId < TOTAL_JOINTS) {
-        m_jointConfigs[jointId].enabled = true;
+    if (jointId >= 0 && jointId < jointCount()) {
+        m_jointState.setEnabled(jointId, true);
+        m_journal.recordEnabled(jointId, true);
         
         if (m_robotStatus.connected) {
             sendCommand(QString("ENABLE_JOINT %1").arg(jointId));
@@ -266,8 +1576,9 @@ void RobotController::enableJoint(int jointId)
 
 void RobotController::disableJoint(int jointId)
 {
-    if (jointId >= 0 && jointId < TOTAL_JOINTS) {
-        m_jointConfigs[jointId].enabled = false;
+    if (jointId >= 0 && jointId < jointCount()) {
+        m_jointState.setEnabled(jointId, false);
+        m_journal.recordEnabled(jointId, false);
         
         if (m_robotStatus.connected) {
             sendCommand(QString("DISABLE_JOINT %1").arg(jointId));
@@ -277,17 +1588,164 @@ void RobotController::disableJoint(int jointId)
 
 RobotStatus RobotController::getRobotStatus() const
 {
-    return m_robotStatus;
+    return statusSnapshot();
 }
 
 JointConfig RobotController::getJointConfig(int jointId) const
 {
-    if (jointId >= 0 && jointId < TOTAL_JOINTS) {
-        return m_jointConfigs[jointId];
+    if (jointId >= 0 && jointId < jointCount()) {
+        JointConfig config = m_jointConfigs[jointId];
+        config.currentAngle = m_jointState.positions()[jointId];
+        config.enabled = m_jointState.isEnabled(jointId);
+        return config;
     }
     return JointConfig();
 }
 
+int RobotController::jointCount() const
+{
+    return m_jointState.jointCount();
+}
+
+double RobotController::batteryLevel() const
+{
+    return m_robotStatus.batteryLevel;
+}
+
+const RobotDescription &RobotController::robotDescription() const
+{
+    return m_description;
+}
+
+const KinematicModel &RobotController::kinematicModel() const
+{
+    return m_kinematics;
+}
+
+const JointStateStore &RobotController::jointState() const
+{
+    return m_jointState;
+}
+
+RobotChangeSet RobotController::takeChanges()
+{
+    // 与界面显示精度一致的变化阈值
+    static const double CHANGE_EPSILON = 0.01;
+    
+    RobotChangeSet changes;
+    changes.joints = m_jointState.takeChanges(CHANGE_EPSILON);
+    changes.status = m_forcedStatusChanges;
+    m_forcedStatusChanges = 0;
+    
+    if (m_robotStatus.connected != m_publishedStatus.connected) {
+        changes.status |= RobotChangeSet::ConnectionChanged;
+    }
+    if (m_robotStatus.emergencyStop != m_publishedStatus.emergencyStop) {
+        changes.status |= RobotChangeSet::EmergencyStopChanged;
+    }
+    if (qRound(m_robotStatus.batteryLevel) != qRound(m_publishedStatus.batteryLevel)) {
+        changes.status |= RobotChangeSet::BatteryChanged;
+    }
+    if (m_robotStatus.errorMessage != m_publishedStatus.errorMessage) {
+        changes.status |= RobotChangeSet::ErrorChanged;
+    }
+    
+    // 电量按整数百分比比较，只有报告变化时才更新快照
+    m_publishedStatus.connected = m_robotStatus.connected;
+    m_publishedStatus.emergencyStop = m_robotStatus.emergencyStop;
+    m_publishedStatus.errorMessage = m_robotStatus.errorMessage;
+    if (changes.status & RobotChangeSet::BatteryChanged) {
+        m_publishedStatus.batteryLevel = m_robotStatus.batteryLevel;
+    }
+    
+    return changes;
+}
+
+const TelemetryHistory &RobotController::telemetryHistory() const
+{
+    return m_telemetry;
+}
+
+void RobotController::setTelemetryMemoryBudget(size_t bytes)
+{
+    // 重新分配后历史清空；读者已取得的视图仍可安全读完，isValid() 返回 false
+    m_telemetry.configure(jointCount(), bytes);
+}
+
+bool RobotController::startSessionRecording(const QString &directory, QString *errorMessage)
+{
+    if (!m_recorder->startRecording(directory, SessionRecorder::DEFAULT_SEGMENT_BYTES, errorMessage)) {
+        return false;
+    }
+    
+    // 关节遥测同时归档到同一目录，失败时不影响会话记录
+    const QString fileName = QDir(directory).filePath(
+        QString("telemetry_%1.rtlm").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss")));
+    QString error;
+    if (!startTelemetryCapture(fileName, &error)) {
+        emit errorOccurred(error);
+    }
+    return true;
+}
+
+void RobotController::stopSessionRecording()
+{
+    m_recorder->stopRecording();
+    stopTelemetryCapture();
+}
+
+bool RobotController::isSessionRecording() const
+{
+    return m_recorder->isRecording();
+}
+
+void RobotController::recordOperatorAction(const QString &action)
+{
+    m_recorder->record(SessionRecordType::OperatorAction, action.toUtf8());
+}
+
+bool RobotController::startTelemetryCapture(const QString &fileName, QString *errorMessage)
+{
+    std::string error;
+    if (!m_telemetryFile.open(QFile::encodeName(fileName).toStdString(), jointCount(),
+                              TelemetryFileWriter::DEFAULT_BLOCK_SAMPLES, TELEMETRY_FRACTION_BITS, &error)) {
+        if (errorMessage) {
+            *errorMessage = QString::fromStdString(error);
+        }
+        return false;
+    }
+    
+    qDebug() << "遥测归档已开始:" << fileName;
+    return true;
+}
+
+void RobotController::stopTelemetryCapture()
+{
+    if (!m_telemetryFile.isOpen()) {
+        return;
+    }
+    
+    qDebug() << "遥测归档已停止，样本数:" << m_telemetryFile.sampleCount()
+             << "字节数:" << m_telemetryFile.bytesWritten();
+    m_telemetryFile.close();
+}
+
+bool RobotController::isTelemetryCapturing() const
+{
+    return m_telemetryFile.isOpen();
+}
+
+RobotStatus RobotController::statusSnapshot() const
+{
+    // 由热数据生成对外的状态快照
+    RobotStatus status = m_robotStatus;
+    const int count = m_jointState.jointCount();
+    status.jointPositions = QVector<double>(m_jointState.positions(), m_jointState.positions() + count);
+    status.jointVelocities = QVector<double>(m_jointState.velocities(), m_jointState.velocities() + count);
+    status.jointTorques = QVector<double>(m_jointState.torques(), m_jointState.torques() + count);
+    return status;
+}
+
 void RobotController::setConnectionType(const QString &type)
 {
     m_connectionType = type.toLower();
@@ -337,9 +1795,20 @@ void RobotController::updateRobotStatus()
         }
         
         m_robotStatus.batteryLevel = batteryLevel;
+        
+        // 记录指令与状态历史
+        const qint64 now = TelemetryHistory::nowNs();
+        m_telemetry.record(TelemetryChannel::CommandedPosition, now, m_jointState.targets());
+        m_telemetry.record(TelemetryChannel::Velocity, now, m_jointState.velocities());
+        m_telemetry.record(TelemetryChannel::Torque, now, m_jointState.torques());
+        m_telemetry.record(TelemetryChannel::Battery, now, &m_robotStatus.batteryLevel);
     }
     
-    emit robotStatusUpdated(m_robotStatus);
+    // 没有接收者时不生成快照，避免空闲时的无用拷贝
+    static const QMetaMethod statusSignal = QMetaMethod::fromSignal(&RobotController::robotStatusUpdated);
+    if (isSignalConnected(statusSignal)) {
+        emit robotStatusUpdated(statusSnapshot());
+    }
 }
 
 void RobotController::onSerialDataReceived()
@@ -384,6 +1853,7 @@ void RobotController::onConnectionError()
     emit errorOccurred(errorMsg);
     
     // 连接断开
+    m_recorder->record(SessionRecordType::ConnectionEvent, QString("error %1").arg(errorMsg).toUtf8());
     m_robotStatus.connected = false;
     emit connectionStatusChanged(false);
 }
@@ -391,6 +1861,7 @@ void RobotController::onConnectionError()
 void RobotController::sendCommand(const QString &command)
 {
     QByteArray data = command.toUtf8() + "\n";
+    m_recorder->record(SessionRecordType::Command, data);
     
     if (m_connectionType == "serial" && m_serialPort && m_serialPort->isOpen()) {
         m_serialPort->write(data);
@@ -402,14 +1873,25 @@ void RobotController::sendCommand(const QString &command)
         m_udpSocket->writeDatagram(data, QHostAddress(m_hostAddress), m_port);
     }
     
-    qDebug() << "发送命令:" << command;
+    qCDebug(robotProtocol) << "发送命令:" << command;
+}
+
+void RobotController::feedReplayData(const QByteArray &data)
+{
+    // 回放数据不经过传输层，也不写入会话记录
+    applyStatusData(data);
 }
 
 void RobotController::processReceivedData(const QByteArray &data)
 {
-    QString message = QString::fromUtf8(data).trimmed();
-    qDebug() << "接收数据:" << message;
+    m_recorder->record(SessionRecordType::Feedback, data);
+    qCDebug(robotProtocol) << "接收数据:" << QString::fromUtf8(data).trimmed();
     
+    applyStatusData(data);
+}
+
+void RobotController::applyStatusData(const QByteArray &data)
+{
     // 解析JSON格式的状态数据
     QJsonParseError error;
     QJsonDocument doc = QJsonDocument::fromJson(data, &error);
@@ -420,10 +1902,46 @@ void RobotController::processReceivedData(const QByteArray &data)
         // 更新关节位置
         if (obj.contains("joints")) {
             QJsonArray joints = obj["joints"].toArray();
-            for (int i = 0; i < joints.size() && i < TOTAL_JOINTS; ++i) {
-                double position = joints[i].toDouble();
-                m_robotStatus.jointPositions[i] = position;
-                m_jointConfigs[i].currentAngle = position;
+            double *positions = m_jointState.positions();
+            for (int i = 0; i < joints.size() && i < jointCount(); ++i) {
+                positions[i] = joints[i].toDouble();
+            }
+            m_telemetry.record(TelemetryChannel::MeasuredPosition, TelemetryHistory::nowNs(), positions);
+            
+            // 里程计：按反馈自带的时间戳积分，没有时按接收间隔；长时间没有反馈时不一次补完
+            if (m_leftWheel >= 0 && m_rightWheel < joints.size()) {
+                double dt = m_odometryClock.nsecsElapsed() * 1e-9;
+                m_odometryClock.restart();
+                if (obj.contains("timestamp")) {
+                    const double stamp = obj.value("timestamp").toDouble();
+                    dt = m_odometryStamp >= 0.0 ? (stamp - m_odometryStamp) * 1e-3 : 0.0;
+                    m_odometryStamp = stamp;
+                }
+                integrateOdometry(positions[m_leftWheel], positions[m_rightWheel], qBound(0.0, dt, 0.1));
+            }
+            
+            if (m_telemetryFile.isOpen()) {
+                // 优先使用数据自带的时间戳（毫秒），回放转存时保留原始时间轴
+                const qint64 timestampUs = obj.contains("timestamp")
+                    ? static_cast<qint64>(obj.value("timestamp").toDouble() * 1000.0)
+                    : QDateTime::currentMSecsSinceEpoch() * 1000;
+                m_telemetryFile.append(timestampUs, positions, m_jointState.velocities(), m_jointState.torques(),
+                                       m_jointState.targets());
+            }
+            
+            // 反馈超出限位时报警（仅在超限关节集合变化时上报）
+            const quint64 violations = m_jointState.limitViolationMask();
+            if (violations != m_limitViolations) {
+                m_limitViolations = violations;
+                if (violations) {
+                    QStringList names;
+                    for (int i = 0; i < jointCount(); ++i) {
+                        if (violations & (quint64(1) << i)) {
+                            names << m_jointConfigs[i].name;
+                        }
+                    }
+                    emit errorOccurred(QString("关节超出限位: %1").arg(names.join(", ")));
+                }
             }
         }
         
@@ -7,8 +7,31 @@
 #include <QTcpSocket>
 #include <QUdpSocket>
 #include <QVector>
+#include <QElapsedTimer>
+#include <QFile>
 
-// 机器人关节配置
+#include "jointstatestore.h"
+#include "robotdescription.h"
+#include "telemetryhistory.h"
+#include "sessionrecorder.h"
+#include "telemetryfile.h"
+#include "commandjournal.h"
+#include "trajectory.h"
+#include "keyframesequence.h"
+#include "inversekinematics.h"
+#include "selfcollision.h"
+#include "environmentmodel.h"
+#include "motionplanner.h"
+#include "roadmap.h"
+#include "reachabilitymap.h"
+#include "pathtiming.h"
+#include "dynamics.h"
+#include "differentialdrive.h"
+#include "wholebodyik.h"
+
+// 机器人关节配置（描述性冷数据）
+// 每周期变化的位置、使能等热数据保存在 JointStateStore 中，
+// currentAngle 和 enabled 仅是 getJointConfig() 返回时填充的快照。
 struct JointConfig {
     int id;
     QString name;
@@ -16,14 +39,28 @@ struct JointConfig {
     double maxAngle;
     double currentAngle;
     bool enabled;
+    JointType type;
+    QString unit;
+    MotionLimits limits;    // 轨迹规划的速度、加速度、加加速度限制
     
     JointConfig(int jointId = 0, const QString &jointName = "", 
                 double min = -180.0, double max = 180.0)
         : id(jointId), name(jointName), minAngle(min), maxAngle(max)
-        , currentAngle(0.0), enabled(false) {}
+        , currentAngle(0.0), enabled(false), type(JointType::Revolute), unit("deg") {}
 };
 
-// 机器人状态
+// 轨迹运动进度（秒）
+struct MotionProgress {
+    bool active;
+    double elapsed;
+    double duration;
+    double remaining;
+    double progress;        // 0 ~ 1
+    
+    MotionProgress() : active(false), elapsed(0.0), duration(0.0), remaining(0.0), progress(0.0) {}
+};
+
+// 机器人状态（对外快照，关节数据由 JointStateStore 生成）
 struct RobotStatus {
     bool connected;
     bool emergencyStop;
@@ -36,6 +73,23 @@ struct RobotStatus {
     RobotStatus() : connected(false), emergencyStop(false), batteryLevel(0.0) {}
 };
 
+// 自上次读取以来的状态变化（关节按字段的位掩码 + 整机状态标志）
+struct RobotChangeSet {
+    enum StatusFlag {
+        ConnectionChanged    = 0x01,
+        EmergencyStopChanged = 0x02,
+        BatteryChanged       = 0x04,
+        ErrorChanged         = 0x08,
+        AllStatusChanged     = 0x0F
+    };
+    
+    JointStateStore::ChangeSet joints;
+    quint32 status;
+    
+    RobotChangeSet() : status(0) {}
+    bool isEmpty() const { return status == 0 && joints.isEmpty(); }
+};
+
 class RobotController : public QObject
 {
     Q_OBJECT
@@ -55,6 +109,86 @@ public:
     void setJointTorque(int jointId, double torque);
     double getJointPosition(int jointId) const;
     
+    // 轨迹运动：按关节限制规划S曲线，以控制频率从预先算好的缓冲下发设定点。
+    // 运动中再次下发时从当前设定点重新规划，未被改变目标的运动关节继续驶向原目标。
+    bool moveJointTo(int jointId, double target);
+    bool moveJointsTo(const QVector<double> &targets, quint64 jointMask);
+    // 整体位姿运动：由最受限的关节决定时长，所有关节同时起止，沿关节空间直线运动
+    bool moveToPose(const QVector<double> &pose, quint64 jointMask = ~quint64(0));
+    // 关键帧序列：从当前设定点出发依次经过各位姿，样条系数预先算好，每个控制周期求值下发
+    bool playSequence(const std::vector<Keyframe> &keyframes, KeyframeSequence::Interpolation interpolation,
+                      QString *errorMessage = nullptr);
+    // 时间最优播放：关键帧的五次样条只作为几何路径，按关节速度、加速度限制（设置了力矩约束时还有力矩）
+    // 求最快的时间参数化，设定点缓冲预先算好后按控制频率下发。关键帧的时间只决定路径形状
+    bool playTimeOptimal(const std::vector<Keyframe> &keyframes, QString *errorMessage = nullptr);
+    void setTorqueConstraint(const PathTorqueConstraint &constraint);   // 空约束为不限力矩
+    // 末端位姿运动：以当前设定点为初值求手臂逆解，收敛后按整体位姿运动驶向解（只动该臂关节）
+    Transform armPose(KinematicModel::ChainId arm) const;     // 当前设定点对应的末端位姿
+    IkResult solveArmIk(KinematicModel::ChainId arm, const Transform &target, QVector<double> *solution) const;
+    bool moveArmTo(KinematicModel::ChainId arm, const Transform &target, IkResult *result = nullptr,
+                   QVector<double> *solution = nullptr);
+    // 全身逆解：升降、腰部和两臂一起求解，够不到时由躯干延伸；另一臂的末端保持当前位姿，
+    // 关节居中和可操作度在零空间内优化。收敛后按整体位姿运动驶向解（躯干和两臂关节）
+    IkResult solveWholeBodyIk(KinematicModel::ChainId arm, const Transform &target, QVector<double> *solution) const;
+    bool moveWholeBodyTo(KinematicModel::ChainId arm, const Transform &target, IkResult *result = nullptr,
+                         QVector<double> *solution = nullptr);
+    // 笛卡尔点动：每个控制周期按关节反馈求雅可比，把末端速度旋量（m/s、rad/s）映射为关节速度下发。
+    // 以 setJointVelocity 下发，直到 stopCartesianJog；开始轨迹运动或急停时自动停止
+    bool startCartesianJog(KinematicModel::ChainId arm, const QVector<double> &twist, bool toolFrame = false);
+    void stopCartesianJog();
+    bool isJogging() const;
+    JogResult jogStatus(KinematicModel::ChainId arm) const;  // 上一周期的速度比例和可操作度
+    // 全身点动：升降、腰部参与末端速度分解，另一臂末端保持不动；切换时停止正在进行的点动
+    void setWholeBodyJog(bool enabled);
+    bool wholeBodyJog() const;
+    void stopMotion();
+    bool isMoving() const;
+    
+    // 自碰撞：每个下发的设定点都先检查，进入停止距离且仍在靠近时拒绝并报告错误。
+    // 状态为最近一次通过检查的设定点，距离超出检测范围时报告为检测范围
+    const SelfCollisionResult &selfCollisionStatus() const;
+    QString selfCollisionPairName(const SelfCollisionResult &result) const;  // 如"左臂关节5 - 右臂关节8末端"
+    
+    // 环境碰撞：加载环境模型后，每个设定点同样检查连杆和底盘与环境的间隙，规则与自碰撞相同。
+    // 启动时按 EnvironmentModel::loadDefault 查找环境描述，没有时不检查
+    bool loadEnvironment(const QString &fileName, QString *errorMessage = nullptr);
+    void clearEnvironment();
+    const EnvironmentModel &environment() const;
+    const EnvironmentClearance &environmentStatus() const;
+    QString environmentPartName(const EnvironmentClearance &clearance) const;   // 如"左臂关节5"、"底盘"
+    // 底座在世界坐标系（环境描述的坐标系）中的位姿，默认为原点
+    void setBasePose(const Transform &pose);
+    const Transform &basePose() const;
+    // 避障运动：在 jointMask 选中的手臂关节上用 RRT-Connect 规划绕开自身和环境的路径，
+    // 路径点作为五次关键帧播放；平滑后的曲线在某段不满足间隙时在该段插入中点重新拟合
+    bool moveToPoseCollisionFree(const QVector<double> &pose, quint64 jointMask, PlanResult *result = nullptr,
+                                 QString *errorMessage = nullptr);
+    // 路图：robot_tool build-roadmap 离线构建，映射到内存使用。规划关节与路图一致时避障运动先查询路图，
+    // 起止点连不上路图时再用 RRT-Connect。环境、底座位姿等变化后路图的边在查询时惰性重新检查
+    bool loadRoadmap(const QString &fileName, QString *errorMessage = nullptr);
+    void clearRoadmap();
+    const Roadmap &roadmap() const;
+    // 可达性图：robot_tool build-reachability 离线构建，映射到内存使用（机器人基坐标系）。
+    // 运动学参数或关节限位与构建时不同时拒绝加载
+    bool loadReachabilityMap(const QString &fileName, QString *errorMessage = nullptr);
+    void clearReachabilityMap();
+    const ReachabilityMap &reachabilityMap() const;
+    // 逆动力学：连杆惯性参数来自描述文件，重力方向随底座位姿换算。开启力矩前馈后，轨迹运动的每个
+    // 设定点同时下发该点的关节力矩（重力补偿 + 惯性力）：缓冲轨迹在启动时按设定点差分批量算好，
+    // 关键帧序列每周期由样条导数计算。描述文件给出力矩限制时，时间最优轨迹同时满足力矩限制
+    void setTorqueFeedforward(bool enabled);
+    bool torqueFeedforward() const;
+    QVector<double> gravityTorques() const;     // 当前设定点的重力补偿力矩，非运动学关节为 0
+    const DynamicModel &dynamicModel() const;
+    // 底盘：底盘组的前两个电机按差速驱动处理。轮速反馈（离线时为下发的轮速）按圆弧积分为里程计，
+    // 积分结果即底座位姿。本体速度指令在每个控制周期按轮加速度限制换算为轮速下发，急停时立即清零；
+    // 加载环境模型时按制动距离预测底盘位姿，会进入停止距离时减速停下并报告错误
+    bool setBaseVelocity(double linear, double angular);   // m/s、rad/s（逆时针为正）
+    void stopBase();                                        // 按加速度限制减速到零
+    bool isBaseMoving() const;
+    const DifferentialDrive &drive() const;                 // 轮速换算与里程计
+    MotionProgress motionProgress() const;
+    
     // 机器人控制
     void emergencyStop();
     void resetToZeroPosition();
@@ -66,9 +200,41 @@ public:
     // 状态获取
     RobotStatus getRobotStatus() const;
     JointConfig getJointConfig(int jointId) const;
+    int jointCount() const;
+    double batteryLevel() const;
+    const RobotDescription &robotDescription() const;
+    const KinematicModel &kinematicModel() const;
+    const JointStateStore &jointState() const;
+    
+    // 变更读取：返回自上次调用以来变化的字段并清零（供界面按需刷新）
+    RobotChangeSet takeChanges();
+    
+    // 遥测历史（绘图、分析、故障回溯）
+    const TelemetryHistory &telemetryHistory() const;
+    void setTelemetryMemoryBudget(size_t bytes);
+    
+    // 会话记录（命令、反馈、连接事件、操作员操作）
+    bool startSessionRecording(const QString &directory, QString *errorMessage = nullptr);
+    void stopSessionRecording();
+    bool isSessionRecording() const;
+    void recordOperatorAction(const QString &action);
+    
+    // 遥测归档：关节反馈按列压缩写入 .rtlm 文件（会话记录开始时自动在同一目录下创建）
+    bool startTelemetryCapture(const QString &fileName, QString *errorMessage = nullptr);
+    void stopTelemetryCapture();
+    bool isTelemetryCapturing() const;
+    
+    // 指令日志：启动时从上次异常退出留下的日志恢复的目标位置、使能和急停状态
+    bool hasRecoveredCommandState() const;
+    const CommandJournalState &recoveredCommandState() const;
+    void resyncRecoveredState();        // 把恢复的指令状态重新下发给机器人
+    void discardRecoveredState();
+    
+    // 回放：把一行状态数据当作机器人反馈处理
+    void feedReplayData(const QByteArray &data);
     
     // 配置
-    void setConnectionType(const QString &type); // "serial", "tcp", "udp"
+    void setConnectionType(const QString &type); // "serial", "tcp", "udp", "replay"
     void setSerialPort(const QString &portName, int baudRate = 115200);
     void setTcpConnection(const QString &host, int port);
     void setUdpConnection(const QString &host, int port);
@@ -85,13 +251,39 @@ private slots:
     void onTcpDataReceived();
     void onUdpDataReceived();
     void onConnectionError();
+    void syncCommandJournal();
+    void streamTrajectory();
+    void streamCartesianJog();
+    void streamChassis();
 
 private:
     void initializeJoints();
+    bool admitSetpoints(const double *candidate);   // 自碰撞和环境碰撞检查，通过时更新状态
+    void openCommandJournal();
+    bool startTrajectory(const QVector<double> &targets, quint64 jointMask, bool synchronized);
+    std::vector<Keyframe> sequenceFrames(const std::vector<Keyframe> &keyframes) const;
+    bool startTimedPath(const KeyframeSequence &path, QString *errorMessage);
+    double streamDuration() const;
+    void renderFeedforward();
+    void sendFeedforward(int sample);
+    void updateBasePose(const Transform &pose);     // 重力方向和环境间隙随底座位姿更新
+    void integrateOdometry(double left, double right, double dt);
+    RobotStatus statusSnapshot() const;
     void sendCommand(const QString &command);
     void processReceivedData(const QByteArray &data);
+    void applyStatusData(const QByteArray &data);
     QString formatJointCommand(int jointId, double value, const QString &type = "position");
     
+    static const int TELEMETRY_FRACTION_BITS = 10;  // 归档量化精度 2^-10（约0.001）
+    static const int CONTROL_RATE_HZ = 100;         // 轨迹设定点下发频率
+    static constexpr double SELF_COLLISION_STOP_DISTANCE = 0.01;  // 米，低于该距离的靠近设定点被拒绝
+    static constexpr double SELF_COLLISION_RANGE = 0.10;          // 米，更远的组合在包围盒层剔除
+    static constexpr double ENVIRONMENT_STOP_DISTANCE = 0.02;     // 米，含体素插值误差的余量
+    static constexpr double ENVIRONMENT_RANGE = 0.15;             // 米，更远的胶囊只查询中点
+    static constexpr double PLANNER_CLEARANCE = 0.03;             // 米，规划路径与自身、环境的最小间隙
+    static constexpr double PLANNER_TIME_BUDGET = 1.0;            // 秒
+    static const int PLANNER_REFINE_ROUNDS = 5;                   // 平滑曲线检查不通过时插入中点的轮数
+    
     // 连接相关
     QString m_connectionType;
     QSerialPort *m_serialPort;
@@ -101,12 +293,73 @@ private:
     int m_port;
     
     // 机器人状态
-    RobotStatus m_robotStatus;
-    QVector<JointConfig> m_jointConfigs;
+    RobotDescription m_description;     // 关节拓扑（启动时从描述文件加载）
+    KinematicModel m_kinematics;        // 由描述中的运动学参数生成
+    ArmIkSolver m_armIk[2];             // 左、右臂逆解（限位在 initializeJoints 中同步）
+    RobotStatus m_robotStatus;          // 连接、急停、电量等整机状态
+    JointStateStore m_jointState;       // 关节热数据
+    QVector<JointConfig> m_jointConfigs; // 关节名称与描述
+    quint64 m_limitViolations;          // 上次上报的超限关节掩码
+    RobotStatus m_publishedStatus;      // 上次 takeChanges() 时的整机状态
+    quint32 m_forcedStatusChanges;
+    TelemetryHistory m_telemetry;       // 各通道遥测历史
+    SessionRecorder *m_recorder;        // 会话记录器
+    TelemetryFileWriter m_telemetryFile; // 压缩遥测归档
+    CommandJournal m_journal;           // 指令预写日志
+    CommandJournalState m_recoveredState; // 启动时恢复、尚未处理的指令状态
+    bool m_journalHealthy;              // 上次落盘是否成功（失败只报告一次）
+    QTimer *m_journalTimer;
+    QVector<MotionLimits> m_motionLimits; // 各关节轨迹限制
+    JointTrajectory m_trajectory;       // 当前轨迹及其设定点缓冲
+    quint64 m_streamMask;               // 仍由轨迹驱动的关节
+    int m_streamSample;                 // 上次下发的采样点
+    KeyframeSequence m_sequence;        // 正在播放的关键帧序列
+    bool m_sequenceMode;                // 当前运动来自序列而不是 m_trajectory
+    int m_sequenceSegment;
+    std::vector<double> m_sequenceSetpoints;
+    PathTiming m_timedPath;             // 时间最优参数化后的路径及其设定点缓冲
+    bool m_timedMode;                   // 当前运动来自 m_timedPath
+    PathTorqueConstraint m_torqueConstraint;
+    QElapsedTimer m_trajectoryClock;
+    QTimer *m_trajectoryTimer;
+    bool m_jogActive[2];                // 左、右臂是否在点动
+    bool m_jogToolFrame[2];
+    double m_jogTwist[2][6];
+    JogResult m_jogResult[2];
+    quint64 m_jogMask;                  // 本次点动下发过速度的关节
+    bool m_jogWholeBody;                // 点动时躯干参与分解
+    WholeBodySolver m_wholeBody;        // 全身逆解（限位在 initializeJoints 中同步）
+    std::vector<double> m_jogSpeedLimits; // 各关节最大速度（与 m_motionLimits 一致）
+    std::vector<double> m_jogVelocities;
+    SelfCollisionModel m_selfCollision; // 连杆胶囊模型（半径来自描述文件）
+    SelfCollisionResult m_selfCollisionStatus;
+    std::vector<double> m_collisionCandidate; // 待检查的设定点
+    EnvironmentModel m_environment;     // 静态环境距离场
+    EnvironmentClearance m_environmentStatus;
+    Transform m_basePose;               // 底座在世界坐标系中的位姿
+    double m_footprintRadius;           // 底盘外形（来自描述文件的底盘组）
+    double m_footprintHeight;
+    MotionPlanner m_planner;            // 避障规划（每次规划前按当前环境和底座位姿配置）
+    QFile m_roadmapFile;                // 映射中的路图文件
+    Roadmap m_roadmap;
+    QFile m_reachabilityFile;           // 映射中的可达性图文件
+    ReachabilityMap m_reachabilityMap;
+    DynamicModel m_dynamics;            // 逆动力学（惯性参数来自描述文件）
+    quint64 m_dynamicsMask;             // 参与逆动力学的关节
+    bool m_torqueFeedforward;           // 轨迹运动时同时下发前馈力矩
+    std::vector<double> m_feedforward;  // 缓冲轨迹各采样点的前馈力矩（与设定点缓冲同布局）
+    std::vector<double> m_feedforwardScratch;
+    int m_feedforwardSegment;
+    QElapsedTimer m_jogClock;           // 离线时按实际周期积分关节位置
+    QTimer *m_jogTimer;
+    DifferentialDrive m_drive;          // 底盘差速驱动（几何来自描述文件的底盘组）
+    int m_leftWheel;                    // 左、右轮电机的关节ID，没有底盘时为 -1
+    int m_rightWheel;
+    double m_odometryStamp;             // 上一帧轮速反馈的时间戳（毫秒），反馈不带时间戳时为 -1
+    QElapsedTimer m_odometryClock;
+    QElapsedTimer m_chassisClock;
+    QTimer *m_chassisTimer;
     QTimer *m_statusTimer;
-    
-    // 常量
-    static const int TOTAL_JOINTS = 21; // 左臂8 + 右臂8 + 腰部2 + 底盘2 + 升降1
 };
 
 #endif // ROBOTCONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,430 @@
+#include "robotdescription.h"
+#include "jointstatestore.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+// [x, y, z, roll, pitch, yaw]，长度为米，角度为度
+Transform poseFromValues(const double *values)
+{
+    return Transform::fromXyzRpy(values[0], values[1], values[2],
+                                 qDegreesToRadians(values[3]), qDegreesToRadians(values[4]),
+                                 qDegreesToRadians(values[5]));
+}
+
+// [a, alpha, d, theta]，长度为米，角度为度
+DhParameters dhFromValues(const double *values)
+{
+    return DhParameters(values[0], qDegreesToRadians(values[1]), values[2], qDegreesToRadians(values[3]));
+}
+
+// [质量, 质心 x, y, z, Ixx, Iyy, Izz] 或再加 [Ixy, Ixz, Iyz]，单位 kg、米、kg·m²
+LinkInertia inertiaFromValues(const double *values, int count)
+{
+    LinkInertia inertia;
+    inertia.mass = values[0];
+    std::copy(values + 1, values + 4, inertia.com);
+    std::copy(values + 4, values + count, inertia.inertia);
+    return inertia;
+}
+
+bool parseNumbers(const QJsonValue &value, int count, double *numbers)
+{
+    const QJsonArray array = value.toArray();
+    if (array.size() != count) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (!array[i].isDouble()) {
+            return false;
+        }
+        numbers[i] = array[i].toDouble();
+    }
+    return true;
+}
+
+// 关节值换算到弧度或米
+double kinematicScale(const JointDescription &joint)
+{
+    const QString unit = joint.unit.toLower();
+    if (joint.type == JointType::Prismatic) {
+        if (unit == "m") {
+            return 1.0;
+        }
+        return unit == "cm" ? 0.01 : 0.001;
+    }
+    return unit == "rad" ? 1.0 : qDegreesToRadians(1.0);
+}
+
+} // namespace
+
+RobotDescription::RobotDescription()
+{
+}
+
+RobotDescription RobotDescription::builtinDescription()
+{
+    // 内置布局就是编译进资源的 robot_description.json，参数只维护一份。
+    // 其中腰部末端转回 x 向前、z 向上的躯干坐标系，原点在两肩连线中点；两臂仅安装位姿左右镜像，
+    // 零位时两臂水平侧平举。惯性参数为按外形估计的值，实机应换成辨识结果。
+    RobotDescription description;
+    QString error;
+    if (!description.loadFromFile(":/robot_description.json", &error)) {
+        qCritical() << "内置机器人描述加载失败:" << error;
+    }
+    return description;
+}
+
+RobotDescription RobotDescription::loadDefault()
+{
+    // 查找顺序：环境变量 ROBOT_DESCRIPTION、程序目录、当前目录
+    QStringList candidates;
+    const QString envFile = qEnvironmentVariable("ROBOT_DESCRIPTION");
+    if (!envFile.isEmpty()) {
+        candidates << envFile;
+    }
+    if (QCoreApplication::instance()) {
+        candidates << QDir(QCoreApplication::applicationDirPath()).filePath("robot_description.json");
+    }
+    candidates << QDir::current().filePath("robot_description.json");
+
+    for (const QString &fileName : candidates) {
+        if (!QFileInfo::exists(fileName)) {
+            continue;
+        }
+
+        RobotDescription description;
+        QString error;
+        if (description.loadFromFile(fileName, &error)) {
+            qDebug() << "机器人描述已加载:" << fileName << description.jointCount() << "个关节";
+            return description;
+        }
+        qWarning() << "机器人描述加载失败:" << fileName << error;
+    }
+
+    return builtinDescription();
+}
+
+bool RobotDescription::loadFromFile(const QString &fileName, QString *errorMessage)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        if (errorMessage) {
+            *errorMessage = QString("JSON解析错误: %1").arg(parseError.errorString());
+        }
+        return false;
+    }
+
+    if (!loadFromJson(doc.object(), errorMessage)) {
+        return false;
+    }
+
+    m_sourceFile = fileName;
+    return true;
+}
+
+bool RobotDescription::loadFromJson(const QJsonObject &root, QString *errorMessage)
+{
+    auto fail = [errorMessage](const QString &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    RobotDescription description;
+    description.m_name = root.value("name").toString("未命名机器人");
+
+    const QJsonArray groups = root.value("groups").toArray();
+    if (groups.isEmpty()) {
+        return fail("缺少 groups 定义");
+    }
+
+    for (const QJsonValue &groupValue : groups) {
+        const QJsonObject groupObj = groupValue.toObject();
+
+        JointGroupDescription group;
+        group.name = groupObj.value("name").toString();
+        group.role = groupObj.value("role").toString();
+
+        // 组级默认值，可被单个关节覆盖
+        JointDescription defaults;
+        if (groupObj.contains("type") && !parseJointType(groupObj.value("type").toString(), &defaults.type)) {
+            return fail(QString("关节组 %1 的类型无效").arg(group.name));
+        }
+        defaults.unit = groupObj.value("unit").toString(defaults.unit);
+        defaults.minValue = groupObj.value("min").toDouble(defaults.minValue);
+        defaults.maxValue = groupObj.value("max").toDouble(defaults.maxValue);
+        defaults.maxVelocity = groupObj.value("maxVelocity").toDouble(defaults.maxVelocity);
+        defaults.maxAcceleration = groupObj.value("maxAcceleration").toDouble(defaults.maxAcceleration);
+        defaults.maxJerk = groupObj.value("maxJerk").toDouble(defaults.maxJerk);
+        defaults.maxTorque = groupObj.value("maxTorque").toDouble(defaults.maxTorque);
+
+        if (groupObj.contains("joints")) {
+            const QJsonArray joints = groupObj.value("joints").toArray();
+            for (int i = 0; i < joints.size(); ++i) {
+                const QJsonObject jointObj = joints[i].toObject();
+                JointDescription joint = defaults;
+                joint.name = jointObj.value("name").toString(QString("%1%2").arg(group.name).arg(i + 1));
+                if (jointObj.contains("type") && !parseJointType(jointObj.value("type").toString(), &joint.type)) {
+                    return fail(QString("关节 %1 的类型无效").arg(joint.name));
+                }
+                joint.unit = jointObj.value("unit").toString(joint.unit);
+                joint.minValue = jointObj.value("min").toDouble(joint.minValue);
+                joint.maxValue = jointObj.value("max").toDouble(joint.maxValue);
+                joint.maxVelocity = jointObj.value("maxVelocity").toDouble(joint.maxVelocity);
+                joint.maxAcceleration = jointObj.value("maxAcceleration").toDouble(joint.maxAcceleration);
+                joint.maxJerk = jointObj.value("maxJerk").toDouble(joint.maxJerk);
+                joint.maxTorque = jointObj.value("maxTorque").toDouble(joint.maxTorque);
+                group.joints.append(joint);
+            }
+        } else {
+            // 简写形式：count + namePattern
+            const int count = groupObj.value("count").toInt(0);
+            const QString pattern = groupObj.value("namePattern").toString(group.name + "%1");
+            for (int i = 0; i < count; ++i) {
+                JointDescription joint = defaults;
+                joint.name = pattern.contains("%1") ? pattern.arg(i + 1) : pattern;
+                group.joints.append(joint);
+            }
+        }
+
+        if (group.joints.isEmpty()) {
+            return fail(QString("关节组 %1 没有关节").arg(group.name));
+        }
+
+        // 底盘外形：{ "radius": 米, "height": 米 }
+        if (groupObj.contains("footprint")) {
+            const QJsonObject footprintObj = groupObj.value("footprint").toObject();
+            group.footprintRadius = footprintObj.value("radius").toDouble(0.0);
+            group.footprintHeight = footprintObj.value("height").toDouble(0.0);
+            if (group.footprintRadius < 0.0 || group.footprintHeight < 0.0) {
+                return fail(QString("关节组 %1 的底盘外形无效").arg(group.name));
+            }
+        }
+
+        // 差速驱动：{ "wheelRadius": 米, "trackWidth": 米, "gearRatio": 减速比, "directions": [左, 右] }
+        if (groupObj.contains("drive")) {
+            const QJsonObject driveObj = groupObj.value("drive").toObject();
+            group.drive.wheelRadius = driveObj.value("wheelRadius").toDouble(group.drive.wheelRadius);
+            group.drive.trackWidth = driveObj.value("trackWidth").toDouble(group.drive.trackWidth);
+            group.drive.gearRatio = driveObj.value("gearRatio").toDouble(group.drive.gearRatio);
+            if (driveObj.contains("directions")) {
+                const QJsonArray directions = driveObj.value("directions").toArray();
+                if (directions.size() != 2) {
+                    return fail(QString("关节组 %1 的电机方向需要 2 个数").arg(group.name));
+                }
+                group.drive.leftDirection = directions.at(0).toDouble(1.0);
+                group.drive.rightDirection = directions.at(1).toDouble(1.0);
+            }
+            if (group.joints.size() < 2 || !(group.drive.wheelRadius > 0.0) || !(group.drive.trackWidth > 0.0)
+                || !(group.drive.gearRatio > 0.0)
+                || std::fabs(std::fabs(group.drive.leftDirection) - 1.0) > 1e-9
+                || std::fabs(std::fabs(group.drive.rightDirection) - 1.0) > 1e-9) {
+                return fail(QString("关节组 %1 的差速驱动参数无效").arg(group.name));
+            }
+        }
+
+        // 运动学：{ "mount": [x,y,z,roll,pitch,yaw], "tool": [...], "dh": [[a,alpha,d,theta], ...],
+        //          "radius": 连杆胶囊半径, "inertia": [[质量,cx,cy,cz,Ixx,Iyy,Izz(,Ixy,Ixz,Iyz)], ...] }
+        if (groupObj.contains("kinematics")) {
+            const QJsonObject kinematicsObj = groupObj.value("kinematics").toObject();
+            double values[6];
+            group.hasKinematics = true;
+            if (kinematicsObj.contains("mount")) {
+                if (!parseNumbers(kinematicsObj.value("mount"), 6, values)) {
+                    return fail(QString("关节组 %1 的安装位姿无效").arg(group.name));
+                }
+                group.mount = poseFromValues(values);
+            }
+            if (kinematicsObj.contains("tool")) {
+                if (!parseNumbers(kinematicsObj.value("tool"), 6, values)) {
+                    return fail(QString("关节组 %1 的末端变换无效").arg(group.name));
+                }
+                group.tool = poseFromValues(values);
+            }
+            group.linkRadius = kinematicsObj.value("radius").toDouble(0.0);
+            if (group.linkRadius < 0.0) {
+                return fail(QString("关节组 %1 的连杆半径无效").arg(group.name));
+            }
+            const QJsonArray dh = kinematicsObj.value("dh").toArray();
+            if (dh.size() != group.joints.size()) {
+                return fail(QString("关节组 %1 的DH参数数量与关节数不一致").arg(group.name));
+            }
+            for (int i = 0; i < dh.size(); ++i) {
+                if (!parseNumbers(dh[i], 4, values)) {
+                    return fail(QString("关节 %1 的DH参数无效").arg(group.joints[i].name));
+                }
+                group.joints[i].dh = dhFromValues(values);
+            }
+            // 惯性参数可省略（按无质量处理）
+            if (kinematicsObj.contains("inertia")) {
+                const QJsonArray inertia = kinematicsObj.value("inertia").toArray();
+                if (inertia.size() != group.joints.size()) {
+                    return fail(QString("关节组 %1 的惯性参数数量与关节数不一致").arg(group.name));
+                }
+                for (int i = 0; i < inertia.size(); ++i) {
+                    double numbers[10];
+                    const int count = inertia[i].toArray().size() == 10 ? 10 : 7;
+                    if (!parseNumbers(inertia[i], count, numbers) || numbers[0] < 0.0
+                        || numbers[4] < 0.0 || numbers[5] < 0.0 || numbers[6] < 0.0) {
+                        return fail(QString("关节 %1 的惯性参数无效").arg(group.joints[i].name));
+                    }
+                    group.joints[i].inertia = inertiaFromValues(numbers, count);
+                }
+            }
+        }
+
+        for (const JointDescription &joint : group.joints) {
+            if (joint.minValue > joint.maxValue) {
+                return fail(QString("关节 %1 的限位无效").arg(joint.name));
+            }
+            if (!(joint.maxVelocity > 0.0) || !(joint.maxAcceleration > 0.0)) {
+                return fail(QString("关节 %1 的速度或加速度限制无效").arg(joint.name));
+            }
+        }
+
+        description.addGroup(group);
+    }
+
+    if (description.jointCount() > JointStateStore::MAX_JOINTS) {
+        return fail(QString("关节数量 %1 超过上限 %2")
+            .arg(description.jointCount()).arg(JointStateStore::MAX_JOINTS));
+    }
+
+    *this = description;
+    return true;
+}
+
+const JointGroupDescription *RobotDescription::findGroup(const QString &role) const
+{
+    for (const JointGroupDescription &group : m_groups) {
+        if (group.role == role) {
+            return &group;
+        }
+    }
+    return nullptr;
+}
+
+KinematicModel RobotDescription::kinematicModel() const
+{
+    KinematicModel model;
+
+    // 返回组内各关节组成的链，第一个关节前接 origin
+    auto groupChain = [this](const JointGroupDescription &group, const Transform &origin) {
+        KinematicChain chain;
+        for (int i = 0; i < group.joints.size(); ++i) {
+            const JointDescription &joint = group.joints[i];
+            KinematicJoint link;
+            link.jointId = group.firstJoint + i;
+            link.prismatic = joint.type == JointType::Prismatic;
+            link.scale = kinematicScale(joint);
+            link.dh = joint.dh;
+            if (i == 0) {
+                link.hasOrigin = true;
+                link.origin = origin;
+            }
+            chain.joints.push_back(link);
+        }
+        chain.tool = group.tool;
+        return chain;
+    };
+
+    // 躯干：升降 → 腰部，前一组的末端变换并入后一组的安装位姿
+    KinematicChain trunk;
+    Transform origin;
+    for (const char *role : { "lift", "waist" }) {
+        const JointGroupDescription *group = findGroup(role);
+        if (!group || !group->hasKinematics) {
+            continue;
+        }
+        const KinematicChain chain = groupChain(*group, origin * group->mount);
+        trunk.joints.insert(trunk.joints.end(), chain.joints.begin(), chain.joints.end());
+        origin = group->tool;
+    }
+    trunk.tool = origin;
+    model.setChain(KinematicModel::Trunk, trunk);
+
+    const JointGroupDescription *leftArm = findGroup("left_arm");
+    if (leftArm && leftArm->hasKinematics) {
+        model.setChain(KinematicModel::LeftArm, groupChain(*leftArm, leftArm->mount));
+    }
+    const JointGroupDescription *rightArm = findGroup("right_arm");
+    if (rightArm && rightArm->hasKinematics) {
+        model.setChain(KinematicModel::RightArm, groupChain(*rightArm, rightArm->mount));
+    }
+    return model;
+}
+
+std::vector<double> RobotDescription::linkRadii() const
+{
+    std::vector<double> radii(size_t(m_joints.size()), 0.0);
+    for (const JointGroupDescription &group : m_groups) {
+        if (!group.hasKinematics) {
+            continue;
+        }
+        for (int i = 0; i < group.joints.size(); ++i) {
+            radii[size_t(group.firstJoint + i)] = group.linkRadius;
+        }
+    }
+    return radii;
+}
+
+std::vector<LinkInertia> RobotDescription::linkInertias() const
+{
+    std::vector<LinkInertia> inertias(size_t(m_joints.size()));
+    for (int i = 0; i < m_joints.size(); ++i) {
+        inertias[size_t(i)] = m_joints[i].inertia;
+    }
+    return inertias;
+}
+
+QString RobotDescription::jointTypeName(JointType type)
+{
+    switch (type) {
+    case JointType::Revolute:  return "revolute";
+    case JointType::Prismatic: return "prismatic";
+    case JointType::Wheel:     return "wheel";
+    }
+    return QString();
+}
+
+bool RobotDescription::parseJointType(const QString &text, JointType *type)
+{
+    const QString lower = text.toLower();
+    if (lower == "revolute") {
+        *type = JointType::Revolute;
+    } else if (lower == "prismatic") {
+        *type = JointType::Prismatic;
+    } else if (lower == "wheel") {
+        *type = JointType::Wheel;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void RobotDescription::addGroup(const JointGroupDescription &group)
+{
+    JointGroupDescription placed = group;
+    placed.firstJoint = m_joints.size();
+    m_joints += placed.joints;
+    m_groups.append(placed);
+}
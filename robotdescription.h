@@ -0,0 +1,97 @@
+#ifndef ROBOTDESCRIPTION_H
+#define ROBOTDESCRIPTION_H
+
+#include <QString>
+#include <QVector>
+#include <QJsonObject>
+#include <vector>
+#include "kinematics.h"
+#include "dynamics.h"
+#include "differentialdrive.h"
+
+// 关节运动类型
+enum class JointType {
+    Revolute,   // 转动关节（角度）
+    Prismatic,  // 移动关节（位移）
+    Wheel       // 轮式电机（速度）
+};
+
+// 单个关节的描述
+struct JointDescription {
+    QString name;
+    JointType type;
+    QString unit;
+    double minValue;
+    double maxValue;
+    double maxVelocity;         // 轨迹规划限制（单位/秒、单位/秒²、单位/秒³）
+    double maxAcceleration;
+    double maxJerk;             // <= 0 时规划梯形速度曲线
+    double maxTorque;           // 力矩（N·m）或力（N）限制，时间最优轨迹使用，<= 0 表示不限
+    DhParameters dh;            // 运动学参数（米、弧度），仅手臂、腰部、升降组使用
+    LinkInertia inertia;        // 该关节之后的连杆惯性参数，逆动力学使用
+
+    JointDescription()
+        : type(JointType::Revolute), unit("deg"), minValue(-180.0), maxValue(180.0)
+        , maxVelocity(90.0), maxAcceleration(360.0), maxJerk(1800.0), maxTorque(0.0) {}
+};
+
+// 关节组（左臂、右臂、腰部、底盘、升降等）
+struct JointGroupDescription {
+    QString name;
+    QString role;       // "left_arm", "right_arm", "waist", "chassis", "lift"
+    int firstJoint;     // 组内第一个关节的全局ID
+    QVector<JointDescription> joints;
+    bool hasKinematics;
+    Transform mount;    // 组的安装位姿：升降相对底座，腰部相对升降末端，手臂相对躯干末端
+    Transform tool;     // 组末端的固定变换（腰部为肩部中心的躯干坐标系，手臂为法兰）
+    double linkRadius;  // 连杆包络胶囊半径（米），自碰撞检测用，0 表示不检测
+    double footprintRadius;     // 底盘外形：以底座原点为中心的竖直圆柱（米），环境碰撞检测用，0 表示不检测
+    double footprintHeight;
+    DriveGeometry drive;        // 底盘差速驱动几何，组内前两个电机为左、右轮
+
+    JointGroupDescription()
+        : firstJoint(0), hasKinematics(false), linkRadius(0.0), footprintRadius(0.0), footprintHeight(0.0) {}
+};
+
+// 机器人描述：关节分组、限位、单位、运动类型、轨迹限制与运动学参数
+// 启动时从描述文件加载，找不到文件时使用编译进资源的 robot_description.json（21自由度布局）。
+class RobotDescription
+{
+public:
+    RobotDescription();
+
+    // 加载
+    bool loadFromFile(const QString &fileName, QString *errorMessage = nullptr);
+    bool loadFromJson(const QJsonObject &root, QString *errorMessage = nullptr);
+    static RobotDescription builtinDescription();
+    static RobotDescription loadDefault();
+
+    // 查询
+    QString name() const { return m_name; }
+    QString sourceFile() const { return m_sourceFile; }
+    int jointCount() const { return m_joints.size(); }
+    const QVector<JointGroupDescription> &groups() const { return m_groups; }
+    const QVector<JointDescription> &joints() const { return m_joints; }
+    const JointDescription &joint(int jointId) const { return m_joints[jointId]; }
+    const JointGroupDescription *findGroup(const QString &role) const;
+
+    // 由升降、腰部、左右臂的运动学参数组成整机模型，关节值按描述中的单位换算
+    KinematicModel kinematicModel() const;
+    // 按全局关节ID展开的连杆胶囊半径（米），供自碰撞模型使用
+    std::vector<double> linkRadii() const;
+    // 按全局关节ID展开的连杆惯性参数，供逆动力学使用
+    std::vector<LinkInertia> linkInertias() const;
+
+    static QString jointTypeName(JointType type);
+    static bool parseJointType(const QString &text, JointType *type);
+
+private:
+    void addGroup(const JointGroupDescription &group);
+
+    QString m_name;
+    QString m_sourceFile;
+    QVector<JointGroupDescription> m_groups;
+    QVector<JointDescription> m_joints;  // 按全局ID展开的关节列表
+};
+
+#endif // ROBOTDESCRIPTION_H
@@ -0,0 +1,1730 @@
+// 机器人模型命令行工具
+//
+// robot_tool fk [--description FILE] <关节值>...
+//   按全局关节ID顺序给出关节值（单位与描述文件一致），省略的关节取 0，打印两臂末端位姿
+//
+// robot_tool bench-fk [选项]
+//   --description FILE          机器人描述文件（默认按 ROBOT_DESCRIPTION、程序目录、当前目录查找）
+//   --count N                   批量路径每次调用的构型数（默认 4096）
+//   --seconds S                 每项测试的时长（默认 1）
+//   --threads N                 批量路径的并行线程数（默认 1），报告总吞吐和每核吞吐
+//
+// robot_tool bench-ik [选项]
+//   --description FILE          机器人描述文件
+//   --arm left|right            求解的手臂（默认 left）
+//   --count N                   目标位姿个数（默认 2000），由随机构型的正运动学生成，必然可达
+//   --spread DEG                热启动初值相对目标构型的随机偏差（默认 10 度）
+//   --iterations N              迭代上限（默认与控制器一致）
+//   同时测试冷启动（初值为无关的随机构型），报告收敛率、迭代次数和耗时的中位数与最坏值
+//
+// robot_tool bench-jog [选项]
+//   --description FILE          机器人描述文件
+//   --count N                   控制周期数（默认 20000），每周期两臂同时由雅可比求点动关节速度
+//
+// robot_tool bench-collision [选项]
+//   --description FILE          机器人描述文件
+//   --count N                   随机构型个数（默认 20000）
+//   --range M                   检测范围（米，默认 0.1，与控制器一致），更远的组合在包围盒层剔除
+//
+// robot_tool bench-env <环境描述> [选项]
+//   --description FILE          机器人描述文件
+//   --count N                   随机构型个数（默认 20000），底座在环境中心附近随机摆放
+//   --range M                   检测范围（米，默认 0.15，与控制器一致）
+//   报告距离场生成或读取缓存的耗时，单点查询耗时，以及整机（连杆胶囊 + 底盘）间隙检测的耗时
+//
+// robot_tool bench-plan [选项]
+//   --description FILE          机器人描述文件
+//   --environment FILE          环境描述（默认无环境，只检查自碰撞）
+//   --arm left|right|both       规划的手臂（默认 left）
+//   --count N                   起止位姿对个数（默认 50），随机生成且都满足间隙要求
+//   --threads N                 规划线程数（默认 0，即硬件线程数）
+//   --budget S                  每次规划的时间预算（默认 1 秒）
+//   --seed N                    规划种子（默认 1），每对位姿使用 seed + 序号
+//   报告成功率、规划和路径缩短耗时的中位数与最坏值，以及缩短前后的路径长度
+//
+// robot_tool build-roadmap <输出文件> [选项]
+//   --description FILE          机器人描述文件
+//   --environment FILE          环境描述（默认无环境），底座取环境坐标系原点
+//   --arm left|right|both       路图的规划关节（默认 left）
+//   --nodes N                   节点数（默认 2000）
+//   --neighbours K              每个节点连接的最近邻个数（默认 10）
+//   --threads N                 构建线程数（默认 0，即硬件线程数）
+//   --seed N                    采样种子（默认 1）
+//   --fixed FILE.pos            未规划关节的取值（默认零位）
+//   --anchor FILE.pos           常用位姿，作为节点加入（可多次给出）
+//   间隙和边检查分辨率与控制器一致。构建后映射输出文件，在常用位姿（不足两个时为随机节点）
+//   之间查询两遍，报告首次查询和重复查询的耗时
+//
+// robot_tool bench-retime [选项]
+//   --description FILE          机器人描述文件
+//   --count N                   随机关键帧序列个数（默认 200），两臂关节随机，其余关节为零
+//   --keyframes N               每个序列的关键帧数（默认 5，含起点）
+//   --grid N                    参数化网格点数（默认 400）
+//   对同一条五次样条路径比较关键帧计时（全速）和时间最优参数化的时长，报告参数化和渲染的耗时，
+//   以及按控制频率差分得到的关节速度、加速度与限制之比的最大值
+//
+// robot_tool bench-dynamics [选项]
+//   --description FILE          机器人描述文件（连杆惯性参数同样来自描述文件）
+//   --count N                   随机构型个数（默认 20000），速度、加速度在关节限制内随机
+//   报告单组逆动力学、重力补偿、路径力矩系数的耗时，批量模式的吞吐，以及各关节重力补偿力矩的最大值
+//
+// robot_tool bench-drive [选项]
+//   --description FILE          机器人描述文件（底盘组的驱动几何和电机限制）
+//   --radius M                  圆周半径（默认 1.0）
+//   --speed V                   线速度指令（m/s，默认 0.3）
+//   --feedback HZ               轮速反馈频率（默认 20）
+//   按控制频率下发绕圆行驶的速度指令，走完一圈后停车。报告轮速变化率与限制之比、加速和制动的
+//   时间与距离，以及按反馈频率用圆弧积分和欧拉积分得到的里程计相对实际轨迹的误差
+//
+// robot_tool bench-wholebody [选项]
+//   --description FILE          机器人描述文件
+//   --count N                   速度分解的控制周期数（默认 5000），构型和两臂末端速度随机
+//   --targets N                 逆解目标个数（默认 300）
+//   报告两臂同时做全身速度分解（含可操作度梯度）的耗时；目标位姿取自升降、腰部也随机的构型，
+//   初值的躯干在行程中点，比较单臂逆解与全身逆解的收敛率和耗时
+//
+// robot_tool build-reachability <输出文件> [选项]
+//   --description FILE          机器人描述文件
+//   --samples N                 采样构型数（默认 8000000），两臂共用
+//   --resolution M              体素边长（米，默认 0.04）
+//   --threads N                 构建线程数（默认 0，即硬件线程数）
+//   --seed N                    采样种子（默认 1）
+//   --fixed-trunk FILE.pos      躯干固定为该位姿文件中的取值（默认躯干在行程内随机采样）
+//   构建后映射输出文件，报告两臂的可达体积、灵活体积（接近方向覆盖一半以上）、最大可操作度，
+//   映射和单点查询的耗时，以及另取随机构型时末端落在已达体素内的比例（采样是否充分）
+
+#include "robotdescription.h"
+#include "kinematics.h"
+#include "inversekinematics.h"
+#include "selfcollision.h"
+#include "environmentmodel.h"
+#include "motionplanner.h"
+#include "roadmap.h"
+#include "pathtiming.h"
+#include "dynamics.h"
+#include "differentialdrive.h"
+#include "wholebodyik.h"
+#include "reachabilitymap.h"
+#include <QFile>
+#include <QSettings>
+#include <QString>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "用法:\n"
+        "  robot_tool fk       [--description FILE] <关节值>...\n"
+        "  robot_tool bench-fk [--description FILE] [--count N] [--seconds S] [--threads N]\n"
+        "  robot_tool bench-ik [--description FILE] [--arm left|right] [--count N] [--spread DEG]\n"
+        "                      [--iterations N]\n"
+        "  robot_tool bench-jog [--description FILE] [--count N]\n"
+        "  robot_tool bench-collision [--description FILE] [--count N] [--range M]\n"
+        "  robot_tool bench-env <环境描述> [--description FILE] [--count N] [--range M]\n"
+        "  robot_tool bench-plan [--description FILE] [--environment FILE] [--arm left|right|both] [--count N]\n"
+        "                        [--threads N] [--budget S] [--seed N]\n"
+        "  robot_tool build-roadmap <输出文件> [--description FILE] [--environment FILE] [--arm left|right|both]\n"
+        "                           [--nodes N] [--neighbours K] [--threads N] [--seed N] [--fixed FILE.pos]\n"
+        "                           [--anchor FILE.pos]...\n"
+        "  robot_tool bench-retime [--description FILE] [--count N] [--keyframes N] [--grid N]\n"
+        "  robot_tool bench-dynamics [--description FILE] [--count N]\n"
+        "  robot_tool bench-drive [--description FILE] [--radius M] [--speed V] [--feedback HZ]\n"
+        "  robot_tool bench-wholebody [--description FILE] [--count N] [--targets N]\n"
+        "  robot_tool build-reachability <输出文件> [--description FILE] [--samples N] [--resolution M]\n"
+        "                                [--threads N] [--seed N] [--fixed-trunk FILE.pos]\n");
+}
+
+bool loadDescription(const std::string &fileName, RobotDescription &description)
+{
+    if (fileName.empty()) {
+        description = RobotDescription::loadDefault();
+        return true;
+    }
+
+    QString error;
+    if (!description.loadFromFile(QString::fromStdString(fileName), &error)) {
+        std::fprintf(stderr, "错误: 无法加载机器人描述 %s: %s\n", fileName.c_str(), error.toStdString().c_str());
+        return false;
+    }
+    return true;
+}
+
+void printPose(const char *name, const Transform &pose)
+{
+    double values[6];
+    pose.toXyzRpy(values);
+    const double degrees = 180.0 / std::acos(-1.0);
+    std::printf("%-6s 位置 (%8.4f, %8.4f, %8.4f) m   姿态 rpy (%8.3f, %8.3f, %8.3f) deg\n", name,
+                values[0], values[1], values[2], values[3] * degrees, values[4] * degrees, values[5] * degrees);
+}
+
+int runFk(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    std::vector<double> values;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--description" && i + 1 < argc) {
+            descriptionFile = argv[++i];
+        } else {
+            char *end = nullptr;
+            const double value = std::strtod(arg.c_str(), &end);
+            if (end == arg.c_str() || *end != '\0') {
+                std::fprintf(stderr, "无效关节值: %s\n", arg.c_str());
+                return 2;
+            }
+            values.push_back(value);
+        }
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const KinematicModel model = description.kinematicModel();
+    if (model.isEmpty()) {
+        std::fprintf(stderr, "错误: 机器人描述中没有手臂的运动学参数\n");
+        return 1;
+    }
+
+    std::vector<double> q(size_t(std::max(description.jointCount(), model.jointCount())), 0.0);
+    std::copy(values.begin(), values.begin() + std::min(values.size(), q.size()), q.begin());
+
+    Transform left;
+    Transform right;
+    model.forward(q.data(), &left, &right);
+    printPose("躯干", model.forward(KinematicModel::Trunk, q.data()));
+    printPose("左臂", left);
+    printPose("右臂", right);
+    return 0;
+}
+
+// SoA 布局的随机构型，关节值在限位内均匀分布，种子固定以便对比不同机器的结果
+std::vector<double> randomConfigurations(const RobotDescription &description, int jointCount, size_t count,
+                                         unsigned seed)
+{
+    std::vector<double> q(size_t(jointCount) * count, 0.0);
+    std::mt19937_64 random(seed);
+    for (int j = 0; j < std::min(jointCount, description.jointCount()); ++j) {
+        const JointDescription &joint = description.joint(j);
+        std::uniform_real_distribution<double> distribution(joint.minValue, joint.maxValue);
+        for (size_t i = 0; i < count; ++i) {
+            q[size_t(j) * count + i] = distribution(random);
+        }
+    }
+    return q;
+}
+
+// 与批量输出相同的分量顺序：旋转矩阵（行优先）后接平移
+double poseComponent(const Transform &pose, int k)
+{
+    return k < 9 ? pose.r[k] : pose.p[k - 9];
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int runBenchFk(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    size_t count = 4096;
+    double seconds = 1.0;
+    int threads = 1;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--count" && hasValue) {
+            count = size_t(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--seconds" && hasValue) {
+            seconds = std::max(0.01, std::atof(value.c_str()));
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::max(1, std::atoi(value.c_str()));
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const KinematicModel model = description.kinematicModel();
+    if (model.isEmpty()) {
+        std::fprintf(stderr, "错误: 机器人描述中没有手臂的运动学参数\n");
+        return 1;
+    }
+    const int jointCount = std::max(description.jointCount(), model.jointCount());
+    const std::vector<double> q = randomConfigurations(description, jointCount, count, 20261018u);
+
+    std::printf("模型: %s，躯干 %zu + 左臂 %zu + 右臂 %zu 个关节，SIMD 宽度 %d\n",
+                description.name().toStdString().c_str(),
+                model.chain(KinematicModel::Trunk).joints.size(),
+                model.chain(KinematicModel::LeftArm).joints.size(),
+                model.chain(KinematicModel::RightArm).joints.size(),
+                KinematicModel::laneWidth());
+
+    // 标量路径：每次一组构型，输入按控制周期的 AoS 布局
+    std::vector<double> single(static_cast<size_t>(jointCount));
+    double checksum = 0.0;
+    size_t scalarCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    do {
+        for (size_t i = 0; i < count; ++i) {
+            for (int j = 0; j < jointCount; ++j) {
+                single[size_t(j)] = q[size_t(j) * count + i];
+            }
+            Transform left;
+            Transform right;
+            model.forward(single.data(), &left, &right);
+            checksum += left.p[0] + right.p[0];
+        }
+        scalarCount += count;
+    } while (secondsSince(start) < seconds);
+    const double scalarRate = scalarCount / secondsSince(start);
+
+    // 批量路径：每个线程独立的输出缓冲，避免伪共享
+    std::atomic<size_t> batchCount(0);
+    std::vector<std::thread> workers;
+    start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            std::vector<double> left(size_t(KinematicModel::POSE_COMPONENTS) * count);
+            std::vector<double> right(size_t(KinematicModel::POSE_COMPONENTS) * count);
+            size_t done = 0;
+            const auto begin = std::chrono::steady_clock::now();
+            do {
+                model.forwardBatch(q.data(), count, count, left.data(), right.data());
+                done += count;
+            } while (secondsSince(begin) < seconds);
+            batchCount += done;
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    const double batchRate = batchCount / secondsSince(start);
+
+    // 批量路径与标量路径的最大偏差
+    std::vector<double> left(size_t(KinematicModel::POSE_COMPONENTS) * count);
+    std::vector<double> right(size_t(KinematicModel::POSE_COMPONENTS) * count);
+    model.forwardBatch(q.data(), count, count, left.data(), right.data());
+    double maxError = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        for (int j = 0; j < jointCount; ++j) {
+            single[size_t(j)] = q[size_t(j) * count + i];
+        }
+        Transform scalarLeft;
+        Transform scalarRight;
+        model.forward(single.data(), &scalarLeft, &scalarRight);
+        for (int k = 0; k < KinematicModel::POSE_COMPONENTS; ++k) {
+            maxError = std::max(maxError, std::fabs(left[size_t(k) * count + i] - poseComponent(scalarLeft, k)));
+            maxError = std::max(maxError, std::fabs(right[size_t(k) * count + i] - poseComponent(scalarRight, k)));
+        }
+    }
+
+    std::printf("%-10s %16s %16s %14s\n", "路径", "构型/秒", "每核构型/秒", "每构型(ns)");
+    std::printf("%-10s %16.0f %16.0f %14.1f\n", "标量", scalarRate, scalarRate, 1e9 / scalarRate);
+    std::printf("%-10s %16.0f %16.0f %14.1f\n", "批量", batchRate, batchRate / threads, 1e9 * threads / batchRate);
+    std::printf("批量 %zu 构型/次，%d 线程，与标量路径最大偏差 %.3g (校验和 %.6g)\n",
+                count, threads, maxError, checksum);
+    return 0;
+}
+
+// 有序样本的分位数
+double percentile(const std::vector<double> &sorted, double fraction)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(sorted.size() - 1, size_t(fraction * (sorted.size() - 1) + 0.5));
+    return sorted[index];
+}
+
+int runBenchIk(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    KinematicModel::ChainId arm = KinematicModel::LeftArm;
+    size_t count = 2000;
+    double spread = 10.0;
+    IkOptions options;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--arm" && (value == "left" || value == "right")) {
+            arm = value == "left" ? KinematicModel::LeftArm : KinematicModel::RightArm;
+        } else if (arg == "--count" && hasValue) {
+            count = size_t(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--spread" && hasValue) {
+            spread = std::max(0.0, std::atof(value.c_str()));
+        } else if (arg == "--iterations" && hasValue) {
+            options.maxIterations = std::max(1, std::atoi(value.c_str()));
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const KinematicModel model = description.kinematicModel();
+    if (model.chain(arm).joints.empty()) {
+        std::fprintf(stderr, "错误: 机器人描述中没有该手臂的运动学参数\n");
+        return 1;
+    }
+
+    const int jointCount = std::max(description.jointCount(), model.jointCount());
+    std::vector<double> minLimits(size_t(jointCount), 0.0);
+    std::vector<double> maxLimits(size_t(jointCount), 0.0);
+    for (int j = 0; j < description.jointCount(); ++j) {
+        minLimits[size_t(j)] = description.joint(j).minValue;
+        maxLimits[size_t(j)] = description.joint(j).maxValue;
+    }
+    ArmIkSolver solver;
+    if (!solver.configure(&model, arm, minLimits.data(), maxLimits.data())) {
+        std::fprintf(stderr, "错误: 手臂关节数超过逆解器上限 %d\n", ArmIkSolver::MAX_CHAIN_JOINTS);
+        return 1;
+    }
+
+    // 目标构型在限位内均匀分布，目标位姿由正运动学得到
+    const std::vector<double> goals = randomConfigurations(description, jointCount, count, 20261018u);
+    const std::vector<double> others = randomConfigurations(description, jointCount, count, 42u);
+    std::mt19937_64 random(7u);
+    std::uniform_real_distribution<double> offset(-spread, spread);
+    const std::vector<KinematicJoint> &armJoints = model.chain(arm).joints;
+
+    std::printf("手臂: %s，%zu 个关节，迭代上限 %d，容差 %.2g m / %.2g rad\n",
+                arm == KinematicModel::LeftArm ? "左臂" : "右臂", armJoints.size(), options.maxIterations,
+                options.positionTolerance, options.orientationTolerance);
+    std::printf("%-16s %8s %8s %8s %10s %10s %10s %12s\n", "初值", "收敛率", "迭代中位", "迭代最大",
+                "中位(us)", "p99(us)", "最大(us)", "未收敛残差(m)");
+
+    std::vector<double> goal(static_cast<size_t>(jointCount));
+    std::vector<double> seed(static_cast<size_t>(jointCount));
+    std::vector<double> solution(static_cast<size_t>(jointCount));
+    double worstIteration = 0.0;
+    for (int mode = 0; mode < 2; ++mode) {
+        std::vector<double> times;
+        std::vector<double> iterationCounts;
+        std::vector<double> perIteration;
+        size_t converged = 0;
+        double worstResidual = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            for (int j = 0; j < jointCount; ++j) {
+                goal[size_t(j)] = goals[size_t(j) * count + i];
+            }
+            const Transform target = model.forward(arm, goal.data());
+
+            // 热启动：目标构型加随机偏差（上一控制周期的解）；冷启动：无关的随机构型
+            seed = goal;
+            for (const KinematicJoint &joint : armJoints) {
+                const size_t j = size_t(joint.jointId);
+                const double value = mode == 0 ? goal[j] + offset(random) : others[j * count + i];
+                seed[j] = std::max(minLimits[j], std::min(maxLimits[j], value));
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            const IkResult result = solver.solve(target, seed.data(), solution.data(), options);
+            const double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+            times.push_back(elapsed);
+            iterationCounts.push_back(result.iterations);
+            perIteration.push_back(elapsed / (result.iterations + 1));
+            if (result.converged) {
+                ++converged;
+            } else {
+                worstResidual = std::max(worstResidual, result.positionError);
+            }
+        }
+        std::sort(times.begin(), times.end());
+        std::sort(iterationCounts.begin(), iterationCounts.end());
+        std::sort(perIteration.begin(), perIteration.end());
+        worstIteration = std::max(worstIteration, percentile(perIteration, 0.99));
+
+        char label[32];
+        if (mode == 0) {
+            std::snprintf(label, sizeof(label), "热启动 ±%.0f°", spread);
+        } else {
+            std::snprintf(label, sizeof(label), "冷启动");
+        }
+        std::printf("%-16s %7.1f%% %8.0f %8.0f %10.2f %10.2f %10.2f %12.3g\n", label,
+                    100.0 * converged / count, percentile(iterationCounts, 0.5), iterationCounts.back(),
+                    percentile(times, 0.5), percentile(times, 0.99), times.back(), worstResidual);
+    }
+
+    // 最大值受调度抖动影响；迭代次数有上限，上限乘单次迭代的 p99 耗时才是可依赖的最坏耗时
+    std::printf("单次迭代 p99 %.2f us，迭代上限下的最坏耗时 %.1f us（1 kHz 周期为 1000 us）\n",
+                worstIteration, worstIteration * (options.maxIterations + 1));
+    return 0;
+}
+
+int runBenchJog(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    size_t count = 20000;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--count" && hasValue) {
+            count = size_t(std::max(1, std::atoi(value.c_str())));
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const KinematicModel model = description.kinematicModel();
+    const int jointCount = std::max(description.jointCount(), model.jointCount());
+    std::vector<double> minLimits(static_cast<size_t>(jointCount), 0.0);
+    std::vector<double> maxLimits(static_cast<size_t>(jointCount), 0.0);
+    std::vector<double> speedLimits(static_cast<size_t>(jointCount), 0.0);
+    for (int j = 0; j < description.jointCount(); ++j) {
+        minLimits[size_t(j)] = description.joint(j).minValue;
+        maxLimits[size_t(j)] = description.joint(j).maxValue;
+        speedLimits[size_t(j)] = description.joint(j).maxVelocity;
+    }
+    ArmIkSolver solvers[2];
+    const KinematicModel::ChainId arms[2] = { KinematicModel::LeftArm, KinematicModel::RightArm };
+    for (int arm = 0; arm < 2; ++arm) {
+        if (!solvers[arm].configure(&model, arms[arm], minLimits.data(), maxLimits.data())) {
+            std::fprintf(stderr, "错误: 机器人描述中缺少手臂运动学参数\n");
+            return 1;
+        }
+    }
+
+    // 每周期的关节反馈和末端速度旋量都不同，避免缓存命中掩盖真实耗时
+    const std::vector<double> configurations = randomConfigurations(description, jointCount, count, 20261018u);
+    std::mt19937_64 random(11u);
+    std::uniform_real_distribution<double> linear(-0.1, 0.1);
+    std::uniform_real_distribution<double> angular(-0.5, 0.5);
+    std::vector<double> q(static_cast<size_t>(jointCount));
+    std::vector<double> velocities(static_cast<size_t>(jointCount));
+    std::vector<double> times;
+    times.reserve(count);
+    double scaleSum = 0.0;
+    size_t limited = 0;
+    for (size_t i = 0; i < count; ++i) {
+        for (int j = 0; j < jointCount; ++j) {
+            q[size_t(j)] = configurations[size_t(j) * count + i];
+        }
+        double twists[2][6];
+        for (int arm = 0; arm < 2; ++arm) {
+            for (int k = 0; k < 6; ++k) {
+                twists[arm][k] = k < 3 ? linear(random) : angular(random);
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        JogResult results[2];
+        for (int arm = 0; arm < 2; ++arm) {
+            results[arm] = solvers[arm].jogVelocities(q.data(), twists[arm], arm == 1, speedLimits.data(),
+                                                      velocities.data());
+        }
+        times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+        for (const JogResult &result : results) {
+            scaleSum += result.scale;
+            limited += result.limited ? 1 : 0;
+        }
+    }
+    std::sort(times.begin(), times.end());
+
+    std::printf("两臂同时点动，%zu 个控制周期\n", count);
+    std::printf("每周期耗时: 中位 %.2f us，p99 %.2f us，最大 %.2f us（1 ms 周期的 %.2f%%）\n",
+                percentile(times, 0.5), percentile(times, 0.99), times.back(), percentile(times, 0.99) / 10.0);
+    std::printf("平均速度比例 %.1f%%，%.1f%% 的求解有关节接近限位\n",
+                100.0 * scaleSum / (2 * count), 100.0 * limited / (2 * count));
+    return 0;
+}
+
+int runBenchCollision(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    size_t count = 20000;
+    double range = 0.1;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--count" && hasValue) {
+            count = size_t(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--range" && hasValue) {
+            range = std::atof(value.c_str());
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const KinematicModel model = description.kinematicModel();
+    SelfCollisionModel collision;
+    if (!collision.configure(&model, description.linkRadii())) {
+        std::fprintf(stderr, "错误: 机器人描述中没有连杆半径\n");
+        return 1;
+    }
+
+    const int jointCount = std::max(description.jointCount(), model.jointCount());
+    const std::vector<double> configurations = randomConfigurations(description, jointCount, count, 20261018u);
+    std::vector<double> q(static_cast<size_t>(jointCount));
+    std::vector<double> times;
+    times.reserve(count);
+    size_t colliding = 0;
+    size_t near = 0;
+    size_t pairsTested = 0;
+    for (size_t i = 0; i < count; ++i) {
+        for (int j = 0; j < jointCount; ++j) {
+            q[size_t(j)] = configurations[size_t(j) * count + i];
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const SelfCollisionResult result = collision.check(q.data(), range);
+        times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+        pairsTested += size_t(result.pairsTested);
+        colliding += result.minimumDistance < 0.0 ? 1 : 0;
+        near += result.capsuleA >= 0 ? 1 : 0;
+    }
+    std::sort(times.begin(), times.end());
+
+    std::printf("%zu 个胶囊，%zu 对参与检测，检测范围 %.3f m\n", collision.capsules().size(), collision.pairCount(), range);
+    std::printf("每次检测（含正运动学）: 中位 %.2f us，p99 %.2f us，最大 %.2f us\n",
+                percentile(times, 0.5), percentile(times, 0.99), times.back());
+    std::printf("平均精确计算 %.1f 对；随机构型中 %.1f%% 在检测范围内，%.1f%% 发生碰撞\n",
+                double(pairsTested) / count, 100.0 * near / count, 100.0 * colliding / count);
+    return 0;
+}
+
+int runBenchEnvironment(int argc, char *argv[])
+{
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+    const QString environmentFile = QString::fromLocal8Bit(argv[2]);
+    std::string descriptionFile;
+    size_t count = 20000;
+    double range = 0.15;
+    for (int i = 3; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--count" && hasValue) {
+            count = size_t(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--range" && hasValue) {
+            range = std::atof(value.c_str());
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    EnvironmentModel environment;
+    QString error;
+    if (!environment.loadFromFile(environmentFile, &error)) {
+        std::fprintf(stderr, "错误: 无法加载环境模型 %s: %s\n", argv[2], error.toStdString().c_str());
+        return 1;
+    }
+    const DistanceField &field = environment.distanceField();
+    std::printf("%zu 个物体，体素 %.0f mm，%u x %u x %u（%.1f MB），%s %.1f ms\n", environment.shapes().size(),
+                field.resolution() * 1000.0, field.dims()[0], field.dims()[1], field.dims()[2],
+                field.memoryBytes() / 1048576.0, environment.loadedFromCache() ? "读取缓存" : "生成距离场",
+                environment.buildSeconds() * 1000.0);
+
+    const KinematicModel model = description.kinematicModel();
+    SelfCollisionModel collision;
+    collision.configure(&model, description.linkRadii());
+    const JointGroupDescription *chassis = description.findGroup("chassis");
+    const double footprintRadius = chassis ? chassis->footprintRadius : 0.0;
+    const double footprintHeight = chassis ? chassis->footprintHeight : 0.0;
+
+    // 单点查询：在距离场范围内均匀取点
+    std::mt19937 random(20261018u);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<double> points(count * 3);
+    for (size_t i = 0; i < count; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            points[i * 3 + size_t(k)] = field.origin()[k] + unit(random) * (field.dims()[k] - 1) * field.resolution();
+        }
+    }
+    double sum = 0.0;
+    const auto queryStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        sum += field.distance(&points[i * 3]);
+    }
+    const double queryNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - queryStart).count();
+    std::printf("单点查询: 平均 %.1f ns（校验和 %.3f）\n", queryNs / count, sum);
+
+    // 整机：随机构型，底座在距离场水平范围内随机平移和转向
+    const int jointCount = std::max(description.jointCount(), model.jointCount());
+    const std::vector<double> configurations = randomConfigurations(description, jointCount, count, 20261018u);
+    std::vector<double> q(static_cast<size_t>(jointCount));
+    std::vector<double> times;
+    times.reserve(count);
+    size_t near = 0;
+    size_t colliding = 0;
+    for (size_t i = 0; i < count; ++i) {
+        for (int j = 0; j < jointCount; ++j) {
+            q[size_t(j)] = configurations[size_t(j) * count + i];
+        }
+        const double x = field.origin()[0] + unit(random) * (field.dims()[0] - 1) * field.resolution();
+        const double y = field.origin()[1] + unit(random) * (field.dims()[1] - 1) * field.resolution();
+        const Transform basePose = Transform::fromXyzRpy(x, y, 0.0, 0.0, 0.0, unit(random) * 2.0 * std::acos(-1.0));
+
+        const auto start = std::chrono::steady_clock::now();
+        collision.check(q.data(), 0.0);
+        const EnvironmentClearance clearance =
+            environment.robotClearance(collision, basePose, footprintRadius, footprintHeight, range);
+        times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+        near += (clearance.capsule >= 0 || clearance.chassis) ? 1 : 0;
+        colliding += clearance.minimumDistance < 0.0 ? 1 : 0;
+    }
+    std::sort(times.begin(), times.end());
+
+    std::printf("整机间隙检测（含正运动学，%zu 个胶囊%s）: 中位 %.2f us，p99 %.2f us，最大 %.2f us\n",
+                collision.capsules().size(), footprintRadius > 0.0 ? " + 底盘" : "",
+                percentile(times, 0.5), percentile(times, 0.99), times.back());
+    std::printf("随机位姿中 %.1f%% 在检测范围 %.3f m 内，%.1f%% 与环境接触\n",
+                100.0 * near / count, range, 100.0 * colliding / count);
+    return 0;
+}
+
+int runBenchPlan(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    QString environmentFile;
+    std::string arm = "left";
+    size_t count = 50;
+    int threads = 0;
+    PlannerOptions options;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--environment" && hasValue) {
+            environmentFile = QString::fromLocal8Bit(argv[i + 1]);
+        } else if (arg == "--arm" && (value == "left" || value == "right" || value == "both")) {
+            arm = value;
+        } else if (arg == "--count" && hasValue) {
+            count = size_t(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--budget" && hasValue) {
+            options.timeBudget = std::atof(value.c_str());
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = uint32_t(std::strtoul(value.c_str(), nullptr, 10));
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    EnvironmentModel environment;
+    if (!environmentFile.isEmpty()) {
+        QString error;
+        if (!environment.loadFromFile(environmentFile, &error)) {
+            std::fprintf(stderr, "错误: 无法加载环境模型 %s: %s\n", environmentFile.toLocal8Bit().constData(),
+                         error.toStdString().c_str());
+            return 1;
+        }
+    }
+
+    const KinematicModel model = description.kinematicModel();
+    const int jointCount = description.jointCount();
+    PlanningScene scene;
+    scene.model = &model;
+    scene.linkRadii = description.linkRadii();
+    for (int j = 0; j < jointCount; ++j) {
+        scene.minLimits.push_back(description.joint(j).minValue);
+        scene.maxLimits.push_back(description.joint(j).maxValue);
+    }
+    scene.environment = environment.isEmpty() ? nullptr : &environment.distanceField();
+
+    std::vector<int> jointIds;
+    if (arm != "right") {
+        for (const KinematicJoint &joint : model.chain(KinematicModel::LeftArm).joints) {
+            jointIds.push_back(joint.jointId);
+        }
+    }
+    if (arm != "left") {
+        for (const KinematicJoint &joint : model.chain(KinematicModel::RightArm).joints) {
+            jointIds.push_back(joint.jointId);
+        }
+    }
+    MotionPlanner planner(threads);
+    std::string error;
+    if (!planner.configure(scene, jointIds, &error)) {
+        std::fprintf(stderr, "错误: %s\n", error.c_str());
+        return 1;
+    }
+
+    // 起止位姿：规划关节在限位内随机，其余关节取零位（限位内）；不满足间隙的丢弃重抽
+    std::vector<double> base(size_t(jointCount), 0.0);
+    for (int j = 0; j < jointCount; ++j) {
+        base[size_t(j)] = std::min(std::max(0.0, scene.minLimits[size_t(j)]), scene.maxLimits[size_t(j)]);
+    }
+    std::mt19937 random(20261018u);
+    std::vector<std::vector<double>> starts;
+    std::vector<std::vector<double>> goals;
+    for (size_t attempt = 0; starts.size() < count && attempt < count * 1000; ++attempt) {
+        std::vector<double> start = base;
+        std::vector<double> goal = base;
+        for (int id : jointIds) {
+            std::uniform_real_distribution<double> distribution(scene.minLimits[size_t(id)], scene.maxLimits[size_t(id)]);
+            start[size_t(id)] = distribution(random);
+            goal[size_t(id)] = distribution(random);
+        }
+        if (planner.isStateValid(start.data(), options.clearance) && planner.isStateValid(goal.data(), options.clearance)) {
+            starts.push_back(start);
+            goals.push_back(goal);
+        }
+    }
+    if (starts.empty()) {
+        std::fprintf(stderr, "错误: 找不到满足间隙要求的随机位姿\n");
+        return 1;
+    }
+
+    std::vector<double> totalMs;
+    std::vector<double> planningMs;
+    std::vector<double> shortcutMs;
+    size_t succeeded = 0;
+    size_t direct = 0;
+    size_t checks = 0;
+    double rawLength = 0.0;
+    double length = 0.0;
+    const uint32_t seed = options.seed;
+    for (size_t i = 0; i < starts.size(); ++i) {
+        options.seed = seed + uint32_t(i);
+        const PlanResult result = planner.plan(starts[i].data(), goals[i].data(), options);
+        totalMs.push_back((result.planningSeconds + result.shortcutSeconds) * 1000.0);
+        planningMs.push_back(result.planningSeconds * 1000.0);
+        shortcutMs.push_back(result.shortcutSeconds * 1000.0);
+        checks += result.stateChecks;
+        if (!result.success) {
+            continue;
+        }
+        ++succeeded;
+        direct += result.nodes == 0 ? 1 : 0;
+        rawLength += result.rawLength;
+        length += result.length;
+    }
+    std::sort(totalMs.begin(), totalMs.end());
+    std::sort(planningMs.begin(), planningMs.end());
+    std::sort(shortcutMs.begin(), shortcutMs.end());
+
+    std::printf("%s，%zu 个关节，%d 个线程，%s\n", arm == "both" ? "两臂" : (arm == "left" ? "左臂" : "右臂"),
+                jointIds.size(), planner.threadCount(),
+                environment.isEmpty() ? "无环境" : environment.name().toStdString().c_str());
+    std::printf("成功 %zu/%zu（其中直线可达 %zu），平均 %.0f 次碰撞检测\n", succeeded, starts.size(), direct,
+                double(checks) / starts.size());
+    std::printf("总耗时: 中位 %.2f ms，p90 %.2f ms，最大 %.2f ms\n", percentile(totalMs, 0.5),
+                percentile(totalMs, 0.9), totalMs.back());
+    std::printf("  树生长: 中位 %.2f ms，最大 %.2f ms；路径缩短: 中位 %.2f ms，最大 %.2f ms\n",
+                percentile(planningMs, 0.5), planningMs.back(), percentile(shortcutMs, 0.5), shortcutMs.back());
+    if (succeeded > 0) {
+        std::printf("平均路径长度: 缩短前 %.1f，缩短后 %.1f（关节单位）\n", rawLength / succeeded, length / succeeded);
+    }
+    return 0;
+}
+
+// 位置文件（QSettings INI，joint_<ID> = 值），缺少的关节取 0
+std::vector<double> readPoseFile(const char *fileName, int jointCount)
+{
+    QSettings settings(QString::fromLocal8Bit(fileName), QSettings::IniFormat);
+    std::vector<double> pose(size_t(jointCount), 0.0);
+    for (int j = 0; j < jointCount; ++j) {
+        pose[size_t(j)] = settings.value(QString("joint_%1").arg(j), 0.0).toDouble();
+    }
+    return pose;
+}
+
+int runBuildRoadmap(int argc, char *argv[])
+{
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+    const std::string outputFile = argv[2];
+    std::string descriptionFile;
+    QString environmentFile;
+    std::string arm = "left";
+    int threads = 0;
+    const char *fixedFile = nullptr;
+    std::vector<const char *> anchorFiles;
+    RoadmapOptions options;
+    for (int i = 3; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--environment" && hasValue) {
+            environmentFile = QString::fromLocal8Bit(argv[i + 1]);
+        } else if (arg == "--arm" && (value == "left" || value == "right" || value == "both")) {
+            arm = value;
+        } else if (arg == "--nodes" && hasValue) {
+            options.nodeCount = std::max(2, std::atoi(value.c_str()));
+        } else if (arg == "--neighbours" && hasValue) {
+            options.neighbours = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = uint32_t(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--fixed" && hasValue) {
+            fixedFile = argv[i + 1];
+        } else if (arg == "--anchor" && hasValue) {
+            anchorFiles.push_back(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    EnvironmentModel environment;
+    if (!environmentFile.isEmpty()) {
+        QString error;
+        if (!environment.loadFromFile(environmentFile, &error)) {
+            std::fprintf(stderr, "错误: 无法加载环境模型 %s: %s\n", environmentFile.toLocal8Bit().constData(),
+                         error.toStdString().c_str());
+            return 1;
+        }
+    }
+
+    const KinematicModel model = description.kinematicModel();
+    const int jointCount = description.jointCount();
+    PlanningScene scene;
+    scene.model = &model;
+    scene.linkRadii = description.linkRadii();
+    for (int j = 0; j < jointCount; ++j) {
+        scene.minLimits.push_back(description.joint(j).minValue);
+        scene.maxLimits.push_back(description.joint(j).maxValue);
+    }
+    scene.environment = environment.isEmpty() ? nullptr : &environment.distanceField();
+    scene.environmentHash = environment.sourceHash();
+
+    std::vector<int> jointIds;
+    if (arm != "right") {
+        for (const KinematicJoint &joint : model.chain(KinematicModel::LeftArm).joints) {
+            jointIds.push_back(joint.jointId);
+        }
+    }
+    if (arm != "left") {
+        for (const KinematicJoint &joint : model.chain(KinematicModel::RightArm).joints) {
+            jointIds.push_back(joint.jointId);
+        }
+    }
+    MotionPlanner planner(threads);
+    std::string error;
+    if (!planner.configure(scene, jointIds, &error)) {
+        std::fprintf(stderr, "错误: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::vector<double> fixed(size_t(jointCount), 0.0);
+    if (fixedFile) {
+        fixed = readPoseFile(fixedFile, jointCount);
+    }
+    for (int j = 0; j < jointCount; ++j) {
+        fixed[size_t(j)] = std::min(std::max(fixed[size_t(j)], scene.minLimits[size_t(j)]), scene.maxLimits[size_t(j)]);
+    }
+    for (const char *fileName : anchorFiles) {
+        std::vector<double> anchor = readPoseFile(fileName, jointCount);
+        for (int j = 0; j < jointCount; ++j) {
+            if (std::find(jointIds.begin(), jointIds.end(), j) == jointIds.end()) {
+                anchor[size_t(j)] = fixed[size_t(j)];
+            }
+        }
+        options.anchors.push_back(anchor);
+    }
+
+    const PlannerOptions checkOptions;
+    Roadmap built;
+    const auto buildStart = std::chrono::steady_clock::now();
+    if (!built.build(planner, fixed.data(), options, checkOptions, &error)) {
+        std::fprintf(stderr, "错误: %s\n", error.c_str());
+        return 1;
+    }
+    const double buildSeconds = secondsSince(buildStart);
+    if (!built.save(outputFile, &error)) {
+        std::fprintf(stderr, "错误: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("%zu 个节点（%zu 个常用位姿），%zu 条边，%d 个线程构建 %.2f 秒，文件 %.1f KB\n", built.nodeCount(),
+                built.anchorCount(), built.edgeCount(), planner.threadCount(), buildSeconds, built.imageBytes() / 1024.0);
+
+    // 与控制器相同：映射文件后直接使用
+    QFile file(QString::fromLocal8Bit(outputFile.c_str()));
+    const uchar *data = file.open(QIODevice::ReadOnly) ? file.map(0, file.size()) : nullptr;
+    Roadmap roadmap;
+    if (!data || !roadmap.attach(data, size_t(file.size()), &error)) {
+        std::fprintf(stderr, "错误: 无法映射路图文件 %s %s\n", outputFile.c_str(), error.c_str());
+        return 1;
+    }
+
+    // 查询位姿：常用位姿，不足两个时取随机节点
+    std::vector<std::vector<double>> poses = options.anchors;
+    if (poses.size() < 2) {
+        std::mt19937 random(20261018u);
+        std::uniform_int_distribution<size_t> pick(0, roadmap.nodeCount() - 1);
+        poses.clear();
+        for (int i = 0; i < 20; ++i) {
+            std::vector<double> pose = fixed;
+            const float *node = roadmap.node(pick(random));
+            for (size_t k = 0; k < jointIds.size(); ++k) {
+                pose[size_t(jointIds[k])] = node[k];
+            }
+            poses.push_back(pose);
+        }
+    }
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<double> times;
+        size_t succeeded = 0;
+        size_t checks = 0;
+        size_t expanded = 0;
+        for (size_t i = 0; i < poses.size(); ++i) {
+            for (size_t j = 0; j < poses.size(); ++j) {
+                if (i == j) {
+                    continue;
+                }
+                const PlanResult result = roadmap.query(planner, poses[i].data(), poses[j].data(), checkOptions);
+                times.push_back(result.planningSeconds * 1000.0);
+                succeeded += result.success ? 1 : 0;
+                checks += result.stateChecks;
+                expanded += result.nodes;
+            }
+        }
+        std::sort(times.begin(), times.end());
+        std::printf("%s: 成功 %zu/%zu，中位 %.3f ms，最大 %.3f ms，平均展开 %.0f 个节点，碰撞检测 %zu 次\n",
+                    pass == 0 ? "首次查询" : "重复查询", succeeded, times.size(), percentile(times, 0.5), times.back(),
+                    double(expanded) / times.size(), checks);
+    }
+    return 0;
+}
+
+int runBenchRetime(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    size_t count = 200;
+    int keyframeCount = 5;
+    PathTimingOptions options;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--count" && hasValue) {
+            count = size_t(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--keyframes" && hasValue) {
+            keyframeCount = std::max(2, std::atoi(value.c_str()));
+        } else if (arg == "--grid" && hasValue) {
+            options.gridPoints = std::max(2, std::atoi(value.c_str()));
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const KinematicModel model = description.kinematicModel();
+    const int jointCount = description.jointCount();
+    std::vector<MotionLimits> limits(static_cast<size_t>(jointCount));
+    for (int j = 0; j < jointCount; ++j) {
+        const JointDescription &joint = description.joint(j);
+        limits[size_t(j)] = MotionLimits(joint.maxVelocity, joint.maxAcceleration, joint.maxJerk);
+    }
+    std::vector<bool> armJoint(static_cast<size_t>(jointCount), false);
+    for (KinematicModel::ChainId arm : { KinematicModel::LeftArm, KinematicModel::RightArm }) {
+        for (const KinematicJoint &joint : model.chain(arm).joints) {
+            if (joint.jointId < jointCount) {
+                armJoint[size_t(joint.jointId)] = true;
+            }
+        }
+    }
+
+    const size_t poses = count * size_t(keyframeCount);
+    const std::vector<double> configurations = randomConfigurations(description, jointCount, poses, 20261018u);
+    const double rate = 100.0;
+    std::vector<double> computeTimes;
+    std::vector<double> renderTimes;
+    double keyframeSum = 0.0;
+    double optimalSum = 0.0;
+    double worstVelocity = 0.0;
+    double worstAcceleration = 0.0;
+    size_t failed = 0;
+    for (size_t n = 0; n < count; ++n) {
+        std::vector<Keyframe> keyframes(static_cast<size_t>(keyframeCount));
+        for (int k = 0; k < keyframeCount; ++k) {
+            Keyframe &keyframe = keyframes[size_t(k)];
+            keyframe.speedScale = 1.0;
+            keyframe.pose.assign(static_cast<size_t>(jointCount), 0.0);
+            for (int j = 0; j < jointCount; ++j) {
+                if (armJoint[size_t(j)]) {
+                    keyframe.pose[size_t(j)] = configurations[size_t(j) * poses + n * size_t(keyframeCount) + size_t(k)];
+                }
+            }
+        }
+        KeyframeSequence sequence;
+        std::string error;
+        if (!sequence.build(keyframes, limits.data(), jointCount, KeyframeSequence::Quintic, &error)) {
+            std::fprintf(stderr, "错误: %s\n", error.c_str());
+            return 1;
+        }
+
+        PathTiming timing;
+        auto start = std::chrono::steady_clock::now();
+        if (!timing.compute(sequence, limits.data(), nullptr, options, &error)) {
+            ++failed;
+            continue;
+        }
+        computeTimes.push_back(secondsSince(start) * 1000.0);
+        start = std::chrono::steady_clock::now();
+        timing.render(rate);
+        renderTimes.push_back(secondsSince(start) * 1000.0);
+        keyframeSum += sequence.duration();
+        optimalSum += timing.duration();
+
+        // 二阶差分包含网格点处的加速度跳变，只作参考
+        for (int sample = 1; sample < timing.sampleCount(); ++sample) {
+            const double *previous = timing.setpoints(sample - 1);
+            const double *current = timing.setpoints(sample);
+            const double *next = timing.setpoints(std::min(sample + 1, timing.sampleCount() - 1));
+            for (int j = 0; j < jointCount; ++j) {
+                const double velocity = (current[j] - previous[j]) * rate;
+                const double acceleration = (next[j] - 2.0 * current[j] + previous[j]) * rate * rate;
+                worstVelocity = std::max(worstVelocity, std::fabs(velocity) / limits[size_t(j)].maxVelocity);
+                if (sample + 1 < timing.sampleCount()) {
+                    worstAcceleration = std::max(worstAcceleration,
+                                                 std::fabs(acceleration) / limits[size_t(j)].maxAcceleration);
+                }
+            }
+        }
+    }
+    if (computeTimes.empty()) {
+        std::fprintf(stderr, "错误: 所有序列的参数化都失败\n");
+        return 1;
+    }
+    std::sort(computeTimes.begin(), computeTimes.end());
+    std::sort(renderTimes.begin(), renderTimes.end());
+
+    const size_t succeeded = computeTimes.size();
+    std::printf("%zu 个序列，每个 %d 个关键帧，网格 %d 点，失败 %zu 个\n", count, keyframeCount, options.gridPoints,
+                failed);
+    std::printf("平均时长: 关键帧计时 %.3f 秒，时间最优 %.3f 秒（%.1f%%）\n", keyframeSum / succeeded,
+                optimalSum / succeeded, 100.0 * optimalSum / keyframeSum);
+    std::printf("参数化耗时: 中位 %.3f ms，最大 %.3f ms；渲染 %.0f Hz 设定点: 中位 %.3f ms，最大 %.3f ms\n",
+                percentile(computeTimes, 0.5), computeTimes.back(), rate, percentile(renderTimes, 0.5),
+                renderTimes.back());
+    std::printf("差分得到的最大速度 %.3f、加速度 %.3f（与关节限制之比）\n", worstVelocity, worstAcceleration);
+    return 0;
+}
+
+int runBenchDynamics(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    size_t count = 20000;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--count" && hasValue) {
+            count = size_t(std::max(1, std::atoi(value.c_str())));
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const KinematicModel model = description.kinematicModel();
+    DynamicModel dynamics;
+    if (!dynamics.configure(model, description.linkInertias()) || dynamics.isEmpty()) {
+        std::fprintf(stderr, "错误: 机器人描述中缺少运动学参数\n");
+        return 1;
+    }
+    const int jointCount = std::max(description.jointCount(), dynamics.jointCount());
+
+    // 行优先布局，与轨迹设定点缓冲相同
+    const std::vector<double> configurations = randomConfigurations(description, jointCount, count, 20261018u);
+    const size_t stride = size_t(jointCount);
+    std::vector<double> q(count * stride);
+    std::vector<double> dq(count * stride);
+    std::vector<double> ddq(count * stride);
+    std::mt19937_64 random(7u);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    for (size_t i = 0; i < count; ++i) {
+        for (int j = 0; j < jointCount; ++j) {
+            const size_t k = i * stride + size_t(j);
+            q[k] = configurations[size_t(j) * count + i];
+            if (j < description.jointCount()) {
+                dq[k] = unit(random) * description.joint(j).maxVelocity;
+                ddq[k] = unit(random) * description.joint(j).maxAcceleration;
+            }
+        }
+    }
+
+    std::vector<double> tau(count * stride, 0.0);
+    std::vector<double> times;
+    times.reserve(count);
+    auto measure = [&](const char *name, const std::function<void(size_t)> &step) {
+        times.clear();
+        for (size_t i = 0; i < count; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            step(i);
+            times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        std::printf("%s: 中位 %.2f us，p99 %.2f us，最大 %.2f us\n", name, percentile(times, 0.5),
+                    percentile(times, 0.99), times.back());
+    };
+    std::vector<double> a(stride, 0.0);
+    std::vector<double> b(stride, 0.0);
+    std::vector<double> c(stride, 0.0);
+    measure("逆动力学", [&](size_t i) {
+        dynamics.inverseDynamics(&q[i * stride], &dq[i * stride], &ddq[i * stride], &tau[i * stride]);
+    });
+    measure("重力补偿", [&](size_t i) {
+        dynamics.gravityTorques(&q[i * stride], &tau[i * stride]);
+    });
+    std::vector<double> worstGravity(stride, 0.0);
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < stride; ++j) {
+            worstGravity[j] = std::max(worstGravity[j], std::fabs(tau[i * stride + j]));
+        }
+    }
+    measure("路径力矩系数", [&](size_t i) {
+        dynamics.pathCoefficients(&q[i * stride], &dq[i * stride], &ddq[i * stride], a.data(), b.data(), c.data());
+    });
+
+    // 批量结果应与逐个计算完全一致
+    std::vector<double> single(stride, 0.0);
+    const auto start = std::chrono::steady_clock::now();
+    dynamics.inverseDynamicsBatch(q.data(), dq.data(), ddq.data(), stride, count, tau.data());
+    const double batchSeconds = secondsSince(start);
+    double mismatch = 0.0;
+    for (size_t i = 0; i < count; i += std::max<size_t>(1, count / 100)) {
+        dynamics.inverseDynamics(&q[i * stride], &dq[i * stride], &ddq[i * stride], single.data());
+        for (int j = 0; j < jointCount; ++j) {
+            if (dynamics.hasJoint(j)) {
+                mismatch = std::max(mismatch, std::fabs(single[size_t(j)] - tau[i * stride + size_t(j)]));
+            }
+        }
+    }
+    std::printf("批量 %zu 组: %.3f ms，每组 %.2f us，与逐个计算的最大差 %.1e\n", count, batchSeconds * 1000.0,
+                batchSeconds * 1e6 / count, mismatch);
+
+    std::printf("随机构型中重力补偿力矩的最大值:\n");
+    for (int j = 0; j < description.jointCount(); ++j) {
+        if (dynamics.hasJoint(j)) {
+            std::printf("  %-12s %9.3f %s\n", description.joint(j).name.toStdString().c_str(), worstGravity[size_t(j)],
+                        description.joint(j).type == JointType::Prismatic ? "N" : "N·m");
+        }
+    }
+    return 0;
+}
+
+int runBenchDrive(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    double radius = 1.0;
+    double speed = 0.3;
+    double feedbackRate = 20.0;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--radius" && hasValue) {
+            radius = std::atof(value.c_str());
+        } else if (arg == "--speed" && hasValue) {
+            speed = std::atof(value.c_str());
+        } else if (arg == "--feedback" && hasValue) {
+            feedbackRate = std::atof(value.c_str());
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+    if (!(radius > 0.0) || !(speed > 0.0) || !(feedbackRate > 0.0)) {
+        std::fprintf(stderr, "半径、速度和反馈频率必须为正\n");
+        return 2;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const JointGroupDescription *chassis = description.findGroup("chassis");
+    if (!chassis || chassis->joints.size() < 2) {
+        std::fprintf(stderr, "描述中没有底盘组\n");
+        return 1;
+    }
+
+    // 轮速限制与控制器相同：取两个电机中较小的
+    const JointDescription &leftJoint = description.joint(chassis->firstJoint);
+    const JointDescription &rightJoint = description.joint(chassis->firstJoint + 1);
+    const double maxSpeed = std::min(std::min(-leftJoint.minValue, leftJoint.maxValue),
+                                     std::min(-rightJoint.minValue, rightJoint.maxValue));
+    const MotionLimits wheelLimits(maxSpeed, std::min(leftJoint.maxVelocity, rightJoint.maxVelocity), 0.0);
+    DifferentialDrive drive;
+    std::string error;
+    if (!drive.configure(chassis->drive, wheelLimits, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("轮半径 %.3f m，轮距 %.3f m，减速比 %.1f，轮速限制 %.0f rpm，%.0f rpm/s（本体 %.2f m/s²）\n",
+                chassis->drive.wheelRadius, chassis->drive.trackWidth, chassis->drive.gearRatio,
+                wheelLimits.maxVelocity, wheelLimits.maxAcceleration, drive.maxLinearAcceleration());
+
+    // 实际轨迹：控制周期内轮速为常数，按控制频率的圆弧积分即为精确解；
+    // 里程计按较低的反馈频率采样轮速，分别用圆弧和欧拉积分
+    const double controlRate = 100.0;
+    const double dt = 1.0 / controlRate;
+    const int feedbackEvery = std::max(1, int(std::lround(controlRate / feedbackRate)));
+    DifferentialDrive arc;
+    arc.configure(chassis->drive, wheelLimits);
+    PlanarPose euler;
+    drive.setCommand(speed, speed / radius);
+
+    // 指令超出轮速限制时两轮同比降速；外侧轮的速度变化最大，决定加速和制动的时间
+    double goalLeft = 0.0;
+    double goalRight = 0.0;
+    drive.wheelSpeeds(speed, speed / radius, &goalLeft, &goalRight);
+    const double fastest = std::max(std::fabs(goalLeft), std::fabs(goalRight));
+    const double cruise = speed * std::min(1.0, wheelLimits.maxVelocity / fastest);
+    const double rampTime = std::min(fastest, wheelLimits.maxVelocity) / wheelLimits.maxAcceleration;
+    if (cruise < speed) {
+        std::printf("指令超出轮速限制，线速度按比例降至 %.3f m/s\n", cruise);
+    }
+
+    double worstRate = 0.0;
+    double previousLeft = 0.0;
+    double previousRight = 0.0;
+    double accelerationTime = -1.0;
+    double accelerationDistance = 0.0;
+    double brakeStart = -1.0;
+    double brakeDistanceStart = 0.0;
+    double stepSeconds = 0.0;
+    double arcError = 0.0;
+    double eulerError = 0.0;
+    const double lapTime = 2.0 * 3.14159265358979323846 * radius / cruise;
+    int tick = 0;
+    for (; tick < 1000000; ++tick) {
+        const double t = tick * dt;
+        if (brakeStart < 0.0 && t >= lapTime) {
+            drive.stop();
+            brakeStart = t;
+            brakeDistanceStart = drive.travelledDistance();
+        }
+        double left = 0.0;
+        double right = 0.0;
+        const auto start = std::chrono::steady_clock::now();
+        drive.step(dt, &left, &right);
+        drive.integrate(left, right, dt);
+        stepSeconds += secondsSince(start);
+        worstRate = std::max(worstRate, std::max(std::fabs(left - previousLeft), std::fabs(right - previousRight))
+                                            / dt / wheelLimits.maxAcceleration);
+        previousLeft = left;
+        previousRight = right;
+        if (accelerationTime < 0.0 && std::fabs(drive.linearVelocity() - cruise) < 1e-9 * cruise) {
+            accelerationTime = t + dt;
+            accelerationDistance = drive.travelledDistance();
+        }
+
+        // 反馈：每 feedbackEvery 个控制周期采样一次轮速，样本之间按该轮速积分
+        if (tick % feedbackEvery == 0) {
+            double linear = 0.0;
+            double angular = 0.0;
+            drive.bodyVelocity(left, right, &linear, &angular);
+            const double interval = feedbackEvery * dt;
+            arc.integrate(left, right, interval);
+            euler.x += linear * std::cos(euler.heading) * interval;
+            euler.y += linear * std::sin(euler.heading) * interval;
+            euler.heading += angular * interval;
+            const PlanarPose &truth = drive.pose();
+            arcError = std::max(arcError, std::hypot(arc.pose().x - truth.x, arc.pose().y - truth.y));
+            eulerError = std::max(eulerError, std::hypot(euler.x - truth.x, euler.y - truth.y));
+        }
+        if (brakeStart >= 0.0 && !drive.isActive()) {
+            break;
+        }
+    }
+    const double totalTime = (tick + 1) * dt;
+
+    std::printf("加速到 %.3f m/s: %.2f s，%.3f m（外侧轮满加速度为 %.2f s，%.3f m）\n", cruise, accelerationTime,
+                accelerationDistance, rampTime, 0.5 * cruise * rampTime);
+    std::printf("制动: %.2f s，%.3f m\n", totalTime - brakeStart, drive.travelledDistance() - brakeDistanceStart);
+    std::printf("轮速变化率与限制之比最大 %.4f\n", worstRate);
+    std::printf("终点 (%.3f, %.3f) m，航向 %.1f°，行驶 %.3f m\n", drive.pose().x, drive.pose().y,
+                drive.pose().heading * 180.0 / 3.14159265358979323846, drive.travelledDistance());
+    std::printf("%.0f Hz 反馈的里程计最大位置误差: 圆弧积分 %.2e m，欧拉积分 %.2e m\n", controlRate / feedbackEvery,
+                arcError, eulerError);
+    std::printf("每周期限速 + 积分: %.0f ns\n", stepSeconds * 1e9 / (tick + 1));
+    return 0;
+}
+
+int runBenchWholeBody(int argc, char *argv[])
+{
+    std::string descriptionFile;
+    size_t count = 5000;
+    size_t targets = 300;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--count" && hasValue) {
+            count = size_t(std::max(1, std::atoi(value.c_str())));
+        } else if (arg == "--targets" && hasValue) {
+            targets = size_t(std::max(1, std::atoi(value.c_str())));
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const KinematicModel model = description.kinematicModel();
+    const int jointCount = std::max(description.jointCount(), model.jointCount());
+    std::vector<double> minLimits(static_cast<size_t>(jointCount), 0.0);
+    std::vector<double> maxLimits(static_cast<size_t>(jointCount), 0.0);
+    std::vector<double> speedLimits(static_cast<size_t>(jointCount), 0.0);
+    for (int j = 0; j < description.jointCount(); ++j) {
+        minLimits[size_t(j)] = description.joint(j).minValue;
+        maxLimits[size_t(j)] = description.joint(j).maxValue;
+        speedLimits[size_t(j)] = description.joint(j).maxVelocity;
+    }
+    WholeBodySolver solver;
+    ArmIkSolver armSolver;
+    if (!solver.configure(&model, minLimits.data(), maxLimits.data())
+        || !armSolver.configure(&model, KinematicModel::LeftArm, minLimits.data(), maxLimits.data())) {
+        std::fprintf(stderr, "错误: 机器人描述中缺少手臂运动学参数\n");
+        return 1;
+    }
+
+    // 速度层：两臂同时给随机旋量
+    const std::vector<double> configurations = randomConfigurations(description, jointCount, count, 20261018u);
+    std::mt19937_64 random(13u);
+    std::uniform_real_distribution<double> linear(-0.1, 0.1);
+    std::uniform_real_distribution<double> angular(-0.5, 0.5);
+    std::vector<double> q(static_cast<size_t>(jointCount));
+    std::vector<double> velocities(static_cast<size_t>(jointCount), 0.0);
+    std::vector<double> times;
+    times.reserve(count);
+    double scaleSum = 0.0;
+    size_t limited = 0;
+    for (size_t i = 0; i < count; ++i) {
+        for (int j = 0; j < jointCount; ++j) {
+            q[size_t(j)] = configurations[size_t(j) * count + i];
+        }
+        WholeBodyTask tasks[2];
+        for (WholeBodyTask &task : tasks) {
+            task.active = true;
+            for (int k = 0; k < 6; ++k) {
+                task.twist[k] = k < 3 ? linear(random) : angular(random);
+            }
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const WholeBodyResult result = solver.velocities(q.data(), tasks, speedLimits.data(), velocities.data());
+        times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        scaleSum += result.scale;
+        limited += result.limited ? 1 : 0;
+    }
+    std::sort(times.begin(), times.end());
+    std::printf("两臂全身速度分解（%d 个关节），%zu 个控制周期\n", solver.jointCount(), count);
+    std::printf("每周期耗时: 中位 %.2f us，p99 %.2f us，最大 %.2f us（10 ms 控制周期的 %.2f%%）\n",
+                percentile(times, 0.5), percentile(times, 0.99), times.back(), percentile(times, 0.99) / 100.0);
+    std::printf("平均速度比例 %.1f%%，%.1f%% 的周期有关节接近限位\n", 100.0 * scaleSum / count,
+                100.0 * limited / count);
+
+    // 位置层：目标来自躯干也随机的构型，初值躯干在行程中点
+    const std::vector<double> goals = randomConfigurations(description, jointCount, targets, 20261019u);
+    const std::vector<double> seeds = randomConfigurations(description, jointCount, targets, 20261020u);
+    IkOptions ikOptions;
+    ikOptions.maxIterations = 60;
+    size_t converged[3] = { 0, 0, 0 };
+    double seconds[3] = { 0.0, 0.0, 0.0 };
+    std::vector<double> goal(static_cast<size_t>(jointCount));
+    std::vector<double> seed(static_cast<size_t>(jointCount));
+    std::vector<double> solution(static_cast<size_t>(jointCount));
+    for (size_t i = 0; i < targets; ++i) {
+        for (int j = 0; j < jointCount; ++j) {
+            goal[size_t(j)] = goals[size_t(j) * targets + i];
+            seed[size_t(j)] = seeds[size_t(j) * targets + i];
+        }
+        for (const KinematicJoint &joint : model.chain(KinematicModel::Trunk).joints) {
+            seed[size_t(joint.jointId)] = 0.5 * (minLimits[size_t(joint.jointId)] + maxLimits[size_t(joint.jointId)]);
+        }
+        WholeBodyTask tasks[2];
+        tasks[0].target = model.forward(KinematicModel::LeftArm, goal.data());
+        tasks[1].target = model.forward(KinematicModel::RightArm, goal.data());
+
+        auto start = std::chrono::steady_clock::now();
+        converged[0] += armSolver.solve(tasks[0].target, seed.data(), solution.data(), ikOptions).converged ? 1 : 0;
+        seconds[0] += secondsSince(start);
+        tasks[0].active = true;
+        start = std::chrono::steady_clock::now();
+        converged[1] += solver.solve(tasks, seed.data(), solution.data(), WholeBodyOptions(), ikOptions).converged;
+        seconds[1] += secondsSince(start);
+        tasks[1].active = true;
+        start = std::chrono::steady_clock::now();
+        converged[2] += solver.solve(tasks, seed.data(), solution.data(), WholeBodyOptions(), ikOptions).converged;
+        seconds[2] += secondsSince(start);
+    }
+    const char *names[3] = { "单臂逆解（躯干固定）", "全身逆解（左臂）", "全身逆解（两臂）" };
+    for (int k = 0; k < 3; ++k) {
+        std::printf("%s: 收敛 %zu/%zu（%.1f%%），平均 %.0f us\n", names[k], converged[k], targets,
+                    100.0 * converged[k] / targets, seconds[k] * 1e6 / targets);
+    }
+    return 0;
+}
+
+int runBuildReachability(int argc, char *argv[])
+{
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+    const std::string outputFile = argv[2];
+    std::string descriptionFile;
+    const char *trunkFile = nullptr;
+    ReachabilityOptions options;
+    for (int i = 3; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        if (arg == "--description" && hasValue) {
+            descriptionFile = value;
+        } else if (arg == "--samples" && hasValue) {
+            options.sampleCount = size_t(std::max(1.0, std::atof(value.c_str())));
+        } else if (arg == "--resolution" && hasValue) {
+            options.resolution = std::max(0.001, std::atof(value.c_str()));
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = uint32_t(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--fixed-trunk" && hasValue) {
+            trunkFile = argv[i + 1];
+            options.sampleTrunk = false;
+        } else {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+        ++i;
+    }
+
+    RobotDescription description;
+    if (!loadDescription(descriptionFile, description)) {
+        return 1;
+    }
+    const KinematicModel model = description.kinematicModel();
+    const int jointCount = std::max(description.jointCount(), model.jointCount());
+    std::vector<double> minLimits(static_cast<size_t>(jointCount), 0.0);
+    std::vector<double> maxLimits(static_cast<size_t>(jointCount), 0.0);
+    for (int j = 0; j < description.jointCount(); ++j) {
+        minLimits[size_t(j)] = description.joint(j).minValue;
+        maxLimits[size_t(j)] = description.joint(j).maxValue;
+    }
+    std::vector<double> fixed(static_cast<size_t>(jointCount), 0.0);
+    if (trunkFile) {
+        fixed = readPoseFile(trunkFile, jointCount);
+    }
+
+    ReachabilityMap built;
+    std::string error;
+    const auto buildStart = std::chrono::steady_clock::now();
+    if (!built.build(model, minLimits.data(), maxLimits.data(), fixed.data(), options, &error)) {
+        std::fprintf(stderr, "错误: %s\n", error.c_str());
+        return 1;
+    }
+    const double buildSeconds = secondsSince(buildStart);
+    if (!built.save(outputFile, &error)) {
+        std::fprintf(stderr, "错误: %s\n", error.c_str());
+        return 1;
+    }
+    const int threads = options.threads > 0 ? options.threads : std::max(1, int(std::thread::hardware_concurrency()));
+    const ReachabilityHeader &header = built.header();
+    std::printf("%zu 个构型（躯干%s），%d 个线程构建 %.2f 秒（每秒 %.0f 个构型），网格 %u x %u x %u（%.0f mm），"
+                "文件 %.1f MB\n", options.sampleCount, options.sampleTrunk ? "随机" : "固定", threads, buildSeconds,
+                options.sampleCount / buildSeconds, header.dimensions[0], header.dimensions[1], header.dimensions[2],
+                options.resolution * 1000.0, built.imageBytes() / 1048576.0);
+
+    // 与控制器相同：映射文件后直接使用
+    const auto mapStart = std::chrono::steady_clock::now();
+    QFile file(QString::fromLocal8Bit(outputFile.c_str()));
+    const uchar *data = file.open(QIODevice::ReadOnly) ? file.map(0, file.size()) : nullptr;
+    ReachabilityMap map;
+    if (!data || !map.attach(data, size_t(file.size()), &error)) {
+        std::fprintf(stderr, "错误: 无法映射可达性图文件 %s %s\n", outputFile.c_str(), error.c_str());
+        return 1;
+    }
+    const double mapSeconds = secondsSince(mapStart);
+
+    const double cellVolume = std::pow(map.resolution(), 3.0);
+    const char *armNames[2] = { "左臂", "右臂" };
+    for (int arm = 0; arm < 2; ++arm) {
+        const ReachabilitySummary summary = map.summary(arm);
+        std::printf("%s: 可达 %.3f m^3（%zu 个体素），灵活 %.3f m^3，最大可操作度 %.4f\n", armNames[arm],
+                    summary.reachableCells * cellVolume, summary.reachableCells, summary.dexterousCells * cellVolume,
+                    summary.maxManipulability);
+    }
+
+    // 另取随机构型：末端落在无样本体素内说明采样不足
+    const size_t checks = 100000;
+    const std::vector<double> q = randomConfigurations(description, jointCount, checks, 20261018u);
+    std::vector<double> single(static_cast<size_t>(jointCount));
+    std::vector<Transform> tools(2 * checks);
+    for (size_t i = 0; i < checks; ++i) {
+        for (int j = 0; j < jointCount; ++j) {
+            single[size_t(j)] = q[size_t(j) * checks + i];
+        }
+        if (!options.sampleTrunk) {
+            for (const KinematicJoint &joint : model.chain(KinematicModel::Trunk).joints) {
+                const size_t id = size_t(joint.jointId);
+                single[id] = std::min(std::max(fixed[id], minLimits[id]), maxLimits[id]);
+            }
+        }
+        model.forward(single.data(), &tools[2 * i], &tools[2 * i + 1]);
+    }
+    size_t missed = 0;
+    double sum = 0.0;
+    const auto lookupStart = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < tools.size(); ++k) {
+        const ReachabilityCell *cell = map.cell(int(k % 2), tools[k].p);
+        missed += !cell || cell->samples == 0 ? 1 : 0;
+        sum += cell ? ReachabilityMap::coverage(*cell) : 0.0;
+    }
+    const double lookupSeconds = secondsSince(lookupStart);
+    std::printf("映射 %.3f ms，单点查询 %.0f ns；另取 %zu 个构型，末端落在无样本体素的比例 %.3f%%（平均覆盖 %.2f）\n",
+                mapSeconds * 1000.0, lookupSeconds * 1e9 / (2 * checks), checks, 100.0 * missed / (2 * checks),
+                sum / (2 * checks));
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        printUsage();
+        return 2;
+    }
+
+    const std::string command = argv[1];
+    if (command == "fk") {
+        return runFk(argc, argv);
+    }
+    if (command == "bench-fk") {
+        return runBenchFk(argc, argv);
+    }
+    if (command == "bench-ik") {
+        return runBenchIk(argc, argv);
+    }
+    if (command == "bench-jog") {
+        return runBenchJog(argc, argv);
+    }
+    if (command == "bench-collision") {
+        return runBenchCollision(argc, argv);
+    }
+    if (command == "bench-env") {
+        return runBenchEnvironment(argc, argv);
+    }
+    if (command == "bench-plan") {
+        return runBenchPlan(argc, argv);
+    }
+    if (command == "build-roadmap") {
+        return runBuildRoadmap(argc, argv);
+    }
+    if (command == "bench-retime") {
+        return runBenchRetime(argc, argv);
+    }
+    if (command == "bench-dynamics") {
+        return runBenchDynamics(argc, argv);
+    }
+    if (command == "bench-drive") {
+        return runBenchDrive(argc, argv);
+    }
+    if (command == "bench-wholebody") {
+        return runBenchWholeBody(argc, argv);
+    }
+    if (command == "build-reachability") {
+        return runBuildReachability(argc, argv);
+    }
+
+    printUsage();
+    return 2;
+}
@@ -0,0 +1,293 @@
+#include "selfcollision.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double MIN_SEGMENT_LENGTH = 1e-3;    // 更短的线段（如球腕的重合坐标系）并入下一段
+
+double distanceSquared(const double *a, const double *b)
+{
+    const double dx = a[0] - b[0];
+    const double dy = a[1] - b[1];
+    const double dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+double dot(const double *a, const double *b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+double clamp01(double value)
+{
+    return value < 0.0 ? 0.0 : (value > 1.0 ? 1.0 : value);
+}
+
+} // namespace
+
+SelfCollisionResult::SelfCollisionResult()
+    : minimumDistance(std::numeric_limits<double>::infinity())
+    , capsuleA(-1)
+    , capsuleB(-1)
+    , pairsTested(0)
+{
+    for (int g = 0; g < PAIR_GROUP_COUNT; ++g) {
+        groupDistance[g] = std::numeric_limits<double>::infinity();
+    }
+}
+
+SelfCollisionModel::SelfCollisionModel()
+    : m_model(nullptr)
+{
+    const KinematicModel::ChainId chains[SelfCollisionResult::PAIR_GROUP_COUNT][2] = {
+        { KinematicModel::LeftArm, KinematicModel::RightArm },
+        { KinematicModel::LeftArm, KinematicModel::Trunk },
+        { KinematicModel::RightArm, KinematicModel::Trunk },
+        { KinematicModel::LeftArm, KinematicModel::LeftArm },
+        { KinematicModel::RightArm, KinematicModel::RightArm },
+    };
+    for (int g = 0; g < SelfCollisionResult::PAIR_GROUP_COUNT; ++g) {
+        m_groupChains[g][0] = chains[g][0];
+        m_groupChains[g][1] = chains[g][1];
+    }
+}
+
+bool SelfCollisionModel::configure(const KinematicModel *model, const std::vector<double> &linkRadii)
+{
+    m_model = nullptr;
+    m_capsules.clear();
+    for (std::vector<CapsulePair> &pairs : m_pairs) {
+        pairs.clear();
+    }
+    if (model->isEmpty()) {
+        return false;
+    }
+
+    // 零位的各坐标系，用于合并零长度线段和排除零位即接触的组合
+    m_frames.assign(size_t(model->frameCount()), Transform());
+    const std::vector<double> zero(size_t(model->jointCount()), 0.0);
+    model->linkFrames(zero.data(), m_frames.data());
+
+    const double origin[3] = { 0.0, 0.0, 0.0 };
+    auto framePoint = [this, &origin](int frame) {
+        return frame < 0 ? origin : m_frames[size_t(frame)].p;
+    };
+
+    // 链在 linkFrames 中的起始下标：躯干从底座原点出发，手臂从躯干末端出发
+    int frame = 0;
+    int trunkTool = -1;
+    for (int c = KinematicModel::Trunk; c <= KinematicModel::RightArm; ++c) {
+        const KinematicModel::ChainId chain = KinematicModel::ChainId(c);
+        const std::vector<KinematicJoint> &joints = model->chain(chain).joints;
+        int start = chain == KinematicModel::Trunk ? -1 : trunkTool;
+        for (size_t k = 0; k <= joints.size(); ++k, ++frame) {
+            if (joints.empty()) {
+                break;
+            }
+            const int jointId = joints[std::min(k, joints.size() - 1)].jointId;
+            if (std::sqrt(distanceSquared(framePoint(start), framePoint(frame))) < MIN_SEGMENT_LENGTH) {
+                continue;
+            }
+            const double radius = size_t(jointId) < linkRadii.size() ? linkRadii[size_t(jointId)] : 0.0;
+            if (radius > 0.0) {
+                CollisionCapsule capsule;
+                capsule.chain = chain;
+                capsule.startFrame = start;
+                capsule.endFrame = frame;
+                capsule.jointId = jointId;
+                capsule.tool = k == joints.size();
+                capsule.radius = radius;
+                m_capsules.push_back(capsule);
+            }
+            start = frame;
+        }
+        if (joints.empty()) {
+            // 空链只占一个末端坐标系
+            ++frame;
+        }
+        if (chain == KinematicModel::Trunk) {
+            trunkTool = frame - 1;
+        }
+    }
+    if (m_capsules.empty()) {
+        return false;
+    }
+
+    m_points.assign(m_capsules.size() * 6, 0.0);
+    m_capsuleBoxes.assign(m_capsules.size(), Box());
+    m_model = model;
+    updateGeometry(zero.data());
+
+    // 共用端点的胶囊（相邻连杆、同一处分出的两臂肩部）和零位即接触的组合不检测
+    for (int g = 0; g < SelfCollisionResult::PAIR_GROUP_COUNT; ++g) {
+        const bool sameChain = m_groupChains[g][0] == m_groupChains[g][1];
+        for (size_t a = 0; a < m_capsules.size(); ++a) {
+            if (m_capsules[a].chain != m_groupChains[g][0]) {
+                continue;
+            }
+            for (size_t b = sameChain ? a + 1 : 0; b < m_capsules.size(); ++b) {
+                const CollisionCapsule &first = m_capsules[a];
+                const CollisionCapsule &second = m_capsules[b];
+                if (second.chain != m_groupChains[g][1]) {
+                    continue;
+                }
+                if (first.startFrame == second.startFrame || first.startFrame == second.endFrame
+                    || first.endFrame == second.startFrame || first.endFrame == second.endFrame) {
+                    continue;
+                }
+                const double *p = &m_points[a * 6];
+                const double *q = &m_points[b * 6];
+                if (segmentDistance(p, p + 3, q, q + 3) <= first.radius + second.radius) {
+                    continue;
+                }
+                CapsulePair pair;
+                pair.a = int(a);
+                pair.b = int(b);
+                m_pairs[g].push_back(pair);
+            }
+        }
+    }
+    return true;
+}
+
+size_t SelfCollisionModel::pairCount() const
+{
+    size_t count = 0;
+    for (const std::vector<CapsulePair> &pairs : m_pairs) {
+        count += pairs.size();
+    }
+    return count;
+}
+
+void SelfCollisionModel::updateGeometry(const double *q) const
+{
+    m_model->linkFrames(q, m_frames.data());
+
+    for (int c = 0; c < KinematicModel::CHAIN_COUNT; ++c) {
+        for (int k = 0; k < 3; ++k) {
+            m_chainBoxes[c].lower[k] = std::numeric_limits<double>::infinity();
+            m_chainBoxes[c].upper[k] = -std::numeric_limits<double>::infinity();
+        }
+    }
+    for (size_t i = 0; i < m_capsules.size(); ++i) {
+        const CollisionCapsule &capsule = m_capsules[i];
+        double *points = &m_points[i * 6];
+        for (int k = 0; k < 3; ++k) {
+            points[k] = capsule.startFrame < 0 ? 0.0 : m_frames[size_t(capsule.startFrame)].p[k];
+            points[k + 3] = m_frames[size_t(capsule.endFrame)].p[k];
+        }
+
+        Box &box = m_capsuleBoxes[i];
+        Box &chainBox = m_chainBoxes[capsule.chain];
+        for (int k = 0; k < 3; ++k) {
+            box.lower[k] = std::min(points[k], points[k + 3]) - capsule.radius;
+            box.upper[k] = std::max(points[k], points[k + 3]) + capsule.radius;
+            chainBox.lower[k] = std::min(chainBox.lower[k], box.lower[k]);
+            chainBox.upper[k] = std::max(chainBox.upper[k], box.upper[k]);
+        }
+    }
+}
+
+double SelfCollisionModel::boxDistance(const Box &a, const Box &b)
+{
+    double sum = 0.0;
+    for (int k = 0; k < 3; ++k) {
+        const double gap = std::max(a.lower[k] - b.upper[k], b.lower[k] - a.upper[k]);
+        if (gap > 0.0) {
+            sum += gap * gap;
+        }
+    }
+    return std::sqrt(sum);
+}
+
+double SelfCollisionModel::segmentDistance(const double *p0, const double *p1, const double *q0, const double *q1)
+{
+    // 两线段最近点（参数 s、t 依次夹紧到 [0, 1]）
+    const double d1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const double d2[3] = { q1[0] - q0[0], q1[1] - q0[1], q1[2] - q0[2] };
+    const double r[3] = { p0[0] - q0[0], p0[1] - q0[1], p0[2] - q0[2] };
+    const double a = dot(d1, d1);
+    const double e = dot(d2, d2);
+    const double f = dot(d2, r);
+    const double epsilon = 1e-12;
+
+    double s = 0.0;
+    double t = 0.0;
+    if (a <= epsilon && e <= epsilon) {
+        return std::sqrt(dot(r, r));
+    }
+    if (a <= epsilon) {
+        t = clamp01(f / e);
+    } else {
+        const double c = dot(d1, r);
+        if (e <= epsilon) {
+            s = clamp01(-c / a);
+        } else {
+            const double b = dot(d1, d2);
+            const double denominator = a * e - b * b;
+            s = denominator > epsilon ? clamp01((b * f - c * e) / denominator) : 0.0;
+            t = (b * s + f) / e;
+            if (t < 0.0) {
+                t = 0.0;
+                s = clamp01(-c / a);
+            } else if (t > 1.0) {
+                t = 1.0;
+                s = clamp01((b - c) / a);
+            }
+        }
+    }
+
+    const double closestP[3] = { p0[0] + d1[0] * s, p0[1] + d1[1] * s, p0[2] + d1[2] * s };
+    const double closestQ[3] = { q0[0] + d2[0] * t, q0[1] + d2[1] * t, q0[2] + d2[2] * t };
+    return std::sqrt(distanceSquared(closestP, closestQ));
+}
+
+SelfCollisionResult SelfCollisionModel::check(const double *q, double range) const
+{
+    SelfCollisionResult result;
+    if (!m_model) {
+        return result;
+    }
+    updateGeometry(q);
+
+    result.minimumDistance = range;
+    for (int g = 0; g < SelfCollisionResult::PAIR_GROUP_COUNT; ++g) {
+        double best = range;
+        result.groupDistance[g] = range;
+        const std::vector<CapsulePair> &pairs = m_pairs[g];
+        if (pairs.empty()) {
+            continue;
+        }
+
+        // 第一层：两条链的总包围盒已超出范围，整组跳过（同一条链不适用）
+        const KinematicModel::ChainId first = m_groupChains[g][0];
+        const KinematicModel::ChainId second = m_groupChains[g][1];
+        if (first != second && boxDistance(m_chainBoxes[first], m_chainBoxes[second]) >= best) {
+            continue;
+        }
+
+        // 第二层：胶囊包围盒距离是表面距离的下界，不小于当前最小值的胶囊对不再精确计算
+        for (const CapsulePair &pair : pairs) {
+            if (boxDistance(m_capsuleBoxes[size_t(pair.a)], m_capsuleBoxes[size_t(pair.b)]) >= best) {
+                continue;
+            }
+            const double *p = &m_points[size_t(pair.a) * 6];
+            const double *r = &m_points[size_t(pair.b) * 6];
+            const double distance = segmentDistance(p, p + 3, r, r + 3)
+                                  - m_capsules[size_t(pair.a)].radius - m_capsules[size_t(pair.b)].radius;
+            ++result.pairsTested;
+            if (distance < best) {
+                best = distance;
+                if (distance < result.minimumDistance) {
+                    result.minimumDistance = distance;
+                    result.capsuleA = pair.a;
+                    result.capsuleB = pair.b;
+                }
+            }
+        }
+        result.groupDistance[g] = best;
+    }
+    return result;
+}
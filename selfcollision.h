@@ -0,0 +1,90 @@
+#ifndef SELFCOLLISION_H
+#define SELFCOLLISION_H
+
+#include <vector>
+#include "kinematics.h"
+
+// 连杆包络胶囊：相邻两个关节坐标系原点之间的线段加半径
+struct CollisionCapsule {
+    KinematicModel::ChainId chain;
+    int startFrame;         // linkFrames 中的下标，-1 为底座原点
+    int endFrame;
+    int jointId;            // 线段终点所属的关节（末端线段为链上最后一个关节）
+    bool tool;              // 终点是链末端（手臂为法兰）
+    double radius;          // 米
+
+    CollisionCapsule()
+        : chain(KinematicModel::Trunk), startFrame(-1), endFrame(0), jointId(0), tool(false), radius(0.0) {}
+};
+
+struct SelfCollisionResult {
+    // 分别统计的部位组合
+    enum PairGroup {
+        ArmArm,             // 左臂 - 右臂
+        LeftArmBody,        // 左臂 - 躯干（升降、腰部）
+        RightArmBody,
+        LeftArmSelf,        // 同一手臂不相邻的连杆
+        RightArmSelf,
+        PAIR_GROUP_COUNT
+    };
+
+    double minimumDistance;                 // 胶囊表面最小距离（米），负值为穿透深度
+    int capsuleA;                           // 距离最近的一对胶囊，-1 表示检测范围内没有胶囊对
+    int capsuleB;
+    double groupDistance[PAIR_GROUP_COUNT]; // 各组合的最小距离
+    int pairsTested;                        // 实际计算精确距离的胶囊对数
+
+    SelfCollisionResult();
+};
+
+// 自碰撞检测：由运动学模型自动生成连杆胶囊，相邻连杆和零位即接触的组合不检测。
+// 两层包围盒层次：每条链一个总包围盒，其下为各胶囊的包围盒。各部位组合分别做分支定界，
+// 包围盒距离不小于当前最小值的链或胶囊对直接跳过，得到的仍是精确的最小距离。
+// 检测过程不分配内存，可在每个设定点下发前调用。
+class SelfCollisionModel
+{
+public:
+    SelfCollisionModel();
+
+    // linkRadii 按全局关节ID索引，半径为 0 的关节不生成胶囊；模型需在检测期间保持有效
+    bool configure(const KinematicModel *model, const std::vector<double> &linkRadii);
+    bool isEmpty() const { return m_capsules.empty(); }
+    const std::vector<CollisionCapsule> &capsules() const { return m_capsules; }
+    size_t pairCount() const;       // 参与检测的胶囊对总数
+
+    // q 按全局关节ID索引，单位与关节一致。距离超过 range 的组合在包围盒层就被剔除，
+    // 报告的距离为 range；需要精确的全局距离时传入很大的值
+    SelfCollisionResult check(const double *q, double range) const;
+    // 最近一次 check 时各胶囊的端点（底座坐标系），每个胶囊 6 个分量，供环境碰撞检测复用
+    const std::vector<double> &capsulePoints() const { return m_points; }
+
+    // 两线段 [p0, p1]、[q0, q1] 之间的最小距离
+    static double segmentDistance(const double *p0, const double *p1, const double *q0, const double *q1);
+
+private:
+    struct Box {
+        double lower[3];
+        double upper[3];
+    };
+
+    struct CapsulePair {
+        int a;
+        int b;
+    };
+
+    void updateGeometry(const double *q) const;
+    static double boxDistance(const Box &a, const Box &b);
+
+    const KinematicModel *m_model;
+    std::vector<CollisionCapsule> m_capsules;
+    std::vector<CapsulePair> m_pairs[SelfCollisionResult::PAIR_GROUP_COUNT];
+    KinematicModel::ChainId m_groupChains[SelfCollisionResult::PAIR_GROUP_COUNT][2];
+
+    // 检测时的暂存（预先分配）
+    mutable std::vector<Transform> m_frames;
+    mutable std::vector<double> m_points;     // 每个胶囊两个端点，各 3 个分量
+    mutable std::vector<Box> m_capsuleBoxes;
+    mutable Box m_chainBoxes[KinematicModel::CHAIN_COUNT];
+};
+
+#endif // SELFCOLLISION_H
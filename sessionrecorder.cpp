@@ -0,0 +1,324 @@
+#include "sessionrecorder.h"
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <chrono>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
+
+static_assert(sizeof(SessionRecord) == SessionRecord::SIZE, "SessionRecord 必须为定长256字节");
+static_assert(sizeof(SessionSegmentHeader) == SessionSegmentHeader::SIZE, "段文件头必须为4096字节");
+
+SessionRecorder::SessionRecorder(QObject *parent)
+    : QThread(parent)
+    , m_queue(QUEUE_CAPACITY)
+    , m_queueHead(0)
+    , m_queueTail(0)
+    , m_dropped(0)
+    , m_stopRequested(false)
+    , m_sequence(0)
+    , m_segmentBytes(DEFAULT_SEGMENT_BYTES)
+    , m_segmentNumber(0)
+    , m_mapped(nullptr)
+    , m_header(nullptr)
+    , m_recordIndex(0)
+    , m_recording(false)
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    stopRecording();
+}
+
+bool SessionRecorder::startRecording(const QString &directory, qint64 segmentBytes, QString *errorMessage)
+{
+    if (m_recording) {
+        return true;
+    }
+
+    QDir dir(directory);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        if (errorMessage) {
+            *errorMessage = QString("无法创建记录目录: %1").arg(directory);
+        }
+        return false;
+    }
+
+    // 段大小至少容纳文件头和一条最长的消息
+    const qint64 minimumBytes = SessionSegmentHeader::SIZE + qint64(MAX_MESSAGE_RECORDS) * SessionRecord::SIZE;
+    m_segmentBytes = qMax(segmentBytes, minimumBytes);
+    m_directory = dir.absolutePath();
+    m_sessionName = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+    m_segmentNumber = 0;
+    m_sequence = 0;
+    m_queueHead.store(0);
+    m_queueTail.store(0);
+    m_dropped.store(0);
+    m_stopRequested.store(false);
+
+    // 第一个段在调用线程中打开以便直接返回错误，之后的段由写线程滚动
+    if (!openSegment(errorMessage)) {
+        return false;
+    }
+
+    m_recording = true;
+    start(QThread::HighPriority);
+    qDebug() << "会话记录已开始:" << m_directory << m_sessionName;
+    return true;
+}
+
+void SessionRecorder::stopRecording()
+{
+    if (!m_recording) {
+        return;
+    }
+
+    m_stopRequested.store(true);
+    wait();
+    m_recording = false;
+    qDebug() << "会话记录已停止，丢弃记录数:" << droppedRecords();
+}
+
+void SessionRecorder::record(SessionRecordType type, const QByteArray &payload)
+{
+    if (!m_recording) {
+        return;
+    }
+
+    const qint64 timestampUs = currentTimeUs();
+    const int chunks = qMax(1, (payload.size() + SessionRecord::PAYLOAD_SIZE - 1) / SessionRecord::PAYLOAD_SIZE);
+
+    // 一条消息的所有分片要么全部入队，要么全部丢弃；超长消息不能整条放进一个段，直接丢弃
+    if (chunks > MAX_MESSAGE_RECORDS) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const quint64 head = m_queueHead.load(std::memory_order_relaxed);
+    const quint64 tail = m_queueTail.load(std::memory_order_acquire);
+    if (head - tail + chunks > static_cast<quint64>(QUEUE_CAPACITY)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    for (int i = 0; i < chunks; ++i) {
+        SessionRecord &record = m_queue[(head + i) & (QUEUE_CAPACITY - 1)];
+        const int offset = i * SessionRecord::PAYLOAD_SIZE;
+        const int length = qMin(SessionRecord::PAYLOAD_SIZE, payload.size() - offset);
+
+        record.magic = SessionRecord::MAGIC;
+        record.type = static_cast<quint16>(type);
+        record.flags = (i + 1 < chunks) ? SessionRecord::Continued : 0;
+        record.sequence = m_sequence++;
+        record.timestampUs = timestampUs;
+        record.length = static_cast<quint16>(qMax(0, length));
+        record.reserved = 0;
+        if (length > 0) {
+            std::memcpy(record.payload, payload.constData() + offset, length);
+        }
+        std::memset(record.payload + record.length, 0, SessionRecord::PAYLOAD_SIZE - record.length);
+        record.checksum = recordChecksum(record);
+    }
+
+    m_queueHead.store(head + chunks, std::memory_order_release);
+}
+
+void SessionRecorder::run()
+{
+    while (!m_stopRequested.load(std::memory_order_acquire)) {
+        drainQueue();
+        msleep(FLUSH_INTERVAL_MS);
+    }
+
+    drainQueue();
+    closeSegment();
+}
+
+void SessionRecorder::drainQueue()
+{
+    quint64 tail = m_queueTail.load(std::memory_order_relaxed);
+    const quint64 head = m_queueHead.load(std::memory_order_acquire);
+    if (tail == head || !m_header) {
+        return;
+    }
+
+    // 生产者按整条消息入队，tail 总在消息起始处；按消息写入，段只在消息边界滚动
+    while (tail != head) {
+        quint64 chunks = 1;
+        while (tail + chunks != head
+               && (m_queue[(tail + chunks - 1) & (QUEUE_CAPACITY - 1)].flags & SessionRecord::Continued)) {
+            ++chunks;
+        }
+
+        // 当前段放不下整条消息时滚动（消息长度不超过最小段容量，新段总能放下）
+        if (m_recordIndex + chunks > m_header->recordCapacity) {
+            closeSegment();
+            QString error;
+            if (!openSegment(&error)) {
+                emit recordingError(error);
+                m_queueTail.store(head, std::memory_order_release);
+                m_stopRequested.store(true);
+                return;
+            }
+        }
+
+        for (quint64 i = 0; i < chunks; ++i) {
+            const SessionRecord &record = m_queue[tail & (QUEUE_CAPACITY - 1)];
+            uchar *target = m_mapped + SessionSegmentHeader::SIZE + m_recordIndex * SessionRecord::SIZE;
+            std::memcpy(target, &record, SessionRecord::SIZE);
+
+            // 稀疏时间索引：只在消息起始记录上建立
+            if (i == 0 && m_recordIndex / m_header->indexStride >= m_header->indexCount
+                && m_header->indexCount < static_cast<quint32>(SessionSegmentHeader::INDEX_CAPACITY)) {
+                SessionSegmentHeader::IndexEntry &entry = m_header->index[m_header->indexCount];
+                entry.timestampUs = record.timestampUs;
+                entry.recordIndex = m_recordIndex;
+                ++m_header->indexCount;
+            }
+
+            ++m_recordIndex;
+            ++tail;
+        }
+    }
+
+    m_queueTail.store(tail, std::memory_order_release);
+    publishCommitted();
+}
+
+void SessionRecorder::publishCommitted()
+{
+    m_header->committedRecords = m_recordIndex;
+
+#ifdef Q_OS_UNIX
+    // 异步写回已映射的页，降低断电时的丢失量
+    ::msync(m_mapped, static_cast<size_t>(m_segmentFile.size()), MS_ASYNC);
+#endif
+}
+
+bool SessionRecorder::openSegment(QString *errorMessage)
+{
+    const QString fileName = QDir(m_directory).filePath(
+        QString("session_%1_%2.srec").arg(m_sessionName).arg(m_segmentNumber, 4, 10, QChar('0')));
+
+    m_segmentFile.setFileName(fileName);
+    if (!m_segmentFile.open(QIODevice::ReadWrite | QIODevice::Truncate)
+        || !m_segmentFile.resize(m_segmentBytes)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法创建段文件 %1: %2").arg(fileName, m_segmentFile.errorString());
+        }
+        m_segmentFile.close();
+        return false;
+    }
+
+    m_mapped = m_segmentFile.map(0, m_segmentBytes);
+    if (!m_mapped) {
+        if (errorMessage) {
+            *errorMessage = QString("无法映射段文件 %1: %2").arg(fileName, m_segmentFile.errorString());
+        }
+        m_segmentFile.close();
+        return false;
+    }
+
+    const quint64 capacity = (m_segmentBytes - SessionSegmentHeader::SIZE) / SessionRecord::SIZE;
+
+    m_header = reinterpret_cast<SessionSegmentHeader *>(m_mapped);
+    std::memset(m_header, 0, sizeof(SessionSegmentHeader));
+    m_header->magic = SessionSegmentHeader::MAGIC;
+    m_header->version = SessionSegmentHeader::VERSION;
+    m_header->segmentNumber = m_segmentNumber;
+    m_header->recordSize = SessionRecord::SIZE;
+    m_header->recordCapacity = capacity;
+    m_header->createdUs = currentTimeUs();
+    m_header->indexStride = static_cast<quint32>(qMax<quint64>(1, capacity / SessionSegmentHeader::INDEX_CAPACITY + 1));
+
+    m_recordIndex = 0;
+    ++m_segmentNumber;
+    return true;
+}
+
+void SessionRecorder::closeSegment()
+{
+    if (!m_mapped) {
+        return;
+    }
+
+    m_header->committedRecords = m_recordIndex;
+    m_header->closed = 1;
+
+    m_segmentFile.unmap(m_mapped);
+    m_mapped = nullptr;
+    m_header = nullptr;
+
+    // 截掉未使用的预分配空间
+    m_segmentFile.resize(SessionSegmentHeader::SIZE + static_cast<qint64>(m_recordIndex) * SessionRecord::SIZE);
+    m_segmentFile.close();
+}
+
+bool SessionRecorder::readSegment(const QString &fileName, const std::function<void(const Entry &)> &callback,
+                                  QString *errorMessage)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+
+    const qint64 size = file.size();
+    const uchar *data = size >= SessionSegmentHeader::SIZE ? file.map(0, size) : nullptr;
+    const SessionSegmentHeader *header = reinterpret_cast<const SessionSegmentHeader *>(data);
+    if (!header || header->magic != SessionSegmentHeader::MAGIC || header->recordSize != SessionRecord::SIZE) {
+        if (errorMessage) {
+            *errorMessage = QString("不是有效的会话段文件: %1").arg(fileName);
+        }
+        return false;
+    }
+
+    // 崩溃后 committedRecords 可能落后于实际写入量，以逐条校验为准
+    const quint64 available = (size - SessionSegmentHeader::SIZE) / SessionRecord::SIZE;
+    Entry entry;
+    bool pending = false;
+
+    for (quint64 i = 0; i < available; ++i) {
+        const SessionRecord *record = reinterpret_cast<const SessionRecord *>(
+            data + SessionSegmentHeader::SIZE + i * SessionRecord::SIZE);
+        if (record->magic != SessionRecord::MAGIC || record->length > SessionRecord::PAYLOAD_SIZE
+            || record->checksum != recordChecksum(*record)) {
+            break;
+        }
+
+        if (!pending) {
+            entry.type = static_cast<SessionRecordType>(record->type);
+            entry.timestampUs = record->timestampUs;
+            entry.sequence = record->sequence;
+            entry.payload.clear();
+        }
+        entry.payload.append(record->payload, record->length);
+
+        pending = record->flags & SessionRecord::Continued;
+        if (!pending) {
+            callback(entry);
+        }
+    }
+
+    return true;
+}
+
+quint16 SessionRecorder::recordChecksum(const SessionRecord &record)
+{
+    // 校验范围：去掉 checksum 字段本身的整条记录
+    SessionRecord copy = record;
+    copy.checksum = 0;
+    return qChecksum(QByteArrayView(reinterpret_cast<const char *>(&copy), SessionRecord::SIZE));
+}
+
+qint64 SessionRecorder::currentTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,139 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+
+#include <QThread>
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+// 会话记录类型
+enum class SessionRecordType : quint16 {
+    Command = 1,            // sendCommand 发出的命令
+    Feedback = 2,           // processReceivedData 收到的反馈
+    ConnectionEvent = 3,    // 连接、断开、连接错误
+    OperatorAction = 4      // 操作员操作
+};
+
+// 定长记录（256字节），超长负载拆分为多条连续记录
+struct SessionRecord {
+    enum Flags : quint16 {
+        Continued = 0x0001  // 负载在下一条记录中继续
+    };
+
+    static const quint32 MAGIC = 0x43455253;  // "SREC"
+    static const int SIZE = 256;
+    static const int HEADER_SIZE = 32;
+    static const int PAYLOAD_SIZE = SIZE - HEADER_SIZE;
+
+    quint32 magic;
+    quint16 type;
+    quint16 flags;
+    quint64 sequence;
+    qint64 timestampUs;     // UTC 微秒
+    quint16 length;         // 本条记录中有效负载字节数
+    quint16 checksum;
+    quint32 reserved;
+    char payload[PAYLOAD_SIZE];
+};
+
+// 段文件头（4096字节），包含提交计数和稀疏时间索引
+struct SessionSegmentHeader {
+    static const quint32 MAGIC = 0x47455353;  // "SSEG"
+    static const quint32 VERSION = 1;
+    static const int SIZE = 4096;
+    static const int INDEX_CAPACITY = (SIZE - 64) / 16;
+
+    struct IndexEntry {
+        qint64 timestampUs;
+        quint64 recordIndex;
+    };
+
+    quint32 magic;
+    quint32 version;
+    quint32 segmentNumber;
+    quint32 recordSize;
+    quint64 recordCapacity;
+    quint64 committedRecords;   // 写线程每次刷新后更新
+    qint64 createdUs;
+    quint32 indexStride;        // 每隔多少条记录写一个索引项
+    quint32 indexCount;
+    quint32 closed;             // 正常关闭为1，崩溃后为0
+    quint32 reserved[3];
+    IndexEntry index[INDEX_CAPACITY];
+};
+
+// 会话记录器
+// 控制线程只把记录放入无锁单生产者队列；后台线程每隔几毫秒把队列写入
+// 预分配并内存映射的段文件，段放不下下一条消息时滚动到下一个文件（多记录消息不跨段）。映射页在进程崩溃后
+// 仍由操作系统写回，最多丢失最后一个刷新周期内的记录。
+class SessionRecorder : public QThread
+{
+    Q_OBJECT
+
+public:
+    static const qint64 DEFAULT_SEGMENT_BYTES = 64 * 1024 * 1024;
+    static const int FLUSH_INTERVAL_MS = 2;
+    static const int QUEUE_CAPACITY = 8192;     // 记录槽数，2的幂
+    static const int MAX_MESSAGE_RECORDS = 1024; // 单条消息最多的记录数，也是段的最小容量
+
+    explicit SessionRecorder(QObject *parent = nullptr);
+    ~SessionRecorder();
+
+    bool startRecording(const QString &directory, qint64 segmentBytes = DEFAULT_SEGMENT_BYTES,
+                        QString *errorMessage = nullptr);
+    void stopRecording();
+    bool isRecording() const { return m_recording; }
+    QString directory() const { return m_directory; }
+
+    // 生产者接口（仅限单一线程调用）
+    void record(SessionRecordType type, const QByteArray &payload);
+    quint64 droppedRecords() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // 读取段文件：校验每条记录并重组负载，遇到第一条无效记录即停止
+    struct Entry {
+        SessionRecordType type;
+        qint64 timestampUs;
+        quint64 sequence;
+        QByteArray payload;
+    };
+    static bool readSegment(const QString &fileName, const std::function<void(const Entry &)> &callback,
+                            QString *errorMessage = nullptr);
+
+signals:
+    void recordingError(const QString &error);
+
+protected:
+    void run() override;
+
+private:
+    bool openSegment(QString *errorMessage);
+    void closeSegment();
+    void drainQueue();
+    void publishCommitted();
+    static quint16 recordChecksum(const SessionRecord &record);
+    static qint64 currentTimeUs();
+
+    // 单生产者单消费者队列
+    std::vector<SessionRecord> m_queue;
+    std::atomic<quint64> m_queueHead;   // 生产者写入位置
+    std::atomic<quint64> m_queueTail;   // 写线程读取位置
+    std::atomic<quint64> m_dropped;
+    std::atomic<bool> m_stopRequested;
+    quint64 m_sequence;
+
+    // 当前段（仅写线程访问）
+    QString m_directory;
+    QString m_sessionName;
+    qint64 m_segmentBytes;
+    quint32 m_segmentNumber;
+    QFile m_segmentFile;
+    uchar *m_mapped;
+    SessionSegmentHeader *m_header;
+    quint64 m_recordIndex;
+    bool m_recording;
+};
+
+#endif // SESSIONRECORDER_H
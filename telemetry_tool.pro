@@ -0,0 +1,22 @@
+QT -= core gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = telemetry_tool
+TEMPLATE = app
+
+unix: LIBS += -lpthread
+
+SOURCES += \
+    telemetrytool.cpp \
+    telemetryquery.cpp \
+    telemetrydiff.cpp \
+    telemetryfile.cpp \
+    telemetrycodec.cpp
+
+HEADERS += \
+    telemetryquery.h \
+    telemetrydiff.h \
+    telemetryfile.h \
+    telemetrycodec.h
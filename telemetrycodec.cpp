@@ -0,0 +1,303 @@
+#include "telemetrycodec.h"
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+inline uint64_t lowMask(int count)
+{
+    return count >= 64 ? ~uint64_t(0) : ((uint64_t(1) << count) - 1);
+}
+
+inline int leadingZeros(uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    return _BitScanReverse64(&index, value) ? 63 - static_cast<int>(index) : 64;
+#else
+    return value ? __builtin_clzll(value) : 64;
+#endif
+}
+
+inline int trailingZeros(uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    return _BitScanForward64(&index, value) ? static_cast<int>(index) : 64;
+#else
+    return value ? __builtin_ctzll(value) : 64;
+#endif
+}
+
+inline uint64_t doubleBits(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline double bitsDouble(uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline int64_t signExtend(uint64_t value, int bits)
+{
+    const uint64_t sign = uint64_t(1) << (bits - 1);
+    return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+} // namespace
+
+BitWriter::BitWriter()
+    : m_accumulator(0)
+    , m_used(0)
+{
+}
+
+void BitWriter::writeBit(bool bit)
+{
+    writeBits(bit ? 1 : 0, 1);
+}
+
+void BitWriter::writeBits(uint64_t value, int count)
+{
+    while (count > 0) {
+        const int take = count < 64 - m_used ? count : 64 - m_used;
+        const uint64_t chunk = (value >> (count - take)) & lowMask(take);
+        m_accumulator = take == 64 ? chunk : (m_accumulator << take) | chunk;
+        m_used += take;
+        count -= take;
+
+        if (m_used == 64) {
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                m_bytes.push_back(static_cast<uint8_t>(m_accumulator >> shift));
+            }
+            m_accumulator = 0;
+            m_used = 0;
+        }
+    }
+}
+
+void BitWriter::finish()
+{
+    if (m_used == 0) {
+        return;
+    }
+
+    const uint64_t aligned = m_accumulator << (64 - m_used);
+    const int bytes = (m_used + 7) / 8;
+    for (int i = 0; i < bytes; ++i) {
+        m_bytes.push_back(static_cast<uint8_t>(aligned >> (56 - 8 * i)));
+    }
+    m_accumulator = 0;
+    m_used = 0;
+}
+
+void BitWriter::clear()
+{
+    m_bytes.clear();
+    m_accumulator = 0;
+    m_used = 0;
+}
+
+BitReader::BitReader(const uint8_t *data, size_t size)
+    : m_data(data)
+    , m_size(size)
+    , m_position(0)
+{
+}
+
+bool BitReader::readBit()
+{
+    const size_t byte = m_position >> 3;
+    const int offset = static_cast<int>(m_position & 7);
+    ++m_position;
+    return byte < m_size && ((m_data[byte] >> (7 - offset)) & 1u);
+}
+
+uint64_t BitReader::readBits(int count)
+{
+    uint64_t value = 0;
+    while (count > 0) {
+        const size_t byte = m_position >> 3;
+        const int offset = static_cast<int>(m_position & 7);
+        const int available = 8 - offset;
+        const int take = count < available ? count : available;
+        const uint8_t bits = byte < m_size ? m_data[byte] : 0;
+
+        value = (value << take) | ((bits >> (available - take)) & lowMask(take));
+        m_position += take;
+        count -= take;
+    }
+    return value;
+}
+
+TimestampEncoder::TimestampEncoder()
+{
+    reset();
+}
+
+void TimestampEncoder::reset()
+{
+    m_count = 0;
+    m_previous = 0;
+    m_previousDelta = 0;
+}
+
+void TimestampEncoder::append(BitWriter &writer, int64_t timestamp)
+{
+    if (m_count == 0) {
+        writer.writeBits(static_cast<uint64_t>(timestamp), 64);
+    } else {
+        const int64_t delta = timestamp - m_previous;
+        const int64_t dod = delta - m_previousDelta;
+
+        // 前缀码：0 | 10+7位 | 110+9位 | 1110+12位 | 11110+32位 | 11111+64位
+        if (dod == 0) {
+            writer.writeBit(false);
+        } else if (dod >= -64 && dod <= 63) {
+            writer.writeBits(0x2, 2);
+            writer.writeBits(static_cast<uint64_t>(dod), 7);
+        } else if (dod >= -256 && dod <= 255) {
+            writer.writeBits(0x6, 3);
+            writer.writeBits(static_cast<uint64_t>(dod), 9);
+        } else if (dod >= -2048 && dod <= 2047) {
+            writer.writeBits(0xE, 4);
+            writer.writeBits(static_cast<uint64_t>(dod), 12);
+        } else if (dod >= INT32_MIN && dod <= INT32_MAX) {
+            writer.writeBits(0x1E, 5);
+            writer.writeBits(static_cast<uint64_t>(dod), 32);
+        } else {
+            writer.writeBits(0x1F, 5);
+            writer.writeBits(static_cast<uint64_t>(dod), 64);
+        }
+        m_previousDelta = delta;
+    }
+
+    m_previous = timestamp;
+    ++m_count;
+}
+
+TimestampDecoder::TimestampDecoder()
+    : m_count(0)
+    , m_previous(0)
+    , m_previousDelta(0)
+{
+}
+
+int64_t TimestampDecoder::next(BitReader &reader)
+{
+    if (m_count++ == 0) {
+        m_previous = static_cast<int64_t>(reader.readBits(64));
+        return m_previous;
+    }
+
+    int64_t dod = 0;
+    if (reader.readBit()) {
+        if (!reader.readBit()) {
+            dod = signExtend(reader.readBits(7), 7);
+        } else if (!reader.readBit()) {
+            dod = signExtend(reader.readBits(9), 9);
+        } else if (!reader.readBit()) {
+            dod = signExtend(reader.readBits(12), 12);
+        } else if (!reader.readBit()) {
+            dod = signExtend(reader.readBits(32), 32);
+        } else {
+            dod = static_cast<int64_t>(reader.readBits(64));
+        }
+    }
+
+    m_previousDelta += dod;
+    m_previous += m_previousDelta;
+    return m_previous;
+}
+
+FloatEncoder::FloatEncoder()
+{
+    reset();
+}
+
+void FloatEncoder::reset()
+{
+    m_count = 0;
+    m_previous = 0;
+    m_leading = -1;
+    m_trailing = 0;
+}
+
+void FloatEncoder::append(BitWriter &writer, double value)
+{
+    const uint64_t bits = doubleBits(value);
+
+    if (m_count++ == 0) {
+        writer.writeBits(bits, 64);
+        m_previous = bits;
+        return;
+    }
+
+    const uint64_t xorValue = bits ^ m_previous;
+    m_previous = bits;
+
+    if (xorValue == 0) {
+        writer.writeBit(false);
+        return;
+    }
+
+    writer.writeBit(true);
+    int leading = leadingZeros(xorValue);
+    const int trailing = trailingZeros(xorValue);
+    if (leading > 31) {
+        leading = 31;   // 5位字段的上限
+    }
+
+    if (m_leading >= 0 && leading >= m_leading && trailing >= m_trailing) {
+        // 有效位落在上一个窗口内，直接复用窗口
+        writer.writeBit(false);
+        writer.writeBits(xorValue >> m_trailing, 64 - m_leading - m_trailing);
+    } else {
+        const int significant = 64 - leading - trailing;
+        writer.writeBit(true);
+        writer.writeBits(static_cast<uint64_t>(leading), 5);
+        writer.writeBits(static_cast<uint64_t>(significant & 63), 6);  // 64 记为 0
+        writer.writeBits(xorValue >> trailing, significant);
+        m_leading = leading;
+        m_trailing = trailing;
+    }
+}
+
+FloatDecoder::FloatDecoder()
+    : m_count(0)
+    , m_previous(0)
+    , m_leading(0)
+    , m_trailing(0)
+{
+}
+
+double FloatDecoder::next(BitReader &reader)
+{
+    if (m_count++ == 0) {
+        m_previous = reader.readBits(64);
+        return bitsDouble(m_previous);
+    }
+
+    if (reader.readBit()) {
+        if (reader.readBit()) {
+            m_leading = static_cast<int>(reader.readBits(5));
+            int significant = static_cast<int>(reader.readBits(6));
+            if (significant == 0) {
+                significant = 64;
+            }
+            m_trailing = 64 - m_leading - significant;
+        }
+        const int significant = 64 - m_leading - m_trailing;
+        m_previous ^= reader.readBits(significant) << m_trailing;
+    }
+
+    return bitsDouble(m_previous);
+}
@@ -0,0 +1,101 @@
+#ifndef TELEMETRYCODEC_H
+#define TELEMETRYCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Gorilla 风格的时间序列压缩
+// 整数序列（时间戳、量化后的数值）使用二阶差分（delta-of-delta）变长前缀码，
+// 浮点数值使用与前值异或后的前导/尾随零编码。
+// 位流按高位在前写入字节数组。
+
+class BitWriter
+{
+public:
+    BitWriter();
+
+    void writeBit(bool bit);
+    void writeBits(uint64_t value, int count);  // 写入 value 的低 count 位
+    void finish();                              // 补齐最后一个字节
+
+    const std::vector<uint8_t> &bytes() const { return m_bytes; }
+    size_t bitCount() const { return m_bytes.size() * 8 + m_used; }
+    void clear();
+
+private:
+    std::vector<uint8_t> m_bytes;
+    uint64_t m_accumulator;
+    int m_used;
+};
+
+class BitReader
+{
+public:
+    BitReader(const uint8_t *data, size_t size);
+
+    bool readBit();
+    uint64_t readBits(int count);
+    bool atEnd() const { return m_position >= m_size * 8; }
+
+private:
+    const uint8_t *m_data;
+    size_t m_size;
+    size_t m_position;  // 位偏移
+};
+
+// 时间戳列编码器
+class TimestampEncoder
+{
+public:
+    TimestampEncoder();
+    void append(BitWriter &writer, int64_t timestamp);
+    void reset();
+
+private:
+    size_t m_count;
+    int64_t m_previous;
+    int64_t m_previousDelta;
+};
+
+class TimestampDecoder
+{
+public:
+    TimestampDecoder();
+    int64_t next(BitReader &reader);
+
+private:
+    size_t m_count;
+    int64_t m_previous;
+    int64_t m_previousDelta;
+};
+
+// 浮点列编码器
+class FloatEncoder
+{
+public:
+    FloatEncoder();
+    void append(BitWriter &writer, double value);
+    void reset();
+
+private:
+    size_t m_count;
+    uint64_t m_previous;
+    int m_leading;
+    int m_trailing;
+};
+
+class FloatDecoder
+{
+public:
+    FloatDecoder();
+    double next(BitReader &reader);
+
+private:
+    size_t m_count;
+    uint64_t m_previous;
+    int m_leading;
+    int m_trailing;
+};
+
+#endif // TELEMETRYCODEC_H
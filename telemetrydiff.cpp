@@ -0,0 +1,367 @@
+#include "telemetrydiff.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+void setError(std::string *errorMessage, const std::string &message)
+{
+    if (errorMessage) {
+        *errorMessage = message;
+    }
+}
+
+} // namespace
+
+TelemetrySessionDiff::TelemetrySessionDiff(const Options &options)
+    : m_options(options)
+    , m_a(nullptr)
+    , m_b(nullptr)
+    , m_jointCount(0)
+    , m_hasTargets(false)
+    , m_report()
+{
+}
+
+template <typename Work>
+void TelemetrySessionDiff::parallelFor(size_t count, const Work &work) const
+{
+    const int threads = m_options.threadCount > 0
+        ? m_options.threadCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const int workers = static_cast<int>(std::min<size_t>(count, static_cast<size_t>(threads)));
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            work(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> pool;
+    pool.reserve(workers);
+    for (int worker = 0; worker < workers; ++worker) {
+        pool.emplace_back([&]() {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                work(i);
+            }
+        });
+    }
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+}
+
+bool TelemetrySessionDiff::compare(const TelemetrySeries &a, const TelemetrySeries &b, int jointCount,
+                                   bool hasTargets, std::string *errorMessage)
+{
+    const size_t requiredColumns = static_cast<size_t>(jointCount) * (hasTargets ? 2 : 1);
+    if (jointCount <= 0 || a.columns < requiredColumns || b.columns < requiredColumns) {
+        setError(errorMessage, "序列列数与关节数不匹配");
+        return false;
+    }
+    if (a.intervalUs != b.intervalUs || a.intervalUs <= 0) {
+        setError(errorMessage, "两个序列的采样间隔必须相同");
+        return false;
+    }
+    if (a.rows < 2 || b.rows < 2) {
+        setError(errorMessage, "序列太短");
+        return false;
+    }
+
+    m_a = &a;
+    m_b = &b;
+    m_jointCount = jointCount;
+    m_hasTargets = hasTargets;
+    m_anchorsA.clear();
+    m_anchorsB.clear();
+
+    const double rate = 1e6 / a.intervalUs;
+    m_report = Report();
+    m_report.alignment = m_options.alignment;
+    m_report.offsetSeconds = 0.0;
+    m_report.correlation = NAN;
+    m_report.durationA = (a.rows - 1) / rate;
+    m_report.durationB = (b.rows - 1) / rate;
+    m_report.meanCycleA = NAN;
+    m_report.meanCycleB = NAN;
+    m_report.drift = 0.0;
+
+    // 运动量信号：所有关节位置变化量之和，用于步骤检测和互相关
+    const std::vector<double> activityA = activity(a);
+    const std::vector<double> activityB = activity(b);
+    const std::vector<size_t> stepsA = detectSteps(activityA, rate);
+    const std::vector<size_t> stepsB = detectSteps(activityB, rate);
+    m_report.stepsA = stepsA.size();
+    m_report.stepsB = stepsB.size();
+
+    // 步骤按出现顺序配对；每步的时长取到下一步开始（最后一步取到运行结束）
+    const size_t matched = std::min(stepsA.size(), stepsB.size());
+    for (size_t k = 0; k < matched; ++k) {
+        Step step;
+        step.startA = stepsA[k] / rate;
+        step.startB = stepsB[k] / rate;
+        step.durationA = (k + 1 < stepsA.size() ? stepsA[k + 1] / rate : m_report.durationA) - step.startA;
+        step.durationB = (k + 1 < stepsB.size() ? stepsB[k + 1] / rate : m_report.durationB) - step.startB;
+        m_report.steps.push_back(step);
+    }
+
+    if (matched > 1) {
+        // 最后一步通常不完整，不计入平均节拍
+        double sumA = 0.0;
+        double sumB = 0.0;
+        for (size_t k = 0; k + 1 < matched; ++k) {
+            sumA += m_report.steps[k].durationA;
+            sumB += m_report.steps[k].durationB;
+        }
+        m_report.meanCycleA = sumA / (matched - 1);
+        m_report.meanCycleB = sumB / (matched - 1);
+
+        const Step &first = m_report.steps.front();
+        const Step &last = m_report.steps.back();
+        m_report.drift = (last.startB - last.startA) - (first.startB - first.startA);
+    }
+
+    if (m_report.alignment == AlignSteps && matched == 0) {
+        // 没有检测到步骤时退回整体互相关
+        m_report.alignment = AlignCrossCorrelation;
+    }
+
+    switch (m_report.alignment) {
+    case AlignStart:
+        break;
+    case AlignCrossCorrelation:
+        crossCorrelate(activityA, activityB, rate);
+        break;
+    case AlignSteps:
+        for (const Step &step : m_report.steps) {
+            m_anchorsA.push_back(step.startA);
+            m_anchorsB.push_back(step.startB);
+        }
+        m_report.offsetSeconds = m_anchorsB.front() - m_anchorsA.front();
+        break;
+    }
+
+    m_report.joints.resize(jointCount);
+    parallelFor(static_cast<size_t>(jointCount), [&](size_t joint) {
+        compareJoint(static_cast<int>(joint), m_report.joints[joint]);
+    });
+    return true;
+}
+
+std::vector<double> TelemetrySessionDiff::activity(const TelemetrySeries &series) const
+{
+    // 在约 0.2 秒的窗口上取位移，压低反馈噪声对静止判定的影响；结果换算为每行的平均位移
+    const double rate = 1e6 / series.intervalUs;
+    const size_t window = std::max<size_t>(1, static_cast<size_t>(std::lround(ACTIVITY_WINDOW_SECONDS * rate)));
+    std::vector<double> result(series.rows, 0.0);
+    for (size_t row = window; row < series.rows; ++row) {
+        const double *current = series.row(row);
+        const double *previous = series.row(row - window);
+        double sum = 0.0;
+        for (int joint = 0; joint < m_jointCount; ++joint) {
+            const double delta = current[joint] - previous[joint];
+            if (!std::isnan(delta)) {
+                sum += std::fabs(delta);
+            }
+        }
+        result[row] = sum / window;
+    }
+    return result;
+}
+
+std::vector<size_t> TelemetrySessionDiff::detectSteps(const std::vector<double> &activity, double rate) const
+{
+    // 静止足够久之后的第一次运动视为新步骤的开始
+    const size_t idleRows = static_cast<size_t>(std::ceil(m_options.minIdleSeconds * rate));
+    size_t idleRun = idleRows;
+    std::vector<size_t> steps;
+
+    for (size_t row = 0; row < activity.size(); ++row) {
+        if (activity[row] * rate > m_options.idleThreshold) {
+            if (idleRun >= idleRows) {
+                steps.push_back(row);
+            }
+            idleRun = 0;
+        } else {
+            ++idleRun;
+        }
+    }
+    return steps;
+}
+
+void TelemetrySessionDiff::crossCorrelate(const std::vector<double> &a, const std::vector<double> &b, double rate)
+{
+    auto normalize = [](const std::vector<double> &values) {
+        double mean = 0.0;
+        for (double value : values) {
+            mean += value;
+        }
+        mean /= values.size();
+
+        double variance = 0.0;
+        for (double value : values) {
+            variance += (value - mean) * (value - mean);
+        }
+        const double scale = variance > 0.0 ? 1.0 / std::sqrt(variance / values.size()) : 0.0;
+
+        std::vector<double> result(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            result[i] = (values[i] - mean) * scale;
+        }
+        return result;
+    };
+
+    const std::vector<double> za = normalize(a);
+    const std::vector<double> zb = normalize(b);
+    const long maxLag = static_cast<long>(m_options.maxLagSeconds * rate);
+    const long sizeA = static_cast<long>(za.size());
+    const long sizeB = static_cast<long>(zb.size());
+
+    // 各偏移量相互独立，并行计算；B 的第 i + lag 行对应 A 的第 i 行
+    std::vector<double> scores(2 * maxLag + 1, -HUGE_VAL);
+    parallelFor(scores.size(), [&](size_t index) {
+        const long lag = static_cast<long>(index) - maxLag;
+        const long first = std::max(0L, -lag);
+        const long last = std::min(sizeA, sizeB - lag);
+        if (last - first < 2) {
+            return;
+        }
+
+        // 有偏估计（除以总长而非重叠长度）：周期性程序在多个偏移上都能对齐，优先取重叠最多的
+        double sum = 0.0;
+        for (long i = first; i < last; ++i) {
+            sum += za[i] * zb[i + lag];
+        }
+        scores[index] = sum / std::min(sizeA, sizeB);
+    });
+
+    const size_t best = static_cast<size_t>(std::max_element(scores.begin(), scores.end()) - scores.begin());
+    double refined = static_cast<double>(best);
+    if (best > 0 && best + 1 < scores.size()) {
+        // 抛物线插值求亚采样间隔的峰值位置
+        const double left = scores[best - 1];
+        const double center = scores[best];
+        const double right = scores[best + 1];
+        const double denominator = left - 2.0 * center + right;
+        if (std::isfinite(denominator) && denominator < 0.0) {
+            refined += 0.5 * (left - right) / denominator;
+        }
+    }
+
+    m_report.offsetSeconds = (refined - maxLag) / rate;
+    m_report.correlation = scores[best];
+}
+
+double TelemetrySessionDiff::mapToB(double secondsA) const
+{
+    if (m_anchorsA.empty()) {
+        return secondsA + m_report.offsetSeconds;
+    }
+
+    // 锚点之间线性插值，两端沿用最近锚点的偏移
+    const auto it = std::upper_bound(m_anchorsA.begin(), m_anchorsA.end(), secondsA);
+    if (it == m_anchorsA.begin()) {
+        return secondsA + (m_anchorsB.front() - m_anchorsA.front());
+    }
+    if (it == m_anchorsA.end()) {
+        return secondsA + (m_anchorsB.back() - m_anchorsA.back());
+    }
+
+    const size_t k = static_cast<size_t>(it - m_anchorsA.begin()) - 1;
+    const double spanA = m_anchorsA[k + 1] - m_anchorsA[k];
+    const double spanB = m_anchorsB[k + 1] - m_anchorsB[k];
+    return m_anchorsB[k] + (secondsA - m_anchorsA[k]) * (spanA > 0.0 ? spanB / spanA : 1.0);
+}
+
+double TelemetrySessionDiff::sampleB(double secondsB, int column) const
+{
+    const double row = std::round(secondsB * 1e6 / m_b->intervalUs);
+    if (row < 0.0 || row >= static_cast<double>(m_b->rows)) {
+        return NAN;
+    }
+    return m_b->at(static_cast<size_t>(row), column);
+}
+
+void TelemetrySessionDiff::compareJoint(int joint, JointReport &report) const
+{
+    const double rate = 1e6 / m_a->intervalUs;
+    double sumSquares = 0.0;
+    report.joint = joint;
+    report.samples = 0;
+    report.maxDeviation = 0.0;
+    report.maxDeviationTime = 0.0;
+
+    for (size_t row = 0; row < m_a->rows; ++row) {
+        const double secondsA = row / rate;
+        const double deviation = sampleB(mapToB(secondsA), joint) - m_a->at(row, joint);
+        if (std::isnan(deviation)) {
+            continue;
+        }
+
+        sumSquares += deviation * deviation;
+        ++report.samples;
+        if (std::fabs(deviation) > std::fabs(report.maxDeviation)) {
+            report.maxDeviation = deviation;
+            report.maxDeviationTime = secondsA;
+        }
+    }
+    report.rmsDeviation = report.samples ? std::sqrt(sumSquares / report.samples) : NAN;
+
+    auto tracking = [&](const TelemetrySeries &series) {
+        if (!m_hasTargets) {
+            return static_cast<double>(NAN);
+        }
+        double sum = 0.0;
+        uint64_t count = 0;
+        for (size_t row = 0; row < series.rows; ++row) {
+            const double error = series.at(row, joint) - series.at(row, m_jointCount + joint);
+            if (!std::isnan(error)) {
+                sum += error * error;
+                ++count;
+            }
+        }
+        return count ? std::sqrt(sum / count) : static_cast<double>(NAN);
+    };
+    report.trackingRmsA = tracking(*m_a);
+    report.trackingRmsB = tracking(*m_b);
+}
+
+bool TelemetrySessionDiff::writeSeries(const std::string &fileName, const std::vector<int> &joints,
+                                       std::string *errorMessage) const
+{
+    if (!m_a || !m_b) {
+        setError(errorMessage, "尚未进行对比");
+        return false;
+    }
+
+    std::FILE *file = std::fopen(fileName.c_str(), "w");
+    if (!file) {
+        setError(errorMessage, "无法创建文件: " + fileName);
+        return false;
+    }
+
+    std::fprintf(file, "time_a,time_b");
+    for (int joint : joints) {
+        std::fprintf(file, ",j%d_a,j%d_b,j%d_diff", joint, joint, joint);
+    }
+    std::fprintf(file, "\n");
+
+    const double rate = 1e6 / m_a->intervalUs;
+    for (size_t row = 0; row < m_a->rows; ++row) {
+        const double secondsA = row / rate;
+        const double secondsB = mapToB(secondsA);
+        std::fprintf(file, "%.3f,%.3f", secondsA, secondsB);
+        for (int joint : joints) {
+            const double valueA = m_a->at(row, joint);
+            const double valueB = sampleB(secondsB, joint);
+            std::fprintf(file, ",%.5g,%.5g,%.5g", valueA, valueB, valueB - valueA);
+        }
+        std::fprintf(file, "\n");
+    }
+
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,102 @@
+#ifndef TELEMETRYDIFF_H
+#define TELEMETRYDIFF_H
+
+#include "telemetryquery.h"
+#include <string>
+#include <vector>
+
+// 两次运行的遥测对比
+// 输入是两次运行按同一间隔重采样的序列（TelemetryQueryEngine::resample），
+// 前 jointCount 列为反馈位置，可选的后 jointCount 列为指令位置。
+// 先按运行起点、整体互相关偏移或程序步骤把 B 的时间轴映射到 A 上，
+// 再逐关节并行计算位置偏差、跟踪误差，以及各步骤的节拍差和累计时间漂移。
+class TelemetrySessionDiff
+{
+public:
+    static constexpr double ACTIVITY_WINDOW_SECONDS = 0.2;
+
+    enum Alignment {
+        AlignStart,             // 起点对齐
+        AlignCrossCorrelation,  // 运动量信号互相关求整体偏移
+        AlignSteps              // 按检测到的程序步骤分段线性对齐
+    };
+
+    struct Options {
+        Alignment alignment;
+        double maxLagSeconds;       // 互相关搜索范围
+        double idleThreshold;       // 所有关节位置变化率之和低于此值（单位/秒）视为静止
+        double minIdleSeconds;      // 静止至少这么久后再运动才算新的步骤
+        int threadCount;            // 0 为硬件线程数
+
+        Options() : alignment(AlignSteps), maxLagSeconds(60.0), idleThreshold(1.0)
+                  , minIdleSeconds(0.5), threadCount(0) {}
+    };
+
+    // 一个程序步骤（秒，相对各自运行的起点）
+    struct Step {
+        double startA;
+        double durationA;
+        double startB;
+        double durationB;
+    };
+
+    struct JointReport {
+        int joint;
+        uint64_t samples;
+        double rmsDeviation;        // B 相对 A 的反馈位置偏差
+        double maxDeviation;
+        double maxDeviationTime;    // A 的时间轴（秒）
+        double trackingRmsA;        // 反馈相对指令的误差，没有指令数据时为 NaN
+        double trackingRmsB;
+    };
+
+    struct Report {
+        Alignment alignment;
+        double offsetSeconds;       // B 相对 A 的整体偏移（起点对齐以外的模式）
+        double correlation;         // 互相关峰值（归一化）
+        double durationA;
+        double durationB;
+        size_t stepsA;
+        size_t stepsB;
+        std::vector<Step> steps;    // 按顺序配对的步骤
+        double meanCycleA;
+        double meanCycleB;
+        double drift;               // 最后一个配对步骤相对第一个步骤的累计时间漂移
+        std::vector<JointReport> joints;
+    };
+
+    explicit TelemetrySessionDiff(const Options &options = Options());
+
+    // 两个序列必须在 compare() 之后、writeSeries() 完成之前保持有效
+    bool compare(const TelemetrySeries &a, const TelemetrySeries &b, int jointCount, bool hasTargets,
+                 std::string *errorMessage = nullptr);
+    const Report &report() const { return m_report; }
+
+    // A 时间轴上的时刻（秒）映射到 B 时间轴
+    double mapToB(double secondsA) const;
+
+    // 可直接绘图的对齐序列：每行 A 时刻、B 时刻，以及各关节的 A 值、B 值和差值
+    bool writeSeries(const std::string &fileName, const std::vector<int> &joints,
+                     std::string *errorMessage = nullptr) const;
+
+private:
+    std::vector<double> activity(const TelemetrySeries &series) const;
+    std::vector<size_t> detectSteps(const std::vector<double> &activity, double rate) const;
+    void crossCorrelate(const std::vector<double> &a, const std::vector<double> &b, double rate);
+    void compareJoint(int joint, JointReport &report) const;
+    double sampleB(double secondsB, int column) const;
+
+    template <typename Work>
+    void parallelFor(size_t count, const Work &work) const;
+
+    Options m_options;
+    const TelemetrySeries *m_a;
+    const TelemetrySeries *m_b;
+    int m_jointCount;
+    bool m_hasTargets;
+    std::vector<double> m_anchorsA;     // 分段线性对齐的锚点（秒）
+    std::vector<double> m_anchorsB;
+    Report m_report;
+};
+
+#endif // TELEMETRYDIFF_H
@@ -0,0 +1,489 @@
+#include "telemetryfile.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+static_assert(sizeof(TelemetryFileHeader) == TelemetryFileHeader::SIZE, "文件头必须为64字节");
+static_assert(sizeof(TelemetryBlockHeader) == TelemetryBlockHeader::SIZE, "块头必须为40字节");
+static_assert(sizeof(TelemetryColumnEntry) == TelemetryColumnEntry::SIZE, "列目录项必须为32字节");
+static_assert(sizeof(TelemetryFileTrailer) == TelemetryFileTrailer::SIZE, "文件尾必须为16字节");
+
+namespace {
+
+bool seekTo(std::FILE *file, uint64_t offset)
+{
+#ifdef _MSC_VER
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+uint64_t fileSizeOf(std::FILE *file)
+{
+#ifdef _MSC_VER
+    _fseeki64(file, 0, SEEK_END);
+    return static_cast<uint64_t>(_ftelli64(file));
+#else
+    fseeko(file, 0, SEEK_END);
+    return static_cast<uint64_t>(ftello(file));
+#endif
+}
+
+void setError(std::string *errorMessage, const std::string &message)
+{
+    if (errorMessage) {
+        *errorMessage = message;
+    }
+}
+
+int64_t currentTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+TelemetryFileWriter::TelemetryFileWriter()
+    : m_file(nullptr)
+    , m_jointCount(0)
+    , m_blockSamples(DEFAULT_BLOCK_SAMPLES)
+    , m_fractionBits(0)
+    , m_quantumScale(1.0)
+    , m_blockCount(0)
+    , m_firstTimestampUs(0)
+    , m_lastTimestampUs(0)
+    , m_totalSamples(0)
+    , m_bytesWritten(0)
+{
+}
+
+TelemetryFileWriter::~TelemetryFileWriter()
+{
+    close();
+}
+
+bool TelemetryFileWriter::open(const std::string &fileName, int jointCount, int blockSamples,
+                               int fractionBits, std::string *errorMessage)
+{
+    close();
+
+    if (jointCount <= 0 || jointCount > 0xFFFF) {
+        setError(errorMessage, "关节数无效");
+        return false;
+    }
+
+    m_file = std::fopen(fileName.c_str(), "wb");
+    if (!m_file) {
+        setError(errorMessage, "无法创建遥测文件: " + fileName);
+        return false;
+    }
+
+    m_jointCount = jointCount;
+    m_blockSamples = std::max(1, blockSamples);
+    m_fractionBits = std::max(0, std::min(fractionBits, 52));
+    m_quantumScale = std::ldexp(1.0, m_fractionBits);
+    m_columns.assign(static_cast<size_t>(jointCount) * static_cast<int>(TelemetryFileChannel::Count), Column());
+    for (Column &column : m_columns) {
+        column.values.reserve(m_blockSamples);
+    }
+    m_index.clear();
+    m_totalSamples = 0;
+    resetBlock();
+
+    TelemetryFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = TelemetryFileHeader::MAGIC;
+    header.version = TelemetryFileHeader::VERSION;
+    header.jointCount = static_cast<uint16_t>(jointCount);
+    header.channelCount = static_cast<uint16_t>(TelemetryFileChannel::Count);
+    header.fractionBits = static_cast<uint16_t>(m_fractionBits);
+    header.blockSamples = static_cast<uint32_t>(m_blockSamples);
+    header.createdUs = currentTimeUs();
+
+    if (std::fwrite(&header, sizeof(header), 1, m_file) != 1) {
+        setError(errorMessage, "写入遥测文件头失败: " + fileName);
+        std::fclose(m_file);
+        m_file = nullptr;
+        return false;
+    }
+    m_bytesWritten = sizeof(header);
+    return true;
+}
+
+void TelemetryFileWriter::close()
+{
+    if (!m_file) {
+        return;
+    }
+
+    flushBlock();
+
+    // 块索引和文件尾放在最后，缺失时读取端退化为顺序扫描
+    TelemetryFileTrailer trailer;
+    trailer.magic = TelemetryFileTrailer::MAGIC;
+    trailer.blockCount = static_cast<uint32_t>(m_index.size());
+    trailer.indexOffset = m_bytesWritten;
+
+    if (!m_index.empty()) {
+        std::fwrite(m_index.data(), sizeof(TelemetryIndexEntry), m_index.size(), m_file);
+    }
+    std::fwrite(&trailer, sizeof(trailer), 1, m_file);
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+bool TelemetryFileWriter::append(int64_t timestampUs, const double *positions,
+                                 const double *velocities, const double *torques, const double *targets)
+{
+    if (!m_file) {
+        return false;
+    }
+
+    // 时间戳倒退（如采集时回放向前跳转）时先结束当前块，块内时间保持单调，
+    // 块头的首末时间戳即该块的时间范围，查询的范围剪枝和事件合并才不会漏样本
+    if (m_blockCount > 0 && timestampUs < m_lastTimestampUs && !flushBlock()) {
+        return false;
+    }
+    if (m_blockCount == 0) {
+        m_firstTimestampUs = timestampUs;
+    }
+    m_lastTimestampUs = timestampUs;
+    m_timestampEncoder.append(m_timestampBits, timestampUs);
+
+    const double *channels[] = {positions, velocities, torques, targets};
+    for (int channel = 0; channel < static_cast<int>(TelemetryFileChannel::Count); ++channel) {
+        const double *row = channels[channel];
+        Column *columns = &m_columns[static_cast<size_t>(channel) * m_jointCount];
+        for (int joint = 0; joint < m_jointCount; ++joint) {
+            double value = row ? row[joint] : 0.0;
+            if (m_fractionBits > 0 && std::isfinite(value)) {
+                value = std::nearbyint(value * m_quantumScale) / m_quantumScale;
+            }
+
+            Column &column = columns[joint];
+            column.values.push_back(value);
+            column.minValue = std::min(column.minValue, value);
+            column.maxValue = std::max(column.maxValue, value);
+        }
+    }
+
+    ++m_totalSamples;
+    if (++m_blockCount >= static_cast<uint32_t>(m_blockSamples)) {
+        return flushBlock();
+    }
+    return true;
+}
+
+TelemetryColumnEncoding TelemetryFileWriter::encodeColumn(const Column &column, BitWriter &bits) const
+{
+    // 量化后的整数必须能被 double 精确表示，差分才不会溢出
+    const double integerLimit = std::ldexp(1.0, 52);
+    bool quantized = m_fractionBits > 0;
+    for (size_t i = 0; quantized && i < column.values.size(); ++i) {
+        quantized = std::fabs(column.values[i] * m_quantumScale) < integerLimit;
+    }
+
+    if (quantized) {
+        TimestampEncoder encoder;
+        for (double value : column.values) {
+            encoder.append(bits, static_cast<int64_t>(value * m_quantumScale));
+        }
+        return TelemetryColumnEncoding::QuantizedDelta;
+    }
+
+    FloatEncoder encoder;
+    for (double value : column.values) {
+        encoder.append(bits, value);
+    }
+    return TelemetryColumnEncoding::XorFloat;
+}
+
+bool TelemetryFileWriter::flushBlock()
+{
+    if (m_blockCount == 0) {
+        return true;
+    }
+
+    const uint32_t columnCount = static_cast<uint32_t>(m_columns.size() + 1);
+    std::vector<TelemetryColumnEntry> directory(columnCount);
+
+    m_timestampBits.finish();
+    std::vector<uint8_t> data = m_timestampBits.bytes();
+    directory[0].offset = 0;
+    directory[0].length = static_cast<uint32_t>(data.size());
+    directory[0].encoding = static_cast<uint32_t>(TelemetryColumnEncoding::QuantizedDelta);
+    directory[0].minValue = static_cast<double>(m_firstTimestampUs);
+    directory[0].maxValue = static_cast<double>(m_lastTimestampUs);
+
+    for (size_t i = 0; i < m_columns.size(); ++i) {
+        const Column &column = m_columns[i];
+        m_columnBits.clear();
+        const TelemetryColumnEncoding encoding = encodeColumn(column, m_columnBits);
+        m_columnBits.finish();
+
+        TelemetryColumnEntry &entry = directory[i + 1];
+        entry.offset = data.size();
+        entry.length = static_cast<uint32_t>(m_columnBits.bytes().size());
+        entry.encoding = static_cast<uint32_t>(encoding);
+        entry.minValue = column.minValue;
+        entry.maxValue = column.maxValue;
+        data.insert(data.end(), m_columnBits.bytes().begin(), m_columnBits.bytes().end());
+    }
+
+    TelemetryBlockHeader header;
+    header.magic = TelemetryBlockHeader::MAGIC;
+    header.sampleCount = m_blockCount;
+    header.columnCount = columnCount;
+    header.reserved = 0;
+    header.firstTimestampUs = m_firstTimestampUs;
+    header.lastTimestampUs = m_lastTimestampUs;
+    header.dataBytes = data.size();
+
+    TelemetryIndexEntry indexEntry;
+    indexEntry.offset = m_bytesWritten;
+    indexEntry.firstTimestampUs = m_firstTimestampUs;
+    indexEntry.lastTimestampUs = m_lastTimestampUs;
+
+    const bool ok = std::fwrite(&header, sizeof(header), 1, m_file) == 1
+        && std::fwrite(directory.data(), sizeof(TelemetryColumnEntry), columnCount, m_file) == columnCount
+        && std::fwrite(data.data(), 1, data.size(), m_file) == data.size();
+    std::fflush(m_file);
+
+    m_bytesWritten += sizeof(header) + sizeof(TelemetryColumnEntry) * columnCount + data.size();
+    m_index.push_back(indexEntry);
+    resetBlock();
+    return ok;
+}
+
+void TelemetryFileWriter::resetBlock()
+{
+    m_timestampBits.clear();
+    m_timestampEncoder.reset();
+    for (Column &column : m_columns) {
+        column.values.clear();
+        column.minValue = HUGE_VAL;
+        column.maxValue = -HUGE_VAL;
+    }
+    m_blockCount = 0;
+}
+
+TelemetryFileReader::TelemetryFileReader()
+    : m_file(nullptr)
+    , m_indexed(false)
+{
+    std::memset(&m_header, 0, sizeof(m_header));
+}
+
+TelemetryFileReader::~TelemetryFileReader()
+{
+    close();
+}
+
+bool TelemetryFileReader::open(const std::string &fileName, std::string *errorMessage)
+{
+    close();
+
+    m_file = std::fopen(fileName.c_str(), "rb");
+    if (!m_file) {
+        setError(errorMessage, "无法打开遥测文件: " + fileName);
+        return false;
+    }
+
+    const uint64_t fileSize = fileSizeOf(m_file);
+    if (!readBytes(0, &m_header, sizeof(m_header))
+        || m_header.magic != TelemetryFileHeader::MAGIC
+        || m_header.version != TelemetryFileHeader::VERSION
+        || m_header.jointCount == 0) {
+        setError(errorMessage, "不是有效的遥测文件: " + fileName);
+        close();
+        return false;
+    }
+
+    m_indexed = loadIndex(fileSize);
+    if (!m_indexed) {
+        scanBlocks(fileSize);
+    }
+    return true;
+}
+
+void TelemetryFileReader::close()
+{
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    m_blocks.clear();
+    m_indexed = false;
+}
+
+uint64_t TelemetryFileReader::sampleCount() const
+{
+    uint64_t count = 0;
+    for (const BlockInfo &block : m_blocks) {
+        count += block.sampleCount;
+    }
+    return count;
+}
+
+// 时间戳倒退时会另起一块，块之间不一定按时间排列，取所有块的最早和最晚时间
+int64_t TelemetryFileReader::firstTimestampUs() const
+{
+    int64_t first = m_blocks.empty() ? 0 : m_blocks.front().firstTimestampUs;
+    for (const BlockInfo &block : m_blocks) {
+        first = std::min(first, block.firstTimestampUs);
+    }
+    return first;
+}
+
+int64_t TelemetryFileReader::lastTimestampUs() const
+{
+    int64_t last = m_blocks.empty() ? 0 : m_blocks.back().lastTimestampUs;
+    for (const BlockInfo &block : m_blocks) {
+        last = std::max(last, block.lastTimestampUs);
+    }
+    return last;
+}
+
+bool TelemetryFileReader::loadIndex(uint64_t fileSize)
+{
+    TelemetryFileTrailer trailer;
+    if (fileSize < TelemetryFileHeader::SIZE + TelemetryFileTrailer::SIZE
+        || !readBytes(fileSize - TelemetryFileTrailer::SIZE, &trailer, sizeof(trailer))
+        || trailer.magic != TelemetryFileTrailer::MAGIC
+        || trailer.indexOffset + uint64_t(trailer.blockCount) * sizeof(TelemetryIndexEntry)
+               != fileSize - TelemetryFileTrailer::SIZE) {
+        return false;
+    }
+
+    std::vector<TelemetryIndexEntry> index(trailer.blockCount);
+    if (!index.empty() && !readBytes(trailer.indexOffset, index.data(), index.size() * sizeof(TelemetryIndexEntry))) {
+        return false;
+    }
+
+    m_blocks.resize(index.size());
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (!loadBlock(index[i].offset, fileSize, m_blocks[i])) {
+            m_blocks.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void TelemetryFileReader::scanBlocks(uint64_t fileSize)
+{
+    // 从文件头之后逐块前进，遇到不完整的块即停止
+    uint64_t offset = TelemetryFileHeader::SIZE;
+    BlockInfo block;
+    while (loadBlock(offset, fileSize, block)) {
+        const uint64_t next = offset + TelemetryBlockHeader::SIZE
+            + uint64_t(block.columns.size()) * TelemetryColumnEntry::SIZE;
+        const ColumnInfo &last = block.columns.back();
+        offset = std::max(next, last.offset + last.length);
+        m_blocks.push_back(block);
+    }
+}
+
+bool TelemetryFileReader::loadBlock(uint64_t offset, uint64_t fileSize, BlockInfo &block)
+{
+    TelemetryBlockHeader header;
+    if (offset + TelemetryBlockHeader::SIZE > fileSize
+        || !readBytes(offset, &header, sizeof(header))
+        || header.magic != TelemetryBlockHeader::MAGIC
+        || header.columnCount != static_cast<uint32_t>(columnCount())
+        || header.sampleCount == 0) {
+        return false;
+    }
+
+    const uint64_t dataStart = offset + TelemetryBlockHeader::SIZE
+        + uint64_t(header.columnCount) * TelemetryColumnEntry::SIZE;
+    if (dataStart + header.dataBytes > fileSize) {
+        return false;
+    }
+
+    std::vector<TelemetryColumnEntry> directory(header.columnCount);
+    if (!readBytes(offset + TelemetryBlockHeader::SIZE, directory.data(),
+                   directory.size() * sizeof(TelemetryColumnEntry))) {
+        return false;
+    }
+
+    block.offset = offset;
+    block.sampleCount = header.sampleCount;
+    block.firstTimestampUs = header.firstTimestampUs;
+    block.lastTimestampUs = header.lastTimestampUs;
+    block.columns.resize(directory.size());
+    for (size_t i = 0; i < directory.size(); ++i) {
+        const TelemetryColumnEntry &entry = directory[i];
+        if (entry.offset + entry.length > header.dataBytes) {
+            return false;
+        }
+        block.columns[i].offset = dataStart + entry.offset;
+        block.columns[i].length = entry.length;
+        block.columns[i].encoding = static_cast<TelemetryColumnEncoding>(entry.encoding);
+        block.columns[i].minValue = entry.minValue;
+        block.columns[i].maxValue = entry.maxValue;
+    }
+    return true;
+}
+
+bool TelemetryFileReader::readBytes(uint64_t offset, void *buffer, size_t size) const
+{
+    std::lock_guard<std::mutex> lock(m_ioMutex);
+    return m_file && seekTo(m_file, offset) && std::fread(buffer, 1, size, m_file) == size;
+}
+
+bool TelemetryFileReader::readTimestamps(size_t block, std::vector<int64_t> &out) const
+{
+    if (block >= m_blocks.size()) {
+        return false;
+    }
+
+    const BlockInfo &info = m_blocks[block];
+    const ColumnInfo &column = info.columns[0];
+    std::vector<uint8_t> bytes(column.length);
+    if (!readBytes(column.offset, bytes.data(), bytes.size())) {
+        return false;
+    }
+
+    BitReader reader(bytes.data(), bytes.size());
+    TimestampDecoder decoder;
+    out.resize(info.sampleCount);
+    for (uint32_t i = 0; i < info.sampleCount; ++i) {
+        out[i] = decoder.next(reader);
+    }
+    return true;
+}
+
+bool TelemetryFileReader::readColumn(size_t block, int column, std::vector<double> &out) const
+{
+    if (block >= m_blocks.size() || column <= 0 || column >= columnCount()) {
+        return false;
+    }
+
+    // 只读取目标列的字节，其余列不触碰
+    const BlockInfo &info = m_blocks[block];
+    const ColumnInfo &entry = info.columns[column];
+    std::vector<uint8_t> bytes(entry.length);
+    if (!readBytes(entry.offset, bytes.data(), bytes.size())) {
+        return false;
+    }
+
+    BitReader reader(bytes.data(), bytes.size());
+    out.resize(info.sampleCount);
+    if (entry.encoding == TelemetryColumnEncoding::QuantizedDelta) {
+        const double quantum = std::ldexp(1.0, -fractionBits());
+        TimestampDecoder decoder;
+        for (uint32_t i = 0; i < info.sampleCount; ++i) {
+            out[i] = static_cast<double>(decoder.next(reader)) * quantum;
+        }
+    } else {
+        FloatDecoder decoder;
+        for (uint32_t i = 0; i < info.sampleCount; ++i) {
+            out[i] = decoder.next(reader);
+        }
+    }
+    return true;
+}
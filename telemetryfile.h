@@ -0,0 +1,206 @@
+#ifndef TELEMETRYFILE_H
+#define TELEMETRYFILE_H
+
+#include "telemetrycodec.h"
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 列式压缩遥测文件（.rtlm）
+//
+// 文件头 | 块 0 | 块 1 | ... | 块索引 | 文件尾
+//
+// 每个块最多保存 blockSamples 个样本（时间戳倒退时提前结束当前块，块内时间单调），块内按列存放：
+//   第 0 列为时间戳（UTC 微秒，二阶差分编码），
+//   第 1 + channel * jointCount + joint 列为对应通道、关节的数值。
+// 数值列默认使用异或浮点编码（无损）；设置量化精度后先量化为 2^-fractionBits 的整数倍，
+// 再按整数做二阶差分编码，平滑运动数据每个样本只需几个比特。
+// 块头后是列目录，记录每列的偏移、长度和最小/最大值，查询时可以整块跳过，
+// 也可以只读取并解码需要的列。每个块独立编码，写完一块即落盘；
+// 进程异常退出导致缺少块索引时，读取端顺序扫描已完整写入的块。
+
+enum class TelemetryFileChannel {
+    Position,
+    Velocity,
+    Torque,
+    Target,     // 指令位置
+    Count
+};
+
+#pragma pack(push, 1)
+struct TelemetryFileHeader {
+    static const uint32_t MAGIC = 0x4D4C5452;  // "RTLM"
+    static const uint16_t VERSION = 1;
+    static const int SIZE = 64;
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t jointCount;
+    uint16_t channelCount;
+    uint16_t fractionBits;      // 量化精度（0 为无损）
+    uint32_t blockSamples;
+    int64_t createdUs;
+    uint8_t reserved[40];
+};
+
+struct TelemetryBlockHeader {
+    static const uint32_t MAGIC = 0x4B425452;  // "RTBK"
+    static const int SIZE = 40;
+
+    uint32_t magic;
+    uint32_t sampleCount;
+    uint32_t columnCount;
+    uint32_t reserved;
+    int64_t firstTimestampUs;
+    int64_t lastTimestampUs;
+    uint64_t dataBytes;         // 列目录之后的列数据总长度
+};
+
+enum class TelemetryColumnEncoding : uint32_t {
+    XorFloat = 0,               // 异或浮点
+    QuantizedDelta = 1          // 量化整数的二阶差分
+};
+
+struct TelemetryColumnEntry {
+    static const int SIZE = 32;
+
+    uint64_t offset;            // 相对列数据起点
+    uint32_t length;
+    uint32_t encoding;          // TelemetryColumnEncoding
+    double minValue;
+    double maxValue;
+};
+
+struct TelemetryIndexEntry {
+    uint64_t offset;            // 块头在文件中的偏移
+    int64_t firstTimestampUs;
+    int64_t lastTimestampUs;
+};
+
+struct TelemetryFileTrailer {
+    static const uint32_t MAGIC = 0x58495452;  // "RTIX"
+    static const int SIZE = 16;
+
+    uint32_t magic;
+    uint32_t blockCount;
+    uint64_t indexOffset;
+};
+#pragma pack(pop)
+
+// 流式写入：样本按列缓存，攒满一块后逐列编码并整块写入文件
+class TelemetryFileWriter
+{
+public:
+    static const int DEFAULT_BLOCK_SAMPLES = 4096;
+
+    TelemetryFileWriter();
+    ~TelemetryFileWriter();
+
+    // fractionBits > 0 时数值量化到 2^-fractionBits 的整数倍（最大误差为半个量化单位），
+    // 列内出现非有限值或超出整数范围时该块的这一列退回无损编码；0 表示全部无损
+    bool open(const std::string &fileName, int jointCount, int blockSamples = DEFAULT_BLOCK_SAMPLES,
+              int fractionBits = 0, std::string *errorMessage = nullptr);
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    // 任一数组可以为空指针，对应通道记为0
+    bool append(int64_t timestampUs, const double *positions, const double *velocities, const double *torques,
+                const double *targets = nullptr);
+
+    int jointCount() const { return m_jointCount; }
+    uint64_t sampleCount() const { return m_totalSamples; }
+    uint64_t bytesWritten() const { return m_bytesWritten; }
+
+private:
+    struct Column {
+        std::vector<double> values;
+        double minValue;
+        double maxValue;
+    };
+
+    bool flushBlock();
+    TelemetryColumnEncoding encodeColumn(const Column &column, BitWriter &bits) const;
+    void resetBlock();
+
+    std::FILE *m_file;
+    int m_jointCount;
+    int m_blockSamples;
+    int m_fractionBits;
+    double m_quantumScale;
+
+    BitWriter m_timestampBits;
+    TimestampEncoder m_timestampEncoder;
+    std::vector<Column> m_columns;
+    BitWriter m_columnBits;
+    uint32_t m_blockCount;
+    int64_t m_firstTimestampUs;
+    int64_t m_lastTimestampUs;
+
+    std::vector<TelemetryIndexEntry> m_index;
+    uint64_t m_totalSamples;
+    uint64_t m_bytesWritten;
+};
+
+// 读取：打开时只加载块头和列目录，列数据按需读取并解码（可多线程并发调用）
+class TelemetryFileReader
+{
+public:
+    struct ColumnInfo {
+        uint64_t offset;        // 文件内绝对偏移
+        uint32_t length;
+        TelemetryColumnEncoding encoding;
+        double minValue;
+        double maxValue;
+    };
+
+    struct BlockInfo {
+        uint64_t offset;
+        uint32_t sampleCount;
+        int64_t firstTimestampUs;
+        int64_t lastTimestampUs;
+        std::vector<ColumnInfo> columns;
+    };
+
+    TelemetryFileReader();
+    ~TelemetryFileReader();
+
+    bool open(const std::string &fileName, std::string *errorMessage = nullptr);
+    void close();
+    bool isOpen() const { return m_file != nullptr; }
+
+    int jointCount() const { return m_header.jointCount; }
+    int channelCount() const { return m_header.channelCount; }
+    int columnCount() const { return 1 + m_header.channelCount * m_header.jointCount; }
+    int fractionBits() const { return m_header.fractionBits; }
+    bool hasIndex() const { return m_indexed; }
+    uint64_t sampleCount() const;
+    int64_t firstTimestampUs() const;
+    int64_t lastTimestampUs() const;
+
+    const std::vector<BlockInfo> &blocks() const { return m_blocks; }
+    int columnIndex(TelemetryFileChannel channel, int joint) const
+    {
+        // 通道按顺序追加在列尾，旧文件中没有的通道返回 -1
+        return static_cast<int>(channel) < m_header.channelCount && joint >= 0 && joint < m_header.jointCount
+            ? 1 + static_cast<int>(channel) * m_header.jointCount + joint : -1;
+    }
+
+    bool readTimestamps(size_t block, std::vector<int64_t> &out) const;
+    bool readColumn(size_t block, int column, std::vector<double> &out) const;
+
+private:
+    bool loadIndex(uint64_t fileSize);
+    void scanBlocks(uint64_t fileSize);
+    bool loadBlock(uint64_t offset, uint64_t fileSize, BlockInfo &block);
+    bool readBytes(uint64_t offset, void *buffer, size_t size) const;
+
+    mutable std::FILE *m_file;
+    mutable std::mutex m_ioMutex;
+    TelemetryFileHeader m_header;
+    std::vector<BlockInfo> m_blocks;
+    bool m_indexed;
+};
+
+#endif // TELEMETRYFILE_H
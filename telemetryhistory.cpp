@@ -0,0 +1,223 @@
+#include "telemetryhistory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+int64_t TelemetryRing::View::timestampAt(size_t index) const
+{
+    return index < count[0] ? timestamps[0][index] : timestamps[1][index - count[0]];
+}
+
+const double *TelemetryRing::View::rowAt(size_t index) const
+{
+    return index < count[0] ? values[0] + index * width
+                            : values[1] + (index - count[0]) * width;
+}
+
+TelemetryRing::Buffer::Buffer(int width, size_t capacity, uint64_t generation)
+    : timestamps(capacity, 0)
+    , values(capacity * size_t(width), 0.0)
+    , capacity(capacity)
+    , mask(capacity ? capacity - 1 : 0)
+    , width(width)
+    , generation(generation)
+    , head(0)
+{
+}
+
+TelemetryRing::TelemetryRing()
+    : m_buffer(std::make_shared<Buffer>(0, 0, 0))
+    , m_writer(m_buffer.get())
+    , m_generation(0)
+{
+}
+
+void TelemetryRing::reset(int width, size_t capacity)
+{
+    // 容量取2的幂，槽位计算只需一次按位与
+    size_t powerOfTwo = capacity ? 1 : 0;
+    while (powerOfTwo && powerOfTwo * 2 <= capacity) {
+        powerOfTwo *= 2;
+    }
+
+    // 不在原缓冲区上重新分配：读者的视图可能仍指向它
+    std::shared_ptr<Buffer> buffer = std::make_shared<Buffer>(std::max(0, width), powerOfTwo, ++m_generation);
+    m_writer = buffer.get();
+    std::atomic_store(&m_buffer, std::move(buffer));
+}
+
+void TelemetryRing::append(int64_t timestampNs, const double *row)
+{
+    Buffer &buffer = *m_writer;
+    if (buffer.capacity == 0) {
+        return;
+    }
+
+    const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    const size_t index = buffer.slot(head);
+    buffer.timestamps[index] = timestampNs;
+    std::memcpy(&buffer.values[index * buffer.width], row, sizeof(double) * buffer.width);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+std::shared_ptr<const TelemetryRing::Buffer> TelemetryRing::current() const
+{
+    return std::atomic_load(&m_buffer);
+}
+
+int TelemetryRing::width() const
+{
+    return current()->width;
+}
+
+size_t TelemetryRing::capacity() const
+{
+    return current()->capacity;
+}
+
+size_t TelemetryRing::size() const
+{
+    const std::shared_ptr<const Buffer> buffer = current();
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    // 最旧的一个槽位可能正被写入，不对读者开放
+    return static_cast<size_t>(std::min<uint64_t>(head, buffer->capacity ? buffer->capacity - 1 : 0));
+}
+
+uint64_t TelemetryRing::totalWritten() const
+{
+    return current()->head.load(std::memory_order_acquire);
+}
+
+uint64_t TelemetryRing::generation() const
+{
+    return current()->generation;
+}
+
+TelemetryRing::View TelemetryRing::latest(size_t count) const
+{
+    const std::shared_ptr<const Buffer> buffer = current();
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    const uint64_t available = std::min<uint64_t>(head, buffer->capacity ? buffer->capacity - 1 : 0);
+    const uint64_t first = head - std::min<uint64_t>(count, available);
+    return makeView(buffer, first, head);
+}
+
+TelemetryRing::View TelemetryRing::range(int64_t fromNs, int64_t toNs) const
+{
+    const std::shared_ptr<const Buffer> buffer = current();
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    const uint64_t available = std::min<uint64_t>(head, buffer->capacity ? buffer->capacity - 1 : 0);
+    const uint64_t oldest = head - available;
+
+    // 时间戳单调递增，二分查找区间 [fromNs, toNs]
+    const uint64_t first = lowerBound(*buffer, oldest, head, fromNs);
+    const uint64_t last = toNs == INT64_MAX ? head : lowerBound(*buffer, first, head, toNs + 1);
+    return makeView(buffer, first, last);
+}
+
+bool TelemetryRing::isValid(const View &view) const
+{
+    if (view.isEmpty()) {
+        return true;
+    }
+
+    // 读取完成后再检查写指针：缓冲区未被换掉、视图中最旧的样本仍未被覆盖即有效
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const std::shared_ptr<const Buffer> buffer = current();
+    if (buffer->generation != view.generation) {
+        return false;
+    }
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    return view.firstSequence + buffer->capacity - 1 >= head;
+}
+
+TelemetryRing::View TelemetryRing::makeView(const std::shared_ptr<const Buffer> &buffer, uint64_t first,
+                                            uint64_t last)
+{
+    View view;
+    view.width = buffer->width;
+    view.firstSequence = first;
+    view.generation = buffer->generation;
+    if (last <= first || buffer->capacity == 0) {
+        return view;
+    }
+
+    const size_t begin = buffer->slot(first);
+    const size_t total = static_cast<size_t>(last - first);
+    const size_t firstPart = std::min(total, buffer->capacity - begin);
+
+    view.timestamps[0] = &buffer->timestamps[begin];
+    view.values[0] = &buffer->values[begin * buffer->width];
+    view.count[0] = firstPart;
+    if (firstPart < total) {
+        view.timestamps[1] = &buffer->timestamps[0];
+        view.values[1] = &buffer->values[0];
+        view.count[1] = total - firstPart;
+    }
+    view.buffer = buffer;
+    return view;
+}
+
+uint64_t TelemetryRing::lowerBound(const Buffer &buffer, uint64_t first, uint64_t last, int64_t timestampNs)
+{
+    while (first < last) {
+        const uint64_t middle = first + (last - first) / 2;
+        if (buffer.timestamps[buffer.slot(middle)] < timestampNs) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return first;
+}
+
+TelemetryHistory::TelemetryHistory(int jointCount, size_t memoryBudget)
+    : m_jointCount(0)
+    , m_memoryBudget(0)
+{
+    configure(jointCount, memoryBudget);
+}
+
+void TelemetryHistory::configure(int jointCount, size_t memoryBudget)
+{
+    m_jointCount = jointCount;
+    m_memoryBudget = memoryBudget;
+
+    // 各通道样本数相同，按每个样本的总字节数平分预算
+    size_t bytesPerSample = 0;
+    for (int i = 0; i < static_cast<int>(TelemetryChannel::Count); ++i) {
+        const int width = i == static_cast<int>(TelemetryChannel::Battery) ? 1 : jointCount;
+        bytesPerSample += TelemetryRing::bytesPerSample(width);
+    }
+
+    const size_t capacity = jointCount > 0 ? memoryBudget / bytesPerSample : 0;
+    for (int i = 0; i < static_cast<int>(TelemetryChannel::Count); ++i) {
+        const int width = i == static_cast<int>(TelemetryChannel::Battery) ? 1 : jointCount;
+        m_rings[i].reset(width, capacity);
+    }
+}
+
+size_t TelemetryHistory::memoryUsage() const
+{
+    size_t bytes = 0;
+    for (const TelemetryRing &ring : m_rings) {
+        bytes += ring.capacity() * TelemetryRing::bytesPerSample(ring.width());
+    }
+    return bytes;
+}
+
+void TelemetryHistory::record(TelemetryChannel channel, int64_t timestampNs, const double *row)
+{
+    m_rings[static_cast<int>(channel)].append(timestampNs, row);
+}
+
+const TelemetryRing &TelemetryHistory::channel(TelemetryChannel channel) const
+{
+    return m_rings[static_cast<int>(channel)];
+}
+
+int64_t TelemetryHistory::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,115 @@
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 遥测通道
+enum class TelemetryChannel {
+    CommandedPosition,  // 指令位置
+    MeasuredPosition,   // 反馈位置
+    Velocity,           // 关节速度
+    Torque,             // 关节扭矩
+    Battery,            // 电池电量（单列）
+    Count
+};
+
+// 定长时间序列环形缓冲区（单写多读，无锁）
+// 每个样本是一个时间戳加一行 width 个数值，写满后覆盖最旧的样本。
+// 写入端只做一次行拷贝和一次 release 存储；读取端拿到指向内部缓冲区的视图，
+// 使用完后用 isValid() 确认期间数据没有被覆盖。
+// reset() 换用新的缓冲区并递增代号，旧缓冲区由仍持有视图的读者共享，最后一个视图释放时回收；
+// 视图的代号与当前不一致时 isValid() 返回 false。
+class TelemetryRing
+{
+    struct Buffer;
+
+public:
+    // 零拷贝读取视图：环形回绕时分为两段
+    struct View {
+        const int64_t *timestamps[2];
+        const double *values[2];
+        size_t count[2];
+        uint64_t firstSequence;
+        uint64_t generation;
+        int width;
+        std::shared_ptr<const Buffer> buffer;   // 保证视图期间缓冲区不被释放
+
+        View() : timestamps{nullptr, nullptr}, values{nullptr, nullptr}
+               , count{0, 0}, firstSequence(0), generation(0), width(0) {}
+        size_t size() const { return count[0] + count[1]; }
+        bool isEmpty() const { return size() == 0; }
+        int64_t timestampAt(size_t index) const;
+        const double *rowAt(size_t index) const;
+    };
+
+    TelemetryRing();
+
+    // 写入端（单线程）：capacity 向下取整为2的幂
+    void reset(int width, size_t capacity);
+    void append(int64_t timestampNs, const double *row);
+
+    // 读取端（任意线程）
+    int width() const;
+    size_t capacity() const;
+    size_t size() const;
+    uint64_t totalWritten() const;
+    uint64_t generation() const;
+    View latest(size_t count) const;
+    View range(int64_t fromNs, int64_t toNs) const;
+    bool isValid(const View &view) const;
+
+    static size_t bytesPerSample(int width) { return sizeof(int64_t) + sizeof(double) * width; }
+
+private:
+    struct Buffer {
+        std::vector<int64_t> timestamps;
+        std::vector<double> values;     // 行优先：slot * width
+        size_t capacity;
+        size_t mask;
+        int width;
+        uint64_t generation;
+        std::atomic<uint64_t> head;     // 已写入的样本总数
+
+        Buffer(int width, size_t capacity, uint64_t generation);
+        size_t slot(uint64_t sequence) const { return static_cast<size_t>(sequence) & mask; }
+    };
+
+    std::shared_ptr<const Buffer> current() const;
+    static View makeView(const std::shared_ptr<const Buffer> &buffer, uint64_t first, uint64_t last);
+    static uint64_t lowerBound(const Buffer &buffer, uint64_t first, uint64_t last, int64_t timestampNs);
+
+    std::shared_ptr<Buffer> m_buffer;   // 读者经 std::atomic_load 取得，写入端直接使用 m_writer
+    Buffer *m_writer;
+    uint64_t m_generation;
+};
+
+// 全部遥测通道的历史记录，按内存预算分配各通道容量
+class TelemetryHistory
+{
+public:
+    static const size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    explicit TelemetryHistory(int jointCount = 0, size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+
+    void configure(int jointCount, size_t memoryBudget);
+    int jointCount() const { return m_jointCount; }
+    size_t memoryBudget() const { return m_memoryBudget; }
+    size_t memoryUsage() const;
+
+    void record(TelemetryChannel channel, int64_t timestampNs, const double *row);
+    const TelemetryRing &channel(TelemetryChannel channel) const;
+
+    // 单调时钟时间戳（纳秒）
+    static int64_t nowNs();
+
+private:
+    TelemetryRing m_rings[static_cast<int>(TelemetryChannel::Count)];
+    int m_jointCount;
+    size_t m_memoryBudget;
+};
+
+#endif // TELEMETRYHISTORY_H
@@ -0,0 +1,617 @@
+#include "telemetryquery.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <map>
+#include <thread>
+
+namespace {
+
+void setError(std::string *errorMessage, const std::string &message)
+{
+    if (errorMessage) {
+        *errorMessage = message;
+    }
+}
+
+// 单列的累加器（聚合和降采样共用）
+struct ColumnAccumulator {
+    uint64_t count = 0;
+    double minValue = HUGE_VAL;
+    double maxValue = -HUGE_VAL;
+    double sum = 0.0;
+
+    void add(double value)
+    {
+        ++count;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+        sum += value;
+    }
+
+    void merge(const ColumnAccumulator &other)
+    {
+        count += other.count;
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+        sum += other.sum;
+    }
+};
+
+} // namespace
+
+bool TelemetryPredicate::matches(double value) const
+{
+    switch (comparison) {
+    case Greater:      return value > threshold;
+    case GreaterEqual: return value >= threshold;
+    case Less:         return value < threshold;
+    case LessEqual:    return value <= threshold;
+    }
+    return false;
+}
+
+bool TelemetryPredicate::mayMatch(double minValue, double maxValue) const
+{
+    // 列目录里的最小/最大值不含 NaN，块内有 NaN 也不会让谓词成立
+    switch (comparison) {
+    case Greater:      return maxValue > threshold;
+    case GreaterEqual: return maxValue >= threshold;
+    case Less:         return minValue < threshold;
+    case LessEqual:    return minValue <= threshold;
+    }
+    return true;
+}
+
+TelemetryQueryEngine::TelemetryQueryEngine(int threadCount)
+    : m_jointCount(0)
+    , m_channelCount(0)
+    , m_threadCount(threadCount > 0 ? threadCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency())))
+    , m_lastScan{0, 0, 0}
+{
+}
+
+TelemetryQueryEngine::~TelemetryQueryEngine() = default;
+
+bool TelemetryQueryEngine::addFile(const std::string &fileName, std::string *errorMessage)
+{
+    std::unique_ptr<TelemetryFileReader> reader(new TelemetryFileReader);
+    if (!reader->open(fileName, errorMessage)) {
+        return false;
+    }
+
+    if (m_jointCount != 0 && reader->jointCount() != m_jointCount) {
+        setError(errorMessage, "关节数与已加载文件不一致: " + fileName);
+        return false;
+    }
+
+    m_jointCount = reader->jointCount();
+    m_channelCount = m_files.empty() ? reader->channelCount() : std::min(m_channelCount, reader->channelCount());
+    m_files.push_back(std::move(reader));
+    return true;
+}
+
+int TelemetryQueryEngine::addDirectory(const std::string &directory, std::string *errorMessage)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    std::vector<std::string> fileNames;
+    for (fs::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (it->is_regular_file() && it->path().extension() == ".rtlm") {
+            fileNames.push_back(it->path().string());
+        }
+    }
+    if (error) {
+        setError(errorMessage, "无法读取目录 " + directory + ": " + error.message());
+        return -1;
+    }
+
+    std::sort(fileNames.begin(), fileNames.end());
+    int added = 0;
+    for (const std::string &fileName : fileNames) {
+        if (!addFile(fileName, errorMessage)) {
+            return -1;
+        }
+        ++added;
+    }
+    return added;
+}
+
+uint64_t TelemetryQueryEngine::sampleCount() const
+{
+    uint64_t count = 0;
+    for (const auto &file : m_files) {
+        count += file->sampleCount();
+    }
+    return count;
+}
+
+int64_t TelemetryQueryEngine::firstTimestampUs() const
+{
+    int64_t first = std::numeric_limits<int64_t>::max();
+    for (const auto &file : m_files) {
+        if (!file->blocks().empty()) {
+            first = std::min(first, file->firstTimestampUs());
+        }
+    }
+    return first == std::numeric_limits<int64_t>::max() ? 0 : first;
+}
+
+int64_t TelemetryQueryEngine::lastTimestampUs() const
+{
+    int64_t last = std::numeric_limits<int64_t>::min();
+    for (const auto &file : m_files) {
+        if (!file->blocks().empty()) {
+            last = std::max(last, file->lastTimestampUs());
+        }
+    }
+    return last == std::numeric_limits<int64_t>::min() ? 0 : last;
+}
+
+int TelemetryQueryEngine::columnIndex(const TelemetryColumnRef &column) const
+{
+    if (column.joint < 0 || column.joint >= m_jointCount
+        || static_cast<int>(column.channel) < 0 || static_cast<int>(column.channel) >= m_channelCount) {
+        return -1;
+    }
+    return 1 + static_cast<int>(column.channel) * m_jointCount + column.joint;
+}
+
+std::vector<TelemetryQueryEngine::BlockRef> TelemetryQueryEngine::selectBlocks(
+    const TelemetryTimeRange &range, const TelemetryPredicate *predicate) const
+{
+    std::vector<BlockRef> blocks;
+    uint64_t total = 0;
+    for (const auto &file : m_files) {
+        const std::vector<TelemetryFileReader::BlockInfo> &infos = file->blocks();
+        total += infos.size();
+        for (size_t i = 0; i < infos.size(); ++i) {
+            if (range.overlaps(infos[i].firstTimestampUs, infos[i].lastTimestampUs)) {
+                blocks.push_back(BlockRef{file.get(), i, infos[i].firstTimestampUs, infos[i].lastTimestampUs, 0});
+            }
+        }
+    }
+
+    std::sort(blocks.begin(), blocks.end(),
+              [](const BlockRef &a, const BlockRef &b) { return a.firstUs < b.firstUs; });
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i].ordinal = i;
+    }
+
+    // 谓词剪枝：块内该列的取值范围不可能满足条件时整块跳过
+    if (predicate) {
+        const int column = columnIndex(predicate->column);
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [&](const BlockRef &ref) {
+            const TelemetryFileReader::ColumnInfo &info = ref.file->blocks()[ref.block].columns[column];
+            return !predicate->mayMatch(info.minValue, info.maxValue);
+        }), blocks.end());
+    }
+
+    m_lastScan.blocksTotal = total;
+    m_lastScan.blocksScanned = blocks.size();
+    m_lastScan.samplesDecoded = 0;
+    return blocks;
+}
+
+template <typename Work>
+void TelemetryQueryEngine::parallelFor(size_t count, const Work &work) const
+{
+    const int workers = static_cast<int>(std::min<size_t>(count, static_cast<size_t>(m_threadCount)));
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            work(i, 0);
+        }
+        return;
+    }
+
+    // 动态分配：块的解码代价不均匀，按原子计数逐块领取
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (int worker = 0; worker < workers; ++worker) {
+        threads.emplace_back([&, worker]() {
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                work(i, worker);
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+std::vector<TelemetryEvent> TelemetryQueryEngine::findEvents(const TelemetryPredicate &predicate,
+                                                             const TelemetryTimeRange &range) const
+{
+    if (columnIndex(predicate.column) < 0) {
+        return std::vector<TelemetryEvent>();
+    }
+
+    struct BlockEvents {
+        std::vector<TelemetryEvent> events;
+        bool openAtStart = false;   // 第一段从块的第一个样本开始
+        bool openAtEnd = false;     // 最后一段持续到块的最后一个样本
+    };
+
+    const std::vector<BlockRef> blocks = selectBlocks(range, &predicate);
+    const int column = columnIndex(predicate.column);
+    const bool upward = predicate.comparison == TelemetryPredicate::Greater
+        || predicate.comparison == TelemetryPredicate::GreaterEqual;
+    std::vector<BlockEvents> results(blocks.size());
+    std::atomic<uint64_t> decoded(0);
+
+    parallelFor(blocks.size(), [&](size_t index, int) {
+        const BlockRef &ref = blocks[index];
+        std::vector<int64_t> timestamps;
+        std::vector<double> values;
+        if (!ref.file->readTimestamps(ref.block, timestamps) || !ref.file->readColumn(ref.block, column, values)) {
+            return;
+        }
+        decoded.fetch_add(timestamps.size(), std::memory_order_relaxed);
+
+        BlockEvents &result = results[index];
+        bool inEvent = false;
+        for (size_t i = 0; i < timestamps.size(); ++i) {
+            const bool hit = range.contains(timestamps[i]) && predicate.matches(values[i]);
+            if (hit && !inEvent) {
+                result.events.push_back(TelemetryEvent{timestamps[i], timestamps[i], values[i], 0});
+                result.openAtStart = result.openAtStart || i == 0;
+            }
+            if (hit) {
+                TelemetryEvent &event = result.events.back();
+                event.endUs = timestamps[i];
+                event.peak = upward ? std::max(event.peak, values[i]) : std::min(event.peak, values[i]);
+                ++event.samples;
+            }
+            inEvent = hit;
+        }
+        result.openAtEnd = inEvent;
+    });
+
+    // 按时间顺序合并，跨越相邻块边界的事件连成一段
+    std::vector<TelemetryEvent> events;
+    bool previousOpen = false;
+    size_t previousOrdinal = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BlockEvents &result = results[i];
+        for (size_t e = 0; e < result.events.size(); ++e) {
+            const TelemetryEvent &event = result.events[e];
+            if (e == 0 && result.openAtStart && previousOpen && blocks[i].ordinal == previousOrdinal + 1) {
+                TelemetryEvent &last = events.back();
+                last.endUs = event.endUs;
+                last.peak = upward ? std::max(last.peak, event.peak) : std::min(last.peak, event.peak);
+                last.samples += event.samples;
+            } else {
+                events.push_back(event);
+            }
+        }
+        previousOpen = result.openAtEnd;
+        previousOrdinal = blocks[i].ordinal;
+    }
+
+    m_lastScan.samplesDecoded = decoded.load();
+    return events;
+}
+
+std::vector<TelemetryColumnStats> TelemetryQueryEngine::aggregate(const std::vector<TelemetryColumnRef> &columns,
+                                                                  const TelemetryTimeRange &range,
+                                                                  const std::vector<double> &percentiles) const
+{
+    std::vector<int> indexes;
+    for (const TelemetryColumnRef &column : columns) {
+        if (columnIndex(column) < 0) {
+            return std::vector<TelemetryColumnStats>();
+        }
+        indexes.push_back(columnIndex(column));
+    }
+
+    const std::vector<BlockRef> blocks = selectBlocks(range, nullptr);
+    const size_t columnCount = indexes.size();
+    const bool wantHistogram = !percentiles.empty();
+
+    // 直方图范围直接取自列目录，不需要额外的扫描
+    std::vector<double> histogramMin(columnCount, HUGE_VAL);
+    std::vector<double> histogramMax(columnCount, -HUGE_VAL);
+    for (const BlockRef &ref : blocks) {
+        const TelemetryFileReader::BlockInfo &info = ref.file->blocks()[ref.block];
+        for (size_t c = 0; c < columnCount; ++c) {
+            histogramMin[c] = std::min(histogramMin[c], info.columns[indexes[c]].minValue);
+            histogramMax[c] = std::max(histogramMax[c], info.columns[indexes[c]].maxValue);
+        }
+    }
+
+    struct WorkerState {
+        std::vector<ColumnAccumulator> accumulators;
+        std::vector<uint64_t> histogram;    // columnCount * HISTOGRAM_BINS
+        uint64_t decoded = 0;
+    };
+
+    const int workers = std::max(1, std::min(m_threadCount, static_cast<int>(blocks.size())));
+    std::vector<WorkerState> states(workers);
+    for (WorkerState &state : states) {
+        state.accumulators.resize(columnCount);
+        if (wantHistogram) {
+            state.histogram.assign(columnCount * HISTOGRAM_BINS, 0);
+        }
+    }
+
+    parallelFor(blocks.size(), [&](size_t index, int worker) {
+        const BlockRef &ref = blocks[index];
+        WorkerState &state = states[worker];
+        std::vector<int64_t> timestamps;
+        std::vector<double> values;
+        if (!ref.file->readTimestamps(ref.block, timestamps)) {
+            return;
+        }
+
+        // 块完全落在范围内时省去逐样本的时间判断
+        const bool whole = range.contains(ref.firstUs) && range.contains(ref.lastUs);
+        for (size_t c = 0; c < columnCount; ++c) {
+            if (!ref.file->readColumn(ref.block, indexes[c], values)) {
+                continue;
+            }
+
+            ColumnAccumulator &accumulator = state.accumulators[c];
+            uint64_t *histogram = wantHistogram ? &state.histogram[c * HISTOGRAM_BINS] : nullptr;
+            const double low = histogramMin[c];
+            const double scale = histogramMax[c] > low ? HISTOGRAM_BINS / (histogramMax[c] - low) : 0.0;
+
+            for (size_t i = 0; i < values.size(); ++i) {
+                const double value = values[i];
+                if (std::isnan(value) || (!whole && !range.contains(timestamps[i]))) {
+                    continue;
+                }
+                accumulator.add(value);
+                if (histogram) {
+                    const int bin = static_cast<int>((value - low) * scale);
+                    ++histogram[std::max(0, std::min(bin, HISTOGRAM_BINS - 1))];
+                }
+            }
+        }
+        state.decoded += timestamps.size();
+    });
+
+    std::vector<TelemetryColumnStats> stats(columnCount);
+    uint64_t decoded = 0;
+    for (const WorkerState &state : states) {
+        decoded += state.decoded;
+    }
+
+    for (size_t c = 0; c < columnCount; ++c) {
+        ColumnAccumulator total;
+        for (const WorkerState &state : states) {
+            total.merge(state.accumulators[c]);
+        }
+
+        TelemetryColumnStats &result = stats[c];
+        result.count = total.count;
+        result.minValue = total.count ? total.minValue : NAN;
+        result.maxValue = total.count ? total.maxValue : NAN;
+        result.mean = total.count ? total.sum / total.count : NAN;
+
+        if (!wantHistogram) {
+            continue;
+        }
+
+        std::vector<uint64_t> histogram(HISTOGRAM_BINS, 0);
+        for (const WorkerState &state : states) {
+            for (int b = 0; b < HISTOGRAM_BINS; ++b) {
+                histogram[b] += state.histogram[c * HISTOGRAM_BINS + b];
+            }
+        }
+
+        // 在目标所在的桶内线性插值，误差不超过一个桶宽
+        const double width = (histogramMax[c] - histogramMin[c]) / HISTOGRAM_BINS;
+        for (double percentile : percentiles) {
+            if (total.count == 0) {
+                result.percentiles.push_back(NAN);
+                continue;
+            }
+
+            const double rank = std::max(0.0, std::min(percentile, 100.0)) / 100.0 * total.count;
+            double cumulative = 0.0;
+            double value = total.maxValue;
+            for (int b = 0; b < HISTOGRAM_BINS; ++b) {
+                if (histogram[b] && cumulative + histogram[b] >= rank) {
+                    value = histogramMin[c] + (b + (rank - cumulative) / histogram[b]) * width;
+                    break;
+                }
+                cumulative += histogram[b];
+            }
+            result.percentiles.push_back(std::max(total.minValue, std::min(value, total.maxValue)));
+        }
+    }
+
+    m_lastScan.samplesDecoded = decoded;
+    return stats;
+}
+
+std::vector<TelemetryBucket> TelemetryQueryEngine::downsample(const std::vector<TelemetryColumnRef> &columns,
+                                                              const TelemetryTimeRange &range,
+                                                              int64_t bucketUs) const
+{
+    std::vector<int> indexes;
+    for (const TelemetryColumnRef &column : columns) {
+        if (columnIndex(column) < 0) {
+            return std::vector<TelemetryBucket>();
+        }
+        indexes.push_back(columnIndex(column));
+    }
+
+    const std::vector<BlockRef> blocks = selectBlocks(range, nullptr);
+    if (blocks.empty() || bucketUs <= 0) {
+        return std::vector<TelemetryBucket>();
+    }
+
+    const size_t columnCount = indexes.size();
+    const int64_t origin = std::max(range.fromUs, blocks.front().firstUs);
+
+    // 每个块只覆盖连续的少数几个桶，先在块内累加，最后按桶号合并
+    struct PartialBucket {
+        int64_t bucket;
+        uint64_t count;
+        std::vector<ColumnAccumulator> columns;
+    };
+    std::vector<std::vector<PartialBucket>> partials(blocks.size());
+    std::atomic<uint64_t> decoded(0);
+
+    parallelFor(blocks.size(), [&](size_t index, int) {
+        const BlockRef &ref = blocks[index];
+        std::vector<int64_t> timestamps;
+        std::vector<std::vector<double>> values(columnCount);
+        if (!ref.file->readTimestamps(ref.block, timestamps)) {
+            return;
+        }
+        for (size_t c = 0; c < columnCount; ++c) {
+            if (!ref.file->readColumn(ref.block, indexes[c], values[c])) {
+                return;
+            }
+        }
+        decoded.fetch_add(timestamps.size(), std::memory_order_relaxed);
+
+        std::vector<PartialBucket> &result = partials[index];
+        for (size_t i = 0; i < timestamps.size(); ++i) {
+            if (!range.contains(timestamps[i])) {
+                continue;
+            }
+
+            const int64_t bucket = (timestamps[i] - origin) / bucketUs;
+            if (result.empty() || result.back().bucket != bucket) {
+                result.push_back(PartialBucket{bucket, 0, std::vector<ColumnAccumulator>(columnCount)});
+            }
+            PartialBucket &partial = result.back();
+            ++partial.count;
+            for (size_t c = 0; c < columnCount; ++c) {
+                if (!std::isnan(values[c][i])) {
+                    partial.columns[c].add(values[c][i]);
+                }
+            }
+        }
+    });
+
+    std::map<int64_t, PartialBucket> merged;
+    for (const std::vector<PartialBucket> &result : partials) {
+        for (const PartialBucket &partial : result) {
+            auto it = merged.find(partial.bucket);
+            if (it == merged.end()) {
+                merged.emplace(partial.bucket, partial);
+                continue;
+            }
+            it->second.count += partial.count;
+            for (size_t c = 0; c < columnCount; ++c) {
+                it->second.columns[c].merge(partial.columns[c]);
+            }
+        }
+    }
+
+    std::vector<TelemetryBucket> buckets;
+    buckets.reserve(merged.size());
+    for (const auto &entry : merged) {
+        TelemetryBucket bucket;
+        bucket.startUs = origin + entry.first * bucketUs;
+        bucket.count = entry.second.count;
+        for (const ColumnAccumulator &accumulator : entry.second.columns) {
+            const bool empty = accumulator.count == 0;
+            bucket.minValues.push_back(empty ? NAN : accumulator.minValue);
+            bucket.maxValues.push_back(empty ? NAN : accumulator.maxValue);
+            bucket.meanValues.push_back(empty ? NAN : accumulator.sum / accumulator.count);
+        }
+        buckets.push_back(bucket);
+    }
+
+    m_lastScan.samplesDecoded = decoded.load();
+    return buckets;
+}
+
+bool TelemetryQueryEngine::resample(const std::vector<TelemetryColumnRef> &columns, const TelemetryTimeRange &range,
+                                    int64_t intervalUs, TelemetrySeries &series) const
+{
+    std::vector<int> indexes;
+    for (const TelemetryColumnRef &column : columns) {
+        if (columnIndex(column) < 0) {
+            return false;
+        }
+        indexes.push_back(columnIndex(column));
+    }
+
+    const std::vector<BlockRef> blocks = selectBlocks(range, nullptr);
+    if (blocks.empty() || intervalUs <= 0) {
+        return false;
+    }
+
+    int64_t lastUs = blocks.front().lastUs;
+    for (const BlockRef &ref : blocks) {
+        lastUs = std::max(lastUs, ref.lastUs);
+    }
+
+    const size_t columnCount = indexes.size();
+    series.originUs = std::max(range.fromUs, blocks.front().firstUs);
+    series.intervalUs = intervalUs;
+    series.rows = static_cast<size_t>((std::min(range.toUs, lastUs) - series.originUs) / intervalUs + 1);
+    series.columns = columnCount;
+
+    // 块内先累加到局部行缓冲，相邻块可能共享边界行，最后顺序合并
+    struct PartialRows {
+        size_t firstRow = 0;
+        std::vector<double> sums;
+        std::vector<uint32_t> counts;
+    };
+    std::vector<PartialRows> partials(blocks.size());
+    std::atomic<uint64_t> decoded(0);
+
+    parallelFor(blocks.size(), [&](size_t index, int) {
+        const BlockRef &ref = blocks[index];
+        std::vector<int64_t> timestamps;
+        std::vector<double> values;
+        if (!ref.file->readTimestamps(ref.block, timestamps)) {
+            return;
+        }
+
+        const int64_t first = std::max(ref.firstUs, series.originUs);
+        const int64_t last = std::min(ref.lastUs, range.toUs);
+        if (last < first) {
+            return;
+        }
+
+        PartialRows &partial = partials[index];
+        partial.firstRow = static_cast<size_t>((first - series.originUs) / intervalUs);
+        const size_t rowCount = static_cast<size_t>((last - series.originUs) / intervalUs) - partial.firstRow + 1;
+        partial.sums.assign(rowCount * columnCount, 0.0);
+        partial.counts.assign(rowCount * columnCount, 0);
+
+        for (size_t c = 0; c < columnCount; ++c) {
+            if (!ref.file->readColumn(ref.block, indexes[c], values)) {
+                continue;
+            }
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (timestamps[i] < first || timestamps[i] > last || std::isnan(values[i])) {
+                    continue;
+                }
+                const size_t row = static_cast<size_t>((timestamps[i] - series.originUs) / intervalUs) - partial.firstRow;
+                partial.sums[row * columnCount + c] += values[i];
+                ++partial.counts[row * columnCount + c];
+            }
+        }
+        decoded.fetch_add(timestamps.size(), std::memory_order_relaxed);
+    });
+
+    std::vector<double> sums(series.rows * columnCount, 0.0);
+    std::vector<uint32_t> counts(series.rows * columnCount, 0);
+    for (const PartialRows &partial : partials) {
+        const size_t offset = partial.firstRow * columnCount;
+        for (size_t i = 0; i < partial.sums.size() && offset + i < sums.size(); ++i) {
+            sums[offset + i] += partial.sums[i];
+            counts[offset + i] += partial.counts[i];
+        }
+    }
+
+    series.values.resize(sums.size());
+    for (size_t i = 0; i < sums.size(); ++i) {
+        series.values[i] = counts[i] ? sums[i] / counts[i] : NAN;
+    }
+
+    m_lastScan.samplesDecoded = decoded.load();
+    return true;
+}
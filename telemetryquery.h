@@ -0,0 +1,145 @@
+#ifndef TELEMETRYQUERY_H
+#define TELEMETRYQUERY_H
+
+#include "telemetryfile.h"
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 遥测归档查询
+// 在一组 .rtlm 文件上按时间范围、关节谓词做事件查找、聚合统计和降采样导出。
+// 先用块头时间范围和列目录中的最小/最大值剪枝，只解码可能命中的块和涉及的列；
+// 剩余的块分发到多个线程并行解码，各线程结果最后按时间顺序合并。
+
+struct TelemetryColumnRef {
+    TelemetryFileChannel channel;
+    int joint;
+
+    TelemetryColumnRef(TelemetryFileChannel c = TelemetryFileChannel::Position, int j = 0)
+        : channel(c), joint(j) {}
+};
+
+struct TelemetryTimeRange {
+    int64_t fromUs;
+    int64_t toUs;       // 闭区间
+
+    TelemetryTimeRange(int64_t from = std::numeric_limits<int64_t>::min(),
+                       int64_t to = std::numeric_limits<int64_t>::max())
+        : fromUs(from), toUs(to) {}
+    bool contains(int64_t timestampUs) const { return timestampUs >= fromUs && timestampUs <= toUs; }
+    bool overlaps(int64_t firstUs, int64_t lastUs) const { return lastUs >= fromUs && firstUs <= toUs; }
+};
+
+struct TelemetryPredicate {
+    enum Comparison { Greater, GreaterEqual, Less, LessEqual };
+
+    TelemetryColumnRef column;
+    Comparison comparison;
+    double threshold;
+
+    TelemetryPredicate() : comparison(Greater), threshold(0.0) {}
+    bool matches(double value) const;
+    bool mayMatch(double minValue, double maxValue) const;     // 块级剪枝
+};
+
+// 谓词连续成立的一段时间
+struct TelemetryEvent {
+    int64_t startUs;
+    int64_t endUs;
+    double peak;        // 段内离阈值最远的值
+    uint64_t samples;
+};
+
+struct TelemetryColumnStats {
+    uint64_t count;
+    double minValue;
+    double maxValue;
+    double mean;
+    std::vector<double> percentiles;    // 与请求的百分位一一对应（直方图插值估计）
+};
+
+// 降采样输出的一个时间桶，数组按请求的列排列
+struct TelemetryBucket {
+    int64_t startUs;
+    uint64_t count;
+    std::vector<double> minValues;
+    std::vector<double> maxValues;
+    std::vector<double> meanValues;
+};
+
+// 等间隔重采样结果：第 row 行为 [originUs + row * intervalUs, +intervalUs) 内的均值，无样本处为 NaN
+struct TelemetrySeries {
+    int64_t originUs = 0;
+    int64_t intervalUs = 0;
+    size_t rows = 0;
+    size_t columns = 0;
+    std::vector<double> values;     // 行优先
+
+    double at(size_t row, size_t column) const { return values[row * columns + column]; }
+    const double *row(size_t row) const { return &values[row * columns]; }
+};
+
+class TelemetryQueryEngine
+{
+public:
+    static const int HISTOGRAM_BINS = 16384;
+
+    struct ScanStatistics {
+        uint64_t blocksTotal;
+        uint64_t blocksScanned;
+        uint64_t samplesDecoded;
+    };
+
+    explicit TelemetryQueryEngine(int threadCount = 0);     // 0 为硬件线程数
+    ~TelemetryQueryEngine();
+
+    // 数据源：所有文件的关节数必须一致
+    bool addFile(const std::string &fileName, std::string *errorMessage = nullptr);
+    int addDirectory(const std::string &directory, std::string *errorMessage = nullptr);
+    size_t fileCount() const { return m_files.size(); }
+    int jointCount() const { return m_jointCount; }
+    int channelCount() const { return m_channelCount; }    // 所有文件共有的通道数
+    uint64_t sampleCount() const;
+    int64_t firstTimestampUs() const;
+    int64_t lastTimestampUs() const;
+
+    // 查询
+    std::vector<TelemetryEvent> findEvents(const TelemetryPredicate &predicate,
+                                           const TelemetryTimeRange &range = TelemetryTimeRange()) const;
+    std::vector<TelemetryColumnStats> aggregate(const std::vector<TelemetryColumnRef> &columns,
+                                                const TelemetryTimeRange &range = TelemetryTimeRange(),
+                                                const std::vector<double> &percentiles = std::vector<double>()) const;
+    std::vector<TelemetryBucket> downsample(const std::vector<TelemetryColumnRef> &columns,
+                                            const TelemetryTimeRange &range, int64_t bucketUs) const;
+    bool resample(const std::vector<TelemetryColumnRef> &columns, const TelemetryTimeRange &range,
+                  int64_t intervalUs, TelemetrySeries &series) const;
+
+    const ScanStatistics &lastScan() const { return m_lastScan; }
+    int threadCount() const { return m_threadCount; }
+
+private:
+    struct BlockRef {
+        const TelemetryFileReader *file;
+        size_t block;
+        int64_t firstUs;
+        int64_t lastUs;
+        size_t ordinal;     // 剪枝前按时间排序的序号，用于判断块是否相邻
+    };
+
+    std::vector<BlockRef> selectBlocks(const TelemetryTimeRange &range, const TelemetryPredicate *predicate) const;
+    int columnIndex(const TelemetryColumnRef &column) const;
+
+    // work(index, worker)：worker 为 [0, threadCount) 内的线程序号，用于访问线程私有的累加器
+    template <typename Work>
+    void parallelFor(size_t count, const Work &work) const;
+
+    std::vector<std::unique_ptr<TelemetryFileReader>> m_files;
+    int m_jointCount;
+    int m_channelCount;
+    int m_threadCount;
+    mutable ScanStatistics m_lastScan;
+};
+
+#endif // TELEMETRYQUERY_H
@@ -0,0 +1,656 @@
+// 遥测归档命令行工具
+//
+// telemetry_tool info  <文件或目录>...
+// telemetry_tool query <文件或目录>... [选项]
+//   --from TIME / --to TIME     时间范围（ISO 8601 UTC，如 2026-10-01T08:00:00）
+//   --last DURATION             最近一段时间（相对归档中最新的样本），如 7d、12h、30m
+//   --channel NAME              position（默认）、velocity、torque、target
+//   --joints LIST               参与统计/导出的关节，如 0,5,7 或 all
+//   --where COND                事件条件，如 5>170、torque:3<=-12
+//   --stats                     输出 min/max/mean
+//   --percentiles LIST          输出百分位，如 50,95,99
+//   --export FILE --bucket DUR  按时间桶降采样导出 CSV（min/max/mean）
+//   --threads N                 扫描线程数（默认硬件线程数）
+//
+// telemetry_tool diff <运行A> <运行B> [选项]
+//   --align steps|xcorr|start   对齐方式：程序步骤（默认）、互相关、起点
+//   --rate HZ                   重采样频率（默认 10）
+//   --a-from/--a-to/--b-from/--b-to TIME  分别截取两次运行的时间范围
+//   --joints LIST               报告和序列中包含的关节（默认全部）
+//   --max-lag DUR               互相关搜索范围（默认 60s）
+//   --idle-threshold V          静止判定阈值，所有关节速度之和（默认 1.0）
+//   --min-idle DUR              步骤之间的最短静止时间（默认 0.5s）
+//   --series FILE               导出对齐后的绘图序列（CSV）
+
+#include "telemetryquery.h"
+#include "telemetrydiff.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage()
+{
+    std::fprintf(stderr,
+        "用法:\n"
+        "  telemetry_tool info  <文件或目录>...\n"
+        "  telemetry_tool query <文件或目录>... [--from TIME] [--to TIME] [--last DUR]\n"
+        "                       [--channel position|velocity|torque|target] [--joints LIST|all]\n"
+        "                       [--where COND] [--stats] [--percentiles LIST]\n"
+        "                       [--export FILE --bucket DUR] [--threads N]\n"
+        "  telemetry_tool diff  <运行A> <运行B> [--align steps|xcorr|start] [--rate HZ]\n"
+        "                       [--a-from TIME] [--a-to TIME] [--b-from TIME] [--b-to TIME]\n"
+        "                       [--joints LIST] [--max-lag DUR] [--idle-threshold V]\n"
+        "                       [--min-idle DUR] [--series FILE] [--threads N]\n");
+}
+
+bool parseChannel(const std::string &name, TelemetryFileChannel &channel)
+{
+    if (name == "position" || name == "pos") {
+        channel = TelemetryFileChannel::Position;
+    } else if (name == "velocity" || name == "vel") {
+        channel = TelemetryFileChannel::Velocity;
+    } else if (name == "torque" || name == "tor") {
+        channel = TelemetryFileChannel::Torque;
+    } else if (name == "target" || name == "command") {
+        channel = TelemetryFileChannel::Target;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *channelName(TelemetryFileChannel channel)
+{
+    switch (channel) {
+    case TelemetryFileChannel::Position: return "position";
+    case TelemetryFileChannel::Velocity: return "velocity";
+    case TelemetryFileChannel::Torque:   return "torque";
+    case TelemetryFileChannel::Target:   return "target";
+    default:                             return "?";
+    }
+}
+
+// 时长：数字加单位 us/ms/s/m/h/d，省略单位按秒
+bool parseDuration(const std::string &text, int64_t &durationUs)
+{
+    char *end = nullptr;
+    const double value = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || value < 0) {
+        return false;
+    }
+
+    const std::string unit(end);
+    double scale;
+    if (unit == "us") {
+        scale = 1.0;
+    } else if (unit == "ms") {
+        scale = 1e3;
+    } else if (unit.empty() || unit == "s") {
+        scale = 1e6;
+    } else if (unit == "m" || unit == "min") {
+        scale = 60e6;
+    } else if (unit == "h") {
+        scale = 3600e6;
+    } else if (unit == "d") {
+        scale = 86400e6;
+    } else {
+        return false;
+    }
+    durationUs = static_cast<int64_t>(value * scale);
+    return true;
+}
+
+// ISO 8601（UTC）：YYYY-MM-DD[THH:MM[:SS[.ffffff]]][Z]
+bool parseTime(const std::string &text, int64_t &timestampUs)
+{
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0;
+    double second = 0.0;
+    const int fields = std::sscanf(text.c_str(), "%d-%d-%d%*[T ]%d:%d:%lf", &year, &month, &day, &hour, &minute, &second);
+    if (fields != 3 && fields < 5) {
+        return false;
+    }
+
+    std::tm tm = {};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+#ifdef _WIN32
+    const int64_t seconds = _mkgmtime(&tm);
+#else
+    const int64_t seconds = timegm(&tm);
+#endif
+    if (seconds == -1) {
+        return false;
+    }
+    timestampUs = seconds * 1000000 + static_cast<int64_t>(std::llround(second * 1e6));
+    return true;
+}
+
+std::string formatTime(int64_t timestampUs)
+{
+    const std::time_t seconds = static_cast<std::time_t>(timestampUs / 1000000);
+    std::tm tm = {};
+#ifdef _WIN32
+    gmtime_s(&tm, &seconds);
+#else
+    gmtime_r(&seconds, &tm);
+#endif
+    char text[48];
+    const size_t length = std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &tm);
+    std::snprintf(text + length, sizeof(text) - length, ".%03dZ", static_cast<int>(timestampUs % 1000000 / 1000));
+    return text;
+}
+
+bool parseList(const std::string &text, std::vector<double> &values)
+{
+    size_t start = 0;
+    while (start <= text.size()) {
+        const size_t comma = text.find(',', start);
+        const std::string item = text.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        char *end = nullptr;
+        const double value = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0') {
+            return false;
+        }
+        values.push_back(value);
+        if (comma == std::string::npos) {
+            break;
+        }
+        start = comma + 1;
+    }
+    return !values.empty();
+}
+
+// 条件：[channel:]joint op value，op 为 > >= < <=
+bool parseCondition(const std::string &text, TelemetryFileChannel defaultChannel, TelemetryPredicate &predicate)
+{
+    std::string rest = text;
+    predicate.column.channel = defaultChannel;
+    const size_t colon = rest.find(':');
+    if (colon != std::string::npos) {
+        if (!parseChannel(rest.substr(0, colon), predicate.column.channel)) {
+            return false;
+        }
+        rest = rest.substr(colon + 1);
+    }
+
+    const size_t op = rest.find_first_of("<>");
+    if (op == std::string::npos || op == 0) {
+        return false;
+    }
+    const bool orEqual = op + 1 < rest.size() && rest[op + 1] == '=';
+    if (rest[op] == '>') {
+        predicate.comparison = orEqual ? TelemetryPredicate::GreaterEqual : TelemetryPredicate::Greater;
+    } else {
+        predicate.comparison = orEqual ? TelemetryPredicate::LessEqual : TelemetryPredicate::Less;
+    }
+
+    char *end = nullptr;
+    const std::string joint = rest.substr(0, op);
+    predicate.column.joint = static_cast<int>(std::strtol(joint.c_str(), &end, 10));
+    if (*end != '\0') {
+        return false;
+    }
+
+    const std::string threshold = rest.substr(op + (orEqual ? 2 : 1));
+    predicate.threshold = std::strtod(threshold.c_str(), &end);
+    return !threshold.empty() && *end == '\0';
+}
+
+bool loadSources(TelemetryQueryEngine &engine, const std::vector<std::string> &paths)
+{
+    for (const std::string &path : paths) {
+        std::string error;
+        const bool ok = std::filesystem::is_directory(path)
+            ? engine.addDirectory(path, &error) >= 0
+            : engine.addFile(path, &error);
+        if (!ok) {
+            std::fprintf(stderr, "错误: %s\n", error.c_str());
+            return false;
+        }
+    }
+
+    if (engine.fileCount() == 0) {
+        std::fprintf(stderr, "错误: 没有找到 .rtlm 文件\n");
+        return false;
+    }
+    return true;
+}
+
+int runInfo(const std::vector<std::string> &paths)
+{
+    TelemetryQueryEngine engine;
+    if (!loadSources(engine, paths)) {
+        return 1;
+    }
+
+    std::printf("文件数: %zu\n关节数: %d\n样本数: %llu\n时间范围: %s ~ %s\n",
+                engine.fileCount(), engine.jointCount(),
+                static_cast<unsigned long long>(engine.sampleCount()),
+                formatTime(engine.firstTimestampUs()).c_str(), formatTime(engine.lastTimestampUs()).c_str());
+    return 0;
+}
+
+int runQuery(int argc, char *argv[])
+{
+    std::vector<std::string> paths;
+    TelemetryTimeRange range;
+    int64_t lastUs = -1;
+    TelemetryFileChannel channel = TelemetryFileChannel::Position;
+    std::vector<int> joints;
+    bool allJoints = false;
+    std::vector<std::string> conditions;
+    bool stats = false;
+    std::vector<double> percentiles;
+    std::string exportFile;
+    int64_t bucketUs = 0;
+    int threads = 0;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        bool ok = true;
+
+        if (arg == "--from" && hasValue) {
+            ok = parseTime(value, range.fromUs);
+            ++i;
+        } else if (arg == "--to" && hasValue) {
+            ok = parseTime(value, range.toUs);
+            ++i;
+        } else if (arg == "--last" && hasValue) {
+            ok = parseDuration(value, lastUs);
+            ++i;
+        } else if (arg == "--channel" && hasValue) {
+            ok = parseChannel(value, channel);
+            ++i;
+        } else if (arg == "--joints" && hasValue) {
+            std::vector<double> list;
+            allJoints = value == "all";
+            ok = allJoints || parseList(value, list);
+            for (double joint : list) {
+                joints.push_back(static_cast<int>(joint));
+            }
+            ++i;
+        } else if (arg == "--where" && hasValue) {
+            conditions.push_back(value);
+            ++i;
+        } else if (arg == "--stats") {
+            stats = true;
+        } else if (arg == "--percentiles" && hasValue) {
+            ok = parseList(value, percentiles);
+            stats = true;
+            ++i;
+        } else if (arg == "--export" && hasValue) {
+            exportFile = value;
+            ++i;
+        } else if (arg == "--bucket" && hasValue) {
+            ok = parseDuration(value, bucketUs) && bucketUs > 0;
+            ++i;
+        } else if (arg == "--threads" && hasValue) {
+            threads = std::atoi(value.c_str());
+            ++i;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            ok = false;
+        } else {
+            paths.push_back(arg);
+        }
+
+        if (!ok) {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+    }
+
+    if (paths.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    TelemetryQueryEngine engine(threads);
+    if (!loadSources(engine, paths)) {
+        return 1;
+    }
+
+    if (lastUs >= 0) {
+        range.fromUs = engine.lastTimestampUs() - lastUs;
+    }
+    if (allJoints) {
+        joints.clear();
+        for (int joint = 0; joint < engine.jointCount(); ++joint) {
+            joints.push_back(joint);
+        }
+    }
+
+    std::vector<TelemetryColumnRef> columns;
+    for (int joint : joints) {
+        if (joint < 0 || joint >= engine.jointCount()) {
+            std::fprintf(stderr, "关节编号超出范围: %d\n", joint);
+            return 2;
+        }
+        columns.push_back(TelemetryColumnRef(channel, joint));
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    auto reportScan = [&]() {
+        const TelemetryQueryEngine::ScanStatistics &scan = engine.lastScan();
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::fprintf(stderr, "  扫描 %llu/%llu 块，解码 %llu 个样本，用时 %.3f 秒\n",
+                     static_cast<unsigned long long>(scan.blocksScanned),
+                     static_cast<unsigned long long>(scan.blocksTotal),
+                     static_cast<unsigned long long>(scan.samplesDecoded), elapsed);
+    };
+
+    for (const std::string &condition : conditions) {
+        TelemetryPredicate predicate;
+        if (!parseCondition(condition, channel, predicate)
+            || predicate.column.joint < 0 || predicate.column.joint >= engine.jointCount()) {
+            std::fprintf(stderr, "无效条件: %s\n", condition.c_str());
+            return 2;
+        }
+
+        const std::vector<TelemetryEvent> events = engine.findEvents(predicate, range);
+        std::printf("条件 %s (%s)：%zu 段\n", condition.c_str(), channelName(predicate.column.channel), events.size());
+        std::printf("%-26s %-26s %12s %12s %10s\n", "开始", "结束", "持续(s)", "峰值", "样本数");
+        for (const TelemetryEvent &event : events) {
+            std::printf("%-26s %-26s %12.3f %12.4f %10llu\n",
+                        formatTime(event.startUs).c_str(), formatTime(event.endUs).c_str(),
+                        (event.endUs - event.startUs) / 1e6, event.peak,
+                        static_cast<unsigned long long>(event.samples));
+        }
+        reportScan();
+    }
+
+    if (stats && !columns.empty()) {
+        const std::vector<TelemetryColumnStats> results = engine.aggregate(columns, range, percentiles);
+        std::printf("%-8s %-9s %12s %12s %12s %12s", "关节", "通道", "样本数", "最小", "最大", "均值");
+        for (double percentile : percentiles) {
+            std::printf("       p%-5g", percentile);
+        }
+        std::printf("\n");
+        for (size_t c = 0; c < results.size(); ++c) {
+            const TelemetryColumnStats &result = results[c];
+            std::printf("%-8d %-9s %12llu %12.4f %12.4f %12.4f", columns[c].joint, channelName(channel),
+                        static_cast<unsigned long long>(result.count), result.minValue, result.maxValue, result.mean);
+            for (double value : result.percentiles) {
+                std::printf(" %12.4f", value);
+            }
+            std::printf("\n");
+        }
+        reportScan();
+    }
+
+    if (!exportFile.empty()) {
+        if (columns.empty() || bucketUs <= 0) {
+            std::fprintf(stderr, "导出需要 --joints 和 --bucket\n");
+            return 2;
+        }
+
+        std::FILE *file = std::fopen(exportFile.c_str(), "w");
+        if (!file) {
+            std::fprintf(stderr, "无法创建导出文件: %s\n", exportFile.c_str());
+            return 1;
+        }
+
+        const std::vector<TelemetryBucket> buckets = engine.downsample(columns, range, bucketUs);
+        std::fprintf(file, "time,samples");
+        for (const TelemetryColumnRef &column : columns) {
+            const char *name = channelName(channel);
+            std::fprintf(file, ",%s%d_min,%s%d_max,%s%d_mean", name, column.joint, name, column.joint, name, column.joint);
+        }
+        std::fprintf(file, "\n");
+        for (const TelemetryBucket &bucket : buckets) {
+            std::fprintf(file, "%s,%llu", formatTime(bucket.startUs).c_str(), static_cast<unsigned long long>(bucket.count));
+            for (size_t c = 0; c < columns.size(); ++c) {
+                std::fprintf(file, ",%.6g,%.6g,%.6g", bucket.minValues[c], bucket.maxValues[c], bucket.meanValues[c]);
+            }
+            std::fprintf(file, "\n");
+        }
+        std::fclose(file);
+        std::printf("已导出 %zu 个时间桶到 %s\n", buckets.size(), exportFile.c_str());
+        reportScan();
+    }
+
+    return 0;
+}
+
+bool loadRun(TelemetryQueryEngine &engine, const std::string &path, const TelemetryTimeRange &range,
+             int64_t intervalUs, TelemetrySeries &series, bool &hasTargets)
+{
+    if (!loadSources(engine, std::vector<std::string>(1, path))) {
+        return false;
+    }
+
+    hasTargets = engine.channelCount() > static_cast<int>(TelemetryFileChannel::Target);
+    std::vector<TelemetryColumnRef> columns;
+    for (int joint = 0; joint < engine.jointCount(); ++joint) {
+        columns.push_back(TelemetryColumnRef(TelemetryFileChannel::Position, joint));
+    }
+    for (int joint = 0; hasTargets && joint < engine.jointCount(); ++joint) {
+        columns.push_back(TelemetryColumnRef(TelemetryFileChannel::Target, joint));
+    }
+
+    if (!engine.resample(columns, range, intervalUs, series)) {
+        std::fprintf(stderr, "错误: %s 在指定范围内没有数据\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+const char *alignmentName(TelemetrySessionDiff::Alignment alignment)
+{
+    switch (alignment) {
+    case TelemetrySessionDiff::AlignStart:            return "起点";
+    case TelemetrySessionDiff::AlignCrossCorrelation: return "互相关";
+    case TelemetrySessionDiff::AlignSteps:            return "程序步骤";
+    }
+    return "?";
+}
+
+int runDiff(int argc, char *argv[])
+{
+    std::vector<std::string> paths;
+    TelemetryTimeRange rangeA;
+    TelemetryTimeRange rangeB;
+    TelemetrySessionDiff::Options options;
+    double rate = 10.0;
+    std::vector<int> joints;
+    std::string seriesFile;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        const std::string value = hasValue ? argv[i + 1] : std::string();
+        int64_t durationUs = 0;
+        bool ok = true;
+
+        if (arg == "--align" && hasValue) {
+            if (value == "steps") {
+                options.alignment = TelemetrySessionDiff::AlignSteps;
+            } else if (value == "xcorr") {
+                options.alignment = TelemetrySessionDiff::AlignCrossCorrelation;
+            } else if (value == "start") {
+                options.alignment = TelemetrySessionDiff::AlignStart;
+            } else {
+                ok = false;
+            }
+            ++i;
+        } else if (arg == "--rate" && hasValue) {
+            rate = std::atof(value.c_str());
+            ok = rate > 0.0 && rate <= 1000.0;
+            ++i;
+        } else if (arg == "--a-from" && hasValue) {
+            ok = parseTime(value, rangeA.fromUs);
+            ++i;
+        } else if (arg == "--a-to" && hasValue) {
+            ok = parseTime(value, rangeA.toUs);
+            ++i;
+        } else if (arg == "--b-from" && hasValue) {
+            ok = parseTime(value, rangeB.fromUs);
+            ++i;
+        } else if (arg == "--b-to" && hasValue) {
+            ok = parseTime(value, rangeB.toUs);
+            ++i;
+        } else if (arg == "--joints" && hasValue) {
+            std::vector<double> list;
+            ok = value == "all" || parseList(value, list);
+            for (double joint : list) {
+                joints.push_back(static_cast<int>(joint));
+            }
+            ++i;
+        } else if (arg == "--max-lag" && hasValue) {
+            ok = parseDuration(value, durationUs);
+            options.maxLagSeconds = durationUs / 1e6;
+            ++i;
+        } else if (arg == "--idle-threshold" && hasValue) {
+            options.idleThreshold = std::atof(value.c_str());
+            ++i;
+        } else if (arg == "--min-idle" && hasValue) {
+            ok = parseDuration(value, durationUs);
+            options.minIdleSeconds = durationUs / 1e6;
+            ++i;
+        } else if (arg == "--series" && hasValue) {
+            seriesFile = value;
+            ++i;
+        } else if (arg == "--threads" && hasValue) {
+            options.threadCount = std::atoi(value.c_str());
+            ++i;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            ok = false;
+        } else {
+            paths.push_back(arg);
+        }
+
+        if (!ok) {
+            std::fprintf(stderr, "无效参数: %s %s\n", arg.c_str(), value.c_str());
+            return 2;
+        }
+    }
+
+    if (paths.size() != 2) {
+        printUsage();
+        return 2;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    const int64_t intervalUs = static_cast<int64_t>(1e6 / rate);
+    TelemetryQueryEngine engineA(options.threadCount);
+    TelemetryQueryEngine engineB(options.threadCount);
+    TelemetrySeries seriesA;
+    TelemetrySeries seriesB;
+    bool targetsA = false;
+    bool targetsB = false;
+    if (!loadRun(engineA, paths[0], rangeA, intervalUs, seriesA, targetsA)
+        || !loadRun(engineB, paths[1], rangeB, intervalUs, seriesB, targetsB)) {
+        return 1;
+    }
+    if (engineA.jointCount() != engineB.jointCount()) {
+        std::fprintf(stderr, "错误: 两次运行的关节数不同 (%d / %d)\n", engineA.jointCount(), engineB.jointCount());
+        return 1;
+    }
+
+    const int jointCount = engineA.jointCount();
+    if (joints.empty()) {
+        for (int joint = 0; joint < jointCount; ++joint) {
+            joints.push_back(joint);
+        }
+    }
+    for (int joint : joints) {
+        if (joint < 0 || joint >= jointCount) {
+            std::fprintf(stderr, "关节编号超出范围: %d\n", joint);
+            return 2;
+        }
+    }
+
+    // 两边都有指令通道时才比较跟踪误差；否则只取前 jointCount 列
+    const bool hasTargets = targetsA && targetsB;
+    TelemetrySessionDiff diff(options);
+    std::string error;
+    if (!diff.compare(seriesA, seriesB, jointCount, hasTargets, &error)) {
+        std::fprintf(stderr, "错误: %s\n", error.c_str());
+        return 1;
+    }
+
+    const TelemetrySessionDiff::Report &report = diff.report();
+    std::printf("运行A: %s  %s  时长 %.1f s\n", paths[0].c_str(), formatTime(seriesA.originUs).c_str(), report.durationA);
+    std::printf("运行B: %s  %s  时长 %.1f s\n", paths[1].c_str(), formatTime(seriesB.originUs).c_str(), report.durationB);
+    std::printf("对齐: %s  偏移 %+.3f s", alignmentName(report.alignment), report.offsetSeconds);
+    if (!std::isnan(report.correlation)) {
+        std::printf("  相关系数 %.3f", report.correlation);
+    }
+    std::printf("\n步骤: A %zu / B %zu，配对 %zu", report.stepsA, report.stepsB, report.steps.size());
+    if (!std::isnan(report.meanCycleA)) {
+        std::printf("  平均节拍 A %.3f s / B %.3f s (%+.2f%%)  累计漂移 %+.3f s",
+                    report.meanCycleA, report.meanCycleB,
+                    (report.meanCycleB / report.meanCycleA - 1.0) * 100.0, report.drift);
+    }
+    std::printf("\n\n");
+
+    std::printf("%-6s %12s %12s %12s %12s %12s\n", "关节", "RMS偏差", "最大偏差", "位置(s)", "跟踪误差A", "跟踪误差B");
+    for (int joint : joints) {
+        const TelemetrySessionDiff::JointReport &item = report.joints[joint];
+        std::printf("%-6d %12.4f %12.4f %12.1f %12.4f %12.4f\n", joint, item.rmsDeviation, item.maxDeviation,
+                    item.maxDeviationTime, item.trackingRmsA, item.trackingRmsB);
+    }
+
+    // 节拍变化最大的几个步骤
+    std::vector<TelemetrySessionDiff::Step> steps = report.steps;
+    if (steps.size() > 1) {
+        steps.pop_back();
+        std::sort(steps.begin(), steps.end(), [](const TelemetrySessionDiff::Step &x, const TelemetrySessionDiff::Step &y) {
+            return std::fabs(x.durationB - x.durationA) > std::fabs(y.durationB - y.durationA);
+        });
+        std::printf("\n%-12s %12s %12s %12s\n", "步骤起点A(s)", "时长A", "时长B", "差值");
+        for (size_t k = 0; k < steps.size() && k < 10; ++k) {
+            std::printf("%-12.1f %12.3f %12.3f %+12.3f\n", steps[k].startA, steps[k].durationA,
+                        steps[k].durationB, steps[k].durationB - steps[k].durationA);
+        }
+    }
+
+    if (!seriesFile.empty()) {
+        if (!diff.writeSeries(seriesFile, joints, &error)) {
+            std::fprintf(stderr, "错误: %s\n", error.c_str());
+            return 1;
+        }
+        std::printf("\n对齐序列已导出到 %s\n", seriesFile.c_str());
+    }
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::fprintf(stderr, "  用时 %.3f 秒\n", elapsed);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        printUsage();
+        return 2;
+    }
+
+    const std::string command = argv[1];
+    if (command == "info") {
+        return runInfo(std::vector<std::string>(argv + 2, argv + argc));
+    }
+    if (command == "query") {
+        return runQuery(argc, argv);
+    }
+    if (command == "diff") {
+        return runDiff(argc, argv);
+    }
+
+    printUsage();
+    return 2;
+}
@@ -0,0 +1,307 @@
+#include "trajectory.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+MotionProfile::MotionProfile()
+    : m_start(0.0)
+    , m_goal(0.0)
+    , m_direction(1.0)
+    , m_peakVelocity(0.0)
+{
+    for (int i = 0; i < SEGMENTS; ++i) {
+        m_segmentEnd[i] = 0.0;
+        m_jerk[i] = 0.0;
+        m_p0[i] = 0.0;
+        m_v0[i] = 0.0;
+        m_a0[i] = 0.0;
+    }
+}
+
+bool MotionProfile::plan(double start, double goal, const MotionLimits &limits)
+{
+    *this = MotionProfile();
+    m_start = start;
+    m_goal = goal;
+    m_direction = goal >= start ? 1.0 : -1.0;
+
+    if (!(limits.maxVelocity > 0.0) || !(limits.maxAcceleration > 0.0)) {
+        return false;
+    }
+
+    const double distance = std::fabs(goal - start);
+    if (distance == 0.0) {
+        return true;
+    }
+
+    const bool jerkLimited = limits.maxJerk > 0.0;
+    const double jerk = limits.maxJerk;
+
+    // 以最大速度巡航时的加速段：速度不够高时加速度到不了上限
+    double accel = limits.maxAcceleration;
+    if (jerkLimited && limits.maxVelocity * jerk < accel * accel) {
+        accel = std::sqrt(limits.maxVelocity * jerk);
+    }
+    double jerkTime = jerkLimited ? accel / jerk : 0.0;
+    double velocity = limits.maxVelocity;
+    double constAccelTime = velocity / accel - jerkTime;
+    double cruiseTime = 0.0;
+
+    // 对称加减速，每段位移为 v * Ta / 2
+    const double rampDistance = velocity * (2.0 * jerkTime + constAccelTime);
+    if (rampDistance <= distance) {
+        cruiseTime = (distance - rampDistance) / velocity;
+    } else {
+        // 距离太短到不了最大速度：先尝试仍有匀加速段，否则连加速度上限也到不了
+        accel = limits.maxAcceleration;
+        jerkTime = jerkLimited ? accel / jerk : 0.0;
+        velocity = 0.5 * accel * (-jerkTime + std::sqrt(jerkTime * jerkTime + 4.0 * distance / accel));
+        constAccelTime = velocity / accel - jerkTime;
+        if (constAccelTime < 0.0) {
+            accel = std::cbrt(0.5 * distance * jerk * jerk);
+            jerkTime = accel / jerk;
+            velocity = accel * jerkTime;
+            constAccelTime = 0.0;
+        }
+    }
+    m_peakVelocity = velocity;
+
+    const double durations[SEGMENTS] = {
+        jerkTime, constAccelTime, jerkTime, cruiseTime, jerkTime, constAccelTime, jerkTime
+    };
+    const double peakJerk = jerkTime > 0.0 ? accel / jerkTime : 0.0;
+    const double jerks[SEGMENTS] = { peakJerk, 0.0, -peakJerk, 0.0, -peakJerk, 0.0, peakJerk };
+    // 梯形曲线各段时长为零的加加速段由这里的加速度跳变代替
+    const double accels[SEGMENTS] = { 0.0, accel, accel, 0.0, 0.0, -accel, -accel };
+
+    double t = 0.0;
+    double p = 0.0;
+    double v = 0.0;
+    for (int i = 0; i < SEGMENTS; ++i) {
+        const double d = durations[i];
+        const double a = accels[i];
+        const double j = jerks[i];
+        m_p0[i] = p;
+        m_v0[i] = v;
+        m_a0[i] = a;
+        m_jerk[i] = j;
+        p += d * (v + d * (a / 2.0 + d * j / 6.0));
+        v += d * (a + d * j / 2.0);
+        t += d;
+        m_segmentEnd[i] = t;
+    }
+    return true;
+}
+
+int MotionProfile::segmentAt(double t) const
+{
+    int segment = 0;
+    while (segment < SEGMENTS - 1 && t >= m_segmentEnd[segment]) {
+        ++segment;
+    }
+    return segment;
+}
+
+double MotionProfile::position(double t) const
+{
+    if (t <= 0.0) {
+        return m_start;
+    }
+    if (t >= duration()) {
+        return m_goal;
+    }
+
+    const int i = segmentAt(t);
+    const double tau = t - (i > 0 ? m_segmentEnd[i - 1] : 0.0);
+    const double s = m_p0[i] + tau * (m_v0[i] + tau * (m_a0[i] / 2.0 + tau * m_jerk[i] / 6.0));
+    return m_start + m_direction * s;
+}
+
+void MotionProfile::sample(double t, double *position, double *velocity, double *acceleration) const
+{
+    double s = 0.0;
+    double v = 0.0;
+    double a = 0.0;
+    if (t >= duration()) {
+        s = std::fabs(m_goal - m_start);
+    } else if (t > 0.0) {
+        const int i = segmentAt(t);
+        const double tau = t - (i > 0 ? m_segmentEnd[i - 1] : 0.0);
+        s = m_p0[i] + tau * (m_v0[i] + tau * (m_a0[i] / 2.0 + tau * m_jerk[i] / 6.0));
+        v = m_v0[i] + tau * (m_a0[i] + tau * m_jerk[i] / 2.0);
+        a = m_a0[i] + tau * m_jerk[i];
+    }
+
+    if (position) {
+        *position = t >= duration() ? m_goal : m_start + m_direction * s;
+    }
+    if (velocity) {
+        *velocity = m_direction * v;
+    }
+    if (acceleration) {
+        *acceleration = m_direction * a;
+    }
+}
+
+JointTrajectory::JointTrajectory()
+    : m_jointCount(0)
+    , m_synchronized(false)
+    , m_moveMask(0)
+    , m_duration(0.0)
+    , m_rate(0.0)
+    , m_sampleCount(0)
+{
+}
+
+bool JointTrajectory::plan(const double *start, const double *goal, const MotionLimits *limits, int jointCount,
+                           uint64_t moveMask)
+{
+    clear();
+    m_profiles.resize(size_t(jointCount));
+    m_start.assign(start, start + jointCount);
+    m_delta.assign(size_t(jointCount), 0.0);
+
+    for (int i = 0; i < jointCount; ++i) {
+        const bool moving = i < 64 && ((moveMask >> i) & 1u);
+        if (!m_profiles[size_t(i)].plan(start[i], moving ? goal[i] : start[i], limits[i])) {
+            clear();
+            return false;
+        }
+        m_delta[size_t(i)] = m_profiles[size_t(i)].goal() - start[i];
+        m_duration = std::max(m_duration, m_profiles[size_t(i)].duration());
+    }
+
+    m_jointCount = jointCount;
+    m_moveMask = moveMask;
+    return true;
+}
+
+bool JointTrajectory::planSynchronized(const double *start, const double *goal, const MotionLimits *limits,
+                                       int jointCount, uint64_t moveMask)
+{
+    clear();
+    m_start.assign(start, start + jointCount);
+    m_delta.assign(size_t(jointCount), 0.0);
+
+    // 各关节按位移归一化后的限制取最小值；不运动的关节比值为无穷大，
+    // 循环没有分支依赖，编译器可以按 SIMD 宽度展开
+    const double inf = std::numeric_limits<double>::infinity();
+    double pathVelocity = inf;
+    double pathAcceleration = inf;
+    double pathJerk = inf;
+    for (int i = 0; i < jointCount; ++i) {
+        const bool moving = i < 64 && ((moveMask >> i) & 1u);
+        const double delta = moving ? goal[i] - start[i] : 0.0;
+        const double inverse = delta != 0.0 ? 1.0 / std::fabs(delta) : inf;
+        m_delta[size_t(i)] = delta;
+        if (!(limits[i].maxVelocity > 0.0) || !(limits[i].maxAcceleration > 0.0)) {
+            return false;
+        }
+        pathVelocity = std::min(pathVelocity, limits[i].maxVelocity * inverse);
+        pathAcceleration = std::min(pathAcceleration, limits[i].maxAcceleration * inverse);
+        pathJerk = std::min(pathJerk, limits[i].maxJerk > 0.0 ? limits[i].maxJerk * inverse : inf);
+    }
+
+    m_jointCount = jointCount;
+    m_synchronized = true;
+    m_moveMask = moveMask;
+
+    if (pathVelocity == inf) {
+        // 没有关节需要运动
+        m_path = MotionProfile();
+        return true;
+    }
+
+    // 只有所有运动关节都不限加加速度时才按梯形规划
+    const MotionLimits pathLimits(pathVelocity, pathAcceleration, pathJerk < inf ? pathJerk : 0.0);
+    if (!m_path.plan(0.0, 1.0, pathLimits)) {
+        clear();
+        return false;
+    }
+    m_duration = m_path.duration();
+    return true;
+}
+
+void JointTrajectory::clear()
+{
+    m_jointCount = 0;
+    m_synchronized = false;
+    m_moveMask = 0;
+    m_duration = 0.0;
+    m_rate = 0.0;
+    m_sampleCount = 0;
+    m_profiles.clear();
+    m_path = MotionProfile();
+    m_start.clear();
+    m_delta.clear();
+    m_setpoints.clear();
+}
+
+void JointTrajectory::render(double rateHz)
+{
+    m_rate = rateHz;
+    m_sampleCount = static_cast<int>(std::ceil(m_duration * rateHz)) + 1;
+    m_setpoints.resize(size_t(m_sampleCount) * size_t(m_jointCount));
+
+    const double step = 1.0 / rateHz;
+    if (m_synchronized) {
+        // 每个采样点只求一次路径参数，各关节为 start + delta * s（可向量化的乘加）
+        const double *start = m_start.data();
+        const double *delta = m_delta.data();
+        for (int s = 0; s < m_sampleCount; ++s) {
+            const double u = s + 1 < m_sampleCount ? m_path.position(s * step) : 1.0;
+            double *row = m_setpoints.data() + size_t(s) * m_jointCount;
+            for (int j = 0; j < m_jointCount; ++j) {
+                row[j] = start[j] + delta[j] * u;
+            }
+        }
+        return;
+    }
+
+    // 关节到位后的采样直接填终点
+    for (int j = 0; j < m_jointCount; ++j) {
+        const MotionProfile &profile = m_profiles[size_t(j)];
+        double *out = m_setpoints.data() + j;
+        const int moving = std::min(m_sampleCount, static_cast<int>(std::ceil(profile.duration() * rateHz)));
+        for (int s = 0; s < moving; ++s) {
+            out[size_t(s) * m_jointCount] = profile.position(s * step);
+        }
+        for (int s = moving; s < m_sampleCount; ++s) {
+            out[size_t(s) * m_jointCount] = profile.goal();
+        }
+    }
+}
+
+void JointTrajectory::carryOver(const JointTrajectory &previous, int fromSample, uint64_t carryMask)
+{
+    if (carryMask == 0 || previous.m_jointCount != m_jointCount || previous.m_sampleCount == 0
+        || m_sampleCount == 0 || previous.m_rate != m_rate) {
+        return;
+    }
+    fromSample = std::max(0, std::min(fromSample, previous.m_sampleCount - 1));
+
+    // 采样点数与 render 一致地由时长决定；延长部分先复制最后一行，新规划的关节停在终点
+    m_duration = std::max(m_duration, previous.m_duration - fromSample / m_rate);
+    const int sampleCount = static_cast<int>(std::ceil(m_duration * m_rate)) + 1;
+    if (sampleCount > m_sampleCount) {
+        m_setpoints.resize(size_t(sampleCount) * size_t(m_jointCount));
+        const double *last = m_setpoints.data() + size_t(m_sampleCount - 1) * m_jointCount;
+        for (int s = m_sampleCount; s < sampleCount; ++s) {
+            std::copy(last, last + m_jointCount, m_setpoints.data() + size_t(s) * m_jointCount);
+        }
+        m_sampleCount = sampleCount;
+    }
+
+    for (int j = 0; j < m_jointCount; ++j) {
+        if (!(j < 64 && ((carryMask >> j) & 1u))) {
+            continue;
+        }
+        for (int s = 0; s < m_sampleCount; ++s) {
+            const int source = std::min(fromSample + s, previous.m_sampleCount - 1);
+            m_setpoints[size_t(s) * m_jointCount + j] = previous.setpoints(source)[j];
+        }
+        m_start[size_t(j)] = previous.setpoints(fromSample)[j];
+        m_delta[size_t(j)] = previous.goal(j) - m_start[size_t(j)];
+    }
+    m_moveMask |= carryMask;
+}
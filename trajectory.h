@@ -0,0 +1,103 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 单关节运动限制（单位与关节单位一致，时间为秒）
+struct MotionLimits {
+    double maxVelocity;
+    double maxAcceleration;
+    double maxJerk;         // <= 0 表示不限加加速度（梯形速度曲线）
+
+    MotionLimits(double velocity = 90.0, double acceleration = 360.0, double jerk = 1800.0)
+        : maxVelocity(velocity), maxAcceleration(acceleration), maxJerk(jerk) {}
+};
+
+// 单关节点到点运动曲线：静止到静止的七段S曲线（加加速度受限），
+// maxJerk <= 0 时退化为三段梯形曲线。规划为闭式解，只计算各段的时长和起点状态。
+class MotionProfile
+{
+public:
+    static const int SEGMENTS = 7;  // 加加速、匀加速、减加速、匀速、加减速、匀减速、减减速
+
+    MotionProfile();
+
+    // 限制无效（速度或加速度不为正）时返回 false
+    bool plan(double start, double goal, const MotionLimits &limits);
+
+    double start() const { return m_start; }
+    double goal() const { return m_goal; }
+    double duration() const { return m_segmentEnd[SEGMENTS - 1]; }
+    double peakVelocity() const { return m_peakVelocity; }
+
+    // t 在 [0, duration()] 之外时取起点或终点
+    double position(double t) const;
+    void sample(double t, double *position, double *velocity, double *acceleration) const;
+
+private:
+    int segmentAt(double t) const;
+
+    double m_start;
+    double m_goal;
+    double m_direction;
+    double m_peakVelocity;
+    double m_segmentEnd[SEGMENTS];  // 各段结束时刻
+    double m_jerk[SEGMENTS];
+    double m_p0[SEGMENTS];          // 各段起点的位移、速度、加速度（相对起点，沿运动方向）
+    double m_v0[SEGMENTS];
+    double m_a0[SEGMENTS];
+};
+
+// 多关节轨迹，按控制频率预先算出设定点缓冲
+// 独立模式下每个关节一条曲线，各自到位；同步模式下所有关节共用一条 0→1 的路径参数曲线，
+// 同时起止并沿关节空间直线运动。
+class JointTrajectory
+{
+public:
+    JointTrajectory();
+
+    // 独立模式：只规划 moveMask 中的关节，其余关节保持 start
+    bool plan(const double *start, const double *goal, const MotionLimits *limits, int jointCount,
+              uint64_t moveMask);
+    // 同步模式：路径参数的速度、加速度、加加速度限制取各关节 限制/位移 的最小值，
+    // 即由最受限的关节决定时长，其余关节按比例放慢
+    bool planSynchronized(const double *start, const double *goal, const MotionLimits *limits, int jointCount,
+                          uint64_t moveMask);
+    void clear();
+
+    bool isEmpty() const { return m_jointCount == 0; }
+    bool isSynchronized() const { return m_synchronized; }
+    int jointCount() const { return m_jointCount; }
+    uint64_t moveMask() const { return m_moveMask; }
+    double duration() const { return m_duration; }
+    double goal(int joint) const { return m_start[joint] + m_delta[joint]; }
+    const MotionProfile &profile(int joint) const { return m_profiles[joint]; }     // 仅独立模式
+    const MotionProfile &path() const { return m_path; }                            // 仅同步模式
+
+    // 设定点缓冲（行优先：第 i 个采样点的全部关节），最后一行为终点
+    void render(double rateHz);
+    // render 之后调用：carryMask 中的关节改为沿 previous 从第 fromSample 个采样点起的剩余设定点继续
+    // （须为同一采样频率），不重新规划，运动中的关节速度、加速度保持连续；previous 剩余时间更长时
+    // 延长缓冲，其余关节在延长部分停在终点。这些关节的 profile() 不再对应实际设定点
+    void carryOver(const JointTrajectory &previous, int fromSample, uint64_t carryMask);
+    double rate() const { return m_rate; }
+    int sampleCount() const { return m_sampleCount; }
+    const double *setpoints(int sample) const { return m_setpoints.data() + size_t(sample) * m_jointCount; }
+
+private:
+    int m_jointCount;
+    bool m_synchronized;
+    uint64_t m_moveMask;
+    double m_duration;
+    double m_rate;
+    int m_sampleCount;
+    std::vector<MotionProfile> m_profiles;
+    MotionProfile m_path;
+    std::vector<double> m_start;
+    std::vector<double> m_delta;        // 终点 - 起点，不运动的关节为 0
+    std::vector<double> m_setpoints;
+};
+
+#endif // TRAJECTORY_H
@@ -0,0 +1,456 @@
+#include "wholebodyik.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double LIMIT_FADE = 20.0;    // 残差小于 20 倍位置容差时开始减弱次任务（与单臂逆解一致）
+const double MIN_MANIPULABILITY = 1e-12;
+
+// n x n 对称正定矩阵（n <= 12）的 Cholesky 分解，失败返回 false
+bool cholesky(const double *a, int n, double *l)
+{
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = a[i * n + j];
+            for (int k = 0; k < j; ++k) {
+                sum -= l[i * n + k] * l[j * n + k];
+            }
+            if (i == j) {
+                if (!(sum > 0.0)) {
+                    return false;
+                }
+                l[i * n + i] = std::sqrt(sum);
+            } else {
+                l[i * n + j] = sum / l[j * n + j];
+            }
+        }
+    }
+    return true;
+}
+
+void choleskySolve(const double *l, int n, double *b)
+{
+    for (int i = 0; i < n; ++i) {
+        double sum = b[i];
+        for (int k = 0; k < i; ++k) {
+            sum -= l[i * n + k] * b[k];
+        }
+        b[i] = sum / l[i * n + i];
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        double sum = b[i];
+        for (int k = i + 1; k < n; ++k) {
+            sum -= l[k * n + i] * b[k];
+        }
+        b[i] = sum / l[i * n + i];
+    }
+}
+
+} // namespace
+
+WholeBodySolver::WholeBodySolver()
+    : m_model(nullptr)
+    , m_trunkCount(0)
+    , m_armCount{ 0, 0 }
+    , m_jointCount(0)
+{
+}
+
+bool WholeBodySolver::configure(const KinematicModel *model, const double *minLimits, const double *maxLimits)
+{
+    m_model = nullptr;
+    m_jointCount = 0;
+    const KinematicModel::ChainId chains[3] = { KinematicModel::Trunk, KinematicModel::LeftArm,
+                                                KinematicModel::RightArm };
+    if (model->jointCount() > MAX_MODEL_JOINTS) {
+        return false;
+    }
+    for (KinematicModel::ChainId id : chains) {
+        const std::vector<KinematicJoint> &joints = model->chain(id).joints;
+        if (joints.size() > size_t(ArmIkSolver::MAX_CHAIN_JOINTS)) {
+            return false;
+        }
+        if (id == KinematicModel::Trunk) {
+            m_trunkCount = int(joints.size());
+        } else {
+            m_armCount[id == KinematicModel::LeftArm ? 0 : 1] = int(joints.size());
+        }
+        for (const KinematicJoint &joint : joints) {
+            m_jointIds[m_jointCount] = joint.jointId;
+            m_scale[m_jointCount] = joint.scale;
+            m_lower[m_jointCount] = minLimits[joint.jointId] * joint.scale;
+            m_upper[m_jointCount] = maxLimits[joint.jointId] * joint.scale;
+            ++m_jointCount;
+        }
+    }
+    if (m_armCount[0] == 0 && m_armCount[1] == 0) {
+        m_jointCount = 0;
+        return false;
+    }
+    m_model = model;
+    return true;
+}
+
+int WholeBodySolver::column(int arm, int chainColumn) const
+{
+    if (chainColumn < m_trunkCount) {
+        return chainColumn;
+    }
+    return chainColumn + (arm == 1 ? m_armCount[0] : 0);
+}
+
+int WholeBodySolver::stackedJacobian(const double *q, const WholeBodyTask *tasks, double *jacobian,
+                                     Transform *poses) const
+{
+    const int n = m_jointCount;
+    double armJacobian[6 * 2 * ArmIkSolver::MAX_CHAIN_JOINTS];
+    int rows = 0;
+    for (int arm = 0; arm < 2; ++arm) {
+        if (!tasks[arm].active || m_armCount[arm] == 0) {
+            continue;
+        }
+        const KinematicModel::ChainId id = arm == 0 ? KinematicModel::LeftArm : KinematicModel::RightArm;
+        poses[arm] = m_model->wholeBodyJacobian(id, q, armJacobian);
+        const int width = m_trunkCount + m_armCount[arm];
+        std::fill(jacobian + rows * n, jacobian + (rows + 6) * n, 0.0);
+        for (int c = 0; c < width; ++c) {
+            const int target = column(arm, c);
+            const double inverseScale = 1.0 / m_scale[target];
+            for (int r = 0; r < 6; ++r) {
+                jacobian[(rows + r) * n + target] = armJacobian[r * width + c] * inverseScale;
+            }
+        }
+        rows += 6;
+    }
+    return rows;
+}
+
+double WholeBodySolver::armManipulability(const double *q, int arm) const
+{
+    const KinematicModel::ChainId id = arm == 0 ? KinematicModel::LeftArm : KinematicModel::RightArm;
+    const int width = m_trunkCount + m_armCount[arm];
+    double jacobian[6 * 2 * ArmIkSolver::MAX_CHAIN_JOINTS];
+    m_model->wholeBodyJacobian(id, q, jacobian);
+    for (int c = 0; c < width; ++c) {
+        const double inverseScale = 1.0 / m_scale[column(arm, c)];
+        for (int r = 0; r < 6; ++r) {
+            jacobian[r * width + c] *= inverseScale;
+        }
+    }
+
+    // sqrt(det(J J^T)) 即 Cholesky 对角元之积
+    double a[36];
+    for (int i = 0; i < 6; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = 0.0;
+            for (int c = 0; c < width; ++c) {
+                sum += jacobian[i * width + c] * jacobian[j * width + c];
+            }
+            a[i * 6 + j] = sum;
+            a[j * 6 + i] = sum;
+        }
+    }
+    double l[36];
+    if (!cholesky(a, 6, l)) {
+        return 0.0;
+    }
+    double manipulability = 1.0;
+    for (int i = 0; i < 6; ++i) {
+        manipulability *= l[i * 6 + i];
+    }
+    return manipulability;
+}
+
+void WholeBodySolver::secondaryVelocities(double *q, const WholeBodyTask *tasks, const WholeBodyOptions &options,
+                                          double *z) const
+{
+    // 关节居中：向行程中点回退，速率与偏离量成正比
+    for (int c = 0; c < m_jointCount; ++c) {
+        const double x = q[m_jointIds[c]] * m_scale[c];
+        z[c] = -options.centeringGain * (x - 0.5 * (m_lower[c] + m_upper[c]));
+    }
+    if (options.manipulabilityGain <= 0.0) {
+        return;
+    }
+
+    // 可操作度：对数可操作度的前向差分梯度，躯干关节累加两臂的梯度
+    for (int arm = 0; arm < 2; ++arm) {
+        if (!tasks[arm].active || m_armCount[arm] == 0) {
+            continue;
+        }
+        const double base = std::log(std::max(MIN_MANIPULABILITY, armManipulability(q, arm)));
+        const int width = m_trunkCount + m_armCount[arm];
+        for (int c = 0; c < width; ++c) {
+            const int target = column(arm, c);
+            double &value = q[m_jointIds[target]];
+            const double saved = value;
+            value += options.gradientStep / m_scale[target];
+            const double shifted = std::log(std::max(MIN_MANIPULABILITY, armManipulability(q, arm)));
+            value = saved;
+            z[target] += options.manipulabilityGain * (shifted - base) / options.gradientStep;
+        }
+    }
+}
+
+bool WholeBodySolver::resolve(const double *jacobian, int rows, const double *weights, const double *v,
+                              const double *z, double lambda2, double *dq) const
+{
+    const int n = m_jointCount;
+    double a[MAX_ROWS * MAX_ROWS];
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = 0.0;
+            for (int c = 0; c < n; ++c) {
+                sum += jacobian[i * n + c] * weights[c] * jacobian[j * n + c];
+            }
+            a[i * rows + j] = sum;
+            a[j * rows + i] = sum;
+        }
+        a[i * rows + i] += lambda2;
+    }
+    double l[MAX_ROWS * MAX_ROWS];
+    if (!cholesky(a, rows, l)) {
+        return false;
+    }
+
+    // 次任务先按权重缩放，主任务只补偿它在末端产生的速度
+    double wz[MAX_JOINTS];
+    double y[MAX_ROWS];
+    for (int c = 0; c < n; ++c) {
+        wz[c] = weights[c] * z[c];
+    }
+    for (int r = 0; r < rows; ++r) {
+        double sum = 0.0;
+        for (int c = 0; c < n; ++c) {
+            sum += jacobian[r * n + c] * wz[c];
+        }
+        y[r] = v[r] - sum;
+    }
+    choleskySolve(l, rows, y);
+    for (int c = 0; c < n; ++c) {
+        double sum = 0.0;
+        for (int r = 0; r < rows; ++r) {
+            sum += jacobian[r * n + c] * y[r];
+        }
+        dq[c] = wz[c] + weights[c] * sum;
+    }
+    return true;
+}
+
+WholeBodyResult WholeBodySolver::velocities(const double *q, const WholeBodyTask *tasks,
+                                            const double *maxVelocities, double *velocities,
+                                            const WholeBodyOptions &options, const JogOptions &jogOptions) const
+{
+    WholeBodyResult result;
+    if (!m_model) {
+        return result;
+    }
+
+    const int n = m_jointCount;
+    double state[MAX_MODEL_JOINTS];
+    std::copy(q, q + m_model->jointCount(), state);
+    double jacobian[MAX_ROWS * MAX_JOINTS];
+    Transform poses[2];
+    const int rows = stackedJacobian(state, tasks, jacobian, poses);
+    if (rows == 0) {
+        return result;
+    }
+
+    // 工具坐标系下的旋量转到基坐标系
+    double v[MAX_ROWS];
+    int row = 0;
+    for (int arm = 0; arm < 2; ++arm) {
+        if (!tasks[arm].active || m_armCount[arm] == 0) {
+            continue;
+        }
+        const Transform &pose = poses[arm];
+        const double *twist = tasks[arm].twist;
+        for (int k = 0; k < 6; k += 3) {
+            for (int i = 0; i < 3; ++i) {
+                v[row + k + i] = tasks[arm].toolFrame
+                    ? pose.r[i * 3] * twist[k] + pose.r[i * 3 + 1] * twist[k + 1] + pose.r[i * 3 + 2] * twist[k + 2]
+                    : twist[k + i];
+            }
+        }
+        row += 6;
+    }
+
+    // 权重：躯干按 trunkWeight，不参与任务的手臂为 0；朝正、负方向的允许速度在限位区间内线性减小
+    double weights[MAX_JOINTS];
+    double upperSpeed[MAX_JOINTS];
+    double lowerSpeed[MAX_JOINTS];
+    double speed[MAX_JOINTS];
+    for (int c = 0; c < n; ++c) {
+        const int arm = c < m_trunkCount ? -1 : (c < m_trunkCount + m_armCount[0] ? 0 : 1);
+        weights[c] = arm < 0 ? options.trunkWeight : (tasks[arm].active ? 1.0 : 0.0);
+        const double x = state[m_jointIds[c]] * m_scale[c];
+        speed[c] = std::fabs(maxVelocities[m_jointIds[c]] * m_scale[c]);
+        upperSpeed[c] = speed[c] * std::max(0.0, std::min(1.0, (m_upper[c] - x) / jogOptions.limitZone));
+        lowerSpeed[c] = speed[c] * std::max(0.0, std::min(1.0, (x - m_lower[c]) / jogOptions.limitZone));
+    }
+
+    // 阻尼取两臂中较大的：可操作度低于阈值时 λ² = λmax² (1 - (w/w0)²)
+    double lambda2 = 0.0;
+    for (int arm = 0; arm < 2; ++arm) {
+        if (!tasks[arm].active || m_armCount[arm] == 0) {
+            continue;
+        }
+        result.manipulability[arm] = armManipulability(state, arm);
+        const double ratio = result.manipulability[arm] / jogOptions.manipulabilityThreshold;
+        if (ratio < 1.0) {
+            lambda2 = std::max(lambda2, jogOptions.maxDamping * jogOptions.maxDamping * (1.0 - ratio * ratio));
+        }
+    }
+    lambda2 = std::max(lambda2, 1e-12);
+
+    double z[MAX_JOINTS];
+    secondaryVelocities(state, tasks, options, z);
+    double dq[MAX_JOINTS];
+    if (!resolve(jacobian, rows, weights, v, z, lambda2, dq)) {
+        return result;
+    }
+
+    // 朝限位运动的关节按剩余允许速度降低权重后重解，让其余冗余关节接替
+    for (int c = 0; c < n; ++c) {
+        const double allowed = dq[c] > 0.0 ? upperSpeed[c] : lowerSpeed[c];
+        if (weights[c] > 0.0 && dq[c] != 0.0 && allowed < speed[c]) {
+            weights[c] *= speed[c] > 0.0 ? allowed / speed[c] : 0.0;
+            result.limited = true;
+        }
+    }
+    if (result.limited && !resolve(jacobian, rows, weights, v, z, lambda2, dq)) {
+        return result;
+    }
+
+    // 整体缩放，保证每个关节都不超过允许速度
+    double scale = 1.0;
+    for (int c = 0; c < n; ++c) {
+        const double allowed = dq[c] > 0.0 ? upperSpeed[c] : lowerSpeed[c];
+        if (std::fabs(dq[c]) > allowed) {
+            scale = std::min(scale, allowed / std::fabs(dq[c]));
+        }
+    }
+    for (int c = 0; c < n; ++c) {
+        const int arm = c < m_trunkCount ? -1 : (c < m_trunkCount + m_armCount[0] ? 0 : 1);
+        if (arm < 0 || tasks[arm].active) {
+            velocities[m_jointIds[c]] = dq[c] * scale / m_scale[c];
+        }
+    }
+    result.scale = scale;
+    return result;
+}
+
+IkResult WholeBodySolver::solve(const WholeBodyTask *tasks, const double *seed, double *solution,
+                                const WholeBodyOptions &options, const IkOptions &ikOptions) const
+{
+    IkResult result;
+    if (!m_model) {
+        return result;
+    }
+    if (solution != seed) {
+        std::copy(seed, seed + m_model->jointCount(), solution);
+    }
+
+    const int n = m_jointCount;
+    double x[MAX_JOINTS];               // 关节值（弧度/米）
+    double best[MAX_JOINTS];
+    double weights[MAX_JOINTS];
+    for (int c = 0; c < n; ++c) {
+        const int arm = c < m_trunkCount ? -1 : (c < m_trunkCount + m_armCount[0] ? 0 : 1);
+        weights[c] = arm < 0 ? options.trunkWeight : (tasks[arm].active ? 1.0 : 0.0);
+        x[c] = std::max(m_lower[c], std::min(m_upper[c], solution[m_jointIds[c]] * m_scale[c]));
+        best[c] = x[c];
+    }
+    double bestCost = std::numeric_limits<double>::infinity();
+    const double weight = ikOptions.orientationWeight;
+    double jacobian[MAX_ROWS * MAX_JOINTS];
+    Transform poses[2];
+
+    for (int iteration = 0; ; ++iteration) {
+        for (int c = 0; c < n; ++c) {
+            solution[m_jointIds[c]] = x[c] / m_scale[c];
+        }
+        const int rows = stackedJacobian(solution, tasks, jacobian, poses);
+        if (rows == 0) {
+            break;
+        }
+
+        // 各臂残差，姿态行乘权重；收敛和最优解都按两臂中较大的残差判断
+        double error[MAX_ROWS];
+        double positionError = 0.0;
+        double orientationError = 0.0;
+        int row = 0;
+        for (int arm = 0; arm < 2; ++arm) {
+            if (!tasks[arm].active || m_armCount[arm] == 0) {
+                continue;
+            }
+            const Transform &target = tasks[arm].target;
+            for (int k = 0; k < 3; ++k) {
+                error[row + k] = target.p[k] - poses[arm].p[k];
+            }
+            ArmIkSolver::orientationError(target, poses[arm], error + row + 3);
+            const double *e = error + row;
+            positionError = std::max(positionError, std::sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]));
+            orientationError = std::max(orientationError, std::sqrt(e[3] * e[3] + e[4] * e[4] + e[5] * e[5]));
+            row += 6;
+        }
+
+        result.iterations = iteration;
+        const bool converged = positionError <= ikOptions.positionTolerance
+                            && orientationError <= ikOptions.orientationTolerance;
+        const double cost = positionError + weight * orientationError;
+        if (converged || cost < bestCost) {
+            bestCost = cost;
+            std::copy(x, x + n, best);
+            result.positionError = positionError;
+            result.orientationError = orientationError;
+        }
+        if (converged) {
+            result.converged = true;
+            break;
+        }
+        if (iteration >= ikOptions.maxIterations) {
+            break;
+        }
+
+        double lambda2 = ikOptions.damping * ikOptions.damping;
+        for (int r = 0; r < rows; ++r) {
+            if (r % 6 >= 3) {
+                error[r] *= weight;
+                for (int c = 0; c < n; ++c) {
+                    jacobian[r * n + c] *= weight;
+                }
+            }
+            lambda2 += 0.5 * error[r] * error[r];
+        }
+
+        // 次任务随残差减小而减弱：零空间运动对末端仍有二阶影响，否则会在容差附近来回拉扯
+        double z[MAX_JOINTS];
+        secondaryVelocities(solution, tasks, options, z);
+        const double fade = std::min(1.0, cost / (LIMIT_FADE * ikOptions.positionTolerance));
+        for (int c = 0; c < n; ++c) {
+            z[c] *= fade;
+        }
+        double step[MAX_JOINTS];
+        if (!resolve(jacobian, rows, weights, error, z, lambda2, step)) {
+            break;
+        }
+
+        // 截断步长后更新并夹紧到限位
+        double largest = 0.0;
+        for (int c = 0; c < n; ++c) {
+            largest = std::max(largest, std::fabs(step[c]));
+        }
+        const double shrink = largest > ikOptions.maxStep ? ikOptions.maxStep / largest : 1.0;
+        for (int c = 0; c < n; ++c) {
+            x[c] = std::max(m_lower[c], std::min(m_upper[c], x[c] + step[c] * shrink));
+        }
+    }
+
+    for (int c = 0; c < n; ++c) {
+        solution[m_jointIds[c]] = best[c] / m_scale[c];
+    }
+    return result;
+}
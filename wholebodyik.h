@@ -0,0 +1,95 @@
+#ifndef WHOLEBODYIK_H
+#define WHOLEBODYIK_H
+
+#include "kinematics.h"
+#include "inversekinematics.h"
+
+// 全身冗余分解参数。长度为米，角度为弧度
+struct WholeBodyOptions {
+    double trunkWeight;             // 躯干关节（升降、腰部）相对手臂关节的权重，越小越少动躯干
+    double centeringGain;           // 零空间目标：各关节向行程中点回退的速率（1/秒）
+    double manipulabilityGain;      // 零空间目标：沿两臂对数可操作度的梯度方向运动的增益
+    double gradientStep;            // 可操作度梯度的差分步长（弧度/米）
+
+    WholeBodyOptions()
+        : trunkWeight(0.3), centeringGain(0.05), manipulabilityGain(0.05), gradientStep(1e-4) {}
+};
+
+// 一条手臂的末端任务：速度层为基坐标系（或工具坐标系）下的速度旋量，位置层为目标位姿。
+// 不参与的手臂不约束末端，其关节不动，末端随躯干运动
+struct WholeBodyTask {
+    bool active;
+    bool toolFrame;
+    double twist[6];                // [vx, vy, vz, wx, wy, wz]，米/秒、弧度/秒
+    Transform target;
+
+    WholeBodyTask() : active(false), toolFrame(false), twist{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 } {}
+};
+
+struct WholeBodyResult {
+    double scale;                   // 实际执行的速度比例（0 ~ 1）
+    double manipulability[2];       // 左、右臂（含躯干关节）的 sqrt(det(J J^T))，未参与为 0
+    bool limited;                   // 有关节因接近限位被减速
+
+    WholeBodyResult() : scale(0.0), manipulability{ 0.0, 0.0 }, limited(false) {}
+};
+
+// 全身逆解：升降、腰部和两臂共同完成一条或两条手臂的末端任务（主任务），
+// 关节居中和两臂可操作度作为次任务投影到主任务的零空间，不影响末端。
+// 两臂任务堆叠为 12 x 19 的雅可比，加权阻尼最小二乘：
+//   dq = W z + W J^T (J W J^T + λ²I)^-1 (v - J W z)
+// 其中 W 为关节权重（躯干权重、接近限位时降低），z 为次任务的关节速度。
+// 躯干关节同时影响两臂末端，一臂够不到时由躯干延伸，另一臂的任务保持其末端不动。
+// 求解过程不分配内存；单次速度分解含可操作度梯度约 20 次雅可比，可在控制周期内同时处理两臂。
+class WholeBodySolver
+{
+public:
+    static const int MAX_JOINTS = 3 * ArmIkSolver::MAX_CHAIN_JOINTS;
+    static const int MAX_ROWS = 12;
+    static const int MAX_MODEL_JOINTS = 64;     // 模型关节数上限（关节数组在栈上拷贝）
+
+    WholeBodySolver();
+
+    // minLimits/maxLimits 按全局关节ID索引，单位与关节一致；模型需在求解期间保持有效
+    bool configure(const KinematicModel *model, const double *minLimits, const double *maxLimits);
+    bool isConfigured() const { return m_model != nullptr; }
+    // 参与全身求解的关节：躯干、左臂、右臂依次排列
+    int jointCount() const { return m_jointCount; }
+    int jointId(int column) const { return m_jointIds[column]; }
+
+    // 速度层：tasks[0]、tasks[1] 为左、右臂任务（只用 twist）。q、maxVelocities、velocities 按全局关节ID
+    // 索引，单位与关节一致，写入躯干和参与任务的手臂关节；朝限位的速度在 limitZone 内线性减到零，
+    // 最后整体缩放以满足关节速度上限
+    WholeBodyResult velocities(const double *q, const WholeBodyTask *tasks, const double *maxVelocities,
+                               double *velocities, const WholeBodyOptions &options = WholeBodyOptions(),
+                               const JogOptions &jogOptions = JogOptions()) const;
+
+    // 位置层：tasks 只用 target，以 seed 为初值迭代，未收敛时 solution 为残差最小的解。
+    // 结果的残差取两臂中较大的
+    IkResult solve(const WholeBodyTask *tasks, const double *seed, double *solution,
+                   const WholeBodyOptions &options = WholeBodyOptions(),
+                   const IkOptions &ikOptions = IkOptions()) const;
+
+private:
+    // 参与任务的手臂的雅可比（换算到弧度/米）依次堆叠为行，列按躯干、左臂、右臂排列；返回行数
+    int stackedJacobian(const double *q, const WholeBodyTask *tasks, double *jacobian, Transform *poses) const;
+    // 次任务：关节居中 + 对数可操作度梯度（弧度/秒、米/秒）；q 在差分时临时修改，返回前复原
+    void secondaryVelocities(double *q, const WholeBodyTask *tasks, const WholeBodyOptions &options,
+                             double *z) const;
+    double armManipulability(const double *q, int arm) const;
+    int column(int arm, int chainColumn) const;     // 手臂雅可比的列在堆叠矩阵中的列
+    // dq = W z + W J^T (J W J^T + λ²I)^-1 (v - J W z)，失败返回 false
+    bool resolve(const double *jacobian, int rows, const double *weights, const double *v, const double *z,
+                 double lambda2, double *dq) const;
+
+    const KinematicModel *m_model;
+    int m_trunkCount;
+    int m_armCount[2];
+    int m_jointCount;                       // 列数：躯干、左臂、右臂依次排列
+    int m_jointIds[MAX_JOINTS];
+    double m_scale[MAX_JOINTS];             // 关节单位到弧度/米
+    double m_lower[MAX_JOINTS];             // 弧度/米
+    double m_upper[MAX_JOINTS];
+};
+
+#endif // WHOLEBODYIK_H